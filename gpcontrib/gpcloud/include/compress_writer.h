@@ -9,6 +9,12 @@
 // 2MB by default
 extern uint64_t S3_ZIP_COMPRESS_CHUNKSIZE;
 
+// CompressWriter deflates on a thread of its own. write() copies data into
+// chunks of S3_ZIP_COMPRESS_CHUNKSIZE and queues up to
+// S3_ZIP_COMPRESS_WRITEBEHIND of them, so the caller only waits when the
+// thread falls that far behind. The thread starts on the first full chunk and
+// also passes the compressed data to the underlying writer, close() finishes
+// the stream once it has stopped.
 class CompressWriter : public Writer {
    public:
     CompressWriter();
@@ -17,8 +23,9 @@ class CompressWriter : public Writer {
     virtual void open(const S3Params &params);
 
     // write() attempts to write up to count bytes from the buffer.
-    // If 'count' is larger than Zip chunk-buffer, it invokes writeOneChunk()
-    // repeatedly to finish upload. Throw exception if encounters errors.
+    // Full chunks are queued for the deflating thread, which invokes
+    // writeOneChunk() on each of them. Throw exception if encounters errors,
+    // including those of the thread.
     virtual uint64_t write(const char *buf, uint64_t count);
 
     // This should be reentrant, has no side effects when called multiple times.
@@ -27,15 +34,38 @@ class CompressWriter : public Writer {
     void setWriter(Writer *writer);
 
    private:
+    static void *DeflateThreadFunc(void *data);
+
+    void deflateChunks();
+    void stopDeflateThread();
+
     void flush();
     uint64_t writeOneChunk(const char *buf, uint64_t count);
 
     Writer *writer;
 
-    // zlib related variables.
+    // zlib related variables, only used by the deflating thread while it runs.
     z_stream zstream;
     char *out;  // Output buffer for compression.
 
+    // Ring of uncompressed chunks. The deflating thread consumes chunk inHead,
+    // write() fills chunk (inHead + inCount) % S3_ZIP_COMPRESS_WRITEBEHIND.
+    char *in[S3_ZIP_COMPRESS_WRITEBEHIND];
+    uint64_t inLen[S3_ZIP_COMPRESS_WRITEBEHIND];
+    uint64_t inHead;
+    uint64_t inCount;  // Number of chunks queued for the thread.
+    uint64_t inFill;   // Size of the chunk being filled by write().
+
+    pthread_t thread;
+    bool threadStarted;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;  // Signalled when a chunk is queued or released, or on stop.
+    bool deflateDone;     // The thread has finished, on stop or error.
+    bool stopping;        // The thread should exit once the queue is empty.
+
+    // exception_ptr is used to pass an error of the thread to write() and close().
+    std::exception_ptr sharedException;
+
     // add this flag to make close() reentrant
     bool isClosed;
 };
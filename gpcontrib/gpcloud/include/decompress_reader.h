@@ -10,6 +10,9 @@
 // 2MB by default
 extern uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE;
 
+// DecompressReader inflates on a thread of its own, which reads ahead up to
+// S3_ZIP_DECOMPRESS_READAHEAD chunks of decompressed data while the caller
+// consumes the previous ones. The thread starts on the first read().
 class DecompressReader : public Reader {
    public:
     DecompressReader();
@@ -29,19 +32,40 @@ class DecompressReader : public Reader {
     void resizeDecompressReaderBuffer(uint64_t size);
 
    private:
-    void decompress();
+    static void *InflateThreadFunc(void *data);
 
-    uint64_t getDecompressedBytesNum() {
-        return S3_ZIP_DECOMPRESS_CHUNKSIZE - this->zstream.avail_out;
-    }
+    void inflateChunks();
+
+    // Decompress the next piece of data into out, return its size.
+    uint64_t decompress(char *out);
+
+    void stopInflateThread();
 
     Reader *reader;
 
-    // zlib related variables.
+    // zlib related variables, only used by the inflating thread once it runs.
     z_stream zstream;
-    char *in;            // Input buffer for decompression.
-    char *out;           // Output buffer for decompression.
-    uint64_t outOffset;  // Next position to read in out buffer.
+    char *in;        // Input buffer for decompression.
+    bool inflateEOF;  // No more data to decompress.
+
+    // Ring of decompressed chunks. The inflating thread fills chunk
+    // (outHead + outCount) % S3_ZIP_DECOMPRESS_READAHEAD, read() copies from
+    // chunk outHead.
+    char *out[S3_ZIP_DECOMPRESS_READAHEAD];
+    uint64_t outLen[S3_ZIP_DECOMPRESS_READAHEAD];
+    uint64_t outHead;
+    uint64_t outCount;
+    uint64_t outOffset;  // Next position to read in chunk outHead.
+
+    pthread_t thread;
+    bool threadStarted;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;  // Signalled when a chunk is filled or released, or on stop.
+    bool inflateDone;     // The thread has finished, on EOF or error.
+    bool stopping;        // The thread should exit.
+
+    // exception_ptr is used to pass an error of the thread to read().
+    std::exception_ptr sharedException;
 
     bool isClosed;
 };
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_S3KEY_WRITER_H_
 #define INCLUDE_S3KEY_WRITER_H_
 
+#include <deque>
+
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3interface.h"
@@ -8,9 +10,24 @@
 
 class WriterBuffer : public vector<uint8_t> {};
 
+// A part waiting for an upload worker.
+struct WriterPart {
+    S3VectorUInt8 data;
+    uint64_t partNumber;
+};
+
+// S3KeyWriter uploads the parts of a key with a pool of up to getNumOfChunks()
+// worker threads, started as parts come. Filled parts are queued behind the
+// ones in flight, so write() only waits once S3_UPLOAD_WRITEBEHIND parts are
+// waiting for a worker.
 class S3KeyWriter : public Writer {
    public:
-    S3KeyWriter() : sharedError(false), s3Interface(NULL), partNumber(0), activeThreads(0) {
+    S3KeyWriter()
+        : sharedError(false),
+          s3Interface(NULL),
+          partNumber(0),
+          activeThreads(0),
+          noMoreParts(false) {
         pthread_mutex_init(&this->mutex, NULL);
         pthread_cond_init(&this->cv, NULL);
         pthread_mutex_init(&this->exceptionMutex, NULL);
@@ -42,6 +59,7 @@ class S3KeyWriter : public Writer {
     static void* UploadThreadFunc(void* p);
 
     void flushBuffer();
+    void stopUploadThreads();
     void completeKeyWriting();
     void checkQueryCancelSignal();
 
@@ -55,11 +73,14 @@ class S3KeyWriter : public Writer {
     string uploadId;
     map<uint64_t, string> etagList;
 
-    vector<pthread_t> threadList;
+    vector<pthread_t> threadList;  // Upload workers.
     pthread_mutex_t mutex;
-    pthread_cond_t cv;
+    pthread_cond_t cv;  // Signalled when a part is queued or taken, or on stop.
     uint64_t partNumber;
-    uint64_t activeThreads;
+    uint64_t activeThreads;  // Number of workers uploading a part.
+
+    std::deque<WriterPart*> partQueue;
+    bool noMoreParts;  // Workers exit once the queue is empty.
 
     S3Params params;
 };
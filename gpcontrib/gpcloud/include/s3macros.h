@@ -27,6 +27,15 @@ extern uint64_t S3_ZIP_COMPRESS_CHUNKSIZE;
 
 #define S3_ZIP_DEFAULT_CHUNKSIZE (1024 * 1024 * 2)
 
+// number of decompressed chunks the inflating thread may have ready ahead of read()
+#define S3_ZIP_DECOMPRESS_READAHEAD 3
+
+// number of uncompressed chunks write() may queue ahead of the deflating thread
+#define S3_ZIP_COMPRESS_WRITEBEHIND 3
+
+// number of parts the upload workers may have waiting behind the ones in flight
+#define S3_UPLOAD_WRITEBEHIND 2
+
 // For deflate, windowBits can be greater than 15 for optional gzip encoding. Add 16 to windowBits
 // to write a simple gzip header and trailer around the compressed data instead of a zlib wrapper.
 #define S3_DEFLATE_WINDOWSBITS (MAX_WBITS + 16)
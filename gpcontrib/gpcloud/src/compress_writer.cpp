@@ -2,8 +2,20 @@
 
 uint64_t S3_ZIP_COMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-CompressWriter::CompressWriter() : writer(NULL), isClosed(true) {
+CompressWriter::CompressWriter() : writer(NULL), threadStarted(false), isClosed(true) {
     this->out = new char[S3_ZIP_COMPRESS_CHUNKSIZE];
+    for (int i = 0; i < S3_ZIP_COMPRESS_WRITEBEHIND; i++) {
+        this->in[i] = new char[S3_ZIP_COMPRESS_CHUNKSIZE];
+        this->inLen[i] = 0;
+    }
+    this->inHead = 0;
+    this->inCount = 0;
+    this->inFill = 0;
+    this->deflateDone = false;
+    this->stopping = false;
+
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->cond, NULL);
 }
 
 CompressWriter::~CompressWriter() {
@@ -11,7 +23,13 @@ CompressWriter::~CompressWriter() {
         this->close();
     } catch (...) {
     }
-    delete this->out;
+    delete[] this->out;
+    for (int i = 0; i < S3_ZIP_COMPRESS_WRITEBEHIND; i++) {
+        delete[] this->in[i];
+    }
+
+    pthread_mutex_destroy(&this->mutex);
+    pthread_cond_destroy(&this->cond);
 }
 
 void CompressWriter::open(const S3Params& params) {
@@ -31,6 +49,13 @@ void CompressWriter::open(const S3Params& params) {
     this->zstream.next_out = (Byte*)this->out;
     this->zstream.avail_out = S3_ZIP_COMPRESS_CHUNKSIZE;
 
+    this->inHead = 0;
+    this->inCount = 0;
+    this->inFill = 0;
+    this->deflateDone = false;
+    this->stopping = false;
+    this->sharedException = NULL;
+
     S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError,
                     string("Failed to initialize zlib library: ") + this->zstream.msg);
 
@@ -76,22 +101,127 @@ uint64_t CompressWriter::write(const char* buf, uint64_t count) {
 
     uint64_t writtenLen = 0;
 
-    for (uint64_t i = 0; i < (count / S3_ZIP_COMPRESS_CHUNKSIZE); i++) {
-        writtenLen += this->writeOneChunk(buf + writtenLen, S3_ZIP_COMPRESS_CHUNKSIZE);
-    }
+    while (writtenLen < count) {
+        uint64_t slot;
+        {
+            UniqueLock lock(&this->mutex);
 
-    if (writtenLen < count) {
-        writtenLen += this->writeOneChunk(buf + writtenLen, count - writtenLen);
+            // the chunk being filled is free unless the whole ring is queued.
+            while (this->inCount == S3_ZIP_COMPRESS_WRITEBEHIND && !this->deflateDone) {
+                pthread_cond_wait(&this->cond, &this->mutex);
+            }
+
+            if (this->sharedException != NULL) {
+                std::rethrow_exception(this->sharedException);
+            }
+
+            slot = (this->inHead + this->inCount) % S3_ZIP_COMPRESS_WRITEBEHIND;
+        }
+
+        uint64_t len = std::min(count - writtenLen, S3_ZIP_COMPRESS_CHUNKSIZE - this->inFill);
+        memcpy(this->in[slot] + this->inFill, buf + writtenLen, len);
+        this->inFill += len;
+        writtenLen += len;
+
+        if (this->inFill == S3_ZIP_COMPRESS_CHUNKSIZE) {
+            if (!this->threadStarted) {
+                int ret = pthread_create(&this->thread, NULL, DeflateThreadFunc, this);
+                S3_CHECK_OR_DIE(ret == 0, S3RuntimeError, "failed to create compression thread");
+                this->threadStarted = true;
+            }
+
+            // hand the full chunk to the thread.
+            UniqueLock lock(&this->mutex);
+            this->inLen[slot] = this->inFill;
+            this->inCount++;
+            this->inFill = 0;
+            pthread_cond_broadcast(&this->cond);
+        }
     }
 
     return writtenLen;
 }
 
+void* CompressWriter::DeflateThreadFunc(void* data) {
+    MaskThreadSignals();
+
+    CompressWriter* compressWriter = static_cast<CompressWriter*>(data);
+
+    S3DEBUG("Compression thread starts");
+    try {
+        compressWriter->deflateChunks();
+    } catch (...) {
+        UniqueLock lock(&compressWriter->mutex);
+        compressWriter->sharedException = std::current_exception();
+    }
+
+    {
+        UniqueLock lock(&compressWriter->mutex);
+        compressWriter->deflateDone = true;
+        pthread_cond_broadcast(&compressWriter->cond);
+    }
+    S3DEBUG("Compression thread ended");
+
+    return NULL;
+}
+
+// Deflate the queued chunks in order until asked to stop with an empty queue.
+void CompressWriter::deflateChunks() {
+    while (true) {
+        uint64_t slot;
+        {
+            UniqueLock lock(&this->mutex);
+            while (this->inCount == 0 && !this->stopping) {
+                pthread_cond_wait(&this->cond, &this->mutex);
+            }
+            if (this->inCount == 0) {
+                return;
+            }
+            slot = this->inHead;
+        }
+
+        this->writeOneChunk(this->in[slot], this->inLen[slot]);
+
+        UniqueLock lock(&this->mutex);
+        this->inHead = (this->inHead + 1) % S3_ZIP_COMPRESS_WRITEBEHIND;
+        this->inCount--;
+        pthread_cond_broadcast(&this->cond);
+    }
+}
+
+void CompressWriter::stopDeflateThread() {
+    if (!this->threadStarted) {
+        return;
+    }
+
+    {
+        UniqueLock lock(&this->mutex);
+        this->stopping = true;
+        pthread_cond_broadcast(&this->cond);
+    }
+
+    // the thread deflates the queued chunks before it exits.
+    pthread_join(this->thread, NULL);
+    this->threadStarted = false;
+}
+
 void CompressWriter::close() {
     if (this->isClosed) {
         return;
     }
 
+    this->stopDeflateThread();
+
+    if (this->sharedException != NULL) {
+        deflateEnd(&this->zstream);
+        this->isClosed = true;
+        std::rethrow_exception(this->sharedException);
+    }
+
+    // the queue is empty now, deflate the partially filled chunk here.
+    this->writeOneChunk(this->in[this->inHead], this->inFill);
+    this->inFill = 0;
+
     int status;
     do {
         status = deflate(&this->zstream, Z_FINISH);
@@ -2,26 +2,44 @@
 
 uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-DecompressReader::DecompressReader() : isClosed(true) {
+DecompressReader::DecompressReader() : threadStarted(false), isClosed(true) {
     this->reader = NULL;
     this->in = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
-    this->out = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
+    for (int i = 0; i < S3_ZIP_DECOMPRESS_READAHEAD; i++) {
+        this->out[i] = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
+        this->outLen[i] = 0;
+    }
+    this->outHead = 0;
+    this->outCount = 0;
     this->outOffset = 0;
+    this->inflateEOF = false;
+    this->inflateDone = false;
+    this->stopping = false;
+
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->cond, NULL);
 }
 
 DecompressReader::~DecompressReader() {
     this->close();
 
-    delete this->in;
-    delete this->out;
+    delete[] this->in;
+    for (int i = 0; i < S3_ZIP_DECOMPRESS_READAHEAD; i++) {
+        delete[] this->out[i];
+    }
+
+    pthread_mutex_destroy(&this->mutex);
+    pthread_cond_destroy(&this->cond);
 }
 
-// Used for unit test to adjust buffer size
+// Used for unit test to adjust buffer size, before the first read()
 void DecompressReader::resizeDecompressReaderBuffer(uint64_t size) {
-    delete this->in;
-    delete this->out;
+    delete[] this->in;
     this->in = new char[size];
-    this->out = new char[size];
+    for (int i = 0; i < S3_ZIP_DECOMPRESS_READAHEAD; i++) {
+        delete[] this->out[i];
+        this->out[i] = new char[size];
+    }
     this->outOffset = 0;
     this->zstream.avail_out = size;
 }
@@ -36,12 +54,18 @@ void DecompressReader::open(const S3Params &params) {
     zstream.zfree = Z_NULL;
     zstream.opaque = Z_NULL;
     zstream.next_in = Z_NULL;
-    zstream.next_out = (Byte *)this->out;
+    zstream.next_out = Z_NULL;
 
     zstream.avail_in = 0;
     zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
 
+    this->outHead = 0;
+    this->outCount = 0;
     this->outOffset = 0;
+    this->inflateEOF = false;
+    this->inflateDone = false;
+    this->stopping = false;
+    this->sharedException = NULL;
 
     // with S3_INFLATE_WINDOWSBITS, it could recognize and decode both zlib and gzip stream.
     int ret = inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS);
@@ -53,29 +77,110 @@ void DecompressReader::open(const S3Params &params) {
 }
 
 uint64_t DecompressReader::read(char *buf, uint64_t bufSize) {
-    uint64_t remainingOutLen = this->getDecompressedBytesNum() - this->outOffset;
+    if (!this->threadStarted) {
+        int ret = pthread_create(&this->thread, NULL, InflateThreadFunc, this);
+        S3_CHECK_OR_DIE(ret == 0, S3RuntimeError, "failed to create decompression thread");
+        this->threadStarted = true;
+    }
 
-    if (remainingOutLen == 0) {
-        this->decompress();
-        this->outOffset = 0;  // reset cursor for out buffer to read from beginning.
-        remainingOutLen = this->getDecompressedBytesNum();
+    uint64_t remainingOutLen;
+    {
+        UniqueLock lock(&this->mutex);
+
+        while (true) {
+            while (this->outCount == 0 && !this->inflateDone) {
+                pthread_cond_wait(&this->cond, &this->mutex);
+            }
+
+            if (this->outCount == 0) {
+                if (this->sharedException != NULL) {
+                    std::rethrow_exception(this->sharedException);
+                }
+                return 0;  // EOF
+            }
+
+            remainingOutLen = this->outLen[this->outHead] - this->outOffset;
+            if (remainingOutLen > 0) {
+                break;
+            }
+
+            // current chunk is consumed, hand it back to the thread.
+            this->outHead = (this->outHead + 1) % S3_ZIP_DECOMPRESS_READAHEAD;
+            this->outCount--;
+            this->outOffset = 0;  // reset cursor for out buffer to read from beginning.
+            pthread_cond_broadcast(&this->cond);
+        }
     }
 
+    // the thread doesn't touch the chunk at outHead until we release it.
     uint64_t count = std::min(remainingOutLen, bufSize);
-    memcpy(buf, this->out + outOffset, count);
+    memcpy(buf, this->out[this->outHead] + outOffset, count);
 
     this->outOffset += count;
 
     return count;
 }
 
-// Read compressed data from underlying reader and decompress to this->out buffer.
-// If no more data to consume, this->zstream.avail_out == S3_ZIP_DECOMPRESS_CHUNKSIZE;
-void DecompressReader::decompress() {
-    if (this->zstream.avail_in == 0) {
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
+void *DecompressReader::InflateThreadFunc(void *data) {
+    MaskThreadSignals();
+
+    DecompressReader *decompressReader = static_cast<DecompressReader *>(data);
+
+    S3DEBUG("Decompression thread starts");
+    try {
+        decompressReader->inflateChunks();
+    } catch (...) {
+        UniqueLock lock(&decompressReader->mutex);
+        decompressReader->sharedException = std::current_exception();
+        decompressReader->inflateDone = true;
+        pthread_cond_broadcast(&decompressReader->cond);
+    }
+    S3DEBUG("Decompression thread ended");
+
+    return NULL;
+}
+
+// Fill the ring of decompressed chunks until EOF or stop. Empty pieces of
+// output are not handed to read(), so that it returns 0 only at EOF.
+void DecompressReader::inflateChunks() {
+    while (true) {
+        uint64_t slot;
+        {
+            UniqueLock lock(&this->mutex);
+            while (this->outCount == S3_ZIP_DECOMPRESS_READAHEAD && !this->stopping) {
+                pthread_cond_wait(&this->cond, &this->mutex);
+            }
+            if (this->stopping) {
+                return;
+            }
+            slot = (this->outHead + this->outCount) % S3_ZIP_DECOMPRESS_READAHEAD;
+        }
+
+        uint64_t len = this->decompress(this->out[slot]);
+
+        UniqueLock lock(&this->mutex);
+        if (len > 0) {
+            this->outLen[slot] = len;
+            this->outCount++;
+        }
+        if (this->inflateEOF) {
+            this->inflateDone = true;
+        }
+        pthread_cond_broadcast(&this->cond);
+
+        if (this->inflateDone) {
+            return;
+        }
+    }
+}
+
+// Read compressed data from underlying reader and decompress to out buffer.
+// If no more data to consume, set inflateEOF.
+uint64_t DecompressReader::decompress(char *out) {
+    this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
+    this->zstream.next_out = (Byte *)out;
 
+    if (this->zstream.avail_in == 0) {
         // read S3_ZIP_DECOMPRESS_CHUNKSIZE data from underlying reader and put into this->in
         // buffer. read() might happen more than once when reaching EOF, make sure every time read()
         // will return 0.
@@ -88,7 +193,8 @@ void DecompressReader::decompress() {
                 "total_out = %u",
                 zstream.avail_in, zstream.avail_out,
 		(unsigned int) zstream.total_in, (unsigned int) zstream.total_out);
-            return;
+            this->inflateEOF = true;
+            return 0;
         }
 
         // Fill this->in as possible as it could, otherwise data in this->in might not be able to be
@@ -106,25 +212,46 @@ void DecompressReader::decompress() {
 
         this->zstream.next_in = (Byte *)this->in;
         this->zstream.avail_in = hasRead;
-    } else {
-        // Still have more data in 'in' buffer to decode.
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
     }
 
     int status = inflate(&this->zstream, Z_NO_FLUSH);
+    uint64_t len = S3_ZIP_DECOMPRESS_CHUNKSIZE - this->zstream.avail_out;
     if (status == Z_STREAM_END) {
         S3DEBUG("Decompression finished: Z_STREAM_END.");
+
+        // Nothing more comes out of a finished stream.
+        if (len == 0) {
+            this->inflateEOF = true;
+        }
     } else if (status < 0 || status == Z_NEED_DICT) {
         inflateEnd(&this->zstream);
         S3_CHECK_OR_DIE(
             false, S3RuntimeError,
             string("Failed to decompress data: ") + std::to_string((unsigned long long)status));
     }
+
+    return len;
+}
+
+void DecompressReader::stopInflateThread() {
+    if (!this->threadStarted) {
+        return;
+    }
+
+    {
+        UniqueLock lock(&this->mutex);
+        this->stopping = true;
+        pthread_cond_broadcast(&this->cond);
+    }
+
+    // the thread finishes the chunk it is decompressing, if any.
+    pthread_join(this->thread, NULL);
+    this->threadStarted = false;
 }
 
 void DecompressReader::close() {
     if (!this->isClosed) {
+        this->stopInflateThread();
         inflateEnd(&zstream);
         this->reader->close();
         this->isClosed = true;
@@ -52,17 +52,8 @@ void S3KeyWriter::close() {
 
 void S3KeyWriter::checkQueryCancelSignal() {
     if (S3QueryIsAbortInProgress() && !this->uploadId.empty()) {
-        // to avoid dead-lock when other upload threads hold the lock
-        pthread_mutex_unlock(&this->mutex);
-
-        // wait for all threads to complete
-        for (size_t i = 0; i < threadList.size(); i++) {
-            pthread_join(threadList[i], NULL);
-        }
-        this->threadList.clear();
-
-        // to avoid double unlock as other parts may lock it
-        pthread_mutex_lock(&this->mutex);
+        // wait for all threads to complete, uploads of the queued parts give up early on abort.
+        this->stopUploadThreads();
 
         S3DEBUG("Start aborting multipart uploading (uploadID: %s, %lu parts uploaded)",
                 this->uploadId.c_str(), this->etagList.size());
@@ -76,85 +67,129 @@ void S3KeyWriter::checkQueryCancelSignal() {
     }
 }
 
-struct ThreadParams {
-    S3KeyWriter* keyWriter;
-    S3VectorUInt8 data;
-    uint64_t currentNumber;
-};
-
 void* S3KeyWriter::UploadThreadFunc(void* data) {
     MaskThreadSignals();
 
-    ThreadParams* params = (ThreadParams*)data;
-    S3KeyWriter* writer = params->keyWriter;
-
-    try {
-        S3DEBUG("Upload thread start: %" PRIX64 ", part number: %" PRIu64 ", data size: %zu",
-                (uint64_t) pthread_self(), params->currentNumber, params->data.size());
-        string etag = writer->s3Interface->uploadPartOfData(
-            params->data, writer->params.getS3Url(), params->currentNumber, writer->uploadId);
-
-        // when unique_lock destructs it will automatically unlock the mutex.
-        UniqueLock threadLock(&writer->mutex);
+    S3KeyWriter* writer = (S3KeyWriter*)data;
+
+    S3DEBUG("Upload thread start: %" PRIX64, (uint64_t) pthread_self());
+    while (true) {
+        WriterPart* part;
+        {
+            UniqueLock queueLock(&writer->mutex);
+            while (writer->partQueue.empty() && !writer->noMoreParts) {
+                pthread_cond_wait(&writer->cv, &writer->mutex);
+            }
+            if (writer->partQueue.empty()) {
+                break;
+            }
+
+            part = writer->partQueue.front();
+            writer->partQueue.pop_front();
+            writer->activeThreads++;
+
+            // notify the flushBuffer, there is room for another part in the queue.
+            pthread_cond_broadcast(&writer->cv);
+        }
 
-        // etag is empty if the query is cancelled by user.
-        if (!etag.empty()) {
-            writer->etagList[params->currentNumber] = etag;
+        try {
+            S3DEBUG("Upload part start: %" PRIX64 ", part number: %" PRIu64 ", data size: %zu",
+                    (uint64_t) pthread_self(), part->partNumber, part->data.size());
+            string etag = writer->s3Interface->uploadPartOfData(
+                part->data, writer->params.getS3Url(), part->partNumber, writer->uploadId);
+
+            // when unique_lock destructs it will automatically unlock the mutex.
+            UniqueLock threadLock(&writer->mutex);
+
+            // etag is empty if the query is cancelled by user.
+            if (!etag.empty()) {
+                writer->etagList[part->partNumber] = etag;
+            }
+            writer->activeThreads--;
+            S3DEBUG("Upload part finish: %" PRIX64 ", eTag: %s, part number: %" PRIu64,
+                    (uint64_t) pthread_self(), etag.c_str(), part->partNumber);
+        } catch (S3Exception& e) {
+            S3ERROR("Upload thread error: %s", e.getMessage().c_str());
+            {
+                UniqueLock exceptLock(&writer->exceptionMutex);
+                writer->sharedError = true;
+                writer->sharedException = std::current_exception();
+            }
+
+            UniqueLock threadLock(&writer->mutex);
+            writer->activeThreads--;
         }
-        writer->activeThreads--;
-        pthread_cond_broadcast(&writer->cv);
-        S3DEBUG("Upload part finish: %" PRIX64 ", eTag: %s, part number: %" PRIu64, (uint64_t) pthread_self(),
-                etag.c_str(), params->currentNumber);
-    } catch (S3Exception& e) {
-        S3ERROR("Upload thread error: %s", e.getMessage().c_str());
-        UniqueLock exceptLock(&writer->exceptionMutex);
-        writer->sharedError = true;
-        writer->sharedException = std::current_exception();
-
-        // notify the flushBuffer, otherwise it will be locked when trying to create a new thread.
-        writer->activeThreads--;
-        pthread_cond_broadcast(&writer->cv);
+
+        delete part;
     }
+    S3DEBUG("Upload thread end: %" PRIX64, (uint64_t) pthread_self());
 
-    delete params;
     return NULL;
 }
 
 void S3KeyWriter::flushBuffer() {
     if (!this->buffer.empty()) {
-        UniqueLock queueLock(&this->mutex);
-        while (this->activeThreads >= this->params.getNumOfChunks()) {
-            pthread_cond_wait(&this->cv, &this->mutex);
+        {
+            UniqueLock queueLock(&this->mutex);
+            while (this->partQueue.size() >= S3_UPLOAD_WRITEBEHIND) {
+                pthread_cond_wait(&this->cv, &this->mutex);
+            }
         }
 
         // Most time query is canceled during uploadPartOfData(). This is the first chance to cancel
         // and clean up upload.
         this->checkQueryCancelSignal();
 
-        this->activeThreads++;
+        WriterPart* part = new WriterPart();
+        part->data.swap(this->buffer);
+        part->partNumber = ++this->partNumber;
 
-        pthread_t writerThread;
-        ThreadParams* params = new ThreadParams();
-        params->keyWriter = this;
-        params->data.swap(this->buffer);
-        params->currentNumber = ++this->partNumber;
-        pthread_create(&writerThread, NULL, UploadThreadFunc, params);
-        threadList.emplace_back(writerThread);
+        UniqueLock queueLock(&this->mutex);
+        this->partQueue.push_back(part);
+        pthread_cond_broadcast(&this->cv);
+
+        // start another worker unless the idle ones can take all queued parts.
+        uint64_t idleThreads = this->threadList.size() - this->activeThreads;
+        if (idleThreads < this->partQueue.size() &&
+            this->threadList.size() < this->params.getNumOfChunks()) {
+            pthread_t writerThread;
+            int ret = pthread_create(&writerThread, NULL, UploadThreadFunc, this);
+            S3_CHECK_OR_DIE(ret == 0, S3RuntimeError, "Failed to create upload thread");
+            threadList.emplace_back(writerThread);
+        }
 
         this->buffer.reserve(this->params.getChunkSize());
     }
 }
 
-void S3KeyWriter::completeKeyWriting() {
-    // make sure the buffer is clear
-    this->flushBuffer();
+// Let the workers upload the queued parts, and wait for them to exit.
+void S3KeyWriter::stopUploadThreads() {
+    {
+        UniqueLock queueLock(&this->mutex);
+        this->noMoreParts = true;
+        pthread_cond_broadcast(&this->cv);
+    }
 
-    // wait for all threads to complete
     for (size_t i = 0; i < threadList.size(); i++) {
         pthread_join(threadList[i], NULL);
     }
     this->threadList.clear();
 
+    // parts are left only if no worker could be started.
+    while (!this->partQueue.empty()) {
+        delete this->partQueue.front();
+        this->partQueue.pop_front();
+    }
+    this->noMoreParts = false;
+}
+
+void S3KeyWriter::completeKeyWriting() {
+    // make sure the buffer is clear
+    this->flushBuffer();
+
+    // wait for all threads to complete
+    this->stopUploadThreads();
+
     this->checkQueryCancelSignal();
 
     vector<string> etags;
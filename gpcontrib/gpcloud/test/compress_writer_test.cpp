@@ -210,3 +210,30 @@ TEST_F(CompressWriterTest, CompressCompressedData) {
 
     EXPECT_TRUE(memcmp(compressedData.data(), result.get(), compressedData.size()) == 0);
 }
+
+class FailingWriter : public MockWriter {
+   public:
+    virtual uint64_t write(const char *buf, uint64_t count) {
+        S3_DIE(S3RuntimeError, "failed to write");
+    }
+};
+
+// Errors of the underlying writer happen on the compression thread.
+TEST(CompressWriter, PassErrorOfUnderlyingWriter) {
+    FailingWriter writer;
+    CompressWriter compressWriter;
+    compressWriter.setWriter(&writer);
+    compressWriter.open(S3Params("s3://abc/def/"));
+
+    vector<char> data(S3_ZIP_COMPRESS_CHUNKSIZE * (S3_ZIP_COMPRESS_WRITEBEHIND + 2));
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i * 7 % 251;
+    }
+
+    EXPECT_THROW(
+        {
+            compressWriter.write(data.data(), data.size());
+            compressWriter.close();
+        },
+        S3RuntimeError);
+}
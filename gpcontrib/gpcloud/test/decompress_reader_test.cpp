@@ -311,3 +311,44 @@ TEST_F(DecompressReaderTest, AbleToDecompressWithIncorrectEncodedStream) {
 
     EXPECT_THROW(decompressReader.read(outputBuffer, sizeof(outputBuffer)), S3RuntimeError);
 }
+
+TEST_F(DecompressReaderTest, AbleToDecompressMoreChunksThanReadAhead) {
+    // Many more chunks than the decompression thread may read ahead, so that it has to wait for
+    // read() to hand chunks back.
+    S3_ZIP_DECOMPRESS_CHUNKSIZE = 16;
+    decompressReader.resizeDecompressReaderBuffer(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    char hello[1000];
+    for (uint32_t i = 0; i < sizeof(hello); i++) {
+        hello[i] = 'a' + i % 26;
+    }
+    setBufReaderByRawData(hello, sizeof(hello));
+
+    char outputBuffer[sizeof(hello)] = {0};
+    uint64_t outOffset = 0;
+
+    while (outOffset < sizeof(hello)) {
+        uint64_t count =
+            decompressReader.read(outputBuffer + outOffset, sizeof(outputBuffer) - outOffset);
+        ASSERT_NE((uint64_t)0, count);
+        outOffset += count;
+    }
+
+    EXPECT_EQ((uint64_t)0, decompressReader.read(outputBuffer, sizeof(outputBuffer)));
+    EXPECT_EQ(0, memcmp(hello, outputBuffer, sizeof(hello)));
+}
+
+TEST_F(DecompressReaderTest, AbleToCloseBeforeEOF) {
+    // The decompression thread is waiting for read() to hand chunks back when we close.
+    S3_ZIP_DECOMPRESS_CHUNKSIZE = 16;
+    decompressReader.resizeDecompressReaderBuffer(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    char hello[1000];
+    memset((void *)hello, 'A', sizeof(hello));
+    setBufReaderByRawData(hello, sizeof(hello));
+
+    char outputBuffer[8] = {0};
+    EXPECT_EQ((uint64_t)8, decompressReader.read(outputBuffer, sizeof(outputBuffer)));
+
+    decompressReader.close();
+}
@@ -136,6 +136,35 @@ TEST_F(S3KeyWriterTest, TestBufferedWrite) {
     this->close();
 }
 
+TEST_F(S3KeyWriterTest, TestUploadMorePartsThanThreads) {
+    testParams.setChunkSize(0x100);
+
+    vector<string> etags;
+    for (int i = 1; i <= 20; i++) {
+        etags.push_back("\"etag" + std::to_string((long long)i) + "\"");
+    }
+
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadid1"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, _, "uploadid1"))
+        .Times(20)
+        .WillRepeatedly(Invoke([](S3VectorUInt8 &data, const S3Url &s3Url, uint64_t partNumber,
+                                  const string &uploadId) {
+            EXPECT_EQ((size_t)0x100, data.size());
+            return "\"etag" + std::to_string((long long)partNumber) + "\"";
+        }));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, "uploadid1", etags))
+        .WillOnce(Return(true));
+
+    char data[0x100 * 20];
+    this->open(testParams);
+    ASSERT_EQ(sizeof(data), this->write(data, sizeof(data)));
+
+    // parts share the upload threads.
+    EXPECT_GE(testParams.getNumOfChunks(), this->threadList.size());
+
+    this->close();
+}
+
 TEST_F(S3KeyWriterTest, TestUploadContent) {
     testParams.setChunkSize(0x100);
 
@@ -34,6 +34,7 @@
 #include "cdb/cdbappendonlystorageread.h"
 #include "cdb/cdbappendonlystoragewrite.h"
 #include "cdb/cdbvars.h"
+#include "executor/executor.h"
 #include "fmgr.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -88,6 +89,9 @@ open_datumstreamread_segfile(
  * Currently, there is one segment file for each column. This function
  * only opens files for those columns which are in the projection.
  *
+ * If readFirstBlock is false, the files are only opened; the datum stream
+ * positions itself later with datumstreamread_seek_row().
+ *
  * If blockDirectory is not NULL, the first block info is written to
  * the block directory.
  */
@@ -97,6 +101,7 @@ open_all_datumstreamread_segfiles(Relation rel,
 								  DatumStreamRead **ds,
 								  AttrNumber *proj_atts,
 								  AttrNumber num_proj_atts,
+								  bool readFirstBlock,
 								  AppendOnlyBlockDirectory *blockDirectory)
 {
 	char	   *basepath = relpathbackend(rel->rd_node, rel->rd_backend, MAIN_FORKNUM);
@@ -107,7 +112,8 @@ open_all_datumstreamread_segfiles(Relation rel,
 		AttrNumber	attno = proj_atts[i];
 
 		open_datumstreamread_segfile(basepath, rel->rd_node, segInfo, ds[attno], attno);
-		datumstreamread_block(ds[attno], blockDirectory, attno);
+		if (readFirstBlock)
+			datumstreamread_block(ds[attno], blockDirectory, attno);
 	}
 
 	pfree(basepath);
@@ -328,6 +334,22 @@ aocs_initscan(AOCSScanDesc scan)
 	pgstat_count_heap_scan(scan->rs_base.rs_rd);
 }
 
+/*
+ * Does the scan defer reading the late columns of this segment file until a
+ * row has passed the qual?
+ *
+ * Segment files written before block headers carried the first row number
+ * can't be positioned by row number, so their late columns are read along
+ * with the qual columns.
+ */
+static inline bool
+aocs_seg_is_late_materialized(AOCSScanDesc scan, AOCSFileSegInfo *segInfo)
+{
+	return scan->columnScanInfo.qual != NULL &&
+		scan->blockDirectory == NULL &&
+		segInfo->formatversion >= AORelationVersion_GetLatest();
+}
+
 static int
 open_next_scan_seg(AOCSScanDesc scan)
 {
@@ -411,12 +433,31 @@ open_next_scan_seg(AOCSScanDesc scan)
 											firstSequence);
 				}
 
-				open_all_datumstreamread_segfiles(scan->rs_base.rs_rd,
-												  curSegInfo,
-												  scan->columnScanInfo.ds,
-												  scan->columnScanInfo.proj_atts,
-												  scan->columnScanInfo.num_proj_atts,
-												  scan->blockDirectory);
+				if (aocs_seg_is_late_materialized(scan, curSegInfo))
+				{
+					open_all_datumstreamread_segfiles(scan->rs_base.rs_rd,
+													  curSegInfo,
+													  scan->columnScanInfo.ds,
+													  scan->columnScanInfo.qual_atts,
+													  scan->columnScanInfo.num_qual_atts,
+													  true,
+													  NULL);
+					open_all_datumstreamread_segfiles(scan->rs_base.rs_rd,
+													  curSegInfo,
+													  scan->columnScanInfo.ds,
+													  scan->columnScanInfo.late_atts,
+													  scan->columnScanInfo.num_late_atts,
+													  false,
+													  NULL);
+				}
+				else
+					open_all_datumstreamread_segfiles(scan->rs_base.rs_rd,
+													  curSegInfo,
+													  scan->columnScanInfo.ds,
+													  scan->columnScanInfo.proj_atts,
+													  scan->columnScanInfo.num_proj_atts,
+													  true,
+													  scan->blockDirectory);
 
 				return scan->cur_seg;
 			}
@@ -590,9 +631,72 @@ aocs_beginscan_internal(Relation relation,
 	return scan;
 }
 
+/*
+ * Enable late materialization for a sequential scan.
+ *
+ * qualcols flags the columns referenced by the scan's qual.  Projected
+ * columns not among them are only fetched for rows that satisfy the qual,
+ * which is evaluated here against the qual columns alone.  Only rows that
+ * pass are returned, and SO_QUAL_APPLIED tells the executor not to evaluate
+ * the qual again.
+ *
+ * Nothing is done unless the qual references at least one projected column
+ * and leaves at least one other projected column to defer.
+ */
+void
+aocs_enable_late_materialization(AOCSScanDesc scan, bool *qualcols,
+								 PlanState *ps)
+{
+	AttrNumber	num_proj_atts = scan->columnScanInfo.num_proj_atts;
+	AttrNumber *qual_atts;
+	AttrNumber *late_atts;
+	AttrNumber	num_qual_atts = 0;
+	AttrNumber	num_late_atts = 0;
+
+	Assert(ps != NULL && ps->qual != NULL);
+
+	/* ANALYZE samples rows by number and has no qual to speak of */
+	if ((scan->rs_base.rs_flags & SO_TYPE_ANALYZE) != 0)
+		return;
+
+	if (scan->columnScanInfo.proj_atts == NULL)
+		return;
+
+	qual_atts = palloc(num_proj_atts * sizeof(AttrNumber));
+	late_atts = palloc(num_proj_atts * sizeof(AttrNumber));
+
+	for (AttrNumber i = 0; i < num_proj_atts; i++)
+	{
+		AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+
+		if (qualcols[attno])
+			qual_atts[num_qual_atts++] = attno;
+		else
+			late_atts[num_late_atts++] = attno;
+	}
+
+	if (num_qual_atts == 0 || num_late_atts == 0)
+	{
+		pfree(qual_atts);
+		pfree(late_atts);
+		return;
+	}
+
+	scan->columnScanInfo.qual_atts = qual_atts;
+	scan->columnScanInfo.num_qual_atts = num_qual_atts;
+	scan->columnScanInfo.late_atts = late_atts;
+	scan->columnScanInfo.num_late_atts = num_late_atts;
+	scan->columnScanInfo.qual = ps->qual;
+	scan->columnScanInfo.ps = ps;
+	scan->rs_base.rs_flags |= SO_QUAL_APPLIED;
+}
+
 void
 aocs_rescan(AOCSScanDesc scan)
 {
+	/* Parameters of the qual may have changed */
+	scan->columnScanInfo.qual_code_cache_valid = false;
+
 	close_cur_scan_seg(scan);
 	if (scan->columnScanInfo.ds)
 		close_ds_read(scan->columnScanInfo.ds, scan->columnScanInfo.relationTupleDesc->natts);
@@ -623,6 +727,15 @@ aocs_endscan(AOCSScanDesc scan)
 	if (scan->columnScanInfo.proj_atts)
 		pfree(scan->columnScanInfo.proj_atts);
 
+	if (scan->columnScanInfo.qual_atts)
+		pfree(scan->columnScanInfo.qual_atts);
+
+	if (scan->columnScanInfo.late_atts)
+		pfree(scan->columnScanInfo.late_atts);
+
+	if (scan->columnScanInfo.qual_code_cache)
+		pfree(scan->columnScanInfo.qual_code_cache);
+
 	for (int i = 0; i < scan->total_seg; ++i)
 	{
 		if (scan->seginfo[i])
@@ -717,6 +830,224 @@ static void upgrade_datum_fetch(AOCSFetchDesc fetch, int attno, Datum values[],
 					   values, isnull, formatversion);
 }
 
+/*
+ * Read the next datum of a column of the current segment file into the
+ * slot's arrays.  Returns false if the segment file has no more rows.
+ */
+static inline bool
+aocs_read_next_datum(AOCSScanDesc scan, AOCSFileSegInfo *curseginfo,
+					 AttrNumber attno, Datum *d, bool *null)
+{
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+	int			err;
+
+	err = datumstreamread_advance(ds);
+	Assert(err >= 0);
+	if (err == 0)
+	{
+		err = datumstreamread_block(ds, scan->blockDirectory, attno);
+		if (err < 0)
+			return false;
+
+		err = datumstreamread_advance(ds);
+		Assert(err > 0);
+	}
+
+	/*
+	 * Get the column's datum right here since the data structures should
+	 * still be hot in CPU data cache memory.
+	 */
+	datumstreamread_get(ds, &d[attno], &null[attno]);
+
+	/*
+	 * Perform any required upgrades on the Datum we just fetched.
+	 */
+	if (curseginfo->formatversion < AORelationVersion_GetLatest())
+		upgrade_datum_scan(scan, attno, d, null, curseginfo->formatversion);
+
+	return true;
+}
+
+/*
+ * Evaluate the late materialization qual on the current row.
+ *
+ * When the qual looks at a single column and the current block of that
+ * column is dictionary encoded, the qual only depends on the dictionary
+ * code, so it is evaluated once per distinct value in the block and the
+ * result is reused for the other rows.
+ */
+static bool
+aocs_eval_late_qual(AOCSScanDesc scan, TupleTableSlot *slot)
+{
+	ExprContext *econtext = scan->columnScanInfo.ps->ps_ExprContext;
+	int8	   *cache = NULL;
+	int32		code = -1;
+	bool		result;
+
+	if (scan->columnScanInfo.num_qual_atts == 1)
+	{
+		AttrNumber	attno = scan->columnScanInfo.qual_atts[0];
+		DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+		uint32		generation;
+
+		if (!slot->tts_isnull[attno])
+			code = datumstreamread_dictionary_code(ds, &generation);
+
+		if (code >= 0)
+		{
+			if (!scan->columnScanInfo.qual_code_cache_valid ||
+				scan->columnScanInfo.qual_code_cache_generation != generation)
+			{
+				int32		count = ds->blockRead.dictionary_count;
+
+				if (scan->columnScanInfo.qual_code_cache_size < count)
+				{
+					if (scan->columnScanInfo.qual_code_cache)
+						pfree(scan->columnScanInfo.qual_code_cache);
+					scan->columnScanInfo.qual_code_cache =
+						MemoryContextAlloc(scan->columnScanInfo.scanCtx, count);
+					scan->columnScanInfo.qual_code_cache_size = count;
+				}
+				memset(scan->columnScanInfo.qual_code_cache, -1, count);
+				scan->columnScanInfo.qual_code_cache_generation = generation;
+				scan->columnScanInfo.qual_code_cache_valid = true;
+			}
+
+			cache = scan->columnScanInfo.qual_code_cache;
+			if (cache[code] >= 0)
+				return cache[code] != 0;
+		}
+	}
+
+	econtext->ecxt_scantuple = slot;
+	ResetExprContext(econtext);
+	result = ExecQual(scan->columnScanInfo.qual, econtext);
+
+	if (cache != NULL)
+		cache[code] = result ? 1 : 0;
+
+	return result;
+}
+
+/*
+ * aocs_getnext() for scans with late materialization enabled.
+ *
+ * The qual columns are read for every row and the qual is evaluated on them.
+ * The remaining projected columns are only positioned and read for rows
+ * that are visible and pass the qual; whole blocks of those columns that
+ * hold no such row are skipped without being decompressed.
+ */
+static bool
+aocs_getnext_late(AOCSScanDesc scan, TupleTableSlot *slot, AttrNumber natts)
+{
+	Datum	   *d = slot->tts_values;
+	bool	   *null = slot->tts_isnull;
+	bool		isSnapshotAny = (scan->rs_base.rs_snapshot == SnapshotAny);
+	AOTupleId	aoTupleId;
+	int			err = 0;
+
+	while (1)
+	{
+		AOCSFileSegInfo *curseginfo;
+		bool		lateSeg;
+		int64		rowNum = INT64CONST(-1);
+
+		/* If necessary, open next seg */
+		if (scan->cur_seg < 0 || err < 0)
+		{
+			err = open_next_scan_seg(scan);
+			if (err < 0)
+			{
+				/* No more seg, we are at the end */
+				ExecClearTuple(slot);
+				scan->cur_seg = -1;
+				return false;
+			}
+			scan->cur_seg_row = 0;
+		}
+
+		Assert(scan->cur_seg >= 0);
+		curseginfo = scan->seginfo[scan->cur_seg];
+		lateSeg = aocs_seg_is_late_materialized(scan, curseginfo);
+
+		for (AttrNumber i = 0; i < scan->columnScanInfo.num_qual_atts && err >= 0; i++)
+		{
+			AttrNumber	attno = scan->columnScanInfo.qual_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+			if (!aocs_read_next_datum(scan, curseginfo, attno, d, null))
+				err = -1;
+			else if (rowNum == INT64CONST(-1) &&
+					 ds->blockFirstRowNum != INT64CONST(-1))
+				rowNum = ds->blockFirstRowNum + datumstreamread_nth(ds);
+		}
+
+		/* Old segment files: read the remaining columns right away */
+		for (AttrNumber i = 0; i < scan->columnScanInfo.num_late_atts && err >= 0 && !lateSeg; i++)
+		{
+			if (!aocs_read_next_datum(scan, curseginfo,
+									  scan->columnScanInfo.late_atts[i], d, null))
+				err = -1;
+		}
+
+		if (err < 0)
+		{
+			close_cur_scan_seg(scan);
+			continue;
+		}
+
+		scan->cur_seg_row++;
+		if (rowNum == INT64CONST(-1))
+			AOTupleIdInit(&aoTupleId, curseginfo->segno, scan->cur_seg_row);
+		else
+			AOTupleIdInit(&aoTupleId, curseginfo->segno, rowNum);
+
+		if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &aoTupleId))
+			continue;
+
+		/*
+		 * Evaluate the qual against the columns read so far. The late
+		 * columns still hold the values of an earlier row, but the qual
+		 * doesn't look at them.
+		 */
+		slot->tts_nvalid = natts;
+		if (!aocs_eval_late_qual(scan, slot))
+		{
+			InstrCountFiltered1(scan->columnScanInfo.ps, 1);
+			continue;
+		}
+
+		if (lateSeg)
+		{
+			Assert(rowNum != INT64CONST(-1));
+
+			for (AttrNumber i = 0; i < scan->columnScanInfo.num_late_atts; i++)
+			{
+				AttrNumber	attno = scan->columnScanInfo.late_atts[i];
+
+				if (!datumstreamread_seek_row(scan->columnScanInfo.ds[attno], rowNum))
+					ereport(ERROR,
+							(errcode(ERRCODE_INTERNAL_ERROR),
+							 errmsg("could not find row " INT64_FORMAT " of column #%d in segment file %d of relation \"%s\"",
+									rowNum,
+									attno + 1,
+									curseginfo->segno,
+									RelationGetRelationName(scan->rs_base.rs_rd))));
+
+				datumstreamread_get(scan->columnScanInfo.ds[attno], &d[attno], &null[attno]);
+			}
+		}
+
+		scan->cdb_fake_ctid = *((ItemPointer) &aoTupleId);
+
+		slot->tts_tid = scan->cdb_fake_ctid;
+		return true;
+	}
+
+	Assert(!"Never here");
+	return false;
+}
+
 bool
 aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 {
@@ -742,6 +1073,9 @@ aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 	natts = slot->tts_tupleDescriptor->natts;
 	Assert(natts <= scan->columnScanInfo.relationTupleDesc->natts);
 
+	if (scan->columnScanInfo.qual != NULL)
+		return aocs_getnext_late(scan, slot, natts);
+
 	while (1)
 	{
 		AOCSFileSegInfo *curseginfo;
@@ -769,37 +1103,14 @@ ReadNext:
 		{
 			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
 
-			err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-			Assert(err >= 0);
-			if (err == 0)
+			if (!aocs_read_next_datum(scan, curseginfo, attno, d, null))
 			{
-				err = datumstreamread_block(scan->columnScanInfo.ds[attno], scan->blockDirectory, attno);
-				if (err < 0)
-				{
-					/*
-					 * Ha, cannot read next block, we need to go to next seg
-					 */
-					close_cur_scan_seg(scan);
-					goto ReadNext;
-				}
-
-				err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-				Assert(err > 0);
-			}
-
-			/*
-			 * Get the column's datum right here since the data structures
-			 * should still be hot in CPU data cache memory.
-			 */
-			datumstreamread_get(scan->columnScanInfo.ds[attno], &d[attno], &null[attno]);
-
-			/*
-			 * Perform any required upgrades on the Datum we just fetched.
-			 */
-			if (curseginfo->formatversion < AORelationVersion_GetLatest())
-			{
-				upgrade_datum_scan(scan, attno, d, null,
-								   curseginfo->formatversion);
+				/*
+				 * Ha, cannot read next block, we need to go to next seg
+				 */
+				err = -1;
+				close_cur_scan_seg(scan);
+				goto ReadNext;
 			}
 
 			if (rowNum == INT64CONST(-1) &&
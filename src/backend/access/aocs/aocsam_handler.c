@@ -32,6 +32,8 @@
 #include "commands/vacuum.h"
 #include "executor/executor.h"
 #include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/optimizer.h"
 #include "pgstat.h"
 #include "storage/lmgr.h"
 #include "storage/procarray.h"
@@ -419,20 +421,61 @@ extractcolumns_from_node(Node *expr, bool *cols, AttrNumber natts)
 	return  ecCtx.found;
 }
 
+static bool
+contain_system_attrs_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Var))
+	{
+		Var *var = (Var *)node;
+
+		return !IS_SPECIAL_VARNO(var->varno) && var->varattno < 0;
+	}
+
+	return expression_tree_walker(node, contain_system_attrs_walker, context);
+}
+
+/*
+ * Can the scan evaluate this qual itself, ahead of reading the columns the
+ * qual doesn't need?
+ *
+ * The scan evaluates the qual in place of ExecScan(), on a slot that only
+ * holds the qual columns. Quals with volatile functions or subplans are left
+ * to ExecScan(), so that they keep seeing complete rows. System attributes
+ * are only set up once the whole row is returned, so quals referencing them
+ * are out too.
+ */
+static bool
+qual_allows_late_materialization(List *qual)
+{
+	return !contain_volatile_functions((Node *)qual) &&
+		!contain_subplans((Node *)qual) &&
+		!contain_system_attrs_walker((Node *)qual, NULL);
+}
+
 static TableScanDesc
 aoco_beginscan_extractcolumns(Relation rel, Snapshot snapshot,
 							  List *targetlist, List *qual,
-							  uint32 flags)
+							  PlanState *ps, uint32 flags)
 {
 	AOCSScanDesc	aoscan;
 	AttrNumber		natts = RelationGetNumberOfAttributes(rel);
 	bool		   *cols;
+	bool		   *qualcols;
 	bool			found = false;
 
 	cols = palloc0(natts * sizeof(*cols));
+	qualcols = palloc0(natts * sizeof(*qualcols));
 
 	found |= extractcolumns_from_node((Node *)targetlist, cols, natts);
-	found |= extractcolumns_from_node((Node *)qual, cols, natts);
+	if (extractcolumns_from_node((Node *)qual, qualcols, natts))
+	{
+		for (AttrNumber attno = 0; attno < natts; attno++)
+			cols[attno] |= qualcols[attno];
+		found = true;
+	}
 
 	/*
 	 * GPDB_12_MERGE_FIXME: is this still true? varattno == 0 is checked inside
@@ -449,7 +492,13 @@ aoco_beginscan_extractcolumns(Relation rel, Snapshot snapshot,
 							cols,
 							flags);
 
+	if (gp_aocs_late_materialization &&
+		ps != NULL && ps->qual != NULL &&
+		qual_allows_late_materialization(qual))
+		aocs_enable_late_materialization(aoscan, qualcols, ps);
+
 	pfree(cols);
+	pfree(qualcols);
 
 	return (TableScanDesc)aoscan;
 }
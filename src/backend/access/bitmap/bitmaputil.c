@@ -25,6 +25,7 @@
 #include "access/reloptions.h"
 #include "access/relscan.h"
 #include "miscadmin.h"
+#include "port/pg_bitutils.h"
 #include "storage/bufmgr.h"
 
 static void _bitmap_findnextword(BMBatchWords* words, uint64 nextReadNo);
@@ -764,24 +765,15 @@ _bitmap_resetWord(BMBatchWords *words, uint32 prevStartNo)
 static uint8
 _bitmap_find_bitset(BM_HRL_WORD word, uint8 lastPos)
 {
-	uint8 pos = lastPos + 1;
-	BM_HRL_WORD	rightmostBitWord;
+	if (lastPos >= BM_HRL_WORD_SIZE)
+		return 0;
 
-	if (pos > BM_HRL_WORD_SIZE)
-	  return 0;
+	/* clear the bits up to and including 'lastPos' */
+	word &= ~((BM_HRL_WORD) 0) << lastPos;
+	if (word == 0)
+		return 0;
 
-	rightmostBitWord = (((BM_HRL_WORD)1) << (pos-1));
-
-	while (pos <= BM_HRL_WORD_SIZE && (word & rightmostBitWord) == 0)
-	{
-		rightmostBitWord <<= 1;
-		pos++;
-	}
-
-	if (pos > BM_HRL_WORD_SIZE)
-		pos = 0;
-
-	return pos;
+	return pg_rightmost_one_pos64(word) + 1;
 }
 
 /*
@@ -953,6 +953,23 @@ CREATE VIEW gp_stat_replication AS
          ON G.gp_segment_id = R.gp_segment_id
     );
 
+CREATE FUNCTION gp_get_segment_interconnect_peer_stats() RETURNS SETOF RECORD AS
+$$
+    SELECT pg_catalog.gp_execution_segment() AS gp_segment_id, *
+    FROM pg_catalog.gp_interconnect_get_peer_stats()
+$$
+LANGUAGE SQL EXECUTE ON ALL SEGMENTS;
+
+CREATE VIEW gp_interconnect_peer_stats AS
+    SELECT -1 AS gp_segment_id, *
+    FROM pg_catalog.gp_interconnect_get_peer_stats()
+    UNION ALL
+    SELECT *
+    FROM pg_catalog.gp_get_segment_interconnect_peer_stats() AS S
+    (gp_segment_id integer, peer_segment_id integer, peer_address text,
+     connections bigint, packets bigint, retransmits bigint,
+     rtt_us bigint, min_rtt_us bigint, cwnd float8);
+
 CREATE VIEW pg_stat_wal_receiver AS
     SELECT
             s.pid,
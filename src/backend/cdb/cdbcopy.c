@@ -616,6 +616,10 @@ cdbCopyEndInternal(CdbCopy *c, char *abort_msg,
 					PQfreemem(buffer);
 			}
 
+			/* remember if the QE has assigned an xid for the COPY */
+			if (q->conn->wrote_xlog)
+				addToGxactXLogSegments(q->segindex);
+
 			/* in SREH mode, check if this seg rejected (how many) rows */
 			if (res->numRejected > 0)
 				segment_rows_rejected = res->numRejected;
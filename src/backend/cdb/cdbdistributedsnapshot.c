@@ -24,58 +24,121 @@
 #include "storage/procarray.h"
 
 /*
- * DistributedSnapshotWithLocalMapping_CommittedTest
- *		Is the given XID still-in-progress according to the
- *      distributed snapshot?  Or, is the transaction strictly local
- *      and needs to be tested with the local snapshot?
+ * Is the local xid in the sorted cache of local xids of in-progress
+ * distributed transactions?
  */
-DistributedSnapshotCommitted
-DistributedSnapshotWithLocalMapping_CommittedTest(
-												  DistributedSnapshotWithLocalMapping *dslm,
-												  TransactionId localXid,
-												  bool isVacuumCheck)
+static bool
+LocalXidCacheFind(DistributedSnapshotWithLocalMapping *dslm,
+				  TransactionId localXid)
 {
-	DistributedSnapshot *ds = &dslm->ds;
-	uint32		i;
-	DistributedTransactionId distribXid = InvalidDistributedTransactionId;
+	int32		low = 0;
+	int32		high = dslm->currentLocalXidsCount - 1;
 
-	Assert(!IS_QUERY_DISPATCHER());
+	Assert(dslm->inProgressMappedLocalXids != NULL);
 
-	/*
-	 * Return early if local xid is not normal as it cannot have distributed
-	 * xid associated with it.
-	 */
-	if (!TransactionIdIsNormal(localXid))
-		return DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE;
+	while (low <= high)
+	{
+		int32		mid = low + (high - low) / 2;
+		TransactionId midXid = dslm->inProgressMappedLocalXids[mid];
+
+		Assert(TransactionIdIsValid(midXid));
+
+		if (TransactionIdEquals(localXid, midXid))
+			return true;
+
+		if (TransactionIdPrecedes(localXid, midXid))
+			high = mid - 1;
+		else
+			low = mid + 1;
+	}
+
+	return false;
+}
+
+/*
+ * Add a local xid to the sorted cache of local xids of in-progress
+ * distributed transactions.
+ */
+static void
+LocalXidCacheAdd(DistributedSnapshotWithLocalMapping *dslm,
+				 TransactionId localXid)
+{
+	int32		pos = dslm->currentLocalXidsCount;
+
+	Assert(dslm->inProgressMappedLocalXids != NULL);
+
+	while (pos > 0 &&
+		   TransactionIdPrecedes(localXid, dslm->inProgressMappedLocalXids[pos - 1]))
+	{
+		dslm->inProgressMappedLocalXids[pos] =
+			dslm->inProgressMappedLocalXids[pos - 1];
+		pos--;
+	}
+	dslm->inProgressMappedLocalXids[pos] = localXid;
+	dslm->currentLocalXidsCount++;
+
+	dslm->minCachedLocalXid = dslm->inProgressMappedLocalXids[0];
+	dslm->maxCachedLocalXid =
+		dslm->inProgressMappedLocalXids[dslm->currentLocalXidsCount - 1];
+}
+
+/*
+ * Is the distributed xid in the in-progress array of the snapshot?
+ *
+ * The array is sorted in ascending order while creating the snapshot in
+ * CreateDistributedSnapshot(), so binary search it.
+ */
+static bool
+InProgressXidArrayFind(DistributedSnapshot *ds,
+					   DistributedTransactionId distribXid)
+{
+	int32		low = 0;
+	int32		high = ds->count - 1;
+
+	while (low <= high)
+	{
+		int32		mid = low + (high - low) / 2;
+
+		if (distribXid == ds->inProgressXidArray[mid])
+			return true;
+
+		if (distribXid < ds->inProgressXidArray[mid])
+			high = mid - 1;
+		else
+			low = mid + 1;
+	}
+
+	return false;
+}
+
+/*
+ * DistributedSnapshotWithLocalMapping_CommittedTest, without consulting the
+ * cache of recent results.
+ */
+static DistributedSnapshotCommitted
+CommittedTestNoResultCache(DistributedSnapshotWithLocalMapping *dslm,
+						   TransactionId localXid,
+						   bool isVacuumCheck)
+{
+	DistributedSnapshot *ds = &dslm->ds;
+	DistributedTransactionId distribXid = InvalidDistributedTransactionId;
 
 	/*
-	 * Checking the distributed committed log can be expensive, so make a scan
-	 * through our cache in distributed snapshot looking for a possible
-	 * corresponding local xid only if it has value in checking.
+	 * Checking the distributed committed log can be expensive, so look for a
+	 * possible corresponding local xid in our cache in distributed snapshot
+	 * first, if it has value in checking.
 	 */
 	if (dslm->currentLocalXidsCount > 0)
 	{
 		Assert(TransactionIdIsNormal(dslm->minCachedLocalXid));
 		Assert(TransactionIdIsNormal(dslm->maxCachedLocalXid));
 
-		if (TransactionIdEquals(localXid, dslm->minCachedLocalXid) ||
-			TransactionIdEquals(localXid, dslm->maxCachedLocalXid))
+		if (TransactionIdFollowsOrEquals(localXid, dslm->minCachedLocalXid) &&
+			TransactionIdPrecedesOrEquals(localXid, dslm->maxCachedLocalXid) &&
+			LocalXidCacheFind(dslm, localXid))
 		{
 			return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 		}
-
-		if (TransactionIdFollows(localXid, dslm->minCachedLocalXid) &&
-			TransactionIdPrecedes(localXid, dslm->maxCachedLocalXid))
-		{
-			for (i = 0; i < dslm->currentLocalXidsCount; i++)
-			{
-				Assert(dslm->inProgressMappedLocalXids != NULL);
-				Assert(TransactionIdIsValid(dslm->inProgressMappedLocalXids[i]));
-
-				if (TransactionIdEquals(localXid, dslm->inProgressMappedLocalXids[i]))
-					return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
-			}
-		}
 	}
 
 	/*
@@ -178,45 +241,17 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
-	for (i = 0; i < ds->count; i++)
+	if (InProgressXidArrayFind(ds, distribXid))
 	{
-		if (distribXid == ds->inProgressXidArray[i])
-		{
-			/*
-			 * Save the relationship to the local xid so we may avoid checking
-			 * the distributed committed log in a subsequent check. We can
-			 * only record local xids till cache size permits.
-			 */
-			if (dslm->currentLocalXidsCount < ds->count)
-			{
-				Assert(dslm->inProgressMappedLocalXids != NULL);
-				dslm->inProgressMappedLocalXids[dslm->currentLocalXidsCount++] =
-					localXid;
-
-				if (!TransactionIdIsValid(dslm->minCachedLocalXid) ||
-					TransactionIdPrecedes(localXid, dslm->minCachedLocalXid))
-				{
-					dslm->minCachedLocalXid = localXid;
-				}
-
-				if (!TransactionIdIsValid(dslm->maxCachedLocalXid) ||
-					TransactionIdFollows(localXid, dslm->maxCachedLocalXid))
-				{
-					dslm->maxCachedLocalXid = localXid;
-				}
-			}
-
-			return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
-		}
-
 		/*
-		 * Leverage the fact that ds->inProgressXidArray is sorted in
-		 * ascending order based on distribXid while creating the snapshot in
-		 * CreateDistributedSnapshot(). So, can fail fast once known are
-		 * lower than rest of them.
+		 * Save the relationship to the local xid so we may avoid checking
+		 * the distributed committed log in a subsequent check. We can only
+		 * record local xids till cache size permits.
 		 */
-		if (distribXid < ds->inProgressXidArray[i])
-			break;
+		if (dslm->currentLocalXidsCount < ds->count)
+			LocalXidCacheAdd(dslm, localXid);
+
+		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
 	/*
@@ -225,6 +260,67 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 	return DISTRIBUTEDSNAPSHOT_COMMITTED_VISIBLE;
 }
 
+/*
+ * DistributedSnapshotWithLocalMapping_CommittedTest
+ *		Is the given XID still-in-progress according to the
+ *      distributed snapshot?  Or, is the transaction strictly local
+ *      and needs to be tested with the local snapshot?
+ */
+DistributedSnapshotCommitted
+DistributedSnapshotWithLocalMapping_CommittedTest(
+												  DistributedSnapshotWithLocalMapping *dslm,
+												  TransactionId localXid,
+												  bool isVacuumCheck)
+{
+	DistributedSnapshotCommitted result;
+	int			slot;
+
+	Assert(!IS_QUERY_DISPATCHER());
+
+	/*
+	 * Return early if local xid is not normal as it cannot have distributed
+	 * xid associated with it.
+	 */
+	if (!TransactionIdIsNormal(localXid))
+		return DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE;
+
+	/* Vacuum checks stop short of the snapshot, don't mix them in */
+	if (isVacuumCheck)
+		return CommittedTestNoResultCache(dslm, localXid, true);
+
+	slot = localXid & (DSLM_RESULT_CACHE_SIZE - 1);
+	if (TransactionIdEquals(dslm->cachedResultXids[slot], localXid))
+		return (DistributedSnapshotCommitted) dslm->cachedResults[slot];
+
+	result = CommittedTestNoResultCache(dslm, localXid, false);
+
+	/*
+	 * The result holds for as long as the snapshot does. That is plain for
+	 * transactions found in the distributed log. A transaction that is not
+	 * there yet can only get there by committing after the distributed
+	 * snapshot was taken, and so after the local one too; the local
+	 * visibility check the caller does for UNKNOWN keeps seeing it as
+	 * in-progress, just as the distributed snapshot would.
+	 */
+	dslm->cachedResultXids[slot] = localXid;
+	dslm->cachedResults[slot] = (uint8) result;
+
+	return result;
+}
+
+/*
+ * Forget what has been cached in the snapshot about local xids, for when the
+ * distributed snapshot changes.
+ */
+void
+DistributedSnapshotWithLocalMapping_ResetCache(DistributedSnapshotWithLocalMapping *dslm)
+{
+	dslm->currentLocalXidsCount = 0;
+	dslm->minCachedLocalXid = InvalidTransactionId;
+	dslm->maxCachedLocalXid = InvalidTransactionId;
+	MemSet(dslm->cachedResultXids, 0, sizeof(dslm->cachedResultXids));
+}
+
 /*
  * Reset all fields except maxCount and the malloc'd pointer for
  * inProgressXidArray.
@@ -78,3 +78,91 @@ cdbRelMaxSegSize(Relation rel)
 
 	return size;
 }
+
+/*
+ * Number of relations whose sizes are asked for in one dispatched query by
+ * cdbRelMaxSegSizes(). Bounds the length of the query text.
+ */
+#define RELSIZE_BATCH_SIZE	1024
+
+/*
+ * Get the max size across segments of each relation in a list of relation
+ * Oids, storing the size of the i'th relation in sizes[i].
+ *
+ * This is the same as calling cdbRelMaxSegSize() on each relation, but the
+ * sizes are collected with one dispatch per batch of relations instead of
+ * one per relation, and the relations don't need to be opened. A relation
+ * that no longer exists has size 0.
+ */
+void
+cdbRelMaxSegSizes(List *relids, int64 *sizes)
+{
+	ListCell   *lc;
+	int			nrelids = list_length(relids);
+	int			batchstart = 0;
+
+	if (nrelids == 0)
+		return;
+
+	memset(sizes, 0, sizeof(int64) * nrelids);
+
+	lc = list_head(relids);
+	while (batchstart < nrelids)
+	{
+		CdbPgResults cdb_pgresults = {NULL, 0};
+		StringInfoData sql;
+		int			batchsize = Min(RELSIZE_BATCH_SIZE, nrelids - batchstart);
+		int			i;
+
+		/*
+		 * Relation Oids are assumed to be in sync in all nodes. The
+		 * ordinality keeps the result rows in the order of the Oids.
+		 */
+		initStringInfo(&sql);
+		appendStringInfoString(&sql,
+							   "select pg_catalog.pg_relation_size(r.oid) "
+							   "from pg_catalog.unnest('{");
+		for (i = 0; i < batchsize; i++)
+		{
+			appendStringInfo(&sql, "%s%u", i > 0 ? "," : "", lfirst_oid(lc));
+			lc = lnext(lc);
+		}
+		appendStringInfoString(&sql,
+							   "}'::pg_catalog.oid[]) with ordinality as r(oid, n) "
+							   "order by r.n");
+
+		CdbDispatchCommand(sql.data, DF_WITH_SNAPSHOT, &cdb_pgresults);
+
+		for (i = 0; i < cdb_pgresults.numResults; i++)
+		{
+			struct pg_result *pgresult = cdb_pgresults.pg_results[i];
+			int			j;
+
+			if (PQresultStatus(pgresult) != PGRES_TUPLES_OK)
+			{
+				cdbdisp_clearCdbPgResults(&cdb_pgresults);
+				elog(ERROR, "cdbRelMaxSegSizes: resultStatus not tuples_Ok: %s %s",
+					 PQresStatus(PQresultStatus(pgresult)), PQresultErrorMessage(pgresult));
+			}
+
+			Assert(PQntuples(pgresult) == batchsize);
+			for (j = 0; j < batchsize; j++)
+			{
+				int64		tempsize = 0;
+
+				/* pg_relation_size() is NULL for a dropped relation */
+				if (PQgetisnull(pgresult, j, 0))
+					continue;
+
+				(void) scanint8(PQgetvalue(pgresult, j, 0), false, &tempsize);
+				if (tempsize > sizes[batchstart + j])
+					sizes[batchstart + j] = tempsize;
+			}
+		}
+
+		pfree(sql.data);
+		cdbdisp_clearCdbPgResults(&cdb_pgresults);
+
+		batchstart += batchsize;
+	}
+}
@@ -119,6 +119,8 @@ int	max_tm_gxacts = 100;
 static void doPrepareTransaction(void);
 static void doInsertForgetCommitted(void);
 static void doNotifyingOnePhaseCommit(void);
+static void splitReadOnlySegments(void);
+static bool preparedDtxDispatchProtocolCommand(DtxProtocolCommand dtxProtocolCommand);
 static void doNotifyingCommitPrepared(void);
 static void doNotifyingAbort(void);
 static void retryAbortPrepared(void);
@@ -431,7 +433,7 @@ doPrepareTransaction(void)
 	elog(DTM_DEBUG5, "doPrepareTransaction moved to state = %s", DtxStateToString(MyTmGxactLocal->state));
 
 	Assert(MyTmGxactLocal->dtxSegments != NIL);
-	succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE, true);
+	succeeded = preparedDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE);
 
 	/*
 	 * Now we've cleaned up our dispatched statement, cancels are allowed
@@ -502,6 +504,65 @@ doNotifyingOnePhaseCommit(void)
 	}
 }
 
+/*
+ * Split the segments of the transaction into the ones that have assigned an
+ * xid, which get the PREPARE, and the read-only ones. The read-only ones are
+ * not prepared, but they stay in the transaction, still holding their locks,
+ * until the commit decision has been made, and are then committed in one
+ * phase after COMMIT PREPARED.
+ */
+static void
+splitReadOnlySegments(void)
+{
+	List	   *readOnlySegments = NIL;
+	List	   *prepareSegments = NIL;
+	ListCell   *lc;
+	MemoryContext oldContext;
+
+	oldContext = MemoryContextSwitchTo(TopTransactionContext);
+	foreach(lc, MyTmGxactLocal->dtxSegments)
+	{
+		int			segindex = lfirst_int(lc);
+
+		if (bms_is_member(segindex, MyTmGxactLocal->xlogSegmentsMap))
+			prepareSegments = lappend_int(prepareSegments, segindex);
+		else
+			readOnlySegments = lappend_int(readOnlySegments, segindex);
+	}
+	MemoryContextSwitchTo(oldContext);
+
+	/* the prepare must still go to at least one segment */
+	if (readOnlySegments == NIL || prepareSegments == NIL)
+	{
+		list_free(readOnlySegments);
+		list_free(prepareSegments);
+		return;
+	}
+
+	elog(DTM_DEBUG5, "splitReadOnlySegments preparing %d of %d segments",
+		 list_length(prepareSegments), list_length(MyTmGxactLocal->dtxSegments));
+
+	MyTmGxactLocal->prepareSegments = prepareSegments;
+	MyTmGxactLocal->readOnlySegments = readOnlySegments;
+}
+
+/*
+ * Dispatch a DTM command to the segments that took part in the PREPARE.
+ */
+static bool
+preparedDtxDispatchProtocolCommand(DtxProtocolCommand dtxProtocolCommand)
+{
+	char		gid[TMGIDSIZE];
+	List	   *segments = MyTmGxactLocal->prepareSegments;
+
+	if (segments == NIL)
+		segments = MyTmGxactLocal->dtxSegments;
+
+	dtxFormGID(gid, getDistributedTransactionTimestamp(), getDistributedTransactionId());
+	return doDispatchDtxProtocolCommand(dtxProtocolCommand, gid, true,
+										segments, NULL, 0);
+}
+
 static void
 doNotifyingCommitPrepared(void)
 {
@@ -531,7 +592,22 @@ doNotifyingCommitPrepared(void)
 	Assert(MyTmGxactLocal->dtxSegments != NIL);
 	PG_TRY();
 	{
-		succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_COMMIT_PREPARED, true);
+		succeeded = preparedDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_COMMIT_PREPARED);
+
+		/*
+		 * The decision is made, let the read-only segments go. If this fails,
+		 * the retry below resets the gangs, which aborts them, and they have
+		 * nothing to commit anyway.
+		 */
+		if (succeeded && MyTmGxactLocal->readOnlySegments != NIL)
+		{
+			char		gid[TMGIDSIZE];
+
+			dtxFormGID(gid, getDistributedTransactionTimestamp(), getDistributedTransactionId());
+			succeeded = doDispatchDtxProtocolCommand(DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE, gid,
+													 true, MyTmGxactLocal->readOnlySegments,
+													 NULL, 0);
+		}
 	}
 	PG_CATCH();
 	{
@@ -832,13 +908,17 @@ prepareDtxTransaction(void)
 	}
 
 	/*
-	 * If only one segment was involved in the transaction, and no local XID
-	 * has been assigned on the QD either, or there is no xlog writing related
-	 * to this transaction on all segments, we can perform one-phase commit.
-	 * Otherwise, broadcast PREPARE TRANSACTION to the segments.
+	 * If only one segment was involved in the transaction, or wrote xlog,
+	 * and no local XID has been assigned on the QD either, or there is no
+	 * xlog writing related to this transaction on all segments, we can
+	 * perform one-phase commit. Otherwise, broadcast PREPARE TRANSACTION to
+	 * the segments that assigned an xid; the others are committed in one
+	 * phase once the distributed commit has been decided.
 	 */
 	if (!TopXactExecutorDidWriteXLog() ||
-		(!markXidCommitted && list_length(MyTmGxactLocal->dtxSegments) < 2))
+		(!markXidCommitted &&
+		 (list_length(MyTmGxactLocal->dtxSegments) < 2 ||
+		  bms_num_members(MyTmGxactLocal->xlogSegmentsMap) < 2)))
 	{
 		setCurrentDtxState(DTX_STATE_ONE_PHASE_COMMIT);
 		/*
@@ -856,6 +936,7 @@ prepareDtxTransaction(void)
 	Assert(MyTmGxactLocal->state == DTX_STATE_ACTIVE_DISTRIBUTED);
 	Assert(MyTmGxact->gxid > FirstDistributedTransactionId);
 
+	splitReadOnlySegments();
 	doPrepareTransaction();
 }
 
@@ -912,7 +993,14 @@ rollbackDtxTransaction(void)
 			break;
 
 		case DTX_STATE_PREPARED:
-			setCurrentDtxState(DTX_STATE_NOTIFYING_ABORT_PREPARED);
+			/*
+			 * The read-only segments were not prepared, so they have to be
+			 * aborted as the segments of a partly prepared transaction.
+			 */
+			if (MyTmGxactLocal->readOnlySegments != NIL)
+				setCurrentDtxState(DTX_STATE_NOTIFYING_ABORT_SOME_PREPARED);
+			else
+				setCurrentDtxState(DTX_STATE_NOTIFYING_ABORT_PREPARED);
 			break;
 
 		case DTX_STATE_NOTIFYING_ABORT_NO_PREPARED:
@@ -1414,6 +1502,9 @@ resetGxact(void)
 	MyTmGxactLocal->writerGangLost = false;
 	MyTmGxactLocal->dtxSegmentsMap = NULL;
 	MyTmGxactLocal->dtxSegments = NIL;
+	MyTmGxactLocal->xlogSegmentsMap = NULL;
+	MyTmGxactLocal->prepareSegments = NIL;
+	MyTmGxactLocal->readOnlySegments = NIL;
 	MyTmGxactLocal->isOnePhaseCommit = false;
 	if (MyTmGxactLocal->waitGxids != NULL)
 	{
@@ -2392,6 +2483,34 @@ addToGxactDtxSegments(Gang *gang)
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Record which segment has assigned an xid in the transaction. Segments that
+ * are involved in the transaction but have not are read-only, and need no
+ * PREPARE.
+ */
+void
+addToGxactXLogSegments(int segindex)
+{
+	MemoryContext oldContext;
+
+	MarkTopTransactionWriteXLogOnExecutor();
+
+	if (!isCurrentDtxActivated())
+		return;
+
+	/* entry db is just a reader */
+	if (segindex == -1)
+		return;
+
+	if (bms_is_member(segindex, MyTmGxactLocal->xlogSegmentsMap))
+		return;
+
+	oldContext = MemoryContextSwitchTo(TopTransactionContext);
+	MyTmGxactLocal->xlogSegmentsMap =
+		bms_add_member(MyTmGxactLocal->xlogSegmentsMap, segindex);
+	MemoryContextSwitchTo(oldContext);
+}
+
 bool
 CurrentDtxIsRollingback(void)
 {
@@ -211,6 +211,8 @@ bool		gp_interconnect_log_stats = false;	/* emit stats at log-level */
 
 bool		gp_interconnect_cache_future_packets = true;
 
+bool		gp_interconnect_local_socket = false;
+
 /*
  * format: dbid:content:address:port,dbid:content:address:port ...
  * example: 1:-1:10.0.0.1:2000 2:0:10.0.0.2:2000 3:1:10.0.0.2:2001
@@ -220,6 +222,14 @@ bool		gp_interconnect_cache_future_packets = true;
  */
 char	   *gp_interconnect_proxy_addresses = NULL;
 
+/*
+ * The ic-proxy coalesces the packets to a peer until they add up to
+ * gp_interconnect_proxy_batch_size bytes, or for at most
+ * gp_interconnect_proxy_flush_interval ms.
+ */
+int			gp_interconnect_proxy_batch_size = 65536;
+int			gp_interconnect_proxy_flush_interval = 0;
+
 int			Gp_udp_bufsize_k;	/* UPD recv buf size, in KB */
 
 #ifdef USE_ASSERT_CHECKING
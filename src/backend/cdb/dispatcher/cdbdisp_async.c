@@ -40,6 +40,7 @@
 #include "cdb/cdbgang.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbpq.h"
+#include "cdb/cdbtm.h"
 #include "miscadmin.h"
 #include "commands/sequence.h"
 #include "access/xact.h"
@@ -910,12 +911,21 @@ processResults(CdbDispatchResult *dispatchResult)
 		if (!pRes)
 		{
 			ELOG_DISPATCHER_DEBUG("%s -> idle", segdbDesc->whoami);
+
+			/*
+			 * The QE reports whether it has assigned an xid right before
+			 * ReadyForQuery, so the flag of the last command may only be
+			 * seen here.
+			 */
+			if (segdbDesc->conn->wrote_xlog)
+				addToGxactXLogSegments(segdbDesc->segindex);
+
 			/* this is normal end of command */
 			return true;
 		}
 
 		if (segdbDesc->conn->wrote_xlog)
-			MarkTopTransactionWriteXLogOnExecutor();
+			addToGxactXLogSegments(segdbDesc->segindex);
 
 		/*
 		 * Attach the PGresult object to the CdbDispatchResult object.
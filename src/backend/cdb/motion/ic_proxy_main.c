@@ -430,7 +430,7 @@ ic_proxy_server_main(void)
 	ic_proxy_reload_addresses(&ic_proxy_server_loop);
 
 	ic_proxy_router_init(&ic_proxy_server_loop);
-	ic_proxy_peer_table_init();
+	ic_proxy_peer_table_init(&ic_proxy_server_loop);
 	ic_proxy_client_table_init();
 
 	ic_proxy_peer_listening = false;
@@ -34,6 +34,18 @@
  * the peer, they are routed to the target clients, or their placeholders,
  * immediately.
  *
+ * Outgoing DATA and MESSAGE packets of the clients are coalesced per peer,
+ * with hundreds of concurrent motions a write per packet would make the
+ * syscalls the bottleneck of the proxy.  The packets are collected in the
+ * peer's batch, and the whole batch is written with one uv_write() once it
+ * reaches gp_interconnect_proxy_batch_size bytes, or when the flush
+ * interval expires.  With a zero gp_interconnect_proxy_flush_interval the
+ * batches are written as soon as the current round of I/O events are
+ * handled, so no latency is added, only the packets routed in the same round
+ * are coalesced.  The packets are still written in the routing order, and
+ * the remote peer splits them with its ibuf as usual, a read of a coalesced
+ * batch is demultiplexed in one go.
+ *
  *
  * Copyright (c) 2020-Present Pivotal Software, Inc.
  *
@@ -57,8 +69,30 @@
  */
 static ICProxyPeer *ic_proxy_peers[65536];
 
+/*
+ * The flushing of the batches.
+ *
+ * The check and prepare handles flush the batches after the I/O events of
+ * the current round are handled, the check one runs right after them, the
+ * prepare one catches the packets routed after the check, e.g. the loopback
+ * ones, before the loop blocks for new events.  The timer is used instead if
+ * a flush interval is set.  They are only active when there are batches.
+ */
+static struct
+{
+	uv_check_t	check;			/* flush after the I/O events */
+	uv_prepare_t prepare;		/* flush before waiting for I/O events */
+	uv_timer_t	timer;			/* flush after the flush interval */
+
+	List	   *peers;			/* List<ICProxyPeer *>, peers with batches */
+} ic_proxy_peer_batches;
+
 
 static void ic_proxy_peer_shutdown(ICProxyPeer *peer);
+static void ic_proxy_peer_flush(ICProxyPeer *peer);
+static void ic_proxy_peer_batches_on_check(uv_check_t *handle);
+static void ic_proxy_peer_batches_on_prepare(uv_prepare_t *handle);
+static void ic_proxy_peer_batches_on_timer(uv_timer_t *handle);
 static void ic_proxy_peer_handle_out_cache(ICProxyPeer *peer);
 static void ic_proxy_peer_on_data_pkt(void *opaque,
 									  const void *data, uint16 size);
@@ -93,14 +127,26 @@ ic_proxy_peer_build_delay(ICProxyPeer *peer, ICProxyPkt *pkt,
  * Initialize the peer register table.
  */
 void
-ic_proxy_peer_table_init(void)
+ic_proxy_peer_table_init(uv_loop_t *loop)
 {
 	memset(ic_proxy_peers, 0, sizeof(ic_proxy_peers));
+
+	uv_check_init(loop, &ic_proxy_peer_batches.check);
+	uv_prepare_init(loop, &ic_proxy_peer_batches.prepare);
+	uv_timer_init(loop, &ic_proxy_peer_batches.timer);
+	ic_proxy_peer_batches.peers = NIL;
 }
 
 void
 ic_proxy_peer_table_uninit(void)
 {
+	uv_check_stop(&ic_proxy_peer_batches.check);
+	uv_prepare_stop(&ic_proxy_peer_batches.prepare);
+	uv_timer_stop(&ic_proxy_peer_batches.timer);
+
+	list_free(ic_proxy_peer_batches.peers);
+	ic_proxy_peer_batches.peers = NIL;
+
 	/*
 	 * nothing to do for the peers table:
 	 * - no need to clear the peers table, we will do that in init();
@@ -108,6 +154,158 @@ ic_proxy_peer_table_uninit(void)
 	 */
 }
 
+/*
+ * Start or stop the flushing of the batches.
+ */
+static void
+ic_proxy_peer_batches_toggle(bool start)
+{
+	if (!start)
+	{
+		uv_check_stop(&ic_proxy_peer_batches.check);
+		uv_prepare_stop(&ic_proxy_peer_batches.prepare);
+		uv_timer_stop(&ic_proxy_peer_batches.timer);
+	}
+	else if (gp_interconnect_proxy_flush_interval > 0)
+		uv_timer_start(&ic_proxy_peer_batches.timer,
+					   ic_proxy_peer_batches_on_timer,
+					   gp_interconnect_proxy_flush_interval, 0);
+	else
+	{
+		uv_check_start(&ic_proxy_peer_batches.check,
+					   ic_proxy_peer_batches_on_check);
+		uv_prepare_start(&ic_proxy_peer_batches.prepare,
+						 ic_proxy_peer_batches_on_prepare);
+	}
+}
+
+/*
+ * Time to flush all the batches.
+ */
+static void
+ic_proxy_peer_batches_flush(void)
+{
+	List	   *peers;
+	ListCell   *cell;
+
+	/*
+	 * Detach the peers first, so the flushing of a peer does not modify the
+	 * list we are walking.
+	 */
+	peers = ic_proxy_peer_batches.peers;
+	ic_proxy_peer_batches.peers = NIL;
+
+	ic_proxy_peer_batches_toggle(false);
+
+	foreach(cell, peers)
+		ic_proxy_peer_flush(lfirst(cell));
+
+	list_free(peers);
+}
+
+static void
+ic_proxy_peer_batches_on_check(uv_check_t *handle)
+{
+	ic_proxy_peer_batches_flush();
+}
+
+static void
+ic_proxy_peer_batches_on_prepare(uv_prepare_t *handle)
+{
+	ic_proxy_peer_batches_flush();
+}
+
+static void
+ic_proxy_peer_batches_on_timer(uv_timer_t *handle)
+{
+	ic_proxy_peer_batches_flush();
+}
+
+/*
+ * Write out the batch of a peer.
+ */
+static void
+ic_proxy_peer_flush(ICProxyPeer *peer)
+{
+	List	   *batch = peer->batch;
+
+	if (batch == NIL)
+		return;
+
+	ic_proxy_log(LOG, "%s: flushing %d outgoing pkts of %d bytes",
+				 peer->name, list_length(batch), peer->batchSize);
+
+	peer->batch = NIL;
+	peer->batchSize = 0;
+
+	ic_proxy_peer_batches.peers = list_delete_ptr(ic_proxy_peer_batches.peers,
+												  peer);
+	if (ic_proxy_peer_batches.peers == NIL)
+		ic_proxy_peer_batches_toggle(false);
+
+	ic_proxy_router_write_batch((uv_stream_t *) &peer->tcp, batch);
+}
+
+/*
+ * Add an outgoing packet to the batch of a peer.
+ *
+ * We'll take the packet's ownership.
+ */
+static void
+ic_proxy_peer_batch(ICProxyPeer *peer, ICProxyPkt *pkt,
+					ic_proxy_sent_cb callback, void *opaque)
+{
+	ICProxyDelay *delay;
+
+	if (peer->batch == NIL)
+	{
+		if (ic_proxy_peer_batches.peers == NIL)
+			ic_proxy_peer_batches_toggle(true);
+
+		ic_proxy_peer_batches.peers = lappend(ic_proxy_peer_batches.peers,
+											  peer);
+	}
+
+	delay = ic_proxy_peer_build_delay(peer, pkt, callback, opaque);
+	peer->batch = lappend(peer->batch, delay);
+	peer->batchSize += pkt->len;
+
+	if (peer->batchSize >= gp_interconnect_proxy_batch_size)
+		ic_proxy_peer_flush(peer);
+}
+
+/*
+ * Drop the batch of a peer that can no longer send.
+ */
+static void
+ic_proxy_peer_drop_batch(ICProxyPeer *peer)
+{
+	ListCell   *cell;
+
+	if (peer->batch == NIL)
+		return;
+
+	foreach(cell, peer->batch)
+	{
+		ICProxyDelay *delay = lfirst(cell);
+
+		ic_proxy_log(WARNING, "%s: unsent outgoing %s, dropping it",
+					 peer->name, ic_proxy_pkt_to_str(delay->pkt));
+
+		ic_proxy_pkt_cache_free(delay->pkt);
+		ic_proxy_free(delay);
+	}
+
+	list_free(peer->batch);
+	peer->batch = NIL;
+	peer->batchSize = 0;
+
+	ic_proxy_peer_batches.peers = list_delete_ptr(ic_proxy_peer_batches.peers,
+												  peer);
+	if (ic_proxy_peer_batches.peers == NIL)
+		ic_proxy_peer_batches_toggle(false);
+}
+
 /*
  * Update the peer name from the state bits.
  *
@@ -346,6 +544,8 @@ ic_proxy_peer_new(uv_loop_t *loop, int16 content, uint16 dbid)
 	peer->dbid = dbid;
 	peer->state = 0;
 	peer->reqs = NIL;
+	peer->batch = NIL;
+	peer->batchSize = 0;
 
 	ic_proxy_ibuf_init_p2p(&peer->ibuf);
 
@@ -383,6 +583,8 @@ ic_proxy_peer_free(ICProxyPeer *peer)
 
 	list_free(peer->reqs);
 
+	ic_proxy_peer_drop_batch(peer);
+
 	ic_proxy_ibuf_uninit(&peer->ibuf);
 	ic_proxy_free(peer);
 
@@ -410,6 +612,9 @@ ic_proxy_peer_on_close(uv_handle_t *handle)
 	/* it's unlikely that the ibuf is non-empty, but clear it for sure */
 	ic_proxy_ibuf_clear(&peer->ibuf);
 
+	/* the batch is flushed on shutdown, anything left can't be sent */
+	ic_proxy_peer_drop_batch(peer);
+
 	ic_proxy_peer_unregister(peer);
 }
 
@@ -470,6 +675,12 @@ ic_proxy_peer_shutdown(ICProxyPeer *peer)
 	/* disconnect all the clients */
 	ic_proxy_client_table_shutdown_by_dbid(peer->dbid);
 
+	/*
+	 * Write out the coalesced packets, the shutdown happens after all the
+	 * pending writes.
+	 */
+	ic_proxy_peer_flush(peer);
+
 	req = ic_proxy_new(uv_shutdown_t);
 
 	uv_shutdown(req, (uv_stream_t *) &peer->tcp, ic_proxy_peer_on_shutdown);
@@ -833,6 +1044,19 @@ ic_proxy_peer_route_data(ICProxyPeer *peer, ICProxyPkt *pkt,
 		return;
 	}
 
+	/*
+	 * Coalesce the packet with the other ones to the peer, unless the peer is
+	 * shutting down.  A non-empty batch must be followed anyway, to keep the
+	 * packets in order if the coalescing is turned off.
+	 */
+	if (peer->batch != NIL ||
+		(gp_interconnect_proxy_batch_size > 0 &&
+		 !(peer->state & IC_PROXY_PEER_STATE_SHUTTING)))
+	{
+		ic_proxy_peer_batch(peer, pkt, callback, opaque);
+		return;
+	}
+
 	ic_proxy_router_write((uv_stream_t *) &peer->tcp, pkt, 0, callback, opaque);
 }
 
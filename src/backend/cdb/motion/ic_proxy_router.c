@@ -22,6 +22,7 @@
 
 
 typedef struct ICProxyWriteReq ICProxyWriteReq;
+typedef struct ICProxyWriteBatchReq ICProxyWriteBatchReq;
 typedef struct ICProxyLoopback ICProxyLoopback;
 
 
@@ -40,6 +41,19 @@ struct ICProxyWriteReq
 	void	   *opaque;			/* the callback data */
 };
 
+/*
+ * A router batched write request.
+ *
+ * Like ICProxyWriteReq, but for a list of packets that are written with one
+ * uv_write() call, each packet has its own callback.
+ */
+struct ICProxyWriteBatchReq
+{
+	uv_write_t	req;			/* the libuv write request */
+
+	List	   *delays;			/* List<ICProxyDelay *>, the packets */
+};
+
 /*
  * The loopback packet queue.
  *
@@ -302,3 +316,77 @@ ic_proxy_router_write(uv_stream_t *stream, ICProxyPkt *pkt, int32 offset,
 
 	uv_write(&wreq->req, stream, &wbuf, 1, ic_proxy_router_on_write);
 }
+
+/*
+ * A batch of packets is written.
+ */
+static void
+ic_proxy_router_on_write_batch(uv_write_t *req, int status)
+{
+	ICProxyWriteBatchReq *wreq = (ICProxyWriteBatchReq *) req;
+	ListCell   *cell;
+
+	if (status < 0)
+		ic_proxy_log(LOG, "ic-proxy-router: fail to send a batch of %d packets: %s",
+					 list_length(wreq->delays), uv_strerror(status));
+	else
+		ic_proxy_log(LOG, "ic-proxy-router: sent a batch of %d packets",
+					 list_length(wreq->delays));
+
+	foreach(cell, wreq->delays)
+	{
+		ICProxyDelay *delay = lfirst(cell);
+
+		if (delay->callback)
+			delay->callback(delay->opaque, delay->pkt, status);
+
+		ic_proxy_pkt_cache_free(delay->pkt);
+		ic_proxy_free(delay);
+	}
+
+	list_free(wreq->delays);
+	ic_proxy_free(req);
+}
+
+/*
+ * Write a batch of packets to a libuv stream.
+ *
+ * The packets are written as a whole with one uv_write() call, which is a
+ * single writev() in most cases, instead of one uv_write() per packet.  The
+ * callback of each packet is triggered, in order, once the batch is written.
+ *
+ * - stream: the target stream, usually a peer;
+ * - delays: List<ICProxyDelay *>, the packets to write and their callbacks,
+ *   the ownership of the list, the delays and the packets is taken;
+ */
+void
+ic_proxy_router_write_batch(uv_stream_t *stream, List *delays)
+{
+	ICProxyWriteBatchReq *wreq;
+	uv_buf_t   *wbufs;
+	ListCell   *cell;
+	int			nbufs = 0;
+
+	Assert(delays != NIL);
+
+	ic_proxy_log(LOG, "ic-proxy-router: sending a batch of %d packets",
+				 list_length(delays));
+
+	wreq = ic_proxy_new(ICProxyWriteBatchReq);
+	wreq->delays = delays;
+
+	wbufs = ic_proxy_alloc(sizeof(*wbufs) * list_length(delays));
+	foreach(cell, delays)
+	{
+		ICProxyDelay *delay = lfirst(cell);
+
+		wbufs[nbufs].base = (char *) delay->pkt;
+		wbufs[nbufs].len = delay->pkt->len;
+		nbufs++;
+	}
+
+	/* libuv keeps its own copy of the buffer descriptors, not the data */
+	uv_write(&wreq->req, stream, wbufs, nbufs, ic_proxy_router_on_write_batch);
+
+	ic_proxy_free(wbufs);
+}
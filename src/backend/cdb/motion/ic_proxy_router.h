@@ -17,6 +17,8 @@
 
 #include <uv.h>
 
+#include "nodes/pg_list.h"
+
 
 typedef void (* ic_proxy_sent_cb) (void *opaque,
 								   const ICProxyPkt *pkt, int status);
@@ -29,6 +31,7 @@ extern void ic_proxy_router_route(uv_loop_t *loop, ICProxyPkt *pkt,
 extern void ic_proxy_router_write(uv_stream_t *stream,
 								  ICProxyPkt *pkt, int32 offset,
 								  ic_proxy_sent_cb callback, void *opaque);
+extern void ic_proxy_router_write_batch(uv_stream_t *stream, List *delays);
 
 
 #endif   /* IC_PROXY_ROUTER_H */
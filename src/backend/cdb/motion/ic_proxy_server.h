@@ -66,6 +66,10 @@ struct ICProxyPeer
 	List	   *reqs;			/* outgoing queue for data that can't be sent
 								 * immediately */
 
+	List	   *batch;			/* outgoing packets being coalesced into one
+								 * write, List<ICProxyDelay *> */
+	int32		batchSize;		/* total bytes of the packets in batch */
+
 	ICProxyIBuf	ibuf;			/* ibuf detects the packet boundaries */
 
 	char		name[128];		/* name of the client, only for logging */
@@ -119,7 +123,7 @@ extern void ic_proxy_client_table_init(void);
 extern void ic_proxy_client_table_uninit(void);
 extern void ic_proxy_client_table_shutdown_by_dbid(uint16 dbid);
 
-extern void ic_proxy_peer_table_init(void);
+extern void ic_proxy_peer_table_init(uv_loop_t *loop);
 extern void ic_proxy_peer_table_uninit(void);
 
 extern ICProxyPeer *ic_proxy_peer_new(uv_loop_t *loop,
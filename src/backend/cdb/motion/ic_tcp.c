@@ -19,9 +19,12 @@
 #include "nodes/pg_list.h"
 #include "nodes/print.h"
 #include "miscadmin.h"
+#include "libpq/hba.h"
 #include "libpq/libpq-be.h"
 #include "postmaster/postmaster.h"
 #include "utils/builtins.h"
+#include "utils/memutils.h"
+#include "utils/varlena.h"
 
 #include "cdb/cdbselect.h"
 #include "cdb/tupchunklist.h"
@@ -37,8 +40,12 @@
 #include <limits.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <netinet/in.h>
+#ifdef HAVE_UNIX_SOCKETS
+#include <sys/un.h>
+#endif
 
 #define USECS_PER_SECOND 1000000
 #define MSECS_PER_SECOND 1000
@@ -73,6 +80,29 @@ int			listenerBacklog = 128;
 /* our timeout value for select() and other socket operations. */
 static struct timeval tval;
 
+/*
+ * Senders on the same host connect to the receiver through a Unix-domain
+ * socket, named after the pid of the receiver, in the first directory of
+ * unix_socket_directories.  The data still flows through the kernel, but
+ * skips the TCP/IP processing of every packet (checksums, acks, congestion
+ * control) that loopback connections pay for.
+ *
+ * localSocketDir is empty if the local listener is not set up, in which case
+ * we connect through TCP too.
+ */
+static int	localListenerFd = -1;
+static char localSocketDir[MAXPGPATH];
+static char localListenerPath[MAXPGPATH];
+
+/* whether a receiver listener address is an address of this host */
+typedef struct LocalAddrCacheEntry
+{
+	char	   *addr;
+	bool		isLocal;
+} LocalAddrCacheEntry;
+
+static List *localAddrCache = NIL;
+
 static inline MotionConn *
 getMotionConn(ChunkTransportStateEntry *pEntry, int iConn)
 {
@@ -90,14 +120,17 @@ static ChunkTransportStateEntry *startOutgoingConnections(ChunkTransportState *t
 static void format_fd_set(StringInfo buf, int nfds, mpp_fd_set *fds, char *pfx, char *sfx);
 static void setupOutgoingConnection(ChunkTransportState *transportStates,
 						ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool setupLocalOutgoingConnection(ChunkTransportState *transportStates,
+							 ChunkTransportStateEntry *pEntry, MotionConn *conn,
+							 struct addrinfo *addr);
 static void updateOutgoingConnection(ChunkTransportState *transportStates,
 						 ChunkTransportStateEntry *pEntry, MotionConn *conn, int errnoSave);
 static void sendRegisterMessage(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static bool readRegisterMessage(ChunkTransportState *transportStates,
 					MotionConn *conn);
-static MotionConn *acceptIncomingConnection(void);
+static MotionConn *acceptIncomingConnection(int listenerFd);
 
-static void flushInterconnectListenerBacklog(void);
+static void flushInterconnectListenerBacklog(int listenerFd);
 
 static void waitOnOutbound(ChunkTransportStateEntry *pEntry);
 
@@ -289,6 +322,146 @@ error:
 			 errdetail("%s: %m", fun)));
 }								/* setupListeningSocket */
 
+/*
+ * Path of the local listener socket of the backend with the given pid.
+ */
+static void
+localSocketPath(char *path, int pid)
+{
+	snprintf(path, MAXPGPATH, "%s/.s.GPIC.%d", localSocketDir, pid);
+}
+
+/*
+ * setupLocalListeningSocket
+ *
+ * Set up the Unix-domain listener for senders on the same host.  Failing to
+ * do so is not an error, the senders connect through TCP instead.
+ */
+static void
+setupLocalListeningSocket(int backlog)
+{
+#ifdef HAVE_UNIX_SOCKETS
+	int			errnoSave;
+	int			fd = -1;
+	const char *fun;
+	char	   *rawstring;
+	List	   *dirs;
+	struct sockaddr_un addr;
+
+	localSocketDir[0] = '\0';
+	localListenerPath[0] = '\0';
+
+	if (!gp_interconnect_local_socket ||
+		Gp_interconnect_type != INTERCONNECT_TYPE_TCP)
+		return;
+
+	rawstring = pstrdup(Unix_socket_directories);
+	if (SplitDirectoriesString(rawstring, ',', &dirs) && dirs != NIL)
+		strlcpy(localSocketDir, (char *) linitial(dirs), sizeof(localSocketDir));
+	list_free_deep(dirs);
+	pfree(rawstring);
+
+	if (localSocketDir[0] == '\0')
+		return;
+
+	localSocketPath(localListenerPath, MyProcPid);
+	if (strlen(localListenerPath) >= UNIXSOCK_PATH_BUFLEN)
+	{
+		ereport(LOG,
+				(errmsg("interconnect local socket path \"%s\" is too long",
+						localListenerPath)));
+		localSocketDir[0] = '\0';
+		localListenerPath[0] = '\0';
+		return;
+	}
+
+	/* A socket of ours can only be left over by a crashed backend. */
+	unlink(localListenerPath);
+
+	MemSet(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strlcpy(addr.sun_path, localListenerPath, sizeof(addr.sun_path));
+
+	fun = "socket";
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		goto error;
+
+	fun = "bind";
+	if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+		goto error;
+
+	/* Only the segments of the cluster, which run as our user, may connect. */
+	fun = "chmod";
+	if (chmod(localListenerPath, S_IRWXU) < 0)
+		goto error;
+
+	fun = "fcntl(O_NONBLOCK)";
+	if (!pg_set_noblock(fd))
+		goto error;
+
+	fun = "listen";
+	if (listen(fd, backlog) < 0)
+		goto error;
+
+	localListenerFd = fd;
+	return;
+
+error:
+	errnoSave = errno;
+	if (fd >= 0)
+		closesocket(fd);
+	unlink(localListenerPath);
+	errno = errnoSave;
+	ereport(LOG,
+			(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+			 errmsg("interconnect could not set up local listener socket \"%s\", using tcp only",
+					localListenerPath),
+			 errdetail("%s: %m", fun)));
+	localSocketDir[0] = '\0';
+	localListenerPath[0] = '\0';
+#endif
+}								/* setupLocalListeningSocket */
+
+/*
+ * Is the listener address of a receiver an address of this host?
+ *
+ * The answers are cached for the life of the backend, the receivers of a
+ * cluster listen on a handful of addresses.
+ */
+static bool
+isLocalAddress(const char *listenerAddr, struct addrinfo *addr)
+{
+	LocalAddrCacheEntry *entry;
+	MemoryContext oldContext;
+	SockAddr	raddr;
+	ListCell   *lc;
+
+	foreach(lc, localAddrCache)
+	{
+		entry = (LocalAddrCacheEntry *) lfirst(lc);
+
+		if (strcmp(entry->addr, listenerAddr) == 0)
+			return entry->isLocal;
+	}
+
+	if (addr->ai_addrlen > sizeof(raddr.addr))
+		return false;
+
+	MemSet(&raddr, 0, sizeof(raddr));
+	memcpy(&raddr.addr, addr->ai_addr, addr->ai_addrlen);
+	raddr.salen = addr->ai_addrlen;
+
+	oldContext = MemoryContextSwitchTo(TopMemoryContext);
+	entry = palloc(sizeof(LocalAddrCacheEntry));
+	entry->addr = pstrdup(listenerAddr);
+	entry->isLocal = check_same_host_or_net(&raddr, ipCmpSameHost);
+	localAddrCache = lappend(localAddrCache, entry);
+	MemoryContextSwitchTo(oldContext);
+
+	return entry->isLocal;
+}
+
 /*
  * Initialize TCP specific comms.
  */
@@ -299,6 +472,7 @@ InitMotionTCP(int *listenerSocketFd, uint16 *listenerPort)
 	tval.tv_usec = 500000;
 
 	setupTCPListeningSocket(listenerBacklog, listenerSocketFd, listenerPort);
+	setupLocalListeningSocket(listenerBacklog);
 
 	return;
 }
@@ -307,8 +481,18 @@ InitMotionTCP(int *listenerSocketFd, uint16 *listenerPort)
 void
 CleanupMotionTCP(void)
 {
-	/* nothing to do. */
-	return;
+	if (localListenerFd >= 0)
+	{
+		closesocket(localListenerFd);
+		localListenerFd = -1;
+	}
+
+	if (localListenerPath[0] != '\0')
+	{
+		unlink(localListenerPath);
+		localListenerPath[0] = '\0';
+	}
+	localSocketDir[0] = '\0';
 }
 
 /* Function readPacket() is used to read in the next packet from the given
@@ -660,6 +844,13 @@ setupOutgoingConnection(ChunkTransportState *transportStates, ChunkTransportStat
 	 * entry
 	 */
 
+	/* A receiver on this host may be reachable through its local socket. */
+	if (setupLocalOutgoingConnection(transportStates, pEntry, conn, addrs))
+	{
+		pg_freeaddrinfo_all(hint.ai_family, addrs);
+		return;
+	}
+
 	/*
 	 * Create a socket.  getaddrinfo() returns the parameters needed by
 	 * socket()
@@ -725,6 +916,78 @@ setupOutgoingConnection(ChunkTransportState *transportStates, ChunkTransportStat
 }								/* setupOutgoingConnection */
 
 
+/*
+ * setupLocalOutgoingConnection
+ *
+ * Called by setupOutgoingConnection to connect to a receiver on this host
+ * through its Unix-domain listener.
+ *
+ * Returns false if the receiver is on another host or cannot be reached this
+ * way, e.g. because it has no local listener or its backlog is full; the
+ * caller then connects through TCP.  Otherwise the state on return is as for
+ * setupOutgoingConnection, except that it is never mcsConnecting.
+ */
+static bool
+setupLocalOutgoingConnection(ChunkTransportState *transportStates,
+							 ChunkTransportStateEntry *pEntry, MotionConn *conn,
+							 struct addrinfo *addr)
+{
+#ifdef HAVE_UNIX_SOCKETS
+	CdbProcess *cdbProc = conn->cdbProc;
+	struct sockaddr_un unaddr;
+	char		path[MAXPGPATH];
+	int			fd;
+
+	if (!gp_interconnect_local_socket || localSocketDir[0] == '\0')
+		return false;
+
+	if (!isLocalAddress(cdbProc->listenerAddr, addr))
+		return false;
+
+	localSocketPath(path, cdbProc->pid);
+	if (strlen(path) >= UNIXSOCK_PATH_BUFLEN)
+		return false;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return false;
+
+	if (!pg_set_noblock(fd))
+	{
+		closesocket(fd);
+		return false;
+	}
+
+	MemSet(&unaddr, 0, sizeof(unaddr));
+	unaddr.sun_family = AF_UNIX;
+	strlcpy(unaddr.sun_path, path, sizeof(unaddr.sun_path));
+
+	/*
+	 * Unlike for TCP, a non-blocking connect() of a Unix-domain socket never
+	 * stays pending: it either completes or fails right away.
+	 */
+	if (connect(fd, (struct sockaddr *) &unaddr, sizeof(unaddr)) < 0)
+	{
+		if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+			ereport(DEBUG1, (errmsg("Interconnect could not connect to seg%d "
+									"slice%d pid=%d through %s, using tcp: %m",
+									conn->remoteContentId,
+									pEntry->recvSlice->sliceIndex,
+									cdbProc->pid, path)));
+		closesocket(fd);
+		return false;
+	}
+
+	conn->sockfd = fd;
+	SIMPLE_FAULT_INJECTOR("interconnect_local_socket_connect");
+	sendRegisterMessage(transportStates, pEntry, conn);
+	return true;
+#else
+	return false;
+#endif
+}								/* setupLocalOutgoingConnection */
+
+
 /*
  * updateOutgoingConnection
  *
@@ -1128,7 +1391,7 @@ old_conn:
  * socket does not have any pending connection requests.
  */
 static MotionConn *
-acceptIncomingConnection(void)
+acceptIncomingConnection(int listenerFd)
 {
 	int			newsockfd;
 	socklen_t	addrsize;
@@ -1143,7 +1406,7 @@ acceptIncomingConnection(void)
 	{							/* loop until success or EWOULDBLOCK */
 		MemSet(&remoteAddr, 0, sizeof(remoteAddr));
 		addrsize = sizeof(remoteAddr);
-		newsockfd = accept(TCP_listenerFd, (struct sockaddr *) &remoteAddr, &addrsize);
+		newsockfd = accept(listenerFd, (struct sockaddr *) &remoteAddr, &addrsize);
 		if (newsockfd >= 0)
 			break;
 
@@ -1169,7 +1432,7 @@ acceptIncomingConnection(void)
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("interconnect error on listener port %d",
 								Gp_listener_port),
-						 errdetail("accept sockfd=%d: %m", TCP_listenerFd)));
+						 errdetail("accept sockfd=%d: %m", listenerFd)));
 				break;			/* not reached */
 			case ENOMEM:
 			case ENFILE:
@@ -1180,7 +1443,7 @@ acceptIncomingConnection(void)
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("interconnect error on listener port %d",
 								Gp_listener_port),
-						 errdetail("accept sockfd=%d: %m", TCP_listenerFd)));
+						 errdetail("accept sockfd=%d: %m", listenerFd)));
 				break;			/* not reached */
 			default:
 				/* Network problem, connection aborted, etc.  Continue. */
@@ -1188,7 +1451,7 @@ acceptIncomingConnection(void)
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("interconnect connection request not completed on listener port %d",
 								Gp_listener_port),
-						 errdetail("accept sockfd=%d: %m", TCP_listenerFd)));
+						 errdetail("accept sockfd=%d: %m", listenerFd)));
 		}						/* switch (errno) */
 	}							/* loop until success or EWOULDBLOCK */
 
@@ -1445,6 +1708,12 @@ SetupTCPInterconnect(EState *estate)
 
 			MPP_FD_SET(TCP_listenerFd, &rset);
 			highsock = TCP_listenerFd;
+
+			if (localListenerFd >= 0)
+			{
+				MPP_FD_SET(localListenerFd, &rset);
+				highsock = Max(highsock, localListenerFd);
+			}
 		}
 
 		/* Inbound connections awaiting registration message */
@@ -1753,10 +2022,15 @@ SetupTCPInterconnect(EState *estate)
 		/*
 		 * Someone tickling our listener port?  Accept pending connections.
 		 */
-		if (MPP_FD_ISSET(TCP_listenerFd, &rset))
+		for (i = 0; i < 2; i++)
 		{
+			int			listenerFd = (i == 0) ? TCP_listenerFd : localListenerFd;
+
+			if (listenerFd < 0 || !MPP_FD_ISSET(listenerFd, &rset))
+				continue;
+
 			n--;
-			while ((conn = acceptIncomingConnection()) != NULL)
+			while ((conn = acceptIncomingConnection(listenerFd)) != NULL)
 			{
 				/*
 				 * get the connection read for a subsequent call to
@@ -2120,7 +2394,9 @@ TeardownTCPInterconnect(ChunkTransportState *transportStates, bool hasErrors)
 	 * them on a subsequent query!)
 	 */
 	if (TCP_listenerFd != -1)
-		flushInterconnectListenerBacklog();
+		flushInterconnectListenerBacklog(TCP_listenerFd);
+	if (localListenerFd != -1)
+		flushInterconnectListenerBacklog(localListenerFd);
 
 	transportStates->activated = false;
 	transportStates->sliceTable = NULL;
@@ -2218,7 +2494,7 @@ format_fd_set(StringInfo buf, int nfds, mpp_fd_set *fds, char *pfx, char *sfx)
 }
 
 static void
-flushInterconnectListenerBacklog(void)
+flushInterconnectListenerBacklog(int listenerFd)
 {
 	int			pendingConn,
 				newfd,
@@ -2229,11 +2505,11 @@ flushInterconnectListenerBacklog(void)
 	do
 	{
 		MPP_FD_ZERO(&rset);
-		MPP_FD_SET(TCP_listenerFd, &rset);
+		MPP_FD_SET(listenerFd, &rset);
 		timeout.tv_sec = 0;
 		timeout.tv_usec = 0;
 
-		pendingConn = select(TCP_listenerFd + 1, (fd_set *) &rset, NULL, NULL, &timeout);
+		pendingConn = select(listenerFd + 1, (fd_set *) &rset, NULL, NULL, &timeout);
 		if (pendingConn > 0)
 		{
 			for (i = 0; i < pendingConn; i++)
@@ -2245,7 +2521,7 @@ flushInterconnectListenerBacklog(void)
 				socklen_t	addrsize;
 
 				addrsize = sizeof(remoteAddr);
-				newfd = accept(TCP_listenerFd, (struct sockaddr *) &remoteAddr, &addrsize);
+				newfd = accept(listenerFd, (struct sockaddr *) &remoteAddr, &addrsize);
 				if (newfd < 0)
 				{
 					ereport(DEBUG3, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
@@ -2299,7 +2575,7 @@ flushInterconnectListenerBacklog(void)
 			ereport(LOG,
 					(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 					 errmsg("interconnect error during listener cleanup"),
-					 errdetail("select sockfd=%d: %m", TCP_listenerFd)));
+					 errdetail("select sockfd=%d: %m", listenerFd)));
 		}
 
 		/*
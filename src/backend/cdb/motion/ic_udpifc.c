@@ -34,6 +34,7 @@
 #include "access/transam.h"
 #include "access/xact.h"
 #include "common/ip.h"
+#include "funcapi.h"
 #include "nodes/execnodes.h"
 #include "nodes/pg_list.h"
 #include "nodes/print.h"
@@ -44,7 +45,9 @@
 #include "pgstat.h"
 #include "postmaster/postmaster.h"
 #include "storage/latch.h"
+#include "storage/lwlock.h"
 #include "storage/pmsignal.h"
+#include "storage/shmem.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
@@ -532,6 +535,43 @@ static ICGlobalControlInfo ic_control_info;
 
 #define MAX_SEQS_IN_DISORDER_ACK (4)
 
+/*
+ * Macros for the delay based flow control
+ *
+ * The delay based flow control keeps a congestion window per connection and
+ * sizes it after the queueing delay of the path, in the way of TCP Vegas: the
+ * number of packets a connection keeps queued in the network is estimated as
+ *
+ *		queued = cwnd x (rtt - baseRtt) / rtt
+ *
+ * where baseRtt is the smallest rtt seen.  The window grows by one packet per
+ * rtt while fewer than DELAY_ALPHA packets are queued, and shrinks by one
+ * packet per rtt while more than DELAY_BETA are.  So it backs off as soon as
+ * queues build up at a busy receiver or switch port, before packets are
+ * dropped, instead of overflowing the queues and backing off on the
+ * retransmits that follow, as the loss based flow control does.  In slow
+ * start, the window doubles every rtt until DELAY_GAMMA packets are queued.
+ * Packet losses still halve the window.
+ *
+ * Packets are paced out at cwnd packets per rtt, in bursts of at most
+ * DELAY_PACING_BURST packets, so that a window opened by a stretch of acks
+ * does not leave in one burst.
+ *
+ * DELAY_INITIAL_CWND         - initial congestion window, in packets
+ * DELAY_MIN_CWND             - min congestion window, in packets
+ */
+#define DELAY_ALPHA (2)
+#define DELAY_BETA (4)
+#define DELAY_GAMMA (1)
+#define DELAY_INITIAL_CWND (4)
+#define DELAY_MIN_CWND (2)
+#define DELAY_PACING_BURST (4)
+
+/*
+ * Number of peers the statistics are kept for, see ICPeerStatsEntry.
+ */
+#define IC_PEER_STATS_MAX_PEERS (1024)
+
 /*
  * UnackQueueRing
  *
@@ -643,6 +683,41 @@ typedef struct ICStatistics
 /* Statistics for UDP interconnect. */
 static ICStatistics ic_statistics;
 
+/*
+ * ICPeerStatsEntry
+ *
+ * Statistics of the connections to a peer, kept in shared memory for the
+ * gp_interconnect_peer_stats view. The senders of all the backends of the
+ * instance add the counters of their connections when they close them.
+ *
+ * connections - the number of connections closed.
+ * packets     - the number of data packets sent, including retransmits.
+ * retransmits - the number of data packets retransmitted.
+ * rtt         - the smoothed rtt of the last connection, in us.
+ * minRtt      - the smallest ack time seen, in us.
+ * cwnd        - the congestion window of the last connection, in packets.
+ *               That is the window shared by all the connections of the
+ *               sender for the loss based flow control.
+ */
+typedef struct ICPeerStatsKey
+{
+	int32		contentId;
+	char		address[64];
+} ICPeerStatsKey;
+
+typedef struct ICPeerStatsEntry
+{
+	ICPeerStatsKey key;
+	int64		connections;
+	int64		packets;
+	int64		retransmits;
+	int64		rtt;
+	int64		minRtt;
+	double		cwnd;
+} ICPeerStatsEntry;
+
+static HTAB *ICPeerStatsHash = NULL;
+
 /*=========================================================================
  * STATIC FUNCTIONS declarations
  */
@@ -772,6 +847,10 @@ static void initMutex(pthread_mutex_t *mutex);
 
 static inline void logPkt(char *prefix, icpkthdr *pkt);
 static void aggregateStatistics(ChunkTransportStateEntry *pEntry);
+static void recordPeerStatistics(ChunkTransportStateEntry *pEntry);
+
+static void updateDelayCwnd(MotionConn *conn, uint64 ackTime);
+static void reduceDelayCwnd(MotionConn *conn, bool timeout);
 
 static inline bool pollAcks(ChunkTransportState *transportStates, int fd, int timeout);
 
@@ -2709,6 +2788,10 @@ startOutgoingUDPConnections(ChunkTransportState *transportStates,
 
 			conn->rtt = DEFAULT_RTT;
 			conn->dev = DEFAULT_DEV;
+			conn->cwnd = DELAY_INITIAL_CWND;
+			conn->ssthresh = Gp_interconnect_queue_depth;
+			conn->baseRtt = 0;
+			conn->nextSendTime = 0;
 			conn->deadlockCheckBeginTime = 0;
 			conn->tupleCount = 0;
 			conn->msgSize = sizeof(conn->conn_info);
@@ -3490,6 +3573,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 			/* connection array allocation may fail in interconnect setup. */
 			if (pEntry->conns)
 			{
+				recordPeerStatistics(pEntry);
+
 				for (i = 0; i < pEntry->numConns; i++)
 				{
 					conn = pEntry->conns + i;
@@ -4139,6 +4224,169 @@ aggregateStatistics(ChunkTransportStateEntry *pEntry)
 	}
 }
 
+/*
+ * recordPeerStatistics
+ * 		Add the counters of the sending connections of a motion to the
+ * 		statistics of their peers.
+ */
+static void
+recordPeerStatistics(ChunkTransportStateEntry *pEntry)
+{
+	int			connNo;
+
+	if (ICPeerStatsHash == NULL)
+		return;
+
+	LWLockAcquire(ICPeerStatsLock, LW_EXCLUSIVE);
+
+	for (connNo = 0; connNo < pEntry->numConns; connNo++)
+	{
+		MotionConn *conn = &pEntry->conns[connNo];
+		ICPeerStatsKey key;
+		ICPeerStatsEntry *entry;
+		bool		found;
+
+		if (conn->cdbProc == NULL)
+			continue;
+
+		MemSet(&key, 0, sizeof(key));
+		key.contentId = conn->cdbProc->contentid;
+		strlcpy(key.address, conn->cdbProc->listenerAddr, sizeof(key.address));
+
+		/* out of entries, the peer goes without statistics */
+		entry = (ICPeerStatsEntry *) hash_search(ICPeerStatsHash, &key,
+												 HASH_ENTER_NULL, &found);
+		if (entry == NULL)
+			continue;
+
+		if (!found)
+		{
+			entry->connections = 0;
+			entry->packets = 0;
+			entry->retransmits = 0;
+			entry->minRtt = 0;
+		}
+
+		entry->connections++;
+		entry->packets += conn->stat_count_sent;
+		entry->retransmits += conn->stat_count_resent;
+		entry->rtt = conn->rtt;
+		if (conn->stat_count_acks > 0 &&
+			(entry->minRtt == 0 || conn->stat_min_ack_time < entry->minRtt))
+			entry->minRtt = conn->stat_min_ack_time;
+
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+			entry->cwnd = conn->cwnd;
+		else if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+			entry->cwnd = snd_control_info.cwnd;
+		else
+			entry->cwnd = 0;
+	}
+
+	LWLockRelease(ICPeerStatsLock);
+}
+
+/*
+ * ICPeerStatsShmemSize
+ * 		Size of the shared memory of the peer statistics.
+ */
+Size
+ICPeerStatsShmemSize(void)
+{
+	return hash_estimate_size(IC_PEER_STATS_MAX_PEERS, sizeof(ICPeerStatsEntry));
+}
+
+/*
+ * ICPeerStatsShmemInit
+ * 		Allocate or attach to the shared memory of the peer statistics.
+ */
+void
+ICPeerStatsShmemInit(void)
+{
+	HASHCTL		info;
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(ICPeerStatsKey);
+	info.entrysize = sizeof(ICPeerStatsEntry);
+
+	ICPeerStatsHash = ShmemInitHash("Interconnect Peer Stats",
+									IC_PEER_STATS_MAX_PEERS,
+									IC_PEER_STATS_MAX_PEERS,
+									&info,
+									HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * gp_interconnect_get_peer_stats
+ * 		Return the statistics of the UDP interconnect connections of this
+ * 		instance to each peer.
+ */
+Datum
+gp_interconnect_get_peer_stats(PG_FUNCTION_ARGS)
+{
+#define GP_INTERCONNECT_PEER_STATS_COLS	8
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	HASH_SEQ_STATUS status;
+	ICPeerStatsEntry *entry;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	if (ICPeerStatsHash == NULL)
+		return (Datum) 0;
+
+	LWLockAcquire(ICPeerStatsLock, LW_SHARED);
+
+	hash_seq_init(&status, ICPeerStatsHash);
+	while ((entry = (ICPeerStatsEntry *) hash_seq_search(&status)) != NULL)
+	{
+		Datum		values[GP_INTERCONNECT_PEER_STATS_COLS];
+		bool		nulls[GP_INTERCONNECT_PEER_STATS_COLS];
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = Int32GetDatum(entry->key.contentId);
+		values[1] = CStringGetTextDatum(entry->key.address);
+		values[2] = Int64GetDatum(entry->connections);
+		values[3] = Int64GetDatum(entry->packets);
+		values[4] = Int64GetDatum(entry->retransmits);
+		values[5] = Int64GetDatum(entry->rtt);
+		values[6] = Int64GetDatum(entry->minRtt);
+		values[7] = Float8GetDatum(entry->cwnd);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	LWLockRelease(ICPeerStatsLock);
+
+	return (Datum) 0;
+}
+
 /*
  * logPkt
  * 		Log a packet.
@@ -4199,7 +4447,7 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 
 	buf = icBufferListDelete(&ackConn->unackQueue, buf);
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 	{
 		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 		unack_queue_ring.numOutStanding--;
@@ -4220,7 +4468,12 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 			uint64		newRTT = 0;
 			uint64		newDEV = 0;
 
-			if (buf->nRetry == 0)
+			if (buf->nRetry == 0 &&
+				Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+			{
+				updateDelayCwnd(buf->conn, ackTime);
+			}
+			else if (buf->nRetry == 0)
 			{
 				newRTT = buf->conn->rtt - (buf->conn->rtt >> RTT_SHIFT_COEFFICIENT) + (ackTime >> RTT_SHIFT_COEFFICIENT);
 				newRTT = Min(MAX_RTT, Max(newRTT, MIN_RTT));
@@ -4267,6 +4520,80 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 #endif
 }
 
+/*
+ * updateDelayCwnd
+ * 		Called by sender to update the rtt and the congestion window of the
+ * 		delay based flow control with the ack time of a packet.
+ *
+ * 	See the macros of the delay based flow control for the algorithm. The rtt
+ * 	and its deviation are smoothed as for the loss based flow control, except
+ * 	that the first ack time replaces the default rtt at once; the window is
+ * 	sized after the difference between the rtt and the base rtt, and starting
+ * 	from a default rtt much larger than the one of the path would shrink it
+ * 	for no reason.
+ */
+static void
+updateDelayCwnd(MotionConn *conn, uint64 ackTime)
+{
+	uint64		rtt = Min(MAX_RTT, Max(ackTime, MIN_RTT));
+	uint64		newDEV;
+	float		queued;
+
+	if (conn->baseRtt == 0)
+	{
+		conn->rtt = rtt;
+		conn->dev = Min(MAX_DEV, Max(rtt >> 1, MIN_DEV));
+		conn->baseRtt = rtt;
+	}
+	else
+	{
+		conn->rtt = conn->rtt - (conn->rtt >> RTT_SHIFT_COEFFICIENT) + (rtt >> RTT_SHIFT_COEFFICIENT);
+		conn->rtt = Min(MAX_RTT, Max(conn->rtt, MIN_RTT));
+
+		newDEV = conn->dev - (conn->dev >> DEV_SHIFT_COEFFICIENT) + ((Max(rtt, conn->rtt) - Min(rtt, conn->rtt)) >> DEV_SHIFT_COEFFICIENT);
+		conn->dev = Min(MAX_DEV, Max(newDEV, MIN_DEV));
+
+		conn->baseRtt = Min(conn->baseRtt, rtt);
+	}
+
+	/* the number of packets of the connection queued in the network */
+	queued = conn->cwnd * (float) (conn->rtt - Min(conn->baseRtt, conn->rtt)) / (float) conn->rtt;
+
+	if (conn->cwnd < conn->ssthresh)
+	{
+		if (queued > DELAY_GAMMA)
+			conn->ssthresh = conn->cwnd;
+		else
+			conn->cwnd += 1;
+	}
+	else if (queued < DELAY_ALPHA)
+		conn->cwnd += 1 / conn->cwnd;
+	else if (queued > DELAY_BETA)
+		conn->cwnd -= 1 / conn->cwnd;
+
+	conn->cwnd = Max(conn->cwnd, DELAY_MIN_CWND);
+	conn->cwnd = Min(conn->cwnd, snd_buffer_pool.maxCount);
+}
+
+/*
+ * reduceDelayCwnd
+ * 		Called by sender to shrink the congestion window of the delay based
+ * 		flow control when a packet of the connection is lost.
+ *
+ * 	A loss reported by the receiver halves the window; an expired packet also
+ * 	restarts slow start from the min window. Several packets expiring at once
+ * 	only count once.
+ */
+static void
+reduceDelayCwnd(MotionConn *conn, bool timeout)
+{
+	if (conn->cwnd <= DELAY_MIN_CWND)
+		return;
+
+	conn->ssthresh = Max(conn->cwnd / 2, DELAY_MIN_CWND);
+	conn->cwnd = timeout ? DELAY_MIN_CWND : conn->ssthresh;
+}
+
 /*
  * handleAck
  * 		handle acks incoming from our upstream peers.
@@ -4731,6 +5058,10 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
  *
  * After sending a buffer, the buffer will be placed into both the unack queue and
  * the corresponding queue in the unack queue ring.
+ *
+ * With the delay based flow control, a connection with outstanding buffers
+ * also waits for its pacing time, the ack of an outstanding buffer calls us
+ * again.
  */
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
@@ -4738,20 +5069,25 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer   *buf = NULL;
+		uint64		now = getCurrentTime();
 
 		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS &&
 			(icBufferListLength(&conn->unackQueue) > 0 &&
 			 unack_queue_ring.numSharedOutStanding >= (snd_control_info.cwnd - snd_control_info.minCwnd)))
 			break;
 
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY &&
+			(icBufferListLength(&conn->unackQueue) > 0 &&
+			 (icBufferListLength(&conn->unackQueue) >= conn->cwnd ||
+			  now < conn->nextSendTime)))
+			break;
+
 		/* for connection setup, we only allow one outstanding packet. */
 		if (conn->state == mcsSetupOutgoingConnection && icBufferListLength(&conn->unackQueue) >= 1)
 			break;
 
 		buf = icBufferListPop(&conn->sndQueue);
 
-		uint64		now = getCurrentTime();
-
 		buf->sentTime = now;
 		buf->unackQueueRingSlot = -1;
 		buf->nRetry = 0;
@@ -4760,7 +5096,16 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		icBufferListAppend(&conn->unackQueue, buf);
 
-		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+		{
+			/* space the packets out over the rtt, allowing a short burst */
+			uint64		interval = (uint64) (conn->rtt / conn->cwnd);
+
+			conn->nextSendTime = Max(conn->nextSendTime,
+									 now - (DELAY_PACING_BURST - 1) * interval) + interval;
+		}
+
+		if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 		{
 			unack_queue_ring.numOutStanding++;
 			if (icBufferListLength(&conn->unackQueue) > 1)
@@ -4786,6 +5131,7 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		sendOnce(transportStates, pEntry, buf, conn);
 		ic_statistics.sndPktNum++;
+		conn->stat_count_sent++;
 
 #ifdef AMS_VERBOSE_LOGGING
 		logPkt("SEND PKT DETAIL", buf->pkt);
@@ -4936,7 +5282,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 			/* this is a lost packet, retransmit */
 
 			buf->nRetry++;
-			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+			if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 			{
 				buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 				putIntoUnackQueueRing(&unack_queue_ring, buf,
@@ -4954,6 +5300,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 #endif
 
 			ic_statistics.retransmits++;
+			buf->conn->stat_count_resent++;
 			curLostPktSeq++;
 			lostPktCnt--;
 
@@ -4987,6 +5334,8 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 		snd_control_info.ssthresh = Max(snd_control_info.cwnd / 2, snd_control_info.minCwnd);
 		snd_control_info.cwnd = snd_control_info.ssthresh;
 	}
+	else if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+		reduceDelayCwnd(conn, false);
 #ifdef AMS_VERBOSE_LOGGING
 	write_log("After DISORDER: sndQ %d unackQ %d",
 			  icBufferListLength(&conn->sndQueue), icBufferListLength(&conn->unackQueue));
@@ -5152,6 +5501,8 @@ checkExpiration(ChunkTransportState *transportStates,
 			retransmits++;
 			ic_statistics.retransmits++;
 			curBuf->conn->stat_count_resent++;
+			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+				reduceDelayCwnd(curBuf->conn, true);
 			curBuf->conn->stat_max_resent = Max(curBuf->conn->stat_max_resent,
 												curBuf->conn->stat_count_resent);
 
@@ -5172,7 +5523,7 @@ checkExpiration(ChunkTransportState *transportStates,
 	 * deal with case when there is a long time this function is not called.
 	 */
 	unack_queue_ring.currentTime = now - (now % TIMER_SPAN);
-	if (retransmits > 0)
+	if (retransmits > 0 && Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
 	{
 		snd_control_info.ssthresh = Max(snd_control_info.cwnd / 2, snd_control_info.minCwnd);
 		snd_control_info.cwnd = snd_control_info.minCwnd;
@@ -5351,7 +5702,7 @@ checkExceptions(ChunkTransportState *transportStates,
 		checkExpirationCapacityFC(transportStates, pEntry, conn, timeout);
 	}
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 	{
 		uint64		now = getCurrentTime();
 
@@ -5404,7 +5755,7 @@ computeTimeout(MotionConn *conn, int retry)
 	if (buf->nRetry == 0 && retry == 0)
 		return 0;
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 		return TIMER_CHECKING_PERIOD;
 
 	/* for capacity based flow control */
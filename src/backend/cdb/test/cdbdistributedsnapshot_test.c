@@ -20,9 +20,7 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 
 	/* Static initializations */
 	{
-		dslm.minCachedLocalXid = InvalidTransactionId;
-		dslm.maxCachedLocalXid = InvalidTransactionId;
-		dslm.currentLocalXidsCount = 0;
+		DistributedSnapshotWithLocalMapping_ResetCache(&dslm);
 
 		dslm.inProgressMappedLocalXids =
 			(TransactionId*)malloc(5 * sizeof(TransactionId));
@@ -86,6 +84,9 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 		ds->inProgressXidArray[0] = 50;
 		ds->inProgressXidArray[1] = 100;
 		ds->inProgressXidArray[2] = 200;
+
+		/* the snapshot changed, so must its cache */
+		DistributedSnapshotWithLocalMapping_ResetCache(&dslm);
 	}
 
 	/* First time the local xid cache should get populated */
@@ -129,9 +130,9 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
 
 	/*
 	 * Lets revalidate that local cache is working and
@@ -143,9 +144,9 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
 
 	/*
 	 * Test where local cache should not be touched, if distributedXid is not
@@ -156,9 +157,19 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
+
+	/*
+	 * The results of the checks are cached in the snapshot, so checking
+	 * xid=15 again is answered without consulting the distributed log or the
+	 * local xid cache, and the latter stays as it was.
+	 */
+	assert_true(dslm.cachedResultXids[15 & (DSLM_RESULT_CACHE_SIZE - 1)] == 15);
+	retval = DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 15, false);
+	assert_true(retval == DISTRIBUTEDSNAPSHOT_COMMITTED_VISIBLE);
+	assert_true(dslm.currentLocalXidsCount == 3);
 
 	free(ds->inProgressXidArray);
 	free(dslm.inProgressMappedLocalXids);
@@ -17,8 +17,10 @@
 #include "catalog/pg_inherits.h"
 #include "catalog/pg_statistic.h"
 #include "cdb/cdbhash.h"
+#include "cdb/cdbvars.h"
 #include "commands/analyzeutils.h"
 #include "commands/vacuum.h"
+#include "executor/spi.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
 #include "parser/parse_oper.h"
@@ -1289,3 +1291,155 @@ leaf_parts_analyzed(Oid attrelid, Oid relid_exclude, List *va_cols, int elevel)
 
 	return !all_parts_empty;
 }
+
+/*
+ *	leaf_parts_unchanged_since_analyze() -- find leaf partitions that don't
+ *                                          need to be analyzed again
+ *
+ * Returns the subset of the leaf partitions in 'part_oids' that have stats
+ * for every column in 'va_cols' (NIL meaning all columns of the root
+ * 'attrelid'), and that no segment has seen modified since the last
+ * ANALYZE. Their existing stats, including the hyperloglog counters, can be
+ * merged into the root's stats as they are.
+ *
+ * Each segment resets its modification counter for a leaf when it samples
+ * the leaf for ANALYZE, so a single query dispatched to the segments tells
+ * which leaves changed. Counters are reported to the statistics collector
+ * with a small delay, so a change committed just before the ANALYZE may be
+ * missed, like with autovacuum.
+ */
+List *
+leaf_parts_unchanged_since_analyze(Oid attrelid, List *part_oids, List *va_cols,
+								   int elevel)
+{
+	StringInfoData str;
+	List	   *candidates = NIL;
+	List	   *changed = NIL;
+	List	   *result = NIL;
+	MemoryContext oldcxt;
+	ListCell   *lc,
+			   *lc_col;
+	uint64		i;
+
+	Assert(Gp_role == GP_ROLE_DISPATCH);
+
+	/* empty list means "all columns" */
+	if (va_cols == NIL)
+	{
+		Relation	parentrel = table_open(attrelid, AccessShareLock);
+		TupleDesc	tupdesc = RelationGetDescr(parentrel);
+
+		for (int j = 0; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute att = TupleDescAttr(tupdesc, j);
+
+			if (att->attisdropped)
+				continue;
+
+			va_cols = lappend(va_cols, makeString(pstrdup(NameStr(att->attname))));
+		}
+		table_close(parentrel, NoLock);
+	}
+
+	/*
+	 * Only leaves that already have stats for all the requested columns are
+	 * candidates for skipping.
+	 */
+	foreach(lc, part_oids)
+	{
+		Oid			partRelid = lfirst_oid(lc);
+		bool		has_stats = true;
+
+		if (get_rel_relkind(partRelid) == RELKIND_PARTITIONED_TABLE)
+			continue;
+
+		if (get_rel_reltuples(partRelid) == 0.0)
+			continue;
+
+		foreach(lc_col, va_cols)
+		{
+			const char *attname = strVal(lfirst(lc_col));
+			AttrNumber	child_attno = fetch_leaf_attnum(partRelid, attname);
+			HeapTuple	heaptupleStats;
+
+			heaptupleStats = fetch_leaf_att_stats(partRelid, child_attno);
+			if (!HeapTupleIsValid(heaptupleStats))
+			{
+				has_stats = false;
+				break;
+			}
+			heap_freetuple(heaptupleStats);
+		}
+
+		if (has_stats)
+			candidates = lappend_oid(candidates, partRelid);
+	}
+
+	if (candidates == NIL)
+		return NIL;
+
+	initStringInfo(&str);
+	appendStringInfoString(&str,
+						   "select distinct c.oid from gp_dist_random('pg_catalog.pg_class') c "
+						   "where c.oid = any ('{");
+	foreach(lc, candidates)
+	{
+		if (lc != list_head(candidates))
+			appendStringInfoChar(&str, ',');
+		appendStringInfo(&str, "%u", lfirst_oid(lc));
+	}
+	appendStringInfoString(&str,
+						   "}'::pg_catalog.oid[]) "
+						   "and (pg_catalog.pg_stat_get_last_analyze_time(c.oid) is null "
+						   "or pg_catalog.pg_stat_get_mod_since_analyze(c.oid) > 0)");
+
+	oldcxt = CurrentMemoryContext;
+
+	if (SPI_OK_CONNECT != SPI_connect())
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("unable to connect to execute internal query")));
+
+	elog(elevel, "Executing SQL: %s", str.data);
+
+	if (SPI_execute(str.data, true, 0) != SPI_OK_SELECT)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("unable to find the partitions changed since the last ANALYZE")));
+
+	for (i = 0; i < SPI_processed; i++)
+	{
+		bool		isnull;
+		Datum		d;
+
+		d = heap_getattr(SPI_tuptable->vals[i], 1, SPI_tuptable->tupdesc, &isnull);
+		if (!isnull)
+		{
+			MemoryContext spicxt = MemoryContextSwitchTo(oldcxt);
+
+			changed = lappend_oid(changed, DatumGetObjectId(d));
+			MemoryContextSwitchTo(spicxt);
+		}
+	}
+
+	SPI_finish();
+
+	foreach(lc, candidates)
+	{
+		Oid			partRelid = lfirst_oid(lc);
+
+		if (list_member_oid(changed, partRelid))
+			continue;
+
+		ereport(elevel,
+				(errmsg("skipping partition %s --- not changed since the last ANALYZE",
+						get_rel_name(partRelid))));
+		result = lappend_oid(result, partRelid);
+	}
+
+	list_free(candidates);
+	list_free(changed);
+	pfree(str.data);
+
+	return result;
+}
@@ -54,6 +54,7 @@
 #include "storage/fd.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/partcache.h"
@@ -228,6 +229,10 @@ static bool CopyReadLine(CopyState cstate);
 static bool CopyReadLineText(CopyState cstate);
 static int	CopyReadAttributesText(CopyState cstate, int stop_processing_at_field);
 static int	CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field);
+static bool CopySendBinaryFixedWidth(CopyState cstate, Oid send_func,
+									 Datum value);
+static bool CopyReadBinaryFixedWidth(CopyState cstate, Oid recv_func,
+									 int32 fld_size, Datum *result);
 static Datum CopyReadBinaryAttribute(CopyState cstate,
 									 int column_no, FmgrInfo *flinfo,
 									 Oid typioparam, int32 typmod,
@@ -261,6 +266,8 @@ static void SendCopyFromForwardedTuple(CopyState cstate,
 						   bool *nulls);
 static void SendCopyFromForwardedHeader(CopyState cstate, CdbCopy *cdbCopy);
 static void SendCopyFromForwardedError(CopyState cstate, CdbCopy *cdbCopy, char *errmsg);
+static void SendCopyFromForwardedLine(CopyState cstate, CdbCopy *cdbCopy);
+static void SendCopyFromForwardedBatch(CopyState cstate, CdbCopy *cdbCopy);
 
 static bool NextCopyFromDispatch(CopyState cstate, ExprContext *econtext,
 								 Datum *values, bool *nulls);
@@ -271,6 +278,8 @@ static bool NextCopyFromX(CopyState cstate, ExprContext *econtext,
 						  Datum *values, bool *nulls);
 static void HandleCopyError(CopyState cstate);
 static void HandleQDErrorFrame(CopyState cstate, char *p, int len);
+static void HandleQDBatchFrame(CopyState cstate, char *p, int len);
+static void NextCopyFromBatchLine(CopyState cstate);
 
 static void CopyInitDataParser(CopyState cstate);
 static void setEncodingConversionProc(CopyState cstate, int encoding, bool iswritable);
@@ -278,6 +287,8 @@ static void setEncodingConversionProc(CopyState cstate, int encoding, bool iswri
 static GpDistributionData *InitDistributionData(CopyState cstate, EState *estate);
 static void FreeDistributionData(GpDistributionData *distData);
 static void InitCopyFromDispatchSplit(CopyState cstate, GpDistributionData *distData, EState *estate);
+static bool CopyFromPassthroughPossible(CopyState cstate, GpDistributionData *distData,
+										PartitionTupleRouting *proute);
 static unsigned int GetTargetSeg(GpDistributionData *distData, TupleTableSlot *slot);
 static ProgramPipes *open_program_pipes(char *command, bool forwrite);
 static void close_program_pipes(CopyState cstate, bool ifThrow);
@@ -352,6 +363,13 @@ extern bool Test_copy_qd_qe_split;
  * needs to be logged in the error log (LOG ERRORS SEGMENT REJECT LIMIT), it
  * sends the erroneous raw to a QE, in a 'copy_from_dispatch_error' struct.
  *
+ * When the QD needs to parse no fields at all, because the table is randomly
+ * distributed and there are no DEFAULTs that the QE couldn't evaluate, the
+ * QD does pass the lines through as is (gp_copy_from_passthrough). It packs
+ * runs of consecutive lines into 'copy_from_dispatch_batch' structs, and
+ * sends each batch to the next QE in round-robin order. The QEs parse the
+ * lines and evaluate the defaults themselves.
+ *
  *
  * COPY TO is simpler: The QEs form the output rows in the final form, and the QD
  * just collects and forwards them to the client. The QD doesn't need to parse
@@ -434,6 +452,28 @@ typedef struct
 /* Size of the struct, without padding at the end. */
 #define SizeOfCopyFromDispatchError (offsetof(copy_from_dispatch_error, line_buf_converted) + sizeof(bool))
 
+typedef struct
+{
+	int64		batch_marker;	/* constant -2, to mark that this is a batch
+								 * frame rather than 'copy_from_dispatch_row' */
+	int64		lineno;			/* line number of the first line */
+	uint32		nlines;			/* # of lines in the batch */
+	uint32		len;			/* size of the data that follows */
+
+	/*
+	 * For each line, the data contains:
+	 *
+	 * uint32	line_len;
+	 * <line>
+	 */
+} copy_from_dispatch_batch;
+
+/* Size of the struct, without padding at the end. */
+#define SizeOfCopyFromDispatchBatch (offsetof(copy_from_dispatch_batch, len) + sizeof(uint32))
+
+/* Send a batch once it has grown this large. */
+#define COPY_DISPATCH_BATCH_SIZE	(64 * 1024)
+
 
 /*
  * Send copy start/stop messages for frontend copies.  These have changed
@@ -3367,6 +3407,15 @@ CopyOneRowTo(CopyState cstate, TupleTableSlot *slot)
 			{
 				bytea	   *outputbytes;
 
+				/*
+				 * Fixed-width built-in types are encoded directly, without
+				 * a palloc'd bytea for each value.
+				 */
+				if (CopySendBinaryFixedWidth(cstate,
+											 out_functions[attnum - 1].fn_oid,
+											 value))
+					continue;
+
 				outputbytes = SendFunctionCall(&out_functions[attnum - 1],
 											   value);
 				CopySendInt32(cstate, VARSIZE(outputbytes) - VARHDRSZ);
@@ -4295,6 +4344,21 @@ CopyFrom(CopyState cstate)
 			if (!cstate->on_segment)
 				SendCopyFromForwardedHeader(cstate, cdbCopy);
 		}
+
+		if (CopyFromPassthroughPossible(cstate, distData, proute))
+		{
+			/* reserve room for the header at the beginning of each batch */
+			cstate->dispatch_passthrough = true;
+			cstate->dispatch_batchbuf = makeStringInfo();
+			enlargeStringInfo(cstate->dispatch_batchbuf, COPY_DISPATCH_BATCH_SIZE);
+			cstate->dispatch_batchbuf->len = SizeOfCopyFromDispatchBatch;
+
+			/*
+			 * Start at a random segment, like a row of a randomly distributed
+			 * table would, so that small COPYs don't all land on segment 0.
+			 */
+			cstate->dispatch_batch_seg = cdbhashrandomseg(cdbCopy->total_segs);
+		}
 	}
 
 	CopyInitDataParser(cstate);
@@ -4545,6 +4609,14 @@ CopyFrom(CopyState cstate)
 
 		skip_tuple = false;
 
+		if (cstate->dispatch_passthrough)
+		{
+			/* in the QD, pass the line through to the QEs as is. */
+			SendCopyFromForwardedLine(cstate, cdbCopy);
+			processed++;
+			continue;
+		}
+
 		/*
 		 * Compute which segment this row belongs to.
 		 */
@@ -4765,6 +4837,9 @@ CopyFrom(CopyState cstate)
 		int64		total_completed_from_qes;
 		int64		total_rejected_from_qes;
 
+		if (cstate->dispatch_passthrough)
+			SendCopyFromForwardedBatch(cstate, cdbCopy);
+
 		cdbCopyEnd(cdbCopy,
 				   &total_completed_from_qes,
 				   &total_rejected_from_qes);
@@ -5598,9 +5673,10 @@ NextCopyFromX(CopyState cstate, ExprContext *econtext,
 	 * in the QD->QE stream as pre-computed Datums. Funny indentation, to
 	 * keep the indentation of the code inside the same as in upstream.
 	 * (We could improve this, and compute immutable defaults that don't
-	 * affect which segment the row belongs to, in the QE.)
+	 * affect which segment the row belongs to, in the QE.) In passthrough
+	 * mode, the QEs compute the defaults, see NextCopyFromExecute().
 	 */
-  if (cstate->dispatch_mode != COPY_EXECUTOR)
+  if (cstate->dispatch_mode != COPY_EXECUTOR && !cstate->dispatch_passthrough)
   {
 	for (i = 0; i < num_defaults; i++)
 	{
@@ -5650,6 +5726,7 @@ NextCopyFromExecute(CopyState cstate, ExprContext *econtext, Datum *values, bool
 	copy_from_dispatch_row frame;
 	int			r;
 	bool		got_error;
+	bool		from_batch;
 
 	tupDesc = RelationGetDescr(cstate->rel);
 	num_phys_attrs = tupDesc->natts;
@@ -5663,6 +5740,8 @@ NextCopyFromExecute(CopyState cstate, ExprContext *econtext, Datum *values, bool
 	 */
 	StaticAssertStmt(SizeOfCopyFromDispatchError >= SizeOfCopyFromDispatchRow,
 					 "copy_from_dispatch_error must be larger than copy_from_dispatch_row");
+	StaticAssertStmt(SizeOfCopyFromDispatchBatch >= SizeOfCopyFromDispatchRow,
+					 "copy_from_dispatch_batch must be larger than copy_from_dispatch_row");
 
 	/*
 	 * If we encounter an error while parsing the row (or we receive a row from
@@ -5671,51 +5750,66 @@ NextCopyFromExecute(CopyState cstate, ExprContext *econtext, Datum *values, bool
 	 */
 retry:
 	got_error = false;
-
-	r = CopyGetData(cstate, (char *) &frame, SizeOfCopyFromDispatchRow);
-	if (r == 0)
-		return false;
-	if (r != SizeOfCopyFromDispatchRow)
-		ereport(ERROR,
-				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-				 errmsg("unexpected EOF in COPY data")));
-	if (frame.lineno == -1)
-	{
-		HandleQDErrorFrame(cstate, (char *) &frame, SizeOfCopyFromDispatchRow);
-		goto retry;
-	}
+	from_batch = (cstate->dispatch_batch_nlines > 0);
 
 	/* Prepare for parsing the input line */
 	attr = tupDesc->attrs;
 	num_phys_attrs = tupDesc->natts;
 
+	if (from_batch)
+	{
+		/* Take the next line of the batch passed through from the QD. */
+		NextCopyFromBatchLine(cstate);
+		frame.fld_count = 0;
+	}
+	else
+	{
+		r = CopyGetData(cstate, (char *) &frame, SizeOfCopyFromDispatchRow);
+		if (r == 0)
+			return false;
+		if (r != SizeOfCopyFromDispatchRow)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("unexpected EOF in COPY data")));
+		if (frame.lineno == -1)
+		{
+			HandleQDErrorFrame(cstate, (char *) &frame, SizeOfCopyFromDispatchRow);
+			goto retry;
+		}
+		if (frame.lineno == -2)
+		{
+			HandleQDBatchFrame(cstate, (char *) &frame, SizeOfCopyFromDispatchRow);
+			goto retry;
+		}
+
+		/* check for overflowing fields */
+		if (frame.fld_count < 0 || frame.fld_count > num_phys_attrs)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("extra data after last expected column")));
+
+		/*
+		 * Read the input line into 'line_buf'.
+		 */
+		resetStringInfo(&cstate->line_buf);
+		enlargeStringInfo(&cstate->line_buf, frame.line_len);
+		if (CopyGetData(cstate, cstate->line_buf.data, frame.line_len) != frame.line_len)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("unexpected EOF in COPY data")));
+		cstate->line_buf.data[frame.line_len] = '\0';
+		cstate->line_buf.len = frame.line_len;
+		cstate->line_buf.cursor = frame.residual_off;
+		cstate->line_buf_valid = true;
+		cstate->line_buf_converted = true;
+		cstate->cur_lineno = frame.lineno;
+		cstate->stopped_processing_at_delim = frame.delim_seen_at_end;
+	}
+
 	/* Initialize all values for row to NULL */
 	MemSet(values, 0, num_phys_attrs * sizeof(Datum));
 	MemSet(nulls, true, num_phys_attrs * sizeof(bool));
 
-	/* check for overflowing fields */
-	if (frame.fld_count < 0 || frame.fld_count > num_phys_attrs)
-		ereport(ERROR,
-				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-				 errmsg("extra data after last expected column")));
-
-	/*
-	 * Read the input line into 'line_buf'.
-	 */
-	resetStringInfo(&cstate->line_buf);
-	enlargeStringInfo(&cstate->line_buf, frame.line_len);
-	if (CopyGetData(cstate, cstate->line_buf.data, frame.line_len) != frame.line_len)
-		ereport(ERROR,
-				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-				 errmsg("unexpected EOF in COPY data")));
-	cstate->line_buf.data[frame.line_len] = '\0';
-	cstate->line_buf.len = frame.line_len;
-	cstate->line_buf.cursor = frame.residual_off;
-	cstate->line_buf_valid = true;
-	cstate->line_buf_converted = true;
-	cstate->cur_lineno = frame.lineno;
-	cstate->stopped_processing_at_delim = frame.delim_seen_at_end;
-
 	/*
 	 * Parse any fields from the input line that were not processed in the
 	 * QD already.
@@ -5849,10 +5943,20 @@ retry:
 		goto retry;
 
 	/*
-	 * Here we should compute defaults for any columns for which we didn't
-	 * get a default from the QD. But at the moment, all defaults are evaluated
-	 * in the QD.
+	 * Compute defaults for any columns for which we didn't get a default from
+	 * the QD. The QD evaluates all defaults, except for the lines it passes
+	 * through in batches; it only does that when the defaults are immutable.
 	 */
+	if (from_batch)
+	{
+		for (i = 0; i < cstate->num_defaults; i++)
+		{
+			int			m = cstate->defmap[i];
+
+			values[m] = ExecEvalExpr(cstate->defexprs[i], econtext, &nulls[m]);
+		}
+	}
+
 	return true;
 }
 
@@ -5918,6 +6022,84 @@ HandleQDErrorFrame(CopyState cstate, char *p, int len)
 
 }
 
+/*
+ * Receive a "batch frame" from QD, in passthrough mode. The lines in it are
+ * then returned one by one by NextCopyFromBatchLine.
+ *
+ * The caller has already read part of the frame; 'p' points to that part,
+ * of length 'len'.
+ */
+static void
+HandleQDBatchFrame(CopyState cstate, char *p, int len)
+{
+	copy_from_dispatch_batch batchframe;
+	StringInfo	batchbuf;
+	int			r;
+
+	Assert(len <= SizeOfCopyFromDispatchBatch);
+
+	Assert(Gp_role == GP_ROLE_EXECUTE);
+
+	memcpy(&batchframe, p, len);
+
+	r = CopyGetData(cstate, ((char *) &batchframe) + len, SizeOfCopyFromDispatchBatch - len);
+	if (r != SizeOfCopyFromDispatchBatch - len)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("unexpected EOF in COPY data")));
+
+	if (cstate->dispatch_batchbuf == NULL)
+	{
+		MemoryContext oldcontext = MemoryContextSwitchTo(cstate->copycontext);
+
+		cstate->dispatch_batchbuf = makeStringInfo();
+		MemoryContextSwitchTo(oldcontext);
+	}
+	batchbuf = cstate->dispatch_batchbuf;
+
+	resetStringInfo(batchbuf);
+	enlargeStringInfo(batchbuf, batchframe.len);
+	if (CopyGetData(cstate, batchbuf->data, batchframe.len) != batchframe.len)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("unexpected EOF in COPY data")));
+	batchbuf->len = batchframe.len;
+
+	cstate->dispatch_batch_nlines = batchframe.nlines;
+	cstate->dispatch_batch_lineno = batchframe.lineno;
+}
+
+/*
+ * Take the next line from the batch received from the QD into 'line_buf',
+ * as if it had come in a 'copy_from_dispatch_row' with no fields processed
+ * in the QD.
+ */
+static void
+NextCopyFromBatchLine(CopyState cstate)
+{
+	StringInfo	batchbuf = cstate->dispatch_batchbuf;
+	uint32		line_len;
+
+	Assert(cstate->dispatch_batch_nlines > 0);
+
+	if (batchbuf->cursor + sizeof(uint32) > batchbuf->len)
+		elog(ERROR, "invalid batch of lines received from QD");
+	memcpy(&line_len, batchbuf->data + batchbuf->cursor, sizeof(uint32));
+	batchbuf->cursor += sizeof(uint32);
+	if (line_len > batchbuf->len - batchbuf->cursor)
+		elog(ERROR, "invalid batch of lines received from QD");
+
+	resetStringInfo(&cstate->line_buf);
+	appendBinaryStringInfo(&cstate->line_buf, batchbuf->data + batchbuf->cursor, line_len);
+	batchbuf->cursor += line_len;
+
+	cstate->line_buf_valid = true;
+	cstate->line_buf_converted = true;
+	cstate->cur_lineno = cstate->dispatch_batch_lineno++;
+	cstate->stopped_processing_at_delim = true;
+	cstate->dispatch_batch_nlines--;
+}
+
 /*
  * Inlined versions of appendBinaryStringInfo and enlargeStringInfo, for
  * speed.
@@ -6139,6 +6321,64 @@ SendCopyFromForwardedError(CopyState cstate, CdbCopy *cdbCopy, char *errormsg)
 	cdbCopySendData(cdbCopy, target_seg, msgbuf->data, msgbuf->len);
 }
 
+/*
+ * Used in the QD in passthrough mode, to add the current input line to the
+ * batch of lines to send to the next QE.
+ */
+static void
+SendCopyFromForwardedLine(CopyState cstate, CdbCopy *cdbCopy)
+{
+	StringInfo	batchbuf = cstate->dispatch_batchbuf;
+	uint32		line_len = cstate->line_buf.len;
+
+	/*
+	 * A batch carries only the line number of its first line, so the lines
+	 * in it must be consecutive. Lines that the QD rejected leave a gap.
+	 */
+	if (cstate->dispatch_batch_nlines > 0 &&
+		cstate->cur_lineno != cstate->dispatch_batch_lineno + cstate->dispatch_batch_nlines)
+		SendCopyFromForwardedBatch(cstate, cdbCopy);
+
+	if (cstate->dispatch_batch_nlines == 0)
+		cstate->dispatch_batch_lineno = cstate->cur_lineno;
+
+	ENLARGE_MSGBUF(batchbuf, sizeof(uint32) + line_len);
+	APPEND_MSGBUF_NOCHECK(batchbuf, &line_len, sizeof(uint32));
+	APPEND_MSGBUF_NOCHECK(batchbuf, cstate->line_buf.data, line_len);
+	cstate->dispatch_batch_nlines++;
+
+	if (batchbuf->len >= COPY_DISPATCH_BATCH_SIZE)
+		SendCopyFromForwardedBatch(cstate, cdbCopy);
+}
+
+/*
+ * Send the batch of lines collected so far, if any, to the next QE.
+ */
+static void
+SendCopyFromForwardedBatch(CopyState cstate, CdbCopy *cdbCopy)
+{
+	StringInfo	batchbuf = cstate->dispatch_batchbuf;
+	copy_from_dispatch_batch *batchframe;
+	int			target_seg;
+
+	if (cstate->dispatch_batch_nlines == 0)
+		return;
+
+	/* Fill in the header. We reserved room for it at the beginning. */
+	batchframe = (copy_from_dispatch_batch *) batchbuf->data;
+	batchframe->batch_marker = -2;
+	batchframe->lineno = cstate->dispatch_batch_lineno;
+	batchframe->nlines = cstate->dispatch_batch_nlines;
+	batchframe->len = batchbuf->len - SizeOfCopyFromDispatchBatch;
+
+	target_seg = cstate->dispatch_batch_seg++ % cdbCopy->total_segs;
+
+	cdbCopySendData(cdbCopy, target_seg, batchbuf->data, batchbuf->len);
+
+	batchbuf->len = SizeOfCopyFromDispatchBatch;
+	cstate->dispatch_batch_nlines = 0;
+}
+
 /*
  * Clean up storage and release resources for COPY FROM.
  */
@@ -7144,6 +7384,13 @@ CopyReadBinaryAttribute(CopyState cstate,
 				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 				 errmsg("invalid field size")));
 
+	/* Decode fixed-width built-in types without calling the converter */
+	if (CopyReadBinaryFixedWidth(cstate, flinfo->fn_oid, fld_size, &result))
+	{
+		*isnull = false;
+		return result;
+	}
+
 	/* reset attribute_buf to empty, and load raw data in it */
 	resetStringInfo(&cstate->attribute_buf);
 
@@ -7171,6 +7418,165 @@ CopyReadBinaryAttribute(CopyState cstate,
 	return result;
 }
 
+/*
+ * Send a value of one of the fixed-width built-in types, whose send function
+ * just emits the value in network byte order, without calling the send
+ * function. Returns false if 'send_func' is not one of those.
+ */
+static bool
+CopySendBinaryFixedWidth(CopyState cstate, Oid send_func, Datum value)
+{
+	union
+	{
+		float4		f;
+		int32		i;
+	}			swap4;
+	union
+	{
+		float8		f;
+		int64		i;
+	}			swap8;
+	uint64		buf8;
+
+	switch (send_func)
+	{
+		case F_BOOLSEND:
+			CopySendInt32(cstate, 1);
+			CopySendChar(cstate, DatumGetBool(value) ? 1 : 0);
+			return true;
+
+		case F_INT2SEND:
+			CopySendInt32(cstate, sizeof(int16));
+			CopySendInt16(cstate, DatumGetInt16(value));
+			return true;
+
+		case F_INT4SEND:
+		case F_OIDSEND:
+		case F_DATE_SEND:
+			CopySendInt32(cstate, sizeof(int32));
+			CopySendInt32(cstate, DatumGetInt32(value));
+			return true;
+
+		case F_FLOAT4SEND:
+			swap4.f = DatumGetFloat4(value);
+			CopySendInt32(cstate, sizeof(int32));
+			CopySendInt32(cstate, swap4.i);
+			return true;
+
+		case F_INT8SEND:
+		case F_TIMESTAMP_SEND:
+		case F_TIMESTAMPTZ_SEND:
+			buf8 = pg_hton64((uint64) DatumGetInt64(value));
+			CopySendInt32(cstate, sizeof(int64));
+			CopySendData(cstate, &buf8, sizeof(buf8));
+			return true;
+
+		case F_FLOAT8SEND:
+			swap8.f = DatumGetFloat8(value);
+			buf8 = pg_hton64((uint64) swap8.i);
+			CopySendInt32(cstate, sizeof(int64));
+			CopySendData(cstate, &buf8, sizeof(buf8));
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * Read a field of 'fld_size' bytes of one of the fixed-width built-in types,
+ * whose receive function does no more than decode the value from network
+ * byte order, without calling the receive function. Returns false without
+ * reading anything if 'recv_func' is not one of those, or the field doesn't
+ * have the type's size; the receive function then reports the error.
+ */
+static bool
+CopyReadBinaryFixedWidth(CopyState cstate, Oid recv_func, int32 fld_size,
+						 Datum *result)
+{
+	union
+	{
+		float4		f;
+		uint32		i;
+	}			swap4;
+	union
+	{
+		float8		f;
+		uint64		i;
+	}			swap8;
+	int			len;
+	char		buf[8];
+	uint16		buf2;
+	uint32		buf4;
+	uint64		buf8;
+
+	switch (recv_func)
+	{
+		case F_BOOLRECV:
+			len = 1;
+			break;
+		case F_INT2RECV:
+			len = sizeof(int16);
+			break;
+		case F_INT4RECV:
+		case F_OIDRECV:
+		case F_FLOAT4RECV:
+			len = sizeof(int32);
+			break;
+		case F_INT8RECV:
+		case F_FLOAT8RECV:
+			len = sizeof(int64);
+			break;
+		default:
+			return false;
+	}
+
+	if (fld_size != len)
+		return false;
+
+	if (CopyGetData(cstate, buf, len) != len)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("unexpected EOF in COPY data")));
+
+	switch (recv_func)
+	{
+		case F_BOOLRECV:
+			*result = BoolGetDatum(buf[0] != 0);
+			break;
+		case F_INT2RECV:
+			memcpy(&buf2, buf, sizeof(buf2));
+			*result = Int16GetDatum((int16) pg_ntoh16(buf2));
+			break;
+		case F_INT4RECV:
+			memcpy(&buf4, buf, sizeof(buf4));
+			*result = Int32GetDatum((int32) pg_ntoh32(buf4));
+			break;
+		case F_OIDRECV:
+			memcpy(&buf4, buf, sizeof(buf4));
+			*result = ObjectIdGetDatum((Oid) pg_ntoh32(buf4));
+			break;
+		case F_FLOAT4RECV:
+			memcpy(&buf4, buf, sizeof(buf4));
+			swap4.i = pg_ntoh32(buf4);
+			*result = Float4GetDatum(swap4.f);
+			break;
+		case F_INT8RECV:
+			memcpy(&buf8, buf, sizeof(buf8));
+			*result = Int64GetDatum((int64) pg_ntoh64(buf8));
+			break;
+		case F_FLOAT8RECV:
+			memcpy(&buf8, buf, sizeof(buf8));
+			swap8.i = pg_ntoh64(buf8);
+			*result = Float8GetDatum(swap8.f);
+			break;
+		default:
+			elog(ERROR, "unexpected receive function %u", recv_func);
+	}
+
+	return true;
+}
+
 /*
  * Send text representation of one attribute, with conversion and escaping
  */
@@ -7791,6 +8197,46 @@ InitCopyFromDispatchSplit(CopyState cstate, GpDistributionData *distData,
 	}
 }
 
+/*
+ * Can the QD pass the input lines through to the QEs as is, in batches?
+ *
+ * That's possible when the QD needs nothing from a row to decide where to
+ * send it: the table is randomly distributed, and there is no partition
+ * routing or WHERE clause. The QEs must also be able to evaluate the
+ * defaults, so they must all be immutable. (A nextval() in a QE would have
+ * to call back to the QD, which isn't listening while it forwards the data.)
+ */
+static bool
+CopyFromPassthroughPossible(CopyState cstate, GpDistributionData *distData,
+							PartitionTupleRouting *proute)
+{
+	if (!gp_copy_from_passthrough)
+		return false;
+
+	if (cstate->binary || cstate->on_segment)
+		return false;
+
+	if (list_length(cstate->attnumlist) == 0 ||
+		cstate->first_qe_processed_field != 0)
+		return false;
+
+	if (distData->policy == NULL ||
+		distData->policy->nattrs != 0 ||
+		GpPolicyIsReplicated(distData->policy))
+		return false;
+
+	if (proute != NULL || cstate->whereClause)
+		return false;
+
+	for (int i = 0; i < cstate->num_defaults; i++)
+	{
+		if (contain_mutable_functions((Node *) cstate->defexprs[i]->expr))
+			return false;
+	}
+
+	return true;
+}
+
 static unsigned int
 GetTargetSeg(GpDistributionData *distData, TupleTableSlot *slot)
 {
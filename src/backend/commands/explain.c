@@ -703,7 +703,15 @@ ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
 		ExplainPropertyStringInfo("Optimizer", es, "Postgres query optimizer");
 #ifdef USE_ORCA
 	else
+	{
 		ExplainPropertyStringInfo("Optimizer", es, "Pivotal Optimizer (GPORCA)");
+
+		if (queryDesc->plannedstmt->planBudgetExhausted)
+			ExplainPropertyStringInfo("Optimizer Search", es,
+									  "planning time budget exhausted after %d of %d search stages",
+									  queryDesc->plannedstmt->planSearchStagesCompleted,
+									  queryDesc->plannedstmt->planSearchStages);
+	}
 #endif
 
 	/* We only list the non-default GUCs in verbose mode */
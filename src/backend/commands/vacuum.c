@@ -901,8 +901,28 @@ expand_vacuum_rel(VacuumRelation *vrel, int options)
 		if (include_parts && !skip_children)
 		{
 			List	   *part_oids = find_all_inheritors(relid, NoLock, NULL);
+			List	   *unchanged_oids = NIL;
 			ListCell   *part_lc;
 
+			/*
+			 * With gp_analyze_changed_partitions_only, a plain ANALYZE of a
+			 * partitioned table leaves out the leaf partitions that haven't
+			 * changed since they were last analyzed. The root's stats are
+			 * then merged from their existing stats.
+			 */
+			if (gp_analyze_changed_partitions_only &&
+				Gp_role == GP_ROLE_DISPATCH &&
+				(options & VACOPT_VACUUM) == 0 &&
+				!skip_this)
+			{
+				int			elevel = ((options & VACOPT_VERBOSE) ? LOG : DEBUG2);
+
+				unchanged_oids = leaf_parts_unchanged_since_analyze(relid,
+																	part_oids,
+																	vrel->va_cols,
+																	elevel);
+			}
+
 			foreach(part_lc, part_oids)
 			{
 				Oid			part_oid = lfirst_oid(part_lc);
@@ -914,6 +934,9 @@ expand_vacuum_rel(VacuumRelation *vrel, int options)
 					get_rel_relkind(part_oid) == RELKIND_PARTITIONED_TABLE)
 					continue;
 
+				if (list_member_oid(unchanged_oids, part_oid))
+					continue;
+
 				/*
 				 * We omit a RangeVar since it wouldn't be appropriate to
 				 * complain about failure to open one of these relations
@@ -41,6 +41,42 @@ static TupleTableSlot *SeqNext(SeqScanState *node);
  * ----------------------------------------------------------------
  */
 
+/* ----------------------------------------------------------------
+ *		SeqBeginScan
+ *
+ *		Starts the scan of a non-parallel SeqScan
+ * ----------------------------------------------------------------
+ */
+static void
+SeqBeginScan(SeqScanState *node)
+{
+	EState	   *estate = node->ss.ps.state;
+	TableScanDesc scandesc;
+
+	/*
+	 * We reach here if the scan is not parallel, or if we're serially
+	 * executing a scan that was planned to be parallel.
+	 */
+	/*
+	 * GPDB: we are using table_beginscan_es in order to also initialize the
+	 * scan state with the column info needed for AOCO relations. Check the
+	 * comment in table_beginscan_es() for more info.
+	 */
+	scandesc = table_beginscan_es(node->ss.ss_currentRelation,
+								  estate->es_snapshot,
+								  node->ss.ps.plan->targetlist,
+								  node->ss.ps.plan->qual,
+								  &node->ss.ps);
+	node->ss.ss_currentScanDesc = scandesc;
+
+	/*
+	 * GPDB: if the AM evaluates the qual itself, it only returns tuples that
+	 * satisfy it. Don't have ExecScan() evaluate it a second time.
+	 */
+	if ((scandesc->rs_flags & SO_QUAL_APPLIED) != 0)
+		node->ss.ps.qual = NULL;
+}
+
 /* ----------------------------------------------------------------
  *		SeqNext
  *
@@ -55,6 +91,9 @@ SeqNext(SeqScanState *node)
 	ScanDirection direction;
 	TupleTableSlot *slot;
 
+	if (node->ss.ss_currentScanDesc == NULL)
+		SeqBeginScan(node);
+
 	/*
 	 * get information from the estate and scan state
 	 */
@@ -63,24 +102,6 @@ SeqNext(SeqScanState *node)
 	direction = estate->es_direction;
 	slot = node->ss.ss_ScanTupleSlot;
 
-	if (scandesc == NULL)
-	{
-		/*
-		 * We reach here if the scan is not parallel, or if we're serially
-		 * executing a scan that was planned to be parallel.
-		 */
-		/*
-		 * GPDB: we are using table_beginscan_es in order to also initialize the
-		 * scan state with the column info needed for AOCO relations. Check the
-		 * comment in table_beginscan_es() for more info.
-		 */
-		scandesc = table_beginscan_es(node->ss.ss_currentRelation,
-									  estate->es_snapshot,
-									  node->ss.ps.plan->targetlist,
-									  node->ss.ps.plan->qual);
-		node->ss.ss_currentScanDesc = scandesc;
-	}
-
 	/*
 	 * get the next tuple from the table
 	 */
@@ -116,6 +137,13 @@ ExecSeqScan(PlanState *pstate)
 {
 	SeqScanState *node = castNode(SeqScanState, pstate);
 
+	/*
+	 * GPDB: start the scan before ExecScan() picks up the qual, which the
+	 * scan may take over.
+	 */
+	if (node->ss.ss_currentScanDesc == NULL)
+		SeqBeginScan(node);
+
 	return ExecScan(&node->ss,
 					(ExecScanAccessMtd) SeqNext,
 					(ExecScanRecheckMtd) SeqRecheck);
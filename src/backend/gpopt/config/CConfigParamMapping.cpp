@@ -81,6 +81,10 @@ CConfigParamMapping::SConfigMappingElem CConfigParamMapping::m_elements[] = {
 	 false,	 // m_negate_param
 	 GPOS_WSZ_LIT("Prints optimization stats.")},
 
+	{EopttraceProfileOptimization, &optimizer_profile,
+	 false,	 // m_negate_param
+	 GPOS_WSZ_LIT("Collect a profile of xforms, jobs and memo growth.")},
+
 	{EopttraceMinidump,
 	 // GPDB_91_MERGE_FIXME: I turned optimizer_minidump from bool into
 	 // an enum-type GUC. It's a bit dirty to cast it like this..
@@ -88,6 +92,10 @@ CConfigParamMapping::SConfigMappingElem CConfigParamMapping::m_elements[] = {
 	 false,	 // m_negate_param
 	 GPOS_WSZ_LIT("Generate optimizer minidump.")},
 
+	{EopttraceBinaryMinidump, &optimizer_minidump_binary,
+	 false,	 // m_negate_param
+	 GPOS_WSZ_LIT("Write optimizer minidumps in the binary DXL format.")},
+
 	{EopttraceDisableMotions, &optimizer_enable_motions,
 	 true,	// m_negate_param
 	 GPOS_WSZ_LIT("Disable motion nodes in optimizer.")},
@@ -140,10 +148,21 @@ CConfigParamMapping::SConfigMappingElem CConfigParamMapping::m_elements[] = {
 	 true,	// m_negate_param
 	 GPOS_WSZ_LIT("Disable deriving stats for all groups after exploration.")},
 
+	{EopttraceDisableJoinStatsCache, &optimizer_enable_join_stats_cache,
+	 true,	// m_negate_param
+	 GPOS_WSZ_LIT(
+		 "Disable reusing join stats derived for the same relations and predicates.")},
+
 	{EopttraceEnableSpacePruning, &optimizer_enable_space_pruning,
 	 false,	 // m_negate_param
 	 GPOS_WSZ_LIT("Enable space pruning in optimizer.")},
 
+	{EopttraceEnableCostBoundPropagation,
+	 &optimizer_enable_cost_bound_propagation,
+	 false,	 // m_negate_param
+	 GPOS_WSZ_LIT(
+		 "Propagate upper cost bounds to child optimization contexts.")},
+
 	{EopttraceForceMultiStageAgg, &optimizer_force_multistage_agg,
 	 false,	 // m_negate_param
 	 GPOS_WSZ_LIT(
@@ -184,6 +203,11 @@ CConfigParamMapping::SConfigMappingElem CConfigParamMapping::m_elements[] = {
 	 false,	 // m_negate_param
 	 GPOS_WSZ_LIT("Enable CTE inlining.")},
 
+	{EopttraceEnableSubexpressionSharing,
+	 &optimizer_enable_subexpression_sharing,
+	 false,	 // m_negate_param
+	 GPOS_WSZ_LIT("Share identical subtrees of union inputs through CTEs.")},
+
 	{EopttraceEnableConstantExpressionEvaluation,
 	 &optimizer_enable_constant_expression_evaluation,
 	 false,	 // m_negate_param
@@ -2111,11 +2111,14 @@ CTranslatorRelcacheToDXL::RetrieveColStats(CMemoryPool *mp,
 	const IMDColumn *md_col = md_rel->GetMdCol(pos);
 	AttrNumber attno = (AttrNumber) md_col->AttrNum();
 
-	// number of rows from pg_class
-	double num_rows;
-
-	num_rows =
-		gpdb::CdbEstimatePartitionedNumTuples(gpdb::GetRelation(rel_oid).get());
+	// number of rows, from the relation statistics cached by the metadata
+	// accessor; estimating it again for every column would visit every
+	// partition of a partitioned table once per column
+	mdid_rel->AddRef();
+	CMDIdRelStats *mdid_rel_stats =
+		GPOS_NEW(mp) CMDIdRelStats(CMDIdGPDB::CastMdid(mdid_rel));
+	double num_rows = md_accessor->Pmdrelstats(mdid_rel_stats)->Rows().Get();
+	mdid_rel_stats->Release();
 
 	// extract column name and type
 	CMDName *md_colname =
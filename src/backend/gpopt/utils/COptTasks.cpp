@@ -49,6 +49,7 @@
 
 #include "gpopt/base/CAutoOptCtxt.h"
 #include "gpopt/engine/CEnumeratorConfig.h"
+#include "gpopt/engine/COptimizationProfile.h"
 #include "gpopt/engine/CStatisticsConfig.h"
 #include "gpopt/engine/CCTEConfig.h"
 #include "gpopt/mdcache/CAutoMDAccessor.h"
@@ -98,6 +99,12 @@ using namespace gpdbcost;
 // default id for the source system
 const CSystemId default_sysid(IMDId::EmdidGPDB, GPOS_WSZ_STR_LENGTH("GPDB"));
 
+// profile accumulated over the queries optimized in this session while
+// optimizer_profile is on, and the memory pool it lives in, which lasts
+// for the whole session
+static CMemoryPool *session_profile_mp = NULL;
+static COptimizationProfile *session_profile = NULL;
+
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -396,6 +403,11 @@ COptTasks::CreateOptimizerConfig(CMemoryPool *mp, ICostModel *cost_model)
 	ULONG broadcast_threshold = (ULONG) optimizer_penalize_broadcast_threshold;
 	ULONG push_group_by_below_setop_threshold =
 		(ULONG) optimizer_push_group_by_below_setop_threshold;
+	ULONG planning_time_budget = gpos::ulong_max;
+	if (0 < optimizer_planning_time_budget)
+	{
+		planning_time_budget = (ULONG) optimizer_planning_time_budget;
+	}
 
 	return GPOS_NEW(mp) COptimizerConfig(
 		GPOS_NEW(mp)
@@ -411,7 +423,7 @@ COptTasks::CreateOptimizerConfig(CMemoryPool *mp, ICostModel *cost_model)
 				  broadcast_threshold,
 				  false, /* don't create Assert nodes for constraints, we'll
 								      * enforce them ourselves in the executor */
-				  push_group_by_below_setop_threshold),
+				  push_group_by_below_setop_threshold, planning_time_budget),
 		GPOS_NEW(mp) CWindowOids(OID(F_WINDOW_ROW_NUMBER), OID(F_WINDOW_RANK)));
 }
 
@@ -635,6 +647,23 @@ COptTasks::OptimizeTask(void *ptr)
 						mp, &mda, opt_ctxt->m_query, plan_dxl,
 						opt_ctxt->m_query->canSetTag,
 						query_to_dxl_translator->GetDistributionHashOpsKind()));
+
+				// report how much of the search ran within the planning
+				// time budget, shown by EXPLAIN
+				CEnumeratorConfig *enumerator_config =
+					optimizer_config->GetEnumeratorCfg();
+				opt_ctxt->m_plan_stmt->planBudgetExhausted =
+					enumerator_config->FTimeBudgetExhausted();
+				opt_ctxt->m_plan_stmt->planSearchStagesCompleted =
+					(int) enumerator_config->UlSearchStagesCompleted();
+				opt_ctxt->m_plan_stmt->planSearchStages =
+					(int) enumerator_config->UlSearchStages();
+			}
+
+			if (GPOS_FTRACE(EopttraceProfileOptimization) &&
+				NULL != optimizer_config->GetProfile())
+			{
+				AddToSessionProfile(optimizer_config->GetProfile());
 			}
 
 			CStatisticsConfig *stats_conf = optimizer_config->GetStatsConf();
@@ -807,6 +836,60 @@ COptTasks::GPOPTOptimizedPlan(Query *query, SOptContext *gpopt_context)
 	return gpopt_context->m_plan_stmt;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::AddToSessionProfile
+//
+//	@doc:
+//		Add the profile of an optimization to the profile of the session
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::AddToSessionProfile(const COptimizationProfile *profile)
+{
+	if (NULL == session_profile)
+	{
+		session_profile_mp =
+			CMemoryPoolManager::GetMemoryPoolMgr()->CreateMemoryPool();
+		session_profile =
+			GPOS_NEW(session_profile_mp) COptimizationProfile(session_profile_mp);
+	}
+
+	session_profile->Merge(profile);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::GetSessionProfile
+//
+//	@doc:
+//		Profile of the queries optimized in this session, NULL if none was
+//		profiled
+//
+//---------------------------------------------------------------------------
+const COptimizationProfile *
+COptTasks::GetSessionProfile()
+{
+	return session_profile;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::ResetSessionProfile
+//
+//	@doc:
+//		Discard the profile of the session
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::ResetSessionProfile()
+{
+	if (NULL != session_profile)
+	{
+		session_profile->Reset();
+	}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::SetXform
@@ -18,12 +18,17 @@
 extern "C" {
 #include "postgres.h"
 #include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
 #include "lib/stringinfo.h"
 #include "utils/builtins.h"
+#include "utils/tuplestore.h"
 }
 
 #include "gpopt/utils/funcs.h"
 #include "gpopt/utils/COptTasks.h"
+#include "gpopt/engine/COptimizationProfile.h"
+#include "gpopt/xforms/CXformFactory.h"
 
 #include "gpos/_api.h"
 #include "gpopt/gpdbwrappers.h"
@@ -95,6 +100,169 @@ Datum EnableXform(PG_FUNCTION_ARGS)
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		OptimizerProfile
+//
+//	@doc:
+//		Returns the profile of the queries optimized in this session while
+//		optimizer_profile was on: a row per search stage with the memo
+//		growth, a row per stage and job type, a row per stage and xform
+//		that was applied, and a row per stage and event counter that is
+//		not zero
+//
+//---------------------------------------------------------------------------
+
+#define OPTIMIZER_PROFILE_COLS 10
+
+extern "C" {
+Datum OptimizerProfile(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc tupdesc;
+
+	// check to see if caller supports us returning a tuplestore
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot "
+						"accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						errmsg("materialize mode required, but it is not "
+							   "allowed in this context")));
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	MemoryContext oldcontext =
+		MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+	Tuplestorestate *tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+	MemoryContextSwitchTo(oldcontext);
+
+	const COptimizationProfile *profile = COptTasks::GetSessionProfile();
+	const ULONG num_stages = (NULL == profile) ? 0 : profile->UlStages();
+	for (ULONG stage = 0; stage < num_stages; stage++)
+	{
+		const COptimizationProfile::SStageStats *stage_stats =
+			profile->PstageStats(stage);
+		Datum values[OPTIMIZER_PROFILE_COLS];
+		bool nulls[OPTIMIZER_PROFILE_COLS];
+
+		if (0 < stage_stats->m_ullRuns)
+		{
+			MemSet(nulls, true, sizeof(nulls));
+			values[0] = Int32GetDatum(stage);
+			nulls[0] = false;
+			values[1] = CStringGetTextDatum("stage");
+			nulls[1] = false;
+			values[3] = Int64GetDatum(stage_stats->m_ullRuns);
+			nulls[3] = false;
+			values[4] = Float8GetDatum(stage_stats->m_ullTime / 1000.0);
+			nulls[4] = false;
+			values[8] = Int64GetDatum(stage_stats->m_ullGroups);
+			nulls[8] = false;
+			values[9] = Int64GetDatum(stage_stats->m_ullGroupExprs);
+			nulls[9] = false;
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+
+		for (ULONG ul = 0; ul < CJob::EjtSentinel; ul++)
+		{
+			const COptimizationProfile::SJobStats *job_stats =
+				&stage_stats->m_rgjob[ul];
+			if (0 == job_stats->m_ullExecutions)
+			{
+				continue;
+			}
+
+			MemSet(nulls, true, sizeof(nulls));
+			values[0] = Int32GetDatum(stage);
+			nulls[0] = false;
+			values[1] = CStringGetTextDatum("job");
+			nulls[1] = false;
+			values[2] = CStringGetTextDatum(
+				COptimizationProfile::SzJobType((CJob::EJobType) ul));
+			nulls[2] = false;
+			values[3] = Int64GetDatum(job_stats->m_ullExecutions);
+			nulls[3] = false;
+			values[4] = Float8GetDatum(job_stats->m_ullTime / 1000.0);
+			nulls[4] = false;
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+
+		for (ULONG ul = 0; ul < CXform::ExfSentinel; ul++)
+		{
+			const COptimizationProfile::SXformStats *xform_stats =
+				&stage_stats->m_rgxform[ul];
+			if (0 == xform_stats->m_ullCalls)
+			{
+				continue;
+			}
+
+			CXform *xform =
+				CXformFactory::Pxff()->Pxf((CXform::EXformId) ul);
+			MemSet(nulls, false, sizeof(nulls));
+			values[0] = Int32GetDatum(stage);
+			values[1] = CStringGetTextDatum("xform");
+			values[2] = CStringGetTextDatum(xform->SzId());
+			values[3] = Int64GetDatum(xform_stats->m_ullCalls);
+			values[4] = Float8GetDatum(xform_stats->m_ullTime / 1000.0);
+			values[5] = Int64GetDatum(xform_stats->m_ullBindings);
+			values[6] = Int64GetDatum(xform_stats->m_ullAlternatives);
+			values[7] = Int64GetDatum(xform_stats->m_ullPruned);
+			nulls[8] = true;
+			nulls[9] = true;
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+
+		for (ULONG ul = 0; ul < COptimizationProfile::EcntSentinel; ul++)
+		{
+			if (0 == stage_stats->m_rgullCounters[ul])
+			{
+				continue;
+			}
+
+			MemSet(nulls, true, sizeof(nulls));
+			values[0] = Int32GetDatum(stage);
+			nulls[0] = false;
+			values[1] = CStringGetTextDatum("counter");
+			nulls[1] = false;
+			values[2] = CStringGetTextDatum(COptimizationProfile::SzCounter(
+				(COptimizationProfile::ECounter) ul));
+			nulls[2] = false;
+			values[3] = Int64GetDatum(stage_stats->m_rgullCounters[ul]);
+			nulls[3] = false;
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+	}
+
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		ResetOptimizerProfile
+//
+//	@doc:
+//		Discards the profile of the queries optimized in this session
+//
+//---------------------------------------------------------------------------
+extern "C" {
+Datum ResetOptimizerProfile(PG_FUNCTION_ARGS)
+{
+	COptTasks::ResetSessionProfile();
+
+	PG_RETURN_VOID();
+}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		LibraryVersion
@@ -0,0 +1,159 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CJoinStatsCache.h
+//
+//	@doc:
+//		Cache of statistics derived for inner joins of memo groups
+//---------------------------------------------------------------------------
+#ifndef GPOPT_CJoinStatsCache_H
+#define GPOPT_CJoinStatsCache_H
+
+#include "gpos/base.h"
+#include "gpos/common/CBitSet.h"
+#include "gpos/common/CHashMap.h"
+#include "gpos/common/CRefCount.h"
+
+#include "gpopt/operators/CExpression.h"
+#include "naucrates/statistics/IStatistics.h"
+
+namespace gpopt
+{
+using namespace gpos;
+using namespace gpnaucrates;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CJoinStatsCache
+//
+//	@doc:
+//		Join order xforms build many expression trees that join the same
+//		atoms with the same predicates, only in a different order or from a
+//		different enumerator. The statistics of such trees are keyed here by
+//		the set of memo groups of the joined atoms plus the set of applied
+//		conjuncts, so that the histograms derived for one tree are reused
+//		for all the others instead of being recomputed.
+//
+//		Only trees of inner joins whose leaves are bound to memo groups are
+//		cached. The stats of a memo group may be reset and derived again,
+//		e.g. after a join order xform added new alternatives to it, so the
+//		key also carries the stats versions of the atoms' groups; entries
+//		made before a reset are never found again. A single instance lives
+//		in COptCtxt for the whole optimization and is emptied whenever the
+//		memo stats are reset as a whole.
+//
+//---------------------------------------------------------------------------
+class CJoinStatsCache
+{
+public:
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CJoinStatsCache::CKey
+	//
+	//	@doc:
+	//		Canonical description of an inner join tree: the memo groups of
+	//		its atoms and its conjuncts, independent of the tree shape
+	//
+	//---------------------------------------------------------------------------
+	class CKey : public CRefCount
+	{
+	private:
+		// memo group ids of the joined atoms
+		CBitSet *m_atoms;
+
+		// sum of the stats versions of the atoms' groups; as versions only
+		// grow, the sum changes whenever the stats of any atom are reset
+		ULONG m_stats_version;
+
+		// distinct conjuncts of all join predicates
+		CExpressionArray *m_conjuncts;
+
+		// were the stats computed using the histogram buckets to find the
+		// join scale factor, see CJoinStatsProcessor
+		BOOL m_scale_factor_from_buckets;
+
+		// precomputed hash value
+		ULONG m_hash;
+
+		// private copy ctor
+		CKey(const CKey &);
+
+	public:
+		// ctor
+		CKey(CBitSet *atoms, ULONG stats_version, CExpressionArray *conjuncts,
+			 BOOL scale_factor_from_buckets);
+
+		// dtor
+		virtual ~CKey();
+
+		// hash function
+		static ULONG
+		HashValue(const CKey *key)
+		{
+			return key->m_hash;
+		}
+
+		// equality function
+		static BOOL Equals(const CKey *key, const CKey *other_key);
+
+	};	// class CKey
+
+private:
+	// hash map from join keys to derived stats
+	typedef CHashMap<CKey, IStatistics, CKey::HashValue, CKey::Equals,
+					 CleanupRelease<CKey>, CleanupRelease<IStatistics> >
+		KeyToStatsMap;
+
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// cached stats
+	KeyToStatsMap *m_stats_map;
+
+	// number of lookups that found cached stats
+	ULONG m_ulHits;
+
+	// private copy ctor
+	CJoinStatsCache(const CJoinStatsCache &);
+
+	// collect the atoms and conjuncts of an inner join tree, return false
+	// if the tree contains anything else
+	static BOOL FCollect(CMemoryPool *mp, CExpression *pexpr, CBitSet *atoms,
+						 ULONG *stats_version, CExpressionArray *conjuncts);
+
+public:
+	// ctor
+	explicit CJoinStatsCache(CMemoryPool *mp);
+
+	// dtor
+	~CJoinStatsCache();
+
+	// compute the key of a join expression, returns NULL if the stats of
+	// the expression cannot be cached
+	CKey *PkeyCreate(CExpression *pexpr) const;
+
+	// cached stats for the given key, NULL if none
+	IStatistics *PstatsLookup(const CKey *key);
+
+	// cache derived stats, takes ownership of the key
+	void Insert(CKey *key, IStatistics *stats);
+
+	// drop all cached stats
+	void Reset();
+
+	// number of lookups that found cached stats, not cleared by Reset
+	ULONG
+	UlHits() const
+	{
+		return m_ulHits;
+	}
+
+};	// class CJoinStatsCache
+
+}  // namespace gpopt
+
+#endif	// !GPOPT_CJoinStatsCache_H
+
+// EOF
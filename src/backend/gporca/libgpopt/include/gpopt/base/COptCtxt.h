@@ -26,6 +26,7 @@ using namespace gpos;
 
 // forward declarations
 class CColRefSet;
+class CJoinStatsCache;
 class COptimizerConfig;
 class ICostModel;
 class IConstExprEvaluator;
@@ -76,6 +77,9 @@ private:
 	// global CTE information
 	CCTEInfo *m_pcteinfo;
 
+	// join stats shared by join order xforms
+	CJoinStatsCache *m_join_stats_cache;
+
 	// system columns required in query output
 	CColRefArray *m_pdrgpcrSystemCols;
 
@@ -244,6 +248,13 @@ public:
 		return m_pcteinfo;
 	}
 
+	// join stats cache
+	CJoinStatsCache *
+	GetJoinStatsCache()
+	{
+		return m_join_stats_cache;
+	}
+
 	// return a new part index id
 	ULONG
 	UlPartIndexNextVal()
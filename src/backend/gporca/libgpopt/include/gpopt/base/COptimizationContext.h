@@ -16,6 +16,7 @@
 
 #include "gpopt/base/CReqdPropRelational.h"
 #include "gpopt/base/CReqdPropPlan.h"
+#include "gpopt/cost/CCost.h"
 #include "gpopt/search/CJobQueue.h"
 #include "naucrates/statistics/IStatistics.h"
 #include "gpos/task/CAutoTraceFlag.h"
@@ -96,6 +97,16 @@ private:
 	// is there a multi-stage Agg plan satisfying required properties
 	BOOL m_fHasMultiStageAggPlan;
 
+	// is there an upper bound on the cost of useful plans, propagated from
+	// the context requesting this one
+	BOOL m_fUpperBound;
+
+	// upper bound on the cost of useful plans
+	CCost m_costUpperBound;
+
+	// were group expressions pruned against the upper bound
+	BOOL m_fUpperBoundPruned;
+
 	// context's optimization job queue
 	CJobQueue m_jqOptimization;
 
@@ -113,7 +124,10 @@ private:
 		  m_ulSearchStageIndex(0),
 		  m_pccBest(NULL),
 		  m_estate(estUnoptimized),
-		  m_fHasMultiStageAggPlan(false){};
+		  m_fHasMultiStageAggPlan(false),
+		  m_fUpperBound(false),
+		  m_costUpperBound(0.0),
+		  m_fUpperBoundPruned(false){};
 
 	// check if Agg node should be optimized for the given context
 	static BOOL FOptimizeAgg(CMemoryPool *mp, CGroupExpression *pgexprParent,
@@ -155,7 +169,10 @@ public:
 		  m_ulSearchStageIndex(ulSearchStageIndex),
 		  m_pccBest(NULL),
 		  m_estate(estUnoptimized),
-		  m_fHasMultiStageAggPlan(false)
+		  m_fHasMultiStageAggPlan(false),
+		  m_fUpperBound(false),
+		  m_costUpperBound(0.0),
+		  m_fUpperBoundPruned(false)
 	{
 		GPOS_ASSERT(NULL != pgroup);
 		GPOS_ASSERT(NULL != prpp);
@@ -263,6 +280,56 @@ public:
 	// set best cost context
 	void SetBest(CCostContext *pcc);
 
+	// is there an upper bound on the cost of useful plans
+	BOOL
+	FUpperBound() const
+	{
+		return m_fUpperBound;
+	}
+
+	// upper bound on the cost of useful plans
+	CCost
+	CostUpperBound() const
+	{
+		GPOS_ASSERT(m_fUpperBound);
+
+		return m_costUpperBound;
+	}
+
+	// set upper bound on the cost of useful plans
+	void
+	SetUpperBound(CCost cost)
+	{
+		GPOS_ASSERT(estUnoptimized == m_estate);
+
+		m_fUpperBound = true;
+		m_costUpperBound = cost;
+	}
+
+	// remove upper bound on the cost of useful plans
+	void
+	RemoveUpperBound()
+	{
+		m_fUpperBound = false;
+		m_fUpperBoundPruned = false;
+	}
+
+	// record that a group expression was pruned against the upper bound
+	void
+	SetUpperBoundPruned()
+	{
+		GPOS_ASSERT(m_fUpperBound);
+
+		m_fUpperBoundPruned = true;
+	}
+
+	// cost above which no plan under this context is useful
+	BOOL FCostBound(CCost *pcost) const;
+
+	// check if group expressions pruned against the upper bound need to be
+	// optimized again
+	BOOL FReoptimize() const;
+
 	// comparison operator for hashtables
 	BOOL
 	operator==(const COptimizationContext &oc) const
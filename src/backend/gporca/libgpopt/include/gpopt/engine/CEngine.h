@@ -33,6 +33,7 @@ class COptimizationContext;
 class CReqdPropPlan;
 class CReqdPropRelational;
 class CEnumeratorConfig;
+class COptimizationProfile;
 
 //---------------------------------------------------------------------------
 //	@class:
@@ -57,6 +58,19 @@ private:
 	// index of current search stage
 	ULONG m_ulCurrSearchStage;
 
+	// planning time budget over all search stages, see
+	// CHint::UlPlanningTimeBudget
+	ULONG m_ulTimeBudget;
+
+	// time spent since the search started, for the planning time budget
+	CTimerUser m_timerBudget;
+
+	// has the planning time budget been spent
+	BOOL m_fTimeBudgetExhausted;
+
+	// number of search stages completed within the planning time budget
+	ULONG m_ulStagesCompleted;
+
 	// memo table
 	CMemo *m_pmemo;
 
@@ -68,17 +82,21 @@ private:
 	// set of activated xforms
 	CXformSet *m_xforms;
 
-	// number of calls to each xform
-	UlongPtrArray *m_pdrgpulpXformCalls;
+	// profile of xforms, jobs and memo growth per search stage, NULL if
+	// profiling is not enabled
+	COptimizationProfile *m_profile;
+
+	// number of xform results that were found in memo when inserted
+	ULONG_PTR m_ulpDuplicateXformResults;
 
-	// time consumed by each xform
-	UlongPtrArray *m_pdrgpulpXformTimes;
+	// number of groups and group expressions in memo when the current
+	// search stage started
+	ULONG_PTR m_ulpStageStartGroups;
 
-	// number of bindings for each xform
-	UlongPtrArray *m_pdrgpulpXformBindings;
+	ULONG m_ulStageStartGroupExprs;
 
-	// number of alternatives generated by each xform
-	UlongPtrArray *m_pdrgpulpXformResults;
+	// join stats cache hits already recorded in the profile
+	ULONG m_ulJoinStatsCacheHits;
 
 #ifdef GPOS_DEBUG
 
@@ -159,8 +177,10 @@ private:
 	BOOL
 	FSearchTerminated() const
 	{
-		// at least one stage has completed and achieved required cost
-		return (NULL != PssPrevious() && PssPrevious()->FAchievedReqdCost());
+		// planning time budget was spent by an earlier stage, or at least
+		// one stage has completed and achieved required cost
+		return m_fTimeBudgetExhausted ||
+			   (NULL != PssPrevious() && PssPrevious()->FAchievedReqdCost());
 	}
 
 	// generate random plan id
@@ -243,7 +263,8 @@ public:
 						 CXform::EXformId exfidOrigin,
 						 CGroupExpression *pgexprOrigin, BOOL fIntermediate);
 
-	// insert a set of xform results into the memo
+	// insert a set of xform results into the memo; the xform time is in
+	// microseconds
 	void InsertXformResult(CGroup *pgroupOrigin, CXformResult *pxfres,
 						   CXform::EXformId exfidOrigin,
 						   CGroupExpression *pgexprOrigin, ULONG ulXformTime,
@@ -296,6 +317,19 @@ public:
 	// execute operations after search stage completes
 	void FinalizeSearchStage();
 
+	// start the planning time budget
+	void StartTimeBudget();
+
+	// give the current search stage what is left of the planning time
+	// budget; return false if nothing is left
+	BOOL FStartStageTimeBudget();
+
+	// record whether the current search stage spent the budget
+	void EndStageTimeBudget();
+
+	// report how much of the search ran within the planning time budget
+	void ReportTimeBudget();
+
 	// main driver of optimization engine
 	void Optimize();
 
@@ -327,6 +361,24 @@ public:
 		return (*m_search_stage_array)[m_ulCurrSearchStage];
 	}
 
+	// should exploration stop since the planning time budget is spent;
+	// implementation and optimization of what was explored still complete
+	// so that the stage produces a plan
+	BOOL
+	FStopExploration() const
+	{
+		return PssCurrent()->FTimeBudgetExhausted();
+	}
+
+	// check if the given exploration xform may still be applied; once the
+	// planning time budget is spent, join order enumeration stops
+	BOOL FExplorationXformAllowed(CXform::EXformId exfid) const;
+
+	// restrict candidate exploration xforms to the ones of the current
+	// stage that are still allowed; n-ary joins keep their expansion in
+	// query order so they remain implementable
+	void RestrictExplorationXforms(CXformSet *xform_set) const;
+
 	// current search stage index accessor
 	ULONG
 	UlCurrSearchStage() const
@@ -380,7 +432,7 @@ public:
 						COptimizationContext *pocChild, EOptimizationLevel eol);
 
 	// determine if a plan, rooted by given group expression, can be safely pruned based on cost bounds
-	BOOL FSafeToPrune(CGroupExpression *pgexpr, CReqdPropPlan *prpp,
+	BOOL FSafeToPrune(CGroupExpression *pgexpr, COptimizationContext *poc,
 					  CCostContext *pccChild, ULONG child_index,
 					  CCost *pcostLowerBound);
 
@@ -406,7 +458,12 @@ public:
 	// return the first group expression in a given group
 	static CGroupExpression *PgexprFirst(CGroup *pgroup);
 
-	UlongPtrArray *GetNumberOfBindings();
+	// optimization profile, NULL if profiling is not enabled
+	COptimizationProfile *
+	Profile() const
+	{
+		return m_profile;
+	}
 
 };	// class CEngine
 
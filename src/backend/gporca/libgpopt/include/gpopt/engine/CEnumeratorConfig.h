@@ -102,6 +102,15 @@ private:
 	// size of plan space
 	ULLONG m_ullSpaceSize;
 
+	// did the search stop because the planning time budget was spent
+	BOOL m_fTimeBudgetExhausted;
+
+	// number of search stages that ran to completion
+	ULONG m_ulSearchStagesCompleted;
+
+	// number of configured search stages
+	ULONG m_ulSearchStages;
+
 	// number of required samples
 	ULLONG m_ullInputSamples;
 
@@ -173,6 +182,39 @@ public:
 		m_ullSpaceSize = ullSpaceSize;
 	}
 
+	// record how much of the search was done
+	void
+	SetSearchProgress(BOOL fTimeBudgetExhausted, ULONG ulSearchStagesCompleted,
+					  ULONG ulSearchStages)
+	{
+		GPOS_ASSERT(ulSearchStagesCompleted <= ulSearchStages);
+
+		m_fTimeBudgetExhausted = fTimeBudgetExhausted;
+		m_ulSearchStagesCompleted = ulSearchStagesCompleted;
+		m_ulSearchStages = ulSearchStages;
+	}
+
+	// did the search stop because the planning time budget was spent
+	BOOL
+	FTimeBudgetExhausted() const
+	{
+		return m_fTimeBudgetExhausted;
+	}
+
+	// number of search stages that ran to completion
+	ULONG
+	UlSearchStagesCompleted() const
+	{
+		return m_ulSearchStagesCompleted;
+	}
+
+	// number of configured search stages
+	ULONG
+	UlSearchStages() const
+	{
+		return m_ulSearchStages;
+	}
+
 	// return number of required samples
 	ULLONG
 	UllInputSamples() const
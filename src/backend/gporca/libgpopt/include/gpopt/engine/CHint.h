@@ -49,6 +49,8 @@ private:
 
 	ULONG m_ulPushGroupByBelowSetopThreshold;
 
+	ULONG m_ulPlanningTimeBudget;
+
 	// private copy ctor
 	CHint(const CHint &);
 
@@ -58,7 +60,8 @@ public:
 		  ULONG join_arity_for_associativity_commutativity,
 		  ULONG array_expansion_threshold, ULONG ulJoinOrderDPLimit,
 		  ULONG broadcast_threshold, BOOL enforce_constraint_on_dml,
-		  ULONG push_group_by_below_setop_threshold)
+		  ULONG push_group_by_below_setop_threshold,
+		  ULONG planning_time_budget)
 		: m_ulMinNumOfPartsToRequireSortOnInsert(
 			  min_num_of_parts_to_require_sort_on_insert),
 		  m_ulJoinArityForAssociativityCommutativity(
@@ -68,7 +71,8 @@ public:
 		  m_ulBroadcastThreshold(broadcast_threshold),
 		  m_fEnforceConstraintsOnDML(enforce_constraint_on_dml),
 		  m_ulPushGroupByBelowSetopThreshold(
-			  push_group_by_below_setop_threshold)
+			  push_group_by_below_setop_threshold),
+		  m_ulPlanningTimeBudget(planning_time_budget)
 	{
 	}
 
@@ -134,6 +138,15 @@ public:
 		return m_ulPushGroupByBelowSetopThreshold;
 	}
 
+	// Time in milliseconds the search may take over all search stages.
+	// Once it is spent, the search stops and the cheapest plan found so far
+	// is returned; gpos::ulong_max means no budget.
+	ULONG
+	UlPlanningTimeBudget() const
+	{
+		return m_ulPlanningTimeBudget;
+	}
+
 	// generate default hint configurations, which disables sort during insert on
 	// append only row-oriented partitioned tables by default
 	static CHint *
@@ -146,7 +159,8 @@ public:
 			JOIN_ORDER_DP_THRESHOLD,			/*ulJoinOrderDPLimit*/
 			BROADCAST_THRESHOLD,				/*broadcast_threshold*/
 			true,								/* enforce_constraint_on_dml */
-			PUSH_GROUP_BY_BELOW_SETOP_THRESHOLD /* push_group_by_below_setop_threshold */
+			PUSH_GROUP_BY_BELOW_SETOP_THRESHOLD, /* push_group_by_below_setop_threshold */
+			gpos::ulong_max						 /* planning_time_budget */
 		);
 	}
 
@@ -0,0 +1,188 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		COptimizationProfile.h
+//
+//	@doc:
+//		Per search stage accounting of optimization time and work
+//---------------------------------------------------------------------------
+#ifndef GPOPT_COptimizationProfile_H
+#define GPOPT_COptimizationProfile_H
+
+#include "gpos/base.h"
+#include "gpos/common/CDynamicPtrArray.h"
+#include "gpos/common/CRefCount.h"
+
+#include "gpopt/search/CJob.h"
+#include "gpopt/xforms/CXform.h"
+
+namespace gpopt
+{
+using namespace gpos;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		COptimizationProfile
+//
+//	@doc:
+//		Counters of where the optimizer spends its time, kept per search
+//		stage: the calls, bindings, generated and pruned alternatives and
+//		time of every xform, the executions and time of every job type, the
+//		growth of the memo, and how often some search shortcuts were taken.
+//
+//		The engine fills a profile while optimizing if the optimization
+//		statistics are printed or the profile is requested. A profile can
+//		be merged into another one, to accumulate the profiles of several
+//		queries. Times are in microseconds.
+//
+//---------------------------------------------------------------------------
+class COptimizationProfile : public CRefCount
+{
+public:
+	// events counted per search stage outside of xforms and jobs
+	enum ECounter
+	{
+		// join stats found in the join stats cache
+		EcntJoinStatsCacheHits = 0,
+
+		// group expressions pruned against the upper cost bound that a
+		// parent context propagated to their optimization context
+		EcntCostBoundPrunes,
+
+		// optimizations whose search was cut short by the planning time
+		// budget, counted in the last stage that ran
+		EcntTimeBudgetExhausted,
+
+		EcntSentinel
+	};
+
+	// counters of an xform
+	struct SXformStats
+	{
+		// number of times the xform was applied to a group expression
+		ULLONG m_ullCalls;
+
+		// number of bindings extracted from memo
+		ULLONG m_ullBindings;
+
+		// number of alternatives generated
+		ULLONG m_ullAlternatives;
+
+		// number of generated alternatives that were already in memo
+		ULLONG m_ullPruned;
+
+		// time spent
+		ULLONG m_ullTime;
+	};
+
+	// counters of a job type
+	struct SJobStats
+	{
+		// number of times a job of this type was executed, a job that is
+		// suspended and resumed is executed more than once
+		ULLONG m_ullExecutions;
+
+		// time spent
+		ULLONG m_ullTime;
+	};
+
+	// counters of a search stage
+	struct SStageStats
+	{
+		// number of times the stage ran
+		ULLONG m_ullRuns;
+
+		// time spent
+		ULLONG m_ullTime;
+
+		// number of groups and group expressions added to memo
+		ULLONG m_ullGroups;
+
+		ULLONG m_ullGroupExprs;
+
+		// xform counters, indexed by xform id
+		SXformStats m_rgxform[CXform::ExfSentinel];
+
+		// job counters, indexed by job type
+		SJobStats m_rgjob[CJob::EjtSentinel];
+
+		// event counters, indexed by counter
+		ULLONG m_rgullCounters[EcntSentinel];
+	};
+
+private:
+	// array of stage counters
+	typedef CDynamicPtrArray<SStageStats, CleanupDelete> StageStatsArray;
+
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// counters of each search stage
+	StageStatsArray *m_pdrgpstage;
+
+	// private copy ctor
+	COptimizationProfile(const COptimizationProfile &);
+
+	// counters of the given stage, adding stages as needed
+	SStageStats *Pstage(ULONG ulStage);
+
+public:
+	// ctor
+	explicit COptimizationProfile(CMemoryPool *mp);
+
+	// dtor
+	virtual ~COptimizationProfile();
+
+	// record an application of an xform
+	void AddXformCall(ULONG ulStage, CXform::EXformId exfid, ULONG ulTime,
+					  ULONG ulBindings, ULONG ulAlternatives, ULONG ulPruned);
+
+	// record an execution of a job
+	void AddJobExecution(ULONG ulStage, CJob::EJobType ejt, ULONG ulTime);
+
+	// record a completed run of a search stage, taking its time in
+	// milliseconds
+	void AddStageRun(ULONG ulStage, ULONG ulTimeMS, ULONG ulGroups,
+					 ULONG ulGroupExprs);
+
+	// record occurrences of an event
+	void AddCount(ULONG ulStage, ECounter ecnt, ULONG ulCount);
+
+	// add the counters of another profile to this one
+	void Merge(const COptimizationProfile *pop);
+
+	// zero all counters
+	void Reset();
+
+	// number of stages with counters
+	ULONG
+	UlStages() const
+	{
+		return m_pdrgpstage->Size();
+	}
+
+	// counters of the given stage
+	const SStageStats *
+	PstageStats(ULONG ulStage) const
+	{
+		return (*m_pdrgpstage)[ulStage];
+	}
+
+	// name of a job type
+	static const CHAR *SzJobType(CJob::EJobType ejt);
+
+	// name of an event counter
+	static const CHAR *SzCounter(ECounter ecnt);
+
+	// is profiling requested by the trace flags of the current task
+	static BOOL FEnabled();
+
+};	// class COptimizationProfile
+
+}  // namespace gpopt
+
+#endif	// !GPOPT_COptimizationProfile_H
+
+// EOF
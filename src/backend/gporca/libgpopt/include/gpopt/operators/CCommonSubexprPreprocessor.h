@@ -0,0 +1,157 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CCommonSubexprPreprocessor.h
+//
+//	@doc:
+//		Preprocessing routines that share identical subtrees of the inputs
+//		of a union through CTEs
+//---------------------------------------------------------------------------
+#ifndef GPOPT_CCommonSubexprPreprocessor_H
+#define GPOPT_CCommonSubexprPreprocessor_H
+
+#include "gpos/base.h"
+
+#include "gpopt/operators/CExpression.h"
+
+namespace gpopt
+{
+//---------------------------------------------------------------------------
+//	@class:
+//		CCommonSubexprPreprocessor
+//
+//	@doc:
+//		Finds subtrees of the inputs of a Union or a Union All that are
+//		identical up to the columns they define, and replaces them with
+//		consumers of a single CTE anchored above the union, e.g.
+//
+//		+--CLogicalUnionAll
+//		   |--CLogicalSelect
+//		   |  |--CLogicalInnerJoin (J1)
+//		   |  +--<pred1>
+//		   +--CLogicalSelect
+//		      |--CLogicalInnerJoin (J2, same as J1 on other columns)
+//		      +--<pred2>
+//
+//		becomes
+//
+//		+--CLogicalCTEAnchor (0)
+//		   +--CLogicalUnionAll
+//		      |--CLogicalSelect
+//		      |  |--CLogicalCTEConsumer (0)
+//		      |  +--<pred1>
+//		      +--CLogicalSelect
+//		         |--CLogicalCTEConsumer (0)
+//		         +--<pred2>
+//
+//		Only subtrees of scans, selects, projects, aggregates and joins
+//		that contain a join are shared. Inlining of the CTE stays a costed
+//		alternative, so the shared plan is picked only when it is cheaper.
+//
+//---------------------------------------------------------------------------
+class CCommonSubexprPreprocessor
+{
+private:
+	// a subtree of a union input that may be shared
+	struct SCandidate
+	{
+		// subtree, not owned
+		CExpression *m_pexpr;
+
+		// index of the union input the subtree is in
+		ULONG m_ulBranch;
+
+		// pre-order position of the subtree root among the logical
+		// nodes of the union input
+		ULONG m_ulNodeId;
+
+		// number of logical nodes in the subtree
+		ULONG m_ulNodes;
+
+		// is the subtree or an overlapping one shared already
+		BOOL m_fClaimed;
+
+		// CTE consumer replacing the subtree, if shared
+		CExpression *m_pexprConsumer;
+
+		// ctor
+		SCandidate(CExpression *pexpr, ULONG ulBranch, ULONG ulNodeId,
+				   ULONG ulNodes)
+			: m_pexpr(pexpr),
+			  m_ulBranch(ulBranch),
+			  m_ulNodeId(ulNodeId),
+			  m_ulNodes(ulNodes),
+			  m_fClaimed(false),
+			  m_pexprConsumer(NULL)
+		{
+		}
+
+		// dtor
+		~SCandidate()
+		{
+			CRefCount::SafeRelease(m_pexprConsumer);
+		}
+	};
+
+	typedef CDynamicPtrArray<SCandidate, CleanupDelete> SCandidateArray;
+
+	// private copy ctor
+	CCommonSubexprPreprocessor(const CCommonSubexprPreprocessor &);
+
+	// can the operator be part of a shared subtree
+	static BOOL FShareableOperator(COperator *pop);
+
+	// can the subtree be shared as a whole
+	static BOOL FShareableSubtree(CExpression *pexpr);
+
+	// collect the candidate subtrees of a union input
+	static BOOL FCollectCandidates(CMemoryPool *mp, CExpression *pexpr,
+								   ULONG ulBranch, ULONG *pulNodeId,
+								   SCandidateArray *pdrgpcand, ULONG *pulNodes,
+								   BOOL *pfHasJoin);
+
+	// map the columns defined by one subtree to the columns defined by
+	// the same positions of another one
+	static BOOL FMapDefinedColumns(CMemoryPool *mp, CExpression *pexprFst,
+								   CExpression *pexprSnd,
+								   UlongToColRefMap *colref_mapping);
+
+	// mapping of the columns of the first subtree to the columns of the
+	// second one if the subtrees are identical up to columns, NULL
+	// otherwise
+	static UlongToColRefMap *PhmulcrEquivalent(CMemoryPool *mp,
+											   CExpression *pexprFst,
+											   CExpression *pexprSnd);
+
+	// order candidates by size, larger first, then by position
+	static INT ICmpCandidates(const void *pvFst, const void *pvSnd);
+
+	// mark the candidates overlapping a shared one
+	static void Claim(SCandidateArray *pdrgpcand, const SCandidate *pcand);
+
+	// share the identical candidates, returning the ids of the new CTEs
+	static ULongPtrArray *PdrgpulShare(CMemoryPool *mp,
+									   SCandidateArray *pdrgpcand);
+
+	// replace the shared subtrees of a union input by their consumers
+	static CExpression *PexprReplace(CMemoryPool *mp, CExpression *pexpr,
+									 ULONG ulBranch, ULONG *pulNodeId,
+									 SCandidateArray *pdrgpcand);
+
+	// share the identical subtrees of the inputs of a union
+	static CExpression *PexprProcessSetOp(CMemoryPool *mp,
+										  CExpression *pexpr);
+
+public:
+	// main driver
+	static CExpression *PexprPreprocess(CMemoryPool *mp, CExpression *pexpr);
+
+};	// class CCommonSubexprPreprocessor
+}  // namespace gpopt
+
+
+#endif	// !GPOPT_CCommonSubexprPreprocessor_H
+
+// EOF
@@ -236,6 +236,9 @@ public:
 	// reset expression stats
 	void ResetStats();
 
+	// set stats derived elsewhere for an equivalent expression
+	void SetStats(IStatistics *stats);
+
 	// compute required plan properties of all expression nodes
 	CReqdPropPlan *PrppCompute(CMemoryPool *mp, CReqdPropPlan *prppInput);
 
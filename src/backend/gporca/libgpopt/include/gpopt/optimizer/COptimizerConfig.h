@@ -28,6 +28,7 @@ using namespace gpos;
 
 // forward decl
 class ICostModel;
+class COptimizationProfile;
 
 //---------------------------------------------------------------------------
 //	@class:
@@ -65,6 +66,9 @@ private:
 	// default window oids
 	CWindowOids *m_window_oids;
 
+	// profile of the last optimization, if it was collected
+	COptimizationProfile *m_profile;
+
 public:
 	// ctor
 	COptimizerConfig(CEnumeratorConfig *pec, CStatisticsConfig *stats_config,
@@ -117,6 +121,16 @@ public:
 		return m_hint;
 	}
 
+	// profile of the last optimization, NULL if it was not collected
+	COptimizationProfile *
+	GetProfile() const
+	{
+		return m_profile;
+	}
+
+	// set the profile of the last optimization
+	void SetProfile(COptimizationProfile *profile);
+
 	// generate default optimizer configurations
 	static COptimizerConfig *PoconfDefault(CMemoryPool *mp);
 
@@ -196,6 +196,9 @@ private:
 	// group stats
 	IStatistics *m_pstats;
 
+	// number of times group stats were reset or replaced
+	ULONG m_ulStatsVersion;
+
 	// scalar expression for stat derivation (subqueries substituted with a dummy)
 	CExpression *m_pexprScalarRep;
 
@@ -358,6 +361,13 @@ public:
 	// group stats accessor
 	IStatistics *Pstats() const;
 
+	// version of group stats, changes whenever they are reset or replaced
+	ULONG
+	UlStatsVersion() const
+	{
+		return m_ulStatsVersion;
+	}
+
 	// attempt initializing stats with the given stat object
 	BOOL FInitStats(IStatistics *stats);
 
@@ -50,6 +50,10 @@ private:
 	// cost threshold
 	CCost m_cost_threshold;
 
+	// time in milliseconds left of the planning time budget when the stage
+	// started, see CHint::UlPlanningTimeBudget
+	ULONG m_time_budget;
+
 	// best plan found at the end of search stage
 	CExpression *m_pexprBest;
 
@@ -67,13 +71,17 @@ public:
 	// dtor
 	virtual ~CSearchStage();
 
-	// restart timer if time threshold is not default indicating don't timeout
+	// restart timer if time threshold or budget is not default indicating
+	// don't timeout, or if the stage is profiled
 	// Restart() is a costly method, so avoid calling unnecessarily
+	void RestartTimer();
+
+	// set the time left of the planning time budget, call before the
+	// timer is restarted
 	void
-	RestartTimer()
+	SetTimeBudget(ULONG ulTimeBudget)
 	{
-		if (m_time_threshold != gpos::ulong_max)
-			m_timer.Restart();
+		m_time_budget = ulTimeBudget;
 	}
 
 	// is search stage timed-out?
@@ -87,6 +95,16 @@ public:
 		return m_timer.ElapsedMS() > m_time_threshold;
 	}
 
+	// has the stage used up the rest of the planning time budget? unlike a
+	// time out, this only stops exploration, see CEngine::FStopExploration
+	BOOL
+	FTimeBudgetExhausted() const
+	{
+		if (m_time_budget == gpos::ulong_max)
+			return false;
+		return m_timer.ElapsedMS() >= m_time_budget;
+	}
+
 	// return elapsed time (in millseconds) since timer was last restarted
 	ULONG
 	UlElapsedTime() const
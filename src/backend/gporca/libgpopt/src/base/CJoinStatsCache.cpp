@@ -0,0 +1,287 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CJoinStatsCache.cpp
+//
+//	@doc:
+//		Implementation of the cache of join statistics
+//---------------------------------------------------------------------------
+
+#include "gpopt/base/CJoinStatsCache.h"
+#include "gpopt/base/CUtils.h"
+#include "gpopt/operators/CPredicateUtils.h"
+#include "gpopt/search/CGroup.h"
+#include "gpopt/search/CGroupExpression.h"
+#include "naucrates/statistics/CJoinStatsProcessor.h"
+
+using namespace gpopt;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::CKey::CKey
+//
+//	@doc:
+//		Ctor, takes ownership of the atoms and conjuncts
+//
+//---------------------------------------------------------------------------
+CJoinStatsCache::CKey::CKey(CBitSet *atoms, ULONG stats_version,
+							CExpressionArray *conjuncts,
+							BOOL scale_factor_from_buckets)
+	: m_atoms(atoms),
+	  m_stats_version(stats_version),
+	  m_conjuncts(conjuncts),
+	  m_scale_factor_from_buckets(scale_factor_from_buckets),
+	  m_hash(0)
+{
+	GPOS_ASSERT(NULL != atoms);
+	GPOS_ASSERT(NULL != conjuncts);
+
+	// conjuncts are combined in an order insensitive way, since different
+	// join trees apply the same predicates in different orders
+	ULONG conjuncts_hash = 0;
+	const ULONG size = conjuncts->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		conjuncts_hash ^= CExpression::HashValue((*conjuncts)[ul]);
+	}
+
+	m_hash = CombineHashes(atoms->HashValue(), conjuncts_hash);
+	m_hash = CombineHashes(m_hash, gpos::HashValue<ULONG>(&m_stats_version));
+	m_hash = CombineHashes(m_hash, gpos::HashValue<BOOL>(
+									   &m_scale_factor_from_buckets));
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::CKey::~CKey
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CJoinStatsCache::CKey::~CKey()
+{
+	m_atoms->Release();
+	m_conjuncts->Release();
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::CKey::Equals
+//
+//	@doc:
+//		Equality function; conjuncts are distinct within a key, so equal
+//		sizes and containment mean the two sets of conjuncts are equal
+//
+//---------------------------------------------------------------------------
+BOOL
+CJoinStatsCache::CKey::Equals(const CKey *key, const CKey *other_key)
+{
+	if (key == other_key)
+	{
+		return true;
+	}
+
+	return key->m_hash == other_key->m_hash &&
+		   key->m_stats_version == other_key->m_stats_version &&
+		   key->m_scale_factor_from_buckets ==
+			   other_key->m_scale_factor_from_buckets &&
+		   key->m_conjuncts->Size() == other_key->m_conjuncts->Size() &&
+		   key->m_atoms->Equals(other_key->m_atoms) &&
+		   CUtils::Contains(key->m_conjuncts, other_key->m_conjuncts);
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::CJoinStatsCache
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+CJoinStatsCache::CJoinStatsCache(CMemoryPool *mp)
+	: m_mp(mp), m_stats_map(NULL), m_ulHits(0)
+{
+	GPOS_ASSERT(NULL != mp);
+
+	m_stats_map = GPOS_NEW(m_mp) KeyToStatsMap(m_mp);
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::~CJoinStatsCache
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CJoinStatsCache::~CJoinStatsCache()
+{
+	m_stats_map->Release();
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::FCollect
+//
+//	@doc:
+//		Collect the memo groups of the atoms, the sum of their stats
+//		versions and the distinct conjuncts of an inner join tree; return
+//		false if the tree contains anything but inner joins over expressions
+//		bound to memo groups
+//
+//---------------------------------------------------------------------------
+BOOL
+CJoinStatsCache::FCollect(CMemoryPool *mp, CExpression *pexpr, CBitSet *atoms,
+						  ULONG *stats_version, CExpressionArray *conjuncts)
+{
+	GPOS_CHECK_STACK_SIZE;
+
+	if (NULL != pexpr->Pgexpr())
+	{
+		// an atom, its stats are the stats of its group
+		CGroup *pgroup = pexpr->Pgexpr()->Pgroup();
+		if (!atoms->ExchangeSet(pgroup->Id()))
+		{
+			*stats_version += pgroup->UlStatsVersion();
+		}
+
+		return true;
+	}
+
+	if (COperator::EopLogicalInnerJoin != pexpr->Pop()->Eopid())
+	{
+		return false;
+	}
+
+	if (!FCollect(mp, (*pexpr)[0], atoms, stats_version, conjuncts) ||
+		!FCollect(mp, (*pexpr)[1], atoms, stats_version, conjuncts))
+	{
+		return false;
+	}
+
+	CExpressionArray *pdrgpexpr =
+		CPredicateUtils::PdrgpexprConjuncts(mp, (*pexpr)[2]);
+	const ULONG size = pdrgpexpr->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		CExpression *pexprConj = (*pdrgpexpr)[ul];
+		if (!CUtils::FScalarConstTrue(pexprConj) &&
+			!CUtils::FEqualAny(pexprConj, conjuncts))
+		{
+			pexprConj->AddRef();
+			conjuncts->Append(pexprConj);
+		}
+	}
+	pdrgpexpr->Release();
+
+	return true;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::PkeyCreate
+//
+//	@doc:
+//		Compute the key of a join expression
+//
+//---------------------------------------------------------------------------
+CJoinStatsCache::CKey *
+CJoinStatsCache::PkeyCreate(CExpression *pexpr) const
+{
+	GPOS_ASSERT(NULL != pexpr);
+
+	if (COperator::EopLogicalInnerJoin != pexpr->Pop()->Eopid() ||
+		NULL != pexpr->Pgexpr())
+	{
+		return NULL;
+	}
+
+	CBitSet *atoms = GPOS_NEW(m_mp) CBitSet(m_mp);
+	ULONG stats_version = 0;
+	CExpressionArray *conjuncts = GPOS_NEW(m_mp) CExpressionArray(m_mp);
+	if (!FCollect(m_mp, pexpr, atoms, &stats_version, conjuncts))
+	{
+		atoms->Release();
+		conjuncts->Release();
+
+		return NULL;
+	}
+
+	return GPOS_NEW(m_mp)
+		CKey(atoms, stats_version, conjuncts,
+			 CJoinStatsProcessor::ComputeScaleFactorFromHistogramBuckets());
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::PstatsLookup
+//
+//	@doc:
+//		Cached stats for the given key, NULL if none
+//
+//---------------------------------------------------------------------------
+IStatistics *
+CJoinStatsCache::PstatsLookup(const CKey *key)
+{
+	GPOS_ASSERT(NULL != key);
+
+	IStatistics *stats = m_stats_map->Find(key);
+	if (NULL != stats)
+	{
+		m_ulHits++;
+	}
+
+	return stats;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::Insert
+//
+//	@doc:
+//		Cache derived stats, takes ownership of the key
+//
+//---------------------------------------------------------------------------
+void
+CJoinStatsCache::Insert(CKey *key, IStatistics *stats)
+{
+	GPOS_ASSERT(NULL != key);
+	GPOS_ASSERT(NULL != stats);
+
+	stats->AddRef();
+	if (!m_stats_map->Insert(key, stats))
+	{
+		// already cached by a derivation that did not look up the cache
+		key->Release();
+		stats->Release();
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CJoinStatsCache::Reset
+//
+//	@doc:
+//		Drop all cached stats
+//
+//---------------------------------------------------------------------------
+void
+CJoinStatsCache::Reset()
+{
+	m_stats_map->Release();
+	m_stats_map = GPOS_NEW(m_mp) KeyToStatsMap(m_mp);
+}
+
+// EOF
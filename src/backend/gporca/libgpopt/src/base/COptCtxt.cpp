@@ -15,6 +15,7 @@
 #include "naucrates/traceflags/traceflags.h"
 #include "gpopt/base/CColRefSet.h"
 #include "gpopt/base/CDefaultComparator.h"
+#include "gpopt/base/CJoinStatsCache.h"
 #include "gpopt/base/COptCtxt.h"
 #include "gpopt/cost/ICostModel.h"
 #include "gpopt/eval/IConstExprEvaluator.h"
@@ -44,6 +45,7 @@ COptCtxt::COptCtxt(CMemoryPool *mp, CColumnFactory *col_factory,
 	  m_pcomp(GPOS_NEW(m_mp) CDefaultComparator(pceeval)),
 	  m_auPartId(m_ulFirstValidPartId),
 	  m_pcteinfo(NULL),
+	  m_join_stats_cache(NULL),
 	  m_pdrgpcrSystemCols(NULL),
 	  m_optimizer_config(optimizer_config),
 	  m_fDMLQuery(false),
@@ -60,6 +62,7 @@ COptCtxt::COptCtxt(CMemoryPool *mp, CColumnFactory *col_factory,
 	GPOS_ASSERT(NULL != optimizer_config->GetCostModel());
 
 	m_pcteinfo = GPOS_NEW(m_mp) CCTEInfo(m_mp);
+	m_join_stats_cache = GPOS_NEW(m_mp) CJoinStatsCache(m_mp);
 	m_cost_model = optimizer_config->GetCostModel();
 	m_direct_dispatchable_filters = GPOS_NEW(mp) CExpressionArray(mp);
 }
@@ -80,6 +83,7 @@ COptCtxt::~COptCtxt()
 	GPOS_DELETE(m_pcomp);
 	m_pceeval->Release();
 	m_pcteinfo->Release();
+	GPOS_DELETE(m_join_stats_cache);
 	m_optimizer_config->Release();
 	CRefCount::SafeRelease(m_pdrgpcrSystemCols);
 	CRefCount::SafeRelease(m_direct_dispatchable_filters);
@@ -96,6 +96,64 @@ COptimizationContext::SetBest(CCostContext *pcc)
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationContext::FCostBound
+//
+//	@doc:
+//		Compute the cost above which no plan under this context is useful,
+//		which is the lower of the best plan found so far and the upper
+//		bound; return false if there is neither
+//
+//---------------------------------------------------------------------------
+BOOL
+COptimizationContext::FCostBound(CCost *pcost) const
+{
+	GPOS_ASSERT(NULL != pcost);
+
+	BOOL fBest = (NULL != m_pccBest && GPOPT_INVALID_COST != m_pccBest->Cost());
+	if (!fBest && !m_fUpperBound)
+	{
+		return false;
+	}
+
+	if (!fBest ||
+		(m_fUpperBound && m_costUpperBound < m_pccBest->Cost()))
+	{
+		*pcost = m_costUpperBound;
+	}
+	else
+	{
+		*pcost = m_pccBest->Cost();
+	}
+
+	return true;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationContext::FReoptimize
+//
+//	@doc:
+//		Check if group expressions pruned against the upper bound need to be
+//		optimized again; this is the case if no plan within the bound was
+//		found, since the context is shared by all requests for the same
+//		properties and a later request may be able to use a costlier plan
+//
+//---------------------------------------------------------------------------
+BOOL
+COptimizationContext::FReoptimize() const
+{
+	if (!m_fUpperBoundPruned)
+	{
+		return false;
+	}
+
+	return NULL == m_pccBest || m_pccBest->Cost() > m_costUpperBound;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptimizationContext::Matches
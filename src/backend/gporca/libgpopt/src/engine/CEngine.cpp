@@ -11,6 +11,7 @@
 #include "gpos/base.h"
 #include "gpos/error/CAutoTrace.h"
 #include "gpos/common/CAutoTimer.h"
+#include "gpos/common/CTimerUser.h"
 #include "gpos/common/syslibwrapper.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/string/CWStringDynamic.h"
@@ -27,8 +28,10 @@
 #include "gpopt/base/CReqdPropRelational.h"
 #include "gpopt/base/CQueryContext.h"
 #include "gpopt/base/COptCtxt.h"
+#include "gpopt/base/CJoinStatsCache.h"
 #include "gpopt/engine/CEngine.h"
 #include "gpopt/engine/CEnumeratorConfig.h"
+#include "gpopt/engine/COptimizationProfile.h"
 #include "gpopt/engine/CStatisticsConfig.h"
 #include "gpopt/minidump/CSerializableStackTrace.h"
 #include "gpopt/operators/CExpression.h"
@@ -79,22 +82,22 @@ CEngine::CEngine(CMemoryPool *mp)
 	  m_pqc(NULL),
 	  m_search_stage_array(NULL),
 	  m_ulCurrSearchStage(0),
+	  m_ulTimeBudget(gpos::ulong_max),
+	  m_fTimeBudgetExhausted(false),
+	  m_ulStagesCompleted(0),
 	  m_pmemo(NULL),
 	  m_pexprEnforcerPattern(NULL),
 	  m_xforms(NULL),
-	  m_pdrgpulpXformCalls(NULL),
-	  m_pdrgpulpXformTimes(NULL),
-	  m_pdrgpulpXformBindings(NULL),
-	  m_pdrgpulpXformResults(NULL)
+	  m_profile(NULL),
+	  m_ulpDuplicateXformResults(0),
+	  m_ulpStageStartGroups(0),
+	  m_ulStageStartGroupExprs(0),
+	  m_ulJoinStatsCacheHits(0)
 {
 	m_pmemo = GPOS_NEW(mp) CMemo(mp);
 	m_pexprEnforcerPattern =
 		GPOS_NEW(mp) CExpression(mp, GPOS_NEW(mp) CPatternLeaf(mp));
 	m_xforms = GPOS_NEW(mp) CXformSet(mp);
-	m_pdrgpulpXformCalls = GPOS_NEW(mp) UlongPtrArray(mp);
-	m_pdrgpulpXformTimes = GPOS_NEW(mp) UlongPtrArray(mp);
-	m_pdrgpulpXformBindings = GPOS_NEW(mp) UlongPtrArray(mp);
-	m_pdrgpulpXformResults = GPOS_NEW(mp) UlongPtrArray(mp);
 }
 
 
@@ -114,10 +117,7 @@ CEngine::~CEngine()
 	// we still have all de-llocations enabled in debug-build to detect any possible leaks
 	GPOS_DELETE(m_pmemo);
 	CRefCount::SafeRelease(m_xforms);
-	m_pdrgpulpXformCalls->Release();
-	m_pdrgpulpXformTimes->Release();
-	m_pdrgpulpXformBindings->Release();
-	m_pdrgpulpXformResults->Release();
+	CRefCount::SafeRelease(m_profile);
 	m_pexprEnforcerPattern->Release();
 	CRefCount::SafeRelease(m_search_stage_array);
 #endif	// GPOS_DEBUG
@@ -169,32 +169,9 @@ CEngine::Init(CQueryContext *pqc, CSearchStageArray *search_stage_array)
 	}
 	GPOS_ASSERT(0 < m_search_stage_array->Size());
 
-	if (GPOS_FTRACE(EopttracePrintOptimizationStatistics))
+	if (COptimizationProfile::FEnabled())
 	{
-		// initialize per-stage xform calls array
-		const ULONG ulStages = m_search_stage_array->Size();
-		for (ULONG ul = 0; ul < ulStages; ul++)
-		{
-			ULONG_PTR *pulpXformCalls =
-				GPOS_NEW_ARRAY(m_mp, ULONG_PTR, CXform::ExfSentinel);
-			ULONG_PTR *pulpXformTimes =
-				GPOS_NEW_ARRAY(m_mp, ULONG_PTR, CXform::ExfSentinel);
-			ULONG_PTR *pulpXformBindings =
-				GPOS_NEW_ARRAY(m_mp, ULONG_PTR, CXform::ExfSentinel);
-			ULONG_PTR *pulpXformResults =
-				GPOS_NEW_ARRAY(m_mp, ULONG_PTR, CXform::ExfSentinel);
-			for (ULONG ulXform = 0; ulXform < CXform::ExfSentinel; ulXform++)
-			{
-				pulpXformCalls[ulXform] = 0;
-				pulpXformTimes[ulXform] = 0;
-				pulpXformBindings[ulXform] = 0;
-				pulpXformResults[ulXform] = 0;
-			}
-			m_pdrgpulpXformCalls->Append(pulpXformCalls);
-			m_pdrgpulpXformTimes->Append(pulpXformTimes);
-			m_pdrgpulpXformBindings->Append(pulpXformBindings);
-			m_pdrgpulpXformResults->Append(pulpXformResults);
-		}
+		m_profile = GPOS_NEW(m_mp) COptimizationProfile(m_mp);
 	}
 
 	m_pqc = pqc;
@@ -337,6 +314,11 @@ CEngine::PgroupInsert(CGroup *pgroupTarget, CExpression *pexpr,
 	{
 		// insertion failed, release created group expression
 		pgexpr->Release();
+
+		if (!fIntermediate)
+		{
+			m_ulpDuplicateXformResults++;
+		}
 	}
 
 	return pgroupContainer;
@@ -355,7 +337,7 @@ void
 CEngine::InsertXformResult(
 	CGroup *pgroupOrigin, CXformResult *pxfres, CXform::EXformId exfidOrigin,
 	CGroupExpression *pgexprOrigin,
-	ULONG ulXformTime,	// time consumed by transformation in msec
+	ULONG ulXformTime,	// time consumed by transformation in usec
 	ULONG ulNumberOfBindings)
 {
 	GPOS_ASSERT(NULL != pxfres);
@@ -363,19 +345,14 @@ CEngine::InsertXformResult(
 	GPOS_ASSERT(CXform::ExfInvalid != exfidOrigin);
 	GPOS_ASSERT(NULL != pgexprOrigin);
 
-	if (GPOS_FTRACE(EopttracePrintOptimizationStatistics) &&
-		0 < pxfres->Pdrgpexpr()->Size())
+	const ULONG ulResults = pxfres->Pdrgpexpr()->Size();
+	if (GPOS_FTRACE(EopttracePrintOptimizationStatistics) && 0 < ulResults)
 	{
 		(void) m_xforms->ExchangeSet(exfidOrigin);
-		(*m_pdrgpulpXformCalls)[m_ulCurrSearchStage][exfidOrigin] += 1;
-		(*m_pdrgpulpXformTimes)[m_ulCurrSearchStage][exfidOrigin] +=
-			ulXformTime;
-		(*m_pdrgpulpXformBindings)[m_ulCurrSearchStage][exfidOrigin] +=
-			ulNumberOfBindings;
-		(*m_pdrgpulpXformResults)[m_ulCurrSearchStage][exfidOrigin] +=
-			pxfres->Pdrgpexpr()->Size();
 	}
 
+	const ULONG_PTR ulpDuplicatesBefore = m_ulpDuplicateXformResults;
+
 	CExpression *pexpr = pxfres->PexprNext();
 	while (NULL != pexpr)
 	{
@@ -390,6 +367,16 @@ CEngine::InsertXformResult(
 
 		pexpr = pxfres->PexprNext();
 	}
+
+	if (NULL != m_profile)
+	{
+		// applications that produced nothing are recorded as well, their
+		// time is part of the cost of the xform
+		m_profile->AddXformCall(
+			m_ulCurrSearchStage, exfidOrigin, ulXformTime, ulNumberOfBindings,
+			ulResults,
+			(ULONG)(m_ulpDuplicateXformResults - ulpDuplicatesBefore));
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -621,11 +608,12 @@ CEngine::FSafeToPruneWithDPEStats(CGroupExpression *pgexpr,
 //---------------------------------------------------------------------------
 BOOL
 CEngine::FSafeToPrune(
-	CGroupExpression *pgexpr, CReqdPropPlan *prpp, CCostContext *pccChild,
-	ULONG child_index,
+	CGroupExpression *pgexpr, COptimizationContext *poc,
+	CCostContext *pccChild, ULONG child_index,
 	CCost *pcostLowerBound	// output: a lower bound on plan's cost
 )
 {
+	GPOS_ASSERT(NULL != poc);
 	GPOS_ASSERT(NULL != pcostLowerBound);
 	*pcostLowerBound = GPOPT_INVALID_COST;
 
@@ -635,6 +623,7 @@ CEngine::FSafeToPrune(
 		return false;
 	}
 
+	CReqdPropPlan *prpp = poc->Prpp();
 	if (GPOS_FTRACE(EopttraceDeriveStatsForDPE) &&
 		!FSafeToPruneWithDPEStats(pgexpr, prpp, pccChild, child_index))
 	{
@@ -660,6 +649,30 @@ CEngine::FSafeToPrune(
 		}
 	}
 
+	if (GPOS_FTRACE(EopttraceEnableCostBoundPropagation) &&
+		poc->FUpperBound())
+	{
+		// the contexts requesting this one cannot use a plan costing more
+		// than the upper bound, even if the group has no plan yet
+		CCost costLowerBound =
+			pgexpr->CostLowerBound(m_mp, prpp, pccChild, child_index);
+		*pcostLowerBound = costLowerBound;
+		if (costLowerBound > poc->CostUpperBound())
+		{
+			// remember the pruning, the group expression has to be optimized
+			// again if the context finds no plan within the bound
+			poc->SetUpperBoundPruned();
+			if (NULL != m_profile)
+			{
+				m_profile->AddCount(m_ulCurrSearchStage,
+									COptimizationProfile::EcntCostBoundPrunes,
+									1);
+			}
+
+			return true;
+		}
+	}
+
 	return false;
 }
 
@@ -701,6 +714,81 @@ CEngine::Pmemotmap()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CEngine::FExplorationXformAllowed
+//
+//	@doc:
+//		Check if the given exploration xform may still be applied; once the
+//		planning time budget is spent, the xforms enumerating join orders
+//		are skipped
+//
+//---------------------------------------------------------------------------
+BOOL
+CEngine::FExplorationXformAllowed(CXform::EXformId exfid) const
+{
+	if (!FStopExploration())
+	{
+		return true;
+	}
+
+	switch (exfid)
+	{
+		case CXform::ExfExpandNAryJoinDP:
+		case CXform::ExfExpandNAryJoinDPv2:
+		case CXform::ExfExpandNAryJoinMinCard:
+		case CXform::ExfExpandNAryJoinGreedy:
+		case CXform::ExfJoinAssociativity:
+		case CXform::ExfJoinCommutativity:
+			return false;
+
+		default:
+			return true;
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CEngine::RestrictExplorationXforms
+//
+//	@doc:
+//		Restrict candidate exploration xforms to the ones of the current
+//		stage that are still allowed; once the planning time budget is
+//		spent, n-ary joins are expanded in query order even if the stage
+//		disables it, since otherwise they cannot be implemented
+//
+//---------------------------------------------------------------------------
+void
+CEngine::RestrictExplorationXforms(CXformSet *xform_set) const
+{
+	const BOOL fNAryJoin = xform_set->Get(CXform::ExfExpandNAryJoin);
+	xform_set->Intersection(PxfsCurrentStage());
+
+	if (!FStopExploration())
+	{
+		return;
+	}
+
+	CXformSetIter xsi(*xform_set);
+	CXformSet *pxfsDisallowed = GPOS_NEW(m_mp) CXformSet(m_mp);
+	while (xsi.Advance())
+	{
+		if (!FExplorationXformAllowed(xsi.TBit()))
+		{
+			(void) pxfsDisallowed->ExchangeSet(xsi.TBit());
+		}
+	}
+	xform_set->Difference(pxfsDisallowed);
+	pxfsDisallowed->Release();
+
+	if (fNAryJoin)
+	{
+		(void) xform_set->ExchangeSet(CXform::ExfExpandNAryJoin);
+	}
+}
+
+
 #ifdef GPOS_DEBUG
 
 //---------------------------------------------------------------------------
@@ -722,6 +810,10 @@ CEngine::ApplyTransformations(CMemoryPool *pmpLocal, CXformSet *xform_set,
 	{
 		GPOS_CHECK_ABORT;
 		CXform *pxform = CXformFactory::Pxff()->Pxf(xsi.TBit());
+		if (pxform->FExploration() && !FExplorationXformAllowed(xsi.TBit()))
+		{
+			continue;
+		}
 
 		// transform group expression, and insert results to memo
 		CXformResult *pxfres = GPOS_NEW(m_mp) CXformResult(m_mp);
@@ -794,7 +886,14 @@ CEngine::TransitionGroupExpression(CMemoryPool *pmpLocal,
 
 	// intersect them with the required set of xforms, then apply transformations
 	pxfsCandidates->Intersection(xform_set);
-	pxfsCandidates->Intersection(PxfsCurrentStage());
+	if (CGroupExpression::estExplored == estTarget)
+	{
+		RestrictExplorationXforms(pxfsCandidates);
+	}
+	else
+	{
+		pxfsCandidates->Intersection(PxfsCurrentStage());
+	}
 	ApplyTransformations(pmpLocal, pxfsCandidates, pgexpr);
 	pxfsCandidates->Release();
 
@@ -999,7 +1098,7 @@ CEngine::PccOptimizeChild(
 	// check if optimization can be early terminated after first child has been optimized
 	CCost costLowerBound(GPOPT_INVALID_COST);
 	if (exprhdl.UlFirstOptimizedChildIndex() == child_index &&
-		FSafeToPrune(pgexpr, pocOrigin->Prpp(), pccChildBest, child_index,
+		FSafeToPrune(pgexpr, pocOrigin, pccChildBest, child_index,
 					 &costLowerBound))
 	{
 		// failed to optimize child due to cost bounding
@@ -1128,7 +1227,7 @@ CEngine::OptimizeGroupExpression(CGroupExpression *pgexpr,
 
 		// check if group expression optimization can be early terminated without optimizing any child
 		CCost costLowerBound(GPOPT_INVALID_COST);
-		if (FSafeToPrune(pgexpr, poc->Prpp(), NULL /*pccChild*/,
+		if (FSafeToPrune(pgexpr, poc, NULL /*pccChild*/,
 						 gpos::ulong_max /*child_index*/, &costLowerBound))
 		{
 			(void) pgexpr->PccComputeCost(m_mp, poc, ul, NULL /*pdrgpoc*/,
@@ -1293,9 +1392,16 @@ CEngine::RecursiveOptimize()
 	CAutoTimer at("\n[OPT]: Total Optimization Time",
 				  GPOS_FTRACE(EopttracePrintOptimizationStatistics));
 
+	StartTimeBudget();
+
 	const ULONG ulSearchStages = m_search_stage_array->Size();
 	for (ULONG ul = 0; !FSearchTerminated() && ul < ulSearchStages; ul++)
 	{
+		if (!FStartStageTimeBudget())
+		{
+			break;
+		}
+
 		PssCurrent()->RestartTimer();
 
 		// apply exploration xforms
@@ -1328,9 +1434,13 @@ CEngine::RecursiveOptimize()
 			m_search_stage_array->Size());
 		PssCurrent()->SetBestExpr(pexprPlan);
 
+		EndStageTimeBudget();
+
 		FinalizeSearchStage();
 	}
 
+	ReportTimeBudget();
+
 	{
 		CAutoTrace atSearch(m_mp);
 		atSearch.Os() << "[OPT]: Search terminated at stage "
@@ -1529,6 +1639,23 @@ CEngine::FinalizeImplementation()
 void
 CEngine::FinalizeSearchStage()
 {
+	if (NULL != m_profile)
+	{
+		m_profile->AddStageRun(
+			m_ulCurrSearchStage, PssCurrent()->UlElapsedTime(),
+			(ULONG)(m_pmemo->UlpGroups() - m_ulpStageStartGroups),
+			m_pmemo->UlGrpExprs() - m_ulStageStartGroupExprs);
+
+		// the cache lives in the optimization context, count its hits
+		// since the previous stage, including those of preprocessing
+		ULONG ulHits =
+			COptCtxt::PoctxtFromTLS()->GetJoinStatsCache()->UlHits();
+		m_profile->AddCount(m_ulCurrSearchStage,
+							COptimizationProfile::EcntJoinStatsCacheHits,
+							ulHits - m_ulJoinStatsCacheHits);
+		m_ulJoinStatsCacheHits = ulHits;
+	}
+
 	ProcessTraceFlags();
 
 	m_xforms->Release();
@@ -1556,21 +1683,20 @@ CEngine::PrintActivatedXforms(IOstream &os) const
 		os << std::endl
 		   << "[OPT]: <Begin Xforms - stage " << m_ulCurrSearchStage << ">"
 		   << std::endl;
+		const COptimizationProfile::SStageStats *pstage =
+			m_profile->PstageStats(m_ulCurrSearchStage);
 		CXformSetIter xsi(*m_xforms);
 		while (xsi.Advance())
 		{
 			CXform *pxform = CXformFactory::Pxff()->Pxf(xsi.TBit());
-			ULONG ulCalls = (ULONG)(
-				*m_pdrgpulpXformCalls)[m_ulCurrSearchStage][pxform->Exfid()];
-			ULONG ulTime = (ULONG)(
-				*m_pdrgpulpXformTimes)[m_ulCurrSearchStage][pxform->Exfid()];
-			ULONG ulBindings = (ULONG)(
-				*m_pdrgpulpXformBindings)[m_ulCurrSearchStage][pxform->Exfid()];
-			ULONG ulResults = (ULONG)(
-				*m_pdrgpulpXformResults)[m_ulCurrSearchStage][pxform->Exfid()];
-			os << pxform->SzId() << ": " << ulCalls << " calls, " << ulBindings
-			   << " total bindings, " << ulResults
-			   << " alternatives generated, " << ulTime << "ms" << std::endl;
+			const COptimizationProfile::SXformStats *pxformstats =
+				&pstage->m_rgxform[pxform->Exfid()];
+			os << pxform->SzId() << ": " << pxformstats->m_ullCalls
+			   << " calls, " << pxformstats->m_ullBindings
+			   << " total bindings, " << pxformstats->m_ullAlternatives
+			   << " alternatives generated, " << pxformstats->m_ullPruned
+			   << " already in memo, " << pxformstats->m_ullTime / 1000 << "ms"
+			   << std::endl;
 		}
 		os << "[OPT]: <End Xforms - stage " << m_ulCurrSearchStage << ">"
 		   << std::endl;
@@ -1666,6 +1792,126 @@ CEngine::ProcessTraceFlags()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CEngine::StartTimeBudget
+//
+//	@doc:
+//		Start the planning time budget; it spans all search stages
+//
+//---------------------------------------------------------------------------
+void
+CEngine::StartTimeBudget()
+{
+	m_ulTimeBudget = COptCtxt::PoctxtFromTLS()
+						 ->GetOptimizerConfig()
+						 ->GetHint()
+						 ->UlPlanningTimeBudget();
+	m_fTimeBudgetExhausted = false;
+	m_ulStagesCompleted = 0;
+
+	if (gpos::ulong_max != m_ulTimeBudget)
+	{
+		m_timerBudget.Restart();
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CEngine::FStartStageTimeBudget
+//
+//	@doc:
+//		Give the current search stage what is left of the planning time
+//		budget; the first stage always runs, so that a plan is produced
+//		even if the budget is spent before the search starts
+//
+//---------------------------------------------------------------------------
+BOOL
+CEngine::FStartStageTimeBudget()
+{
+	if (gpos::ulong_max == m_ulTimeBudget)
+	{
+		return true;
+	}
+
+	ULONG ulElapsed = m_timerBudget.ElapsedMS();
+	if (ulElapsed >= m_ulTimeBudget)
+	{
+		if (0 < m_ulCurrSearchStage)
+		{
+			m_fTimeBudgetExhausted = true;
+			return false;
+		}
+		ulElapsed = m_ulTimeBudget;
+	}
+
+	PssCurrent()->SetTimeBudget(m_ulTimeBudget - ulElapsed);
+
+	return true;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CEngine::EndStageTimeBudget
+//
+//	@doc:
+//		Record whether the current search stage spent the planning time
+//		budget; no later stage is started once it is spent
+//
+//---------------------------------------------------------------------------
+void
+CEngine::EndStageTimeBudget()
+{
+	if (PssCurrent()->FTimeBudgetExhausted())
+	{
+		m_fTimeBudgetExhausted = true;
+	}
+	else
+	{
+		m_ulStagesCompleted++;
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CEngine::ReportTimeBudget
+//
+//	@doc:
+//		Report how much of the search ran within the planning time budget
+//
+//---------------------------------------------------------------------------
+void
+CEngine::ReportTimeBudget()
+{
+	const ULONG ulSearchStages = m_search_stage_array->Size();
+	COptCtxt::PoctxtFromTLS()
+		->GetOptimizerConfig()
+		->GetEnumeratorCfg()
+		->SetSearchProgress(m_fTimeBudgetExhausted, m_ulStagesCompleted,
+							ulSearchStages);
+
+	if (m_fTimeBudgetExhausted && NULL != m_profile)
+	{
+		// the first stage always runs
+		GPOS_ASSERT(0 < m_ulCurrSearchStage);
+		m_profile->AddCount(m_ulCurrSearchStage - 1,
+							COptimizationProfile::EcntTimeBudgetExhausted, 1);
+	}
+
+	if (m_fTimeBudgetExhausted &&
+		GPOS_FTRACE(EopttracePrintOptimizationStatistics))
+	{
+		CAutoTrace atBudget(m_mp);
+		atBudget.Os() << "[OPT]: Planning time budget of " << m_ulTimeBudget
+					  << "ms exhausted after " << m_ulStagesCompleted << "/"
+					  << ulSearchStages << " search stages";
+	}
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CEngine::Optimize
@@ -1695,11 +1941,24 @@ CEngine::Optimize()
 	CSchedulerContext sc;
 	sc.Init(m_mp, &jf, &sched, this);
 
+	StartTimeBudget();
+
 	const ULONG ulSearchStages = m_search_stage_array->Size();
 	for (ULONG ul = 0; !FSearchTerminated() && ul < ulSearchStages; ul++)
 	{
+		if (!FStartStageTimeBudget())
+		{
+			break;
+		}
+
 		PssCurrent()->RestartTimer();
 
+		if (NULL != m_profile)
+		{
+			m_ulpStageStartGroups = m_pmemo->UlpGroups();
+			m_ulStageStartGroupExprs = m_pmemo->UlGrpExprs();
+		}
+
 		// optimize root group
 		m_pqc->Prpp()->AddRef();
 		COptimizationContext *poc = GPOS_NEW(m_mp) COptimizationContext(
@@ -1724,9 +1983,18 @@ CEngine::Optimize()
 			m_search_stage_array->Size());
 		PssCurrent()->SetBestExpr(pexprPlan);
 
+		EndStageTimeBudget();
+
 		FinalizeSearchStage();
 	}
 
+	ReportTimeBudget();
+
+	if (NULL != m_profile)
+	{
+		// hand the profile to the caller of the optimizer
+		optimizer_config->SetProfile(m_profile);
+	}
 
 	if (GPOS_FTRACE(EopttracePrintOptimizationStatistics))
 	{
@@ -2358,12 +2626,6 @@ CEngine::FCheckReqdProps(CExpressionHandle &exprhdl, CReqdPropPlan *prpp,
 	return FCheckReqdPartPropagation(popPhysical, prpp->Pepp());
 }
 
-UlongPtrArray *
-CEngine::GetNumberOfBindings()
-{
-	return m_pdrgpulpXformBindings;
-}
-
 #ifdef GPOS_DEBUG
 //---------------------------------------------------------------------------
 //	@function:
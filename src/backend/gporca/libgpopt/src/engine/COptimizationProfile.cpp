@@ -0,0 +1,299 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		COptimizationProfile.cpp
+//
+//	@doc:
+//		Implementation of per search stage accounting of optimization
+//		time and work
+//---------------------------------------------------------------------------
+
+#include "gpos/base.h"
+#include "gpos/common/clibwrapper.h"
+
+#include "gpopt/engine/COptimizationProfile.h"
+
+#include "naucrates/traceflags/traceflags.h"
+
+using namespace gpopt;
+
+// names of job types, indexed by job type
+static const CHAR *rgszJobTypes[] = {
+	"Test",
+	"GroupOptimization",
+	"GroupImplementation",
+	"GroupExploration",
+	"GroupExpressionOptimization",
+	"GroupExpressionImplementation",
+	"GroupExpressionExploration",
+	"Transformation",
+};
+
+GPOS_CPL_ASSERT(CJob::EjtSentinel == GPOS_ARRAY_SIZE(rgszJobTypes));
+
+// names of event counters, indexed by counter
+static const CHAR *rgszCounters[] = {
+	"JoinStatsCacheHits",
+	"CostBoundPrunes",
+	"TimeBudgetExhausted",
+};
+
+GPOS_CPL_ASSERT(COptimizationProfile::EcntSentinel ==
+				GPOS_ARRAY_SIZE(rgszCounters));
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::COptimizationProfile
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+COptimizationProfile::COptimizationProfile(CMemoryPool *mp)
+	: m_mp(mp), m_pdrgpstage(NULL)
+{
+	m_pdrgpstage = GPOS_NEW(mp) StageStatsArray(mp);
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::~COptimizationProfile
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+COptimizationProfile::~COptimizationProfile()
+{
+	m_pdrgpstage->Release();
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::Pstage
+//
+//	@doc:
+//		Counters of the given stage, adding zeroed stages as needed
+//
+//---------------------------------------------------------------------------
+COptimizationProfile::SStageStats *
+COptimizationProfile::Pstage(ULONG ulStage)
+{
+	while (m_pdrgpstage->Size() <= ulStage)
+	{
+		SStageStats *pstage = GPOS_NEW(m_mp) SStageStats;
+		(void) clib::Memset(pstage, 0, sizeof(SStageStats));
+		m_pdrgpstage->Append(pstage);
+	}
+
+	return (*m_pdrgpstage)[ulStage];
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::AddXformCall
+//
+//	@doc:
+//		Record an application of an xform to a group expression
+//
+//---------------------------------------------------------------------------
+void
+COptimizationProfile::AddXformCall(ULONG ulStage, CXform::EXformId exfid,
+								   ULONG ulTime, ULONG ulBindings,
+								   ULONG ulAlternatives, ULONG ulPruned)
+{
+	GPOS_ASSERT(CXform::ExfSentinel > exfid);
+	GPOS_ASSERT(ulPruned <= ulAlternatives);
+
+	SXformStats *pxformstats = &Pstage(ulStage)->m_rgxform[exfid];
+	pxformstats->m_ullCalls++;
+	pxformstats->m_ullBindings += ulBindings;
+	pxformstats->m_ullAlternatives += ulAlternatives;
+	pxformstats->m_ullPruned += ulPruned;
+	pxformstats->m_ullTime += ulTime;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::AddJobExecution
+//
+//	@doc:
+//		Record an execution of a job
+//
+//---------------------------------------------------------------------------
+void
+COptimizationProfile::AddJobExecution(ULONG ulStage, CJob::EJobType ejt,
+									  ULONG ulTime)
+{
+	GPOS_ASSERT(CJob::EjtSentinel > ejt);
+
+	SJobStats *pjobstats = &Pstage(ulStage)->m_rgjob[ejt];
+	pjobstats->m_ullExecutions++;
+	pjobstats->m_ullTime += ulTime;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::AddStageRun
+//
+//	@doc:
+//		Record a completed run of a search stage and the number of groups
+//		and group expressions it added to memo
+//
+//---------------------------------------------------------------------------
+void
+COptimizationProfile::AddStageRun(ULONG ulStage, ULONG ulTimeMS,
+								  ULONG ulGroups, ULONG ulGroupExprs)
+{
+	SStageStats *pstage = Pstage(ulStage);
+	pstage->m_ullRuns++;
+	pstage->m_ullTime += (ULLONG) ulTimeMS * 1000;
+	pstage->m_ullGroups += ulGroups;
+	pstage->m_ullGroupExprs += ulGroupExprs;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::AddCount
+//
+//	@doc:
+//		Record occurrences of an event in a search stage
+//
+//---------------------------------------------------------------------------
+void
+COptimizationProfile::AddCount(ULONG ulStage, ECounter ecnt, ULONG ulCount)
+{
+	GPOS_ASSERT(EcntSentinel > ecnt);
+
+	Pstage(ulStage)->m_rgullCounters[ecnt] += ulCount;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::Merge
+//
+//	@doc:
+//		Add the counters of another profile to this one
+//
+//---------------------------------------------------------------------------
+void
+COptimizationProfile::Merge(const COptimizationProfile *pop)
+{
+	GPOS_ASSERT(NULL != pop);
+	GPOS_ASSERT(this != pop);
+
+	const ULONG ulStages = pop->UlStages();
+	for (ULONG ulStage = 0; ulStage < ulStages; ulStage++)
+	{
+		const SStageStats *pstageSrc = pop->PstageStats(ulStage);
+		SStageStats *pstage = Pstage(ulStage);
+
+		pstage->m_ullRuns += pstageSrc->m_ullRuns;
+		pstage->m_ullTime += pstageSrc->m_ullTime;
+		pstage->m_ullGroups += pstageSrc->m_ullGroups;
+		pstage->m_ullGroupExprs += pstageSrc->m_ullGroupExprs;
+
+		for (ULONG ul = 0; ul < CXform::ExfSentinel; ul++)
+		{
+			const SXformStats *pxformstatsSrc = &pstageSrc->m_rgxform[ul];
+			SXformStats *pxformstats = &pstage->m_rgxform[ul];
+
+			pxformstats->m_ullCalls += pxformstatsSrc->m_ullCalls;
+			pxformstats->m_ullBindings += pxformstatsSrc->m_ullBindings;
+			pxformstats->m_ullAlternatives +=
+				pxformstatsSrc->m_ullAlternatives;
+			pxformstats->m_ullPruned += pxformstatsSrc->m_ullPruned;
+			pxformstats->m_ullTime += pxformstatsSrc->m_ullTime;
+		}
+
+		for (ULONG ul = 0; ul < CJob::EjtSentinel; ul++)
+		{
+			pstage->m_rgjob[ul].m_ullExecutions +=
+				pstageSrc->m_rgjob[ul].m_ullExecutions;
+			pstage->m_rgjob[ul].m_ullTime += pstageSrc->m_rgjob[ul].m_ullTime;
+		}
+
+		for (ULONG ul = 0; ul < EcntSentinel; ul++)
+		{
+			pstage->m_rgullCounters[ul] += pstageSrc->m_rgullCounters[ul];
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::Reset
+//
+//	@doc:
+//		Zero all counters
+//
+//---------------------------------------------------------------------------
+void
+COptimizationProfile::Reset()
+{
+	m_pdrgpstage->Clear();
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::SzJobType
+//
+//	@doc:
+//		Name of a job type
+//
+//---------------------------------------------------------------------------
+const CHAR *
+COptimizationProfile::SzJobType(CJob::EJobType ejt)
+{
+	GPOS_ASSERT(CJob::EjtSentinel > ejt);
+
+	return rgszJobTypes[ejt];
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::SzCounter
+//
+//	@doc:
+//		Name of an event counter
+//
+//---------------------------------------------------------------------------
+const CHAR *
+COptimizationProfile::SzCounter(ECounter ecnt)
+{
+	GPOS_ASSERT(EcntSentinel > ecnt);
+
+	return rgszCounters[ecnt];
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizationProfile::FEnabled
+//
+//	@doc:
+//		Is profiling requested, either to print the optimization statistics
+//		or to report the profile to the caller of the optimizer
+//
+//---------------------------------------------------------------------------
+BOOL
+COptimizationProfile::FEnabled()
+{
+	return GPOS_FTRACE(EopttracePrintOptimizationStatistics) ||
+		   GPOS_FTRACE(EopttraceProfileOptimization);
+}
+
+// EOF
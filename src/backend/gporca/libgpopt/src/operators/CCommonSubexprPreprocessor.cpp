@@ -0,0 +1,586 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CCommonSubexprPreprocessor.cpp
+//
+//	@doc:
+//		Preprocessing routines that share identical subtrees of the inputs
+//		of a union through CTEs
+//---------------------------------------------------------------------------
+
+#include "gpos/base.h"
+
+#include "gpopt/base/CUtils.h"
+#include "gpopt/base/COptCtxt.h"
+#include "gpopt/operators/CCommonSubexprPreprocessor.h"
+#include "gpopt/operators/CLogicalCTEAnchor.h"
+#include "gpopt/operators/CLogicalCTEConsumer.h"
+#include "gpopt/operators/CLogicalGet.h"
+#include "gpopt/operators/CScalarProjectElement.h"
+#include "gpopt/xforms/CXformUtils.h"
+
+using namespace gpopt;
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::FShareableOperator
+//
+//	@doc:
+//		Check if the given logical operator can be part of a shared
+//		subtree
+//
+//---------------------------------------------------------------------------
+BOOL
+CCommonSubexprPreprocessor::FShareableOperator(COperator *pop)
+{
+	switch (pop->Eopid())
+	{
+		case COperator::EopLogicalGet:
+		case COperator::EopLogicalSelect:
+		case COperator::EopLogicalProject:
+		case COperator::EopLogicalGbAgg:
+		case COperator::EopLogicalInnerJoin:
+		case COperator::EopLogicalNAryJoin:
+		case COperator::EopLogicalLeftOuterJoin:
+		case COperator::EopLogicalLeftSemiJoin:
+		case COperator::EopLogicalLeftAntiSemiJoin:
+		case COperator::EopLogicalLeftAntiSemiJoinNotIn:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::FShareableSubtree
+//
+//	@doc:
+//		Check if a subtree of shareable operators can be moved to a CTE
+//		producer; it must be self-contained and produce the same rows
+//		each time it is evaluated
+//
+//---------------------------------------------------------------------------
+BOOL
+CCommonSubexprPreprocessor::FShareableSubtree(CExpression *pexpr)
+{
+	if (0 < pexpr->DeriveOuterReferences()->Size() ||
+		CUtils::FHasSubqueryOrApply(pexpr))
+	{
+		return false;
+	}
+
+	CFunctionProp *pfp = pexpr->DeriveFunctionProperties();
+
+	return IMDFunction::EfsVolatile > pfp->Efs() &&
+		   !pfp->NeedsSingletonExecution() &&
+		   0 == pexpr->DerivePartitionInfo()->UlConsumers();
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::FCollectCandidates
+//
+//	@doc:
+//		Number the logical nodes of a union input in pre-order and collect
+//		the subtrees that may be shared; return true if the whole subtree
+//		consists of shareable operators
+//
+//---------------------------------------------------------------------------
+BOOL
+CCommonSubexprPreprocessor::FCollectCandidates(
+	CMemoryPool *mp, CExpression *pexpr, ULONG ulBranch, ULONG *pulNodeId,
+	SCandidateArray *pdrgpcand,
+	ULONG *pulNodes,  // output: number of logical nodes in subtree
+	BOOL *pfHasJoin	  // output: does subtree contain a join
+)
+{
+	// protect against stack overflow during recursion
+	GPOS_CHECK_STACK_SIZE;
+	GPOS_ASSERT(pexpr->Pop()->FLogical());
+
+	COperator *pop = pexpr->Pop();
+	const ULONG ulNodeId = (*pulNodeId)++;
+	BOOL fShareable = FShareableOperator(pop);
+	BOOL fHasJoin = CUtils::FLogicalJoin(pop);
+	ULONG ulNodes = 1;
+
+	const ULONG arity = pexpr->Arity();
+	for (ULONG ul = 0; ul < arity; ul++)
+	{
+		CExpression *pexprChild = (*pexpr)[ul];
+		if (!pexprChild->Pop()->FLogical())
+		{
+			continue;
+		}
+
+		ULONG ulChildNodes = 0;
+		BOOL fChildHasJoin = false;
+		BOOL fChildShareable =
+			FCollectCandidates(mp, pexprChild, ulBranch, pulNodeId, pdrgpcand,
+							   &ulChildNodes, &fChildHasJoin);
+		fShareable = fShareable && fChildShareable;
+		fHasJoin = fHasJoin || fChildHasJoin;
+		ulNodes += ulChildNodes;
+	}
+
+	*pulNodes = ulNodes;
+	*pfHasJoin = fHasJoin;
+
+	// sharing a single scan is not worth the materialization
+	if (fShareable && fHasJoin && FShareableSubtree(pexpr))
+	{
+		pdrgpcand->Append(
+			GPOS_NEW(mp) SCandidate(pexpr, ulBranch, ulNodeId, ulNodes));
+	}
+
+	return fShareable;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::FMapDefinedColumns
+//
+//	@doc:
+//		Walk two subtrees in parallel and map every column defined by the
+//		first one to the column defined at the same position by the second
+//		one; return false if the subtrees differ in shape or in the tables
+//		they scan
+//
+//---------------------------------------------------------------------------
+BOOL
+CCommonSubexprPreprocessor::FMapDefinedColumns(
+	CMemoryPool *mp, CExpression *pexprFst, CExpression *pexprSnd,
+	UlongToColRefMap *colref_mapping)
+{
+	// protect against stack overflow during recursion
+	GPOS_CHECK_STACK_SIZE;
+
+	COperator *popFst = pexprFst->Pop();
+	COperator *popSnd = pexprSnd->Pop();
+	const ULONG arity = pexprFst->Arity();
+	if (popFst->Eopid() != popSnd->Eopid() || arity != pexprSnd->Arity())
+	{
+		return false;
+	}
+
+	CColRefArray *pdrgpcrFst = NULL;
+	CColRefArray *pdrgpcrSnd = NULL;
+	if (COperator::EopLogicalGet == popFst->Eopid())
+	{
+		CLogicalGet *popGetFst = CLogicalGet::PopConvert(popFst);
+		CLogicalGet *popGetSnd = CLogicalGet::PopConvert(popSnd);
+		if (!popGetFst->Ptabdesc()->MDId()->Equals(
+				popGetSnd->Ptabdesc()->MDId()))
+		{
+			return false;
+		}
+
+		popGetFst->PdrgpcrOutput()->AddRef();
+		pdrgpcrFst = popGetFst->PdrgpcrOutput();
+		popGetSnd->PdrgpcrOutput()->AddRef();
+		pdrgpcrSnd = popGetSnd->PdrgpcrOutput();
+	}
+	else if (COperator::EopScalarProjectElement == popFst->Eopid())
+	{
+		pdrgpcrFst = GPOS_NEW(mp) CColRefArray(mp);
+		pdrgpcrFst->Append(CScalarProjectElement::PopConvert(popFst)->Pcr());
+		pdrgpcrSnd = GPOS_NEW(mp) CColRefArray(mp);
+		pdrgpcrSnd->Append(CScalarProjectElement::PopConvert(popSnd)->Pcr());
+	}
+
+	BOOL fMapped = true;
+	if (NULL != pdrgpcrFst)
+	{
+		fMapped = pdrgpcrFst->Size() == pdrgpcrSnd->Size();
+		for (ULONG ul = 0; fMapped && ul < pdrgpcrFst->Size(); ul++)
+		{
+			CColRef *pcrFst = (*pdrgpcrFst)[ul];
+			CColRef *pcrSnd = (*pdrgpcrSnd)[ul];
+			ULONG id = pcrFst->Id();
+			CColRef *pcrMapped = colref_mapping->Find(&id);
+			if (NULL == pcrMapped && pcrFst != pcrSnd)
+			{
+				(void) colref_mapping->Insert(GPOS_NEW(mp) ULONG(id), pcrSnd);
+			}
+			else
+			{
+				// a column defined twice, or by both subtrees
+				fMapped = false;
+			}
+		}
+
+		pdrgpcrFst->Release();
+		pdrgpcrSnd->Release();
+	}
+
+	for (ULONG ul = 0; fMapped && ul < arity; ul++)
+	{
+		fMapped = FMapDefinedColumns(mp, (*pexprFst)[ul], (*pexprSnd)[ul],
+									 colref_mapping);
+	}
+
+	return fMapped;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::PhmulcrEquivalent
+//
+//	@doc:
+//		Return the mapping of the columns defined by the first subtree to
+//		the ones defined by the second subtree if the subtrees compute the
+//		same result up to that mapping, NULL otherwise
+//
+//---------------------------------------------------------------------------
+UlongToColRefMap *
+CCommonSubexprPreprocessor::PhmulcrEquivalent(CMemoryPool *mp,
+											  CExpression *pexprFst,
+											  CExpression *pexprSnd)
+{
+	UlongToColRefMap *colref_mapping = GPOS_NEW(mp) UlongToColRefMap(mp);
+	if (!FMapDefinedColumns(mp, pexprFst, pexprSnd, colref_mapping))
+	{
+		colref_mapping->Release();
+		return NULL;
+	}
+
+	// the subtrees are equivalent if renaming the columns of the first
+	// one yields the second one, which also compares all predicates,
+	// projections and grouping columns
+	CExpression *pexprRemapped = pexprFst->PexprCopyWithRemappedColumns(
+		mp, colref_mapping, false /*must_exist*/);
+	BOOL fMatches = pexprRemapped->Matches(pexprSnd);
+	pexprRemapped->Release();
+
+	if (!fMatches)
+	{
+		colref_mapping->Release();
+		return NULL;
+	}
+
+	return colref_mapping;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::ICmpCandidates
+//
+//	@doc:
+//		Order candidates by decreasing size, then by position, so that
+//		the largest shareable subtrees are considered first and the
+//		first occurrence of a subtree becomes the producer
+//
+//---------------------------------------------------------------------------
+INT
+CCommonSubexprPreprocessor::ICmpCandidates(const void *pvFst,
+										   const void *pvSnd)
+{
+	const SCandidate *pcandFst = *(const SCandidate **) pvFst;
+	const SCandidate *pcandSnd = *(const SCandidate **) pvSnd;
+
+	if (pcandFst->m_ulNodes != pcandSnd->m_ulNodes)
+	{
+		return pcandFst->m_ulNodes > pcandSnd->m_ulNodes ? -1 : 1;
+	}
+
+	if (pcandFst->m_ulBranch != pcandSnd->m_ulBranch)
+	{
+		return pcandFst->m_ulBranch < pcandSnd->m_ulBranch ? -1 : 1;
+	}
+
+	if (pcandFst->m_ulNodeId != pcandSnd->m_ulNodeId)
+	{
+		return pcandFst->m_ulNodeId < pcandSnd->m_ulNodeId ? -1 : 1;
+	}
+
+	return 0;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::Claim
+//
+//	@doc:
+//		Mark the candidates that overlap a shared candidate, i.e. its
+//		ancestors and descendants in the same union input
+//
+//---------------------------------------------------------------------------
+void
+CCommonSubexprPreprocessor::Claim(SCandidateArray *pdrgpcand,
+								  const SCandidate *pcand)
+{
+	const ULONG size = pdrgpcand->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		SCandidate *pcandOther = (*pdrgpcand)[ul];
+		if (pcandOther->m_ulBranch == pcand->m_ulBranch &&
+			pcandOther->m_ulNodeId < pcand->m_ulNodeId + pcand->m_ulNodes &&
+			pcand->m_ulNodeId < pcandOther->m_ulNodeId + pcandOther->m_ulNodes)
+		{
+			pcandOther->m_fClaimed = true;
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::PdrgpulShare
+//
+//	@doc:
+//		Group the candidates that are identical up to columns, create a
+//		CTE producer for each group with more than one member and attach
+//		a consumer to each member; return the ids of the created CTEs
+//
+//---------------------------------------------------------------------------
+ULongPtrArray *
+CCommonSubexprPreprocessor::PdrgpulShare(CMemoryPool *mp,
+										 SCandidateArray *pdrgpcand)
+{
+	CCTEInfo *pcteinfo = COptCtxt::PoctxtFromTLS()->Pcteinfo();
+	ULongPtrArray *pdrgpulCTEIds = GPOS_NEW(mp) ULongPtrArray(mp);
+
+	pdrgpcand->Sort(ICmpCandidates);
+
+	const ULONG size = pdrgpcand->Size();
+	for (ULONG ulFst = 0; ulFst < size; ulFst++)
+	{
+		SCandidate *pcandFst = (*pdrgpcand)[ulFst];
+		if (pcandFst->m_fClaimed)
+		{
+			continue;
+		}
+
+		CColRefArray *pdrgpcrOutput =
+			pcandFst->m_pexpr->DeriveOutputColumns()->Pdrgpcr(mp);
+		ULONG ulCTEId = gpos::ulong_max;
+
+		// candidates of equal size are disjoint, so any of them may join
+		// the group of the first one
+		for (ULONG ulSnd = ulFst + 1;
+			 ulSnd < size &&
+			 (*pdrgpcand)[ulSnd]->m_ulNodes == pcandFst->m_ulNodes;
+			 ulSnd++)
+		{
+			SCandidate *pcandSnd = (*pdrgpcand)[ulSnd];
+			if (pcandSnd->m_fClaimed || pcandSnd->m_pexpr == pcandFst->m_pexpr)
+			{
+				continue;
+			}
+
+			UlongToColRefMap *colref_mapping =
+				PhmulcrEquivalent(mp, pcandFst->m_pexpr, pcandSnd->m_pexpr);
+			if (NULL == colref_mapping)
+			{
+				continue;
+			}
+
+			if (gpos::ulong_max == ulCTEId)
+			{
+				// first match, move the subtree to a producer and let the
+				// first candidate consume it with its own columns
+				ulCTEId = pcteinfo->next_id();
+				(void) CXformUtils::PexprAddCTEProducer(
+					mp, ulCTEId, pdrgpcrOutput, pcandFst->m_pexpr);
+
+				pdrgpcrOutput->AddRef();
+				pcandFst->m_pexprConsumer = GPOS_NEW(mp) CExpression(
+					mp, GPOS_NEW(mp)
+							CLogicalCTEConsumer(mp, ulCTEId, pdrgpcrOutput));
+				pcteinfo->IncrementConsumers(ulCTEId);
+				Claim(pdrgpcand, pcandFst);
+				pdrgpulCTEIds->Append(GPOS_NEW(mp) ULONG(ulCTEId));
+			}
+
+			// the consumer produces the columns the subtree defined
+			CColRefArray *pdrgpcrConsumer = CUtils::PdrgpcrRemap(
+				mp, pdrgpcrOutput, colref_mapping, true /*must_exist*/);
+			colref_mapping->Release();
+
+			pcandSnd->m_pexprConsumer = GPOS_NEW(mp) CExpression(
+				mp, GPOS_NEW(mp)
+						CLogicalCTEConsumer(mp, ulCTEId, pdrgpcrConsumer));
+			pcteinfo->IncrementConsumers(ulCTEId);
+			Claim(pdrgpcand, pcandSnd);
+		}
+
+		pdrgpcrOutput->Release();
+	}
+
+	return pdrgpulCTEIds;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::PexprReplace
+//
+//	@doc:
+//		Copy a union input, numbering its logical nodes as when collecting
+//		candidates, and replace the shared subtrees by their consumers
+//
+//---------------------------------------------------------------------------
+CExpression *
+CCommonSubexprPreprocessor::PexprReplace(CMemoryPool *mp, CExpression *pexpr,
+										 ULONG ulBranch, ULONG *pulNodeId,
+										 SCandidateArray *pdrgpcand)
+{
+	// protect against stack overflow during recursion
+	GPOS_CHECK_STACK_SIZE;
+	GPOS_ASSERT(pexpr->Pop()->FLogical());
+
+	const ULONG ulNodeId = (*pulNodeId)++;
+	const ULONG size = pdrgpcand->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		SCandidate *pcand = (*pdrgpcand)[ul];
+		if (NULL != pcand->m_pexprConsumer &&
+			pcand->m_ulBranch == ulBranch && pcand->m_ulNodeId == ulNodeId)
+		{
+			GPOS_ASSERT(pcand->m_pexpr == pexpr);
+
+			// skip the numbers of the replaced subtree
+			*pulNodeId += pcand->m_ulNodes - 1;
+			pcand->m_pexprConsumer->AddRef();
+			return pcand->m_pexprConsumer;
+		}
+	}
+
+	CExpressionArray *pdrgpexprChildren = GPOS_NEW(mp) CExpressionArray(mp);
+	const ULONG arity = pexpr->Arity();
+	for (ULONG ul = 0; ul < arity; ul++)
+	{
+		CExpression *pexprChild = (*pexpr)[ul];
+		if (pexprChild->Pop()->FLogical())
+		{
+			pexprChild =
+				PexprReplace(mp, pexprChild, ulBranch, pulNodeId, pdrgpcand);
+		}
+		else
+		{
+			pexprChild->AddRef();
+		}
+		pdrgpexprChildren->Append(pexprChild);
+	}
+
+	COperator *pop = pexpr->Pop();
+	pop->AddRef();
+	return GPOS_NEW(mp) CExpression(mp, pop, pdrgpexprChildren);
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::PexprProcessSetOp
+//
+//	@doc:
+//		Share the identical subtrees of the inputs of a union and anchor
+//		the created CTEs above it; the inputs are then processed
+//		recursively to share subtrees of nested unions
+//
+//---------------------------------------------------------------------------
+CExpression *
+CCommonSubexprPreprocessor::PexprProcessSetOp(CMemoryPool *mp,
+											  CExpression *pexpr)
+{
+	SCandidateArray *pdrgpcand = GPOS_NEW(mp) SCandidateArray(mp);
+
+	const ULONG arity = pexpr->Arity();
+	for (ULONG ul = 0; ul < arity; ul++)
+	{
+		ULONG ulNodeId = 0;
+		ULONG ulNodes = 0;
+		BOOL fHasJoin = false;
+		(void) FCollectCandidates(mp, (*pexpr)[ul], ul, &ulNodeId, pdrgpcand,
+								  &ulNodes, &fHasJoin);
+	}
+
+	ULongPtrArray *pdrgpulCTEIds = PdrgpulShare(mp, pdrgpcand);
+
+	CExpressionArray *pdrgpexprChildren = GPOS_NEW(mp) CExpressionArray(mp);
+	for (ULONG ul = 0; ul < arity; ul++)
+	{
+		ULONG ulNodeId = 0;
+		CExpression *pexprReplaced =
+			PexprReplace(mp, (*pexpr)[ul], ul, &ulNodeId, pdrgpcand);
+		pdrgpexprChildren->Append(PexprPreprocess(mp, pexprReplaced));
+		pexprReplaced->Release();
+	}
+	pdrgpcand->Release();
+
+	COperator *pop = pexpr->Pop();
+	pop->AddRef();
+	CExpression *pexprResult =
+		GPOS_NEW(mp) CExpression(mp, pop, pdrgpexprChildren);
+
+	const ULONG ulCTEs = pdrgpulCTEIds->Size();
+	for (ULONG ul = 0; ul < ulCTEs; ul++)
+	{
+		pexprResult = GPOS_NEW(mp) CExpression(
+			mp, GPOS_NEW(mp) CLogicalCTEAnchor(mp, *(*pdrgpulCTEIds)[ul]),
+			pexprResult);
+	}
+	pdrgpulCTEIds->Release();
+
+	return pexprResult;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCommonSubexprPreprocessor::PexprPreprocess
+//
+//	@doc:
+//		Main driver; scalar subtrees are not searched, so the unions
+//		inside subqueries are left as they are
+//
+//---------------------------------------------------------------------------
+CExpression *
+CCommonSubexprPreprocessor::PexprPreprocess(CMemoryPool *mp,
+											CExpression *pexpr)
+{
+	// protect against stack overflow during recursion
+	GPOS_CHECK_STACK_SIZE;
+	GPOS_ASSERT(NULL != mp);
+	GPOS_ASSERT(NULL != pexpr);
+
+	COperator *pop = pexpr->Pop();
+	if (COperator::EopLogicalUnionAll == pop->Eopid() ||
+		COperator::EopLogicalUnion == pop->Eopid())
+	{
+		return PexprProcessSetOp(mp, pexpr);
+	}
+
+	// recursively process logical child expressions
+	const ULONG arity = pexpr->Arity();
+	CExpressionArray *pdrgpexprChildren = GPOS_NEW(mp) CExpressionArray(mp);
+	for (ULONG ul = 0; ul < arity; ul++)
+	{
+		CExpression *pexprChild = (*pexpr)[ul];
+		if (pexprChild->Pop()->FLogical())
+		{
+			pexprChild = PexprPreprocess(mp, pexprChild);
+		}
+		else
+		{
+			pexprChild->AddRef();
+		}
+		pdrgpexprChildren->Append(pexprChild);
+	}
+
+	pop->AddRef();
+	return GPOS_NEW(mp) CExpression(mp, pop, pdrgpexprChildren);
+}
+
+// EOF
@@ -716,6 +716,26 @@ CExpression::ResetStats()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CExpression::SetStats
+//
+//	@doc:
+//		Set stats derived elsewhere for an equivalent expression
+//
+//---------------------------------------------------------------------------
+void
+CExpression::SetStats(IStatistics *stats)
+{
+	GPOS_ASSERT(NULL != stats);
+	GPOS_ASSERT(NULL == m_pstats);
+	GPOS_ASSERT(Pop()->FLogical());
+
+	stats->AddRef();
+	m_pstats = stats;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CExpression::HasOuterRefs
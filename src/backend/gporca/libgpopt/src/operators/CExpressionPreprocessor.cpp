@@ -20,6 +20,7 @@
 #include "gpopt/exception.h"
 
 #include "gpopt/operators/CWindowPreprocessor.h"
+#include "gpopt/operators/CCommonSubexprPreprocessor.h"
 #include "gpopt/operators/CLogicalConstTableGet.h"
 #include "gpopt/operators/CLogicalCTEAnchor.h"
 #include "gpopt/operators/CLogicalCTEConsumer.h"
@@ -2702,11 +2703,27 @@ CExpressionPreprocessor::PexprPreprocess(
 	GPOS_CHECK_ABORT;
 	pexrReorderedScalarCmpChildren->Release();
 
-	// (26) normalize expression again
+	// (26) share identical subtrees of union inputs through CTEs, only if
+	// the CTEs may still be inlined where sharing does not pay off
+	CExpression *pexprShared = NULL;
+	if (GPOS_FTRACE(EopttraceEnableSubexpressionSharing) &&
+		GPOS_FTRACE(EopttraceEnableCTEInlining))
+	{
+		pexprShared = CCommonSubexprPreprocessor::PexprPreprocess(
+			mp, pexprExistWithPredFromINSubq);
+		GPOS_CHECK_ABORT;
+		pexprExistWithPredFromINSubq->Release();
+	}
+	else
+	{
+		pexprShared = pexprExistWithPredFromINSubq;
+	}
+
+	// (27) normalize expression again
 	CExpression *pexprNormalized2 =
-		CNormalizer::PexprNormalize(mp, pexprExistWithPredFromINSubq);
+		CNormalizer::PexprNormalize(mp, pexprShared);
 	GPOS_CHECK_ABORT;
-	pexprExistWithPredFromINSubq->Release();
+	pexprShared->Release();
 
 	return pexprNormalized2;
 }
@@ -17,6 +17,7 @@
 
 #include "naucrates/base/CDatumGenericGPDB.h"
 #include "naucrates/dxl/operators/CDXLNode.h"
+#include "naucrates/dxl/xml/COstreamDXLBinary.h"
 #include "naucrates/md/IMDProvider.h"
 
 #include "naucrates/traceflags/traceflags.h"
@@ -250,6 +251,8 @@ COptimizer::PdxlnOptimize(
 	CMiniDumperDXL mdmp(mp);
 	CAutoP<std::wofstream> wosMinidump;
 	CAutoP<COstreamBasic> osMinidump;
+	CAutoP<std::ofstream> ofsMinidump;
+	CAutoP<COstreamDXLBinary> osBinaryMinidump;
 	if (fMinidump)
 	{
 		CHAR file_name[GPOS_FILE_NAME_BUF_SIZE];
@@ -261,10 +264,24 @@ COptimizer::PdxlnOptimize(
 		// Note: std::wofstream won't throw an error on failure. The stream is merely marked as
 		// failed. We could check the state, and avoid the overhead of serializing the
 		// minidump if it failed, but it's hardly worth optimizing for an error case.
-		wosMinidump = GPOS_NEW(mp) std::wofstream(file_name);
-		osMinidump = GPOS_NEW(mp) COstreamBasic(wosMinidump.Value());
+		if (GPOS_FTRACE(EopttraceBinaryMinidump))
+		{
+			// the binary stream writes the end of the document when it is
+			// destroyed, before the file is closed
+			ofsMinidump = GPOS_NEW(mp)
+				std::ofstream(file_name, std::ios::out | std::ios::binary);
+			osBinaryMinidump =
+				GPOS_NEW(mp) COstreamDXLBinary(mp, *ofsMinidump.Value());
+
+			mdmp.Init(osBinaryMinidump.Value());
+		}
+		else
+		{
+			wosMinidump = GPOS_NEW(mp) std::wofstream(file_name);
+			osMinidump = GPOS_NEW(mp) COstreamBasic(wosMinidump.Value());
 
-		mdmp.Init(osMinidump.Value());
+			mdmp.Init(osMinidump.Value());
+		}
 	}
 	CDXLNode *pdxlnPlan = NULL;
 	CErrorHandlerStandard errhdl;
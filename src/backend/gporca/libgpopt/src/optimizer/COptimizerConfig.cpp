@@ -13,6 +13,7 @@
 #include "gpos/string/CWStringDynamic.h"
 
 #include "gpopt/cost/ICostModel.h"
+#include "gpopt/engine/COptimizationProfile.h"
 #include "gpopt/optimizer/COptimizerConfig.h"
 #include "naucrates/dxl/CCostModelConfigSerializer.h"
 #include "naucrates/dxl/xml/CXMLSerializer.h"
@@ -37,7 +38,8 @@ COptimizerConfig::COptimizerConfig(CEnumeratorConfig *pec,
 	  m_cte_conf(pcteconf),
 	  m_cost_model(cost_model),
 	  m_hint(phint),
-	  m_window_oids(pwindowoids)
+	  m_window_oids(pwindowoids),
+	  m_profile(NULL)
 {
 	GPOS_ASSERT(NULL != pec);
 	GPOS_ASSERT(NULL != stats_config);
@@ -63,6 +65,25 @@ COptimizerConfig::~COptimizerConfig()
 	m_cost_model->Release();
 	m_hint->Release();
 	m_window_oids->Release();
+	CRefCount::SafeRelease(m_profile);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptimizerConfig::SetProfile
+//
+//	@doc:
+//		Set the profile of the last optimization, replacing any earlier one
+//
+//---------------------------------------------------------------------------
+void
+COptimizerConfig::SetProfile(COptimizationProfile *profile)
+{
+	GPOS_ASSERT(NULL != profile);
+
+	profile->AddRef();
+	CRefCount::SafeRelease(m_profile);
+	m_profile = profile;
 }
 
 //---------------------------------------------------------------------------
@@ -206,6 +227,9 @@ COptimizerConfig::Serialize(CMemoryPool *mp, CXMLSerializer *xml_serializer,
 	xml_serializer->AddAttribute(
 		CDXLTokens::GetDXLTokenStr(EdxltokenPushGroupByBelowSetopThreshold),
 		m_hint->UlPushGroupByBelowSetopThreshold());
+	xml_serializer->AddAttribute(
+		CDXLTokens::GetDXLTokenStr(EdxltokenPlanningTimeBudget),
+		m_hint->UlPlanningTimeBudget());
 	xml_serializer->CloseElement(
 		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
 		CDXLTokens::GetDXLTokenStr(EdxltokenHint));
@@ -158,6 +158,7 @@ CGroup::CGroup(CMemoryPool *mp, BOOL fScalar)
 	  m_join_opfamilies(NULL),
 	  m_pdp(NULL),
 	  m_pstats(NULL),
+	  m_ulStatsVersion(0),
 	  m_pexprScalarRep(NULL),
 	  m_pexprScalarRepIsExact(false),
 	  m_pccDummy(NULL),
@@ -868,6 +869,7 @@ CGroup::AppendStats(CMemoryPool *mp, IStatistics *stats)
 		CGroupProxy gp(this);
 		current_stats = m_pstats;
 		m_pstats = NULL;
+		m_ulStatsVersion++;
 		gp.InitStats(stats_copy);
 	}
 
@@ -1853,6 +1855,7 @@ CGroup::ResetStats()
 		CGroupProxy gp(this);
 		stats = m_pstats;
 		m_pstats = NULL;
+		m_ulStatsVersion++;
 	}
 	CRefCount::SafeRelease(stats);
 	stats = NULL;
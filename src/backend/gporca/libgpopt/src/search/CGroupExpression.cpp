@@ -16,6 +16,7 @@
 
 #include "gpopt/base/CUtils.h"
 #include "gpopt/base/COptimizationContext.h"
+#include "gpopt/engine/COptimizationProfile.h"
 #include "gpopt/operators/CPhysicalAgg.h"
 #include "gpopt/search/CBinding.h"
 #include "gpopt/search/CGroupExpression.h"
@@ -377,8 +378,20 @@ CGroupExpression::PccInsertBest(CCostContext *pcc)
 	CCostContext *pccExisting = PccRemove(poc, ulOptReq);
 	CCostContext *pccKept = NULL;
 
-	// compare existing context with given context
-	if (NULL == pccExisting || pcc->FBetterThan(pccExisting))
+	// compare existing context with given context; the cost of a pruned
+	// context is only a lower bound, so a costed plan always takes
+	// precedence over a pruned one
+	BOOL fInsert = (NULL == pccExisting);
+	if (!fInsert && pcc->FPruned() != pccExisting->FPruned())
+	{
+		fInsert = pccExisting->FPruned();
+	}
+	else if (!fInsert)
+	{
+		fInsert = pcc->FBetterThan(pccExisting);
+	}
+
+	if (fInsert)
 	{
 		// insert new context
 		pccKept = PccInsert(pcc);
@@ -767,15 +780,15 @@ void
 CGroupExpression::Transform(
 	CMemoryPool *mp, CMemoryPool *pmpLocal, CXform *pxform,
 	CXformResult *pxfres,
-	ULONG *pulElapsedTime,	// output: elapsed time in millisecond
+	ULONG *pulElapsedTime,	// output: elapsed time in microseconds
 	ULONG *pulNumberOfBindings)
 {
 	GPOS_ASSERT(NULL != pulElapsedTime);
 	GPOS_CHECK_ABORT;
 
-	BOOL fPrintOptStats = GPOS_FTRACE(EopttracePrintOptimizationStatistics);
+	BOOL fProfile = COptimizationProfile::FEnabled();
 	CTimerUser timer;
-	if (fPrintOptStats)
+	if (fProfile)
 	{
 		timer.Restart();
 	}
@@ -785,9 +798,9 @@ CGroupExpression::Transform(
 	if (GPOPT_FDISABLED_XFORM(pxform->Exfid()) ||
 		!pxform->FCompatible(m_exfidOrigin))
 	{
-		if (fPrintOptStats)
+		if (fProfile)
 		{
-			*pulElapsedTime = timer.ElapsedMS();
+			*pulElapsedTime = timer.ElapsedUS();
 		}
 		return;
 	}
@@ -798,9 +811,9 @@ CGroupExpression::Transform(
 	exprhdl.DeriveProps(NULL /*pdpctxt*/);
 	if (CXform::ExfpNone == pxform->Exfp(exprhdl))
 	{
-		if (GPOS_FTRACE(EopttracePrintOptimizationStatistics))
+		if (fProfile)
 		{
-			*pulElapsedTime = timer.ElapsedMS();
+			*pulElapsedTime = timer.ElapsedUS();
 		}
 		return;
 	}
@@ -844,9 +857,9 @@ CGroupExpression::Transform(
 	// post-prcoessing before applying xform to group expression
 	PostprocessTransform(pmpLocal, mp, pxform);
 
-	if (fPrintOptStats)
+	if (fProfile)
 	{
-		*pulElapsedTime = timer.ElapsedMS();
+		*pulElapsedTime = timer.ElapsedUS();
 	}
 }
 
@@ -178,7 +178,7 @@ CJobGroupExpressionExploration::ScheduleApplicableTransformations(
 
 	// intersect them with required xforms and schedule jobs
 	xform_set->Intersection(CXformFactory::Pxff()->PxfsExploration());
-	xform_set->Intersection(psc->Peng()->PxfsCurrentStage());
+	psc->Peng()->RestrictExplorationXforms(xform_set);
 	ScheduleTransformations(psc, xform_set);
 	xform_set->Release();
 
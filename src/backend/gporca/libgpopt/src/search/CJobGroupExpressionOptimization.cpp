@@ -332,7 +332,7 @@ CJobGroupExpressionOptimization::EevtInitialize(CSchedulerContext *psc,
 	// check if job can be early terminated without optimizing any child
 	CCost costLowerBound(GPOPT_INVALID_COST);
 	if (psc->Peng()->FSafeToPrune(
-			pjgeo->m_pgexpr, pjgeo->m_poc->Prpp(), NULL /*pccChild*/,
+			pjgeo->m_pgexpr, pjgeo->m_poc, NULL /*pccChild*/,
 			gpos::ulong_max /*child_index*/, &costLowerBound))
 	{
 		(void) pjgeo->m_pgexpr->PccComputeCost(
@@ -385,7 +385,7 @@ CJobGroupExpressionOptimization::DerivePrevChildProps(CSchedulerContext *psc)
 
 	// check if job can be early terminated after previous children have been optimized
 	CCost costLowerBound(GPOPT_INVALID_COST);
-	if (psc->Peng()->FSafeToPrune(m_pgexpr, m_poc->Prpp(), pccChildBest,
+	if (psc->Peng()->FSafeToPrune(m_pgexpr, m_poc, pccChildBest,
 								  ulPrevChildIndex, &costLowerBound))
 	{
 		// failed to optimize child due to cost bounding
@@ -517,6 +517,15 @@ CJobGroupExpressionOptimization::ScheduleChildGroupsJobs(CSchedulerContext *psc)
 		return;
 	}
 
+	CCost costBound(GPOPT_INVALID_COST);
+	if (GPOS_FTRACE(EopttraceEnableCostBoundPropagation) &&
+		m_poc->FCostBound(&costBound))
+	{
+		// a child plan costing more than the plans current context can use
+		// cannot be part of a useful plan either
+		pocChild->SetUpperBound(costBound);
+	}
+
 	CJobGroupOptimization::ScheduleJob(psc, pgroupChild, m_pgexpr, pocChild,
 									   this);
 	pocChild->Release();
@@ -323,6 +323,18 @@ CJobGroupOptimization::EevtCompleteOptimization(CSchedulerContext *,  // psc
 		return eevOptimizing;
 	}
 
+	if (pjgo->m_poc->FReoptimize())
+	{
+		// no plan was found within the upper bound; the context may be
+		// shared with requests that can use costlier plans, so optimize
+		// group expressions pruned against the bound again without it
+		pjgo->m_poc->RemoveUpperBound();
+		pjgo->m_eolCurrent = pjgo->m_pgroup->EolMax();
+		pjgo->m_pgexprLastScheduled = NULL;
+
+		return eevOptimizing;
+	}
+
 	// move optimization context to optimized state
 	pjgo->m_poc->SetState(COptimizationContext::estOptimized);
 
@@ -132,6 +132,14 @@ CJobTransformation::EevtTransform(CSchedulerContext *psc, CJob *pjOwner)
 	CGroupExpression *pgexpr = pjt->m_pgexpr;
 	CXform *pxform = pjt->m_xform;
 
+	// the planning time budget may have been spent since the job was
+	// scheduled
+	if (pxform->FExploration() &&
+		!psc->Peng()->FExplorationXformAllowed(pxform->Exfid()))
+	{
+		return eevCompleted;
+	}
+
 	// insert transformation results to memo
 	CXformResult *pxfres = GPOS_NEW(pmpGlobal) CXformResult(pmpGlobal);
 	ULONG ulElapsedTime = 0;
@@ -22,6 +22,7 @@
 #include "gpopt/base/CDrvdProp.h"
 #include "gpopt/base/CDrvdPropCtxtPlan.h"
 #include "gpopt/base/CReqdPropPlan.h"
+#include "gpopt/base/CJoinStatsCache.h"
 #include "gpopt/base/COptimizationContext.h"
 #include "gpopt/base/COptCtxt.h"
 
@@ -706,13 +707,15 @@ CMemo::ResetGroupStates()
 //	@doc:
 //		Reset statistics by recursively descending from root group;
 //		we call this function before stats derivation to reset stale stats
-//		computed during previous search stages
+//		computed during previous search stages; join stats cached during
+//		those stages are dropped as well
 //
 //---------------------------------------------------------------------------
 void
 CMemo::ResetStats()
 {
 	(void) m_pgroupRoot->FResetStats();
+	COptCtxt::PoctxtFromTLS()->GetJoinStatsCache()->Reset();
 }
 
 
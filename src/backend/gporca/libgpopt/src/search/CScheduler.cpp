@@ -10,8 +10,11 @@
 //---------------------------------------------------------------------------
 
 #include "gpos/base.h"
+#include "gpos/common/CWallClock.h"
 #include "gpos/error/CAutoTrace.h"
 
+#include "gpopt/engine/CEngine.h"
+#include "gpopt/engine/COptimizationProfile.h"
 #include "gpopt/search/CJobFactory.h"
 #include "gpopt/search/CScheduler.h"
 #include "gpopt/search/CSchedulerContext.h"
@@ -112,6 +115,8 @@ CScheduler::ExecuteJobs(CSchedulerContext *psc)
 {
 	CJob *pj = NULL;
 	ULONG count = 0;
+	COptimizationProfile *profile = psc->Peng()->Profile();
+	CWallClock clock;
 
 	// keep retrieving jobs
 	while (NULL != (pj = PjRetrieve()))
@@ -119,8 +124,17 @@ CScheduler::ExecuteJobs(CSchedulerContext *psc)
 		// prepare for job execution
 		PreExecute(pj);
 
-		// execute job
+		// execute job, timing it if the engine keeps a profile
+		if (NULL != profile)
+		{
+			clock.Restart();
+		}
 		BOOL fCompleted = FExecute(pj, psc);
+		if (NULL != profile)
+		{
+			profile->AddJobExecution(psc->Peng()->UlCurrSearchStage(),
+									 pj->Ejt(), clock.ElapsedUS());
+		}
 
 #ifdef GPOS_DEBUG
 		// restrict parallelism to keep track of jobs
@@ -9,6 +9,7 @@
 //		Implementation of optimizer search stage
 //---------------------------------------------------------------------------
 
+#include "gpopt/engine/COptimizationProfile.h"
 #include "gpopt/search/CSearchStage.h"
 #include "gpopt/xforms/CXformFactory.h"
 
@@ -28,6 +29,7 @@ CSearchStage::CSearchStage(CXformSet *xform_set, ULONG ulTimeThreshold,
 	: m_xforms(xform_set),
 	  m_time_threshold(ulTimeThreshold),
 	  m_cost_threshold(costThreshold),
+	  m_time_budget(gpos::ulong_max),
 	  m_pexprBest(NULL),
 	  m_costBest(GPOPT_INVALID_COST)
 {
@@ -37,10 +39,8 @@ CSearchStage::CSearchStage(CXformSet *xform_set, ULONG ulTimeThreshold,
 	// include all implementation rules in any search strategy
 	m_xforms->Union(CXformFactory::Pxff()->PxfsImplementation());
 
-	if (GPOS_FTRACE(EopttracePrintOptimizationStatistics))
-	{
-		m_timer.Restart();
-	}
+	// the elapsed time may be read even if the timer is never restarted
+	m_timer.Restart();
 }
 
 
@@ -59,6 +59,26 @@ CSearchStage::~CSearchStage()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CSearchStage::RestartTimer
+//
+//	@doc:
+//		Restart timer at the start of the stage, if its elapsed time is
+//		needed for a time out, the planning time budget or the profile
+//
+//---------------------------------------------------------------------------
+void
+CSearchStage::RestartTimer()
+{
+	if (m_time_threshold != gpos::ulong_max ||
+		m_time_budget != gpos::ulong_max || COptimizationProfile::FEnabled())
+	{
+		m_timer.Restart();
+	}
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CSearchStage::OsPrint
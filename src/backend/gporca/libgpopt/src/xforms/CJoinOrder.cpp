@@ -15,15 +15,19 @@
 #include "gpos/string/CWStringDynamic.h"
 
 #include "gpos/common/clibwrapper.h"
+#include "gpos/common/CAutoRef.h"
 #include "gpos/common/CBitSet.h"
 
 #include "gpopt/base/CDrvdPropScalar.h"
 #include "gpopt/base/CColRefSetIter.h"
+#include "gpopt/base/CJoinStatsCache.h"
+#include "gpopt/base/COptCtxt.h"
 #include "gpopt/operators/CLogicalJoin.h"
 #include "gpopt/operators/CLogicalInnerJoin.h"
 #include "gpopt/operators/CLogicalLeftOuterJoin.h"
 #include "gpopt/operators/CPredicateUtils.h"
 #include "gpopt/xforms/CJoinOrder.h"
+#include "naucrates/traceflags/traceflags.h"
 
 
 using namespace gpopt;
@@ -578,7 +582,9 @@ CJoinOrder::PcompCombine(SComponent *comp1, SComponent *comp2)
 //		CJoinOrder::DeriveStats
 //
 //	@doc:
-//		Helper function to derive stats on a given component
+//		Helper function to derive stats on a given component; stats of
+//		inner joins of the same atoms with the same predicates are shared
+//		across join order xforms through the join stats cache
 //
 //---------------------------------------------------------------------------
 void
@@ -586,12 +592,37 @@ CJoinOrder::DeriveStats(CExpression *pexpr)
 {
 	GPOS_ASSERT(NULL != pexpr);
 
-	if (NULL == pexpr->Pstats())
+	if (NULL != pexpr->Pstats())
 	{
-		CExpressionHandle exprhdl(m_mp);
-		exprhdl.Attach(pexpr);
-		exprhdl.DeriveStats(m_mp, m_mp, NULL /*prprel*/,
-							NULL /*pdrgpstatCtxt*/);
+		return;
+	}
+
+	CJoinStatsCache *join_stats_cache = NULL;
+	CAutoRef<CJoinStatsCache::CKey> a_key;
+	if (!GPOS_FTRACE(EopttraceDisableJoinStatsCache))
+	{
+		join_stats_cache = COptCtxt::PoctxtFromTLS()->GetJoinStatsCache();
+		a_key = join_stats_cache->PkeyCreate(pexpr);
+	}
+
+	if (NULL != a_key.Value())
+	{
+		IStatistics *stats = join_stats_cache->PstatsLookup(a_key.Value());
+		if (NULL != stats)
+		{
+			pexpr->SetStats(stats);
+			return;
+		}
+	}
+
+	CExpressionHandle exprhdl(m_mp);
+	exprhdl.Attach(pexpr);
+	exprhdl.DeriveStats(m_mp, m_mp, NULL /*prprel*/, NULL /*pdrgpstatCtxt*/);
+
+	if (NULL != a_key.Value())
+	{
+		join_stats_cache->Insert(a_key.Reset(),
+								 const_cast<IStatistics *>(pexpr->Pstats()));
 	}
 }
 
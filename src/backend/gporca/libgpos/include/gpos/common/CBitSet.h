@@ -6,7 +6,8 @@
 //		CBitSet.h
 //
 //	@doc:
-//		Implementation of bitset as linked list of bitvectors
+//		Implementation of bitset as a range of words, or as linked list of
+//		bitvectors for sparse sets
 //---------------------------------------------------------------------------
 #ifndef GPOS_CBitSet_H
 #define GPOS_CBitSet_H
@@ -24,7 +25,10 @@ namespace gpos
 //		CBitSet
 //
 //	@doc:
-//		Linked list of CBitSetLink's
+//		Contiguous range of words covering all set bits; small ranges are
+//		kept inline in the object, larger ones in a single array that is
+//		grown as needed; once the range would get too sparse the set
+//		switches to a linked list of CBitSetLink's
 //
 //---------------------------------------------------------------------------
 class CBitSet : public CRefCount
@@ -81,10 +85,35 @@ protected:
 
 	};	// class CBitSetLink
 
-	// list of bit set links
+	// number of words kept inline before an array is allocated
+	static const ULONG InlineWords = 2;
+
+	// a range of words is kept as long as it has no more than this many
+	// words per element
+	static const ULONG MaxDenseWordsPerBit = 2;
+
+	// inline words
+	ULLONG m_inline_words[InlineWords];
+
+	// words of the range, either m_inline_words or allocated from m_mp
+	ULLONG *m_words;
+
+	// index of the first word of the range
+	ULONG m_base;
+
+	// number of words in the range
+	ULONG m_len;
+
+	// number of words m_words can hold
+	ULONG m_capacity;
+
+	// list of bit set links, used instead of the range for sparse sets
 	CList<CBitSetLink> m_bsllist;
 
-	// pool to allocate links from
+	// is the set kept in m_bsllist
+	BOOL m_is_linked;
+
+	// pool to allocate words and links from
 	CMemoryPool *m_mp;
 
 	// size of individual bitvectors
@@ -96,9 +125,42 @@ protected:
 	// private copy ctor
 	CBitSet(const CBitSet &);
 
+	// word at given index, zero if outside of the range
+	ULLONG
+	GetWord(ULONG idx) const
+	{
+		GPOS_ASSERT(!m_is_linked);
+
+		if (idx < m_base || idx >= m_base + m_len)
+		{
+			return 0;
+		}
+
+		return m_words[idx - m_base];
+	}
+
+	// is a range of given number of words dense enough for given number
+	// of elements
+	BOOL IsDenseRange(ULONG len, ULONG size) const;
+
+	// extend range to cover given words
+	void Extend(ULONG first_idx, ULONG last_idx);
+
+	// drop zero words at both ends of the range
+	void Trim();
+
+	// move the elements from the range to links
+	void ConvertToLinked();
+
 	// find link with offset less or equal to given value
 	CBitSetLink *FindLinkByOffset(ULONG, CBitSetLink * = NULL) const;
 
+	// set given bit in the links; return previous value
+	BOOL LinkedExchangeSet(ULONG pos);
+
+	// release links that have no bits set
+	void RemoveEmptyLinks();
+
 	// reset set
 	void Clear();
 
@@ -108,6 +170,9 @@ protected:
 	// re-compute size of set
 	void RecomputeSize();
 
+	// find first set bit of the range at or after given position
+	BOOL GetNextSetBit(ULONG start_pos, ULONG &next_pos) const;
+
 public:
 	// ctor
 	CBitSet(CMemoryPool *mp, ULONG vector_size = 256);
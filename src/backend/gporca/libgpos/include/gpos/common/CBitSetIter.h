@@ -31,7 +31,7 @@ private:
 	// bitset
 	const CBitSet &m_bs;
 
-	// current cursor position (in current link)
+	// current cursor position (in current link for linked sets)
 	ULONG m_cursor;
 
 	// current cursor link
@@ -14,6 +14,7 @@
 #include "gpos/string/CWStringDynamic.h"
 
 #include "gpos/common/CBitSet.h"
+#include "gpos/common/CBitSetIter.h"
 #include "gpos/memory/CAutoMemoryPool.h"
 #include "gpos/test/CUnittest.h"
 
@@ -36,6 +37,7 @@ CBitSetTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Basics),
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Removal),
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_SetOps),
+		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Sparse),
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Performance)};
 
 	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
@@ -209,6 +211,123 @@ CBitSetTest::EresUnittest_SetOps()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSetTest::EresUnittest_Sparse
+//
+//	@doc:
+//		Test for sets whose bits are far apart, forcing the word range
+//		to grow in both directions or the set to switch to links
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CBitSetTest::EresUnittest_Sparse()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	const ULONG rgulBits[] = {5000, 70, 100000, 3, 4095, 64};
+	const ULONG ulBits = GPOS_ARRAY_SIZE(rgulBits);
+
+	CBitSet *pbs1 = GPOS_NEW(mp) CBitSet(mp);
+	for (ULONG i = 0; i < ulBits; i++)
+	{
+		BOOL fSet GPOS_ASSERTS_ONLY = pbs1->ExchangeSet(rgulBits[i]);
+		GPOS_ASSERT(!fSet);
+	}
+	GPOS_ASSERT(ulBits == pbs1->Size());
+	GPOS_ASSERT(!pbs1->Get(0) && !pbs1->Get(4096) && !pbs1->Get(99999));
+
+	// iteration returns bits in ascending order
+	ULONG ulPrev GPOS_ASSERTS_ONLY = 0;
+	ULONG ulCount GPOS_ASSERTS_ONLY = 0;
+	CBitSetIter bsi(*pbs1);
+	while (bsi.Advance())
+	{
+		GPOS_ASSERT(0 == ulCount || ulPrev < bsi.Bit());
+		GPOS_ASSERT(pbs1->Get(bsi.Bit()));
+		ulPrev = bsi.Bit();
+		ulCount++;
+	}
+	GPOS_ASSERT(ulBits == ulCount);
+
+	// same contents built in a different order compare and hash equal
+	CBitSet *pbs2 = GPOS_NEW(mp) CBitSet(mp);
+	for (ULONG i = ulBits; i > 0; i--)
+	{
+		(void) pbs2->ExchangeSet(rgulBits[i - 1]);
+	}
+	(void) pbs2->ExchangeSet(200000);
+	(void) pbs2->ExchangeClear(200000);
+	GPOS_ASSERT(pbs1->Equals(pbs2));
+	GPOS_ASSERT(pbs1->HashValue() == pbs2->HashValue());
+
+	// disjoint set spanning a different range
+	CBitSet *pbs3 = GPOS_NEW(mp) CBitSet(mp);
+	(void) pbs3->ExchangeSet(1);
+	(void) pbs3->ExchangeSet(300000);
+	GPOS_ASSERT(pbs1->IsDisjoint(pbs3) && pbs3->IsDisjoint(pbs1));
+
+	pbs2->Union(pbs3);
+	GPOS_ASSERT(ulBits + 2 == pbs2->Size());
+	GPOS_ASSERT(pbs2->ContainsAll(pbs1) && pbs2->ContainsAll(pbs3));
+	GPOS_ASSERT(!pbs1->ContainsAll(pbs2));
+
+	pbs2->Difference(pbs3);
+	GPOS_ASSERT(pbs2->Equals(pbs1));
+
+	pbs2->Intersection(pbs3);
+	GPOS_ASSERT(0 == pbs2->Size());
+	GPOS_ASSERT(pbs2->IsDisjoint(pbs1));
+
+	CBitSet *pbs4 = GPOS_NEW(mp) CBitSet(mp, *pbs1);
+	GPOS_ASSERT(pbs4->Equals(pbs1));
+	(void) pbs4->ExchangeClear(100000);
+	(void) pbs4->ExchangeClear(3);
+	pbs1->Intersection(pbs4);
+	GPOS_ASSERT(pbs1->Equals(pbs4));
+	GPOS_ASSERT(ulBits - 2 == pbs1->Size());
+
+	// a set kept as a range and a set kept as links compare equal, and
+	// both hash like the bitvectors of the links
+	CBitSet *pbs5 = GPOS_NEW(mp) CBitSet(mp);
+	(void) pbs5->ExchangeSet(3);
+	(void) pbs5->ExchangeSet(70);
+	CBitSet *pbs6 = GPOS_NEW(mp) CBitSet(mp);
+	(void) pbs6->ExchangeSet(1000000);
+	(void) pbs6->ExchangeSet(70);
+	(void) pbs6->ExchangeSet(3);
+	(void) pbs6->ExchangeClear(1000000);
+	GPOS_ASSERT(pbs5->Equals(pbs6) && pbs6->Equals(pbs5));
+
+	CBitVector bv(mp, 256);
+	(void) bv.ExchangeSet(3);
+	(void) bv.ExchangeSet(70);
+	GPOS_ASSERT(gpos::CombineHashes(0, bv.HashValue()) == pbs5->HashValue());
+	GPOS_ASSERT(pbs5->HashValue() == pbs6->HashValue());
+
+	// operations between the two forms
+	GPOS_ASSERT(!pbs5->IsDisjoint(pbs1) && !pbs1->IsDisjoint(pbs5));
+	pbs6->Intersection(pbs1);
+	GPOS_ASSERT(1 == pbs6->Size() && pbs6->Get(70));
+	pbs5->Union(pbs1);
+	GPOS_ASSERT(ulBits - 1 == pbs5->Size());
+	GPOS_ASSERT(pbs5->ContainsAll(pbs1) && pbs5->Get(3));
+	pbs5->Difference(pbs1);
+	GPOS_ASSERT(1 == pbs5->Size() && pbs5->Get(3));
+
+	pbs1->Release();
+	pbs2->Release();
+	pbs3->Release();
+	pbs4->Release();
+	pbs5->Release();
+	pbs6->Release();
+
+	return GPOS_OK;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CBitSetTest::EresUnittest_Performance
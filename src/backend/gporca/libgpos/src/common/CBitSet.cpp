@@ -8,12 +8,20 @@
 //	@doc:
 //		Implementation of bit sets
 //
-//		Underlying assumption: a set contains only a few links of bitvectors
+//		Underlying assumption: the elements of a set are clustered, as
+//		column ids of the same relation are, hence keeping a single range of
+//		words from the lowest to the highest set bit is compact; set
+//		operations then become straight loops over words without any
+//		per-chunk allocation or list walking;
+//
+//		Sets whose elements are too far apart for that fall back to a
+//		linked list of bitvectors; a set contains only a few such links
 //		hence, keeping them in a linked list is efficient;
 //---------------------------------------------------------------------------
 
 #include "gpos/base.h"
 #include "gpos/common/CAutoRef.h"
+#include "gpos/common/CAutoRg.h"
 #include "gpos/common/CBitSet.h"
 #include "gpos/common/CBitSetIter.h"
 
@@ -23,6 +31,61 @@
 
 using namespace gpos;
 
+#define BITS_PER_WORD (8 * GPOS_SIZEOF(ULLONG))
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CountBits
+//
+//	@doc:
+//		Number of set bits in a word
+//
+//---------------------------------------------------------------------------
+static inline ULONG
+CountBits(ULLONG word)
+{
+#if defined(__GNUC__)
+	return (ULONG) __builtin_popcountll(word);
+#else
+	ULONG nbits = 0;
+	for (; word != 0; nbits++)
+	{
+		word &= (word - 1);
+	}
+
+	return nbits;
+#endif
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		LowestBit
+//
+//	@doc:
+//		Position of the lowest set bit of a non-zero word
+//
+//---------------------------------------------------------------------------
+static inline ULONG
+LowestBit(ULLONG word)
+{
+	GPOS_ASSERT(0 != word);
+
+#if defined(__GNUC__)
+	return (ULONG) __builtin_ctzll(word);
+#else
+	ULONG bit = 0;
+	while (0 == (word & (ULLONG) 1))
+	{
+		word >>= 1;
+		bit++;
+	}
+
+	return bit;
+#endif
+}
+
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -69,6 +132,176 @@ CBitSet::CBitSetLink::~CBitSetLink()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::IsDenseRange
+//
+//	@doc:
+//		Check if a range of the given number of words is dense enough to
+//		hold the given number of elements; ranges no larger than a single
+//		bitvector always are
+//
+//---------------------------------------------------------------------------
+BOOL
+CBitSet::IsDenseRange(ULONG len, ULONG size) const
+{
+	ULONG min_len = (m_vector_size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	if (min_len < InlineWords)
+	{
+		min_len = InlineWords;
+	}
+
+	return len <= min_len || len <= size * MaxDenseWordsPerBit;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::Extend
+//
+//	@doc:
+//		Extend the range of words to cover the given word indexes; existing
+//		words are moved in place when there is room, otherwise the range is
+//		copied into a larger array
+//
+//---------------------------------------------------------------------------
+void
+CBitSet::Extend(ULONG first_idx, ULONG last_idx)
+{
+	GPOS_ASSERT(!m_is_linked);
+	GPOS_ASSERT(first_idx <= last_idx);
+
+	if (0 == m_len)
+	{
+		m_base = first_idx;
+	}
+
+	ULONG new_base = std::min(m_base, first_idx);
+	ULONG new_end = std::max(m_base + m_len, last_idx + 1);
+
+	if (new_base == m_base && new_end == m_base + m_len)
+	{
+		return;
+	}
+
+	ULONG new_len = new_end - new_base;
+	ULONG shift = m_base - new_base;
+	ULLONG *words = m_words;
+	ULONG capacity = m_capacity;
+
+	if (new_len > m_capacity)
+	{
+		capacity = std::max(new_len, 2 * m_capacity);
+		words = GPOS_NEW_ARRAY(m_mp, ULLONG, capacity);
+	}
+
+	// copy from the end since regions overlap when moving in place
+	for (ULONG i = m_len; i > 0; i--)
+	{
+		words[shift + i - 1] = m_words[i - 1];
+	}
+	for (ULONG i = 0; i < shift; i++)
+	{
+		words[i] = 0;
+	}
+	for (ULONG i = shift + m_len; i < new_len; i++)
+	{
+		words[i] = 0;
+	}
+
+	if (words != m_words)
+	{
+		if (m_words != m_inline_words)
+		{
+			GPOS_DELETE_ARRAY(m_words);
+		}
+		m_words = words;
+		m_capacity = capacity;
+	}
+
+	m_base = new_base;
+	m_len = new_len;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::Trim
+//
+//	@doc:
+//		Drop zero words at both ends of the range
+//
+//---------------------------------------------------------------------------
+void
+CBitSet::Trim()
+{
+	ULONG first = 0;
+	while (first < m_len && 0 == m_words[first])
+	{
+		first++;
+	}
+
+	if (first == m_len)
+	{
+		m_len = 0;
+		return;
+	}
+
+	ULONG end = m_len;
+	while (0 == m_words[end - 1])
+	{
+		end--;
+	}
+
+	if (0 < first)
+	{
+		for (ULONG i = first; i < end; i++)
+		{
+			m_words[i - first] = m_words[i];
+		}
+	}
+
+	m_base += first;
+	m_len = end - first;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::ConvertToLinked
+//
+//	@doc:
+//		Move all elements of the range into links; the set stays linked
+//		until it is cleared
+//
+//---------------------------------------------------------------------------
+void
+CBitSet::ConvertToLinked()
+{
+	GPOS_ASSERT(!m_is_linked);
+
+	m_is_linked = true;
+	m_size = 0;
+
+	for (ULONG i = 0; i < m_len; i++)
+	{
+		for (ULLONG word = m_words[i]; 0 != word; word &= (word - 1))
+		{
+			(void) LinkedExchangeSet((m_base + i) * BITS_PER_WORD +
+									 LowestBit(word));
+		}
+	}
+
+	m_len = 0;
+	if (m_words != m_inline_words)
+	{
+		GPOS_DELETE_ARRAY(m_words);
+		m_words = m_inline_words;
+		m_capacity = InlineWords;
+	}
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CBitSet::FindLinkByOffset
@@ -117,23 +350,107 @@ CBitSet::FindLinkByOffset(ULONG offset, CBitSetLink *bsl) const
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::LinkedExchangeSet
+//
+//	@doc:
+//		Set given bit in the links; return previous value; allocate new link
+//		if necessary
+//
+//---------------------------------------------------------------------------
+BOOL
+CBitSet::LinkedExchangeSet(ULONG pos)
+{
+	GPOS_ASSERT(m_is_linked);
+
+	ULONG offset = ComputeOffset(pos);
+
+	CBitSetLink *bsl = FindLinkByOffset(offset);
+	if (NULL == bsl || bsl->GetOffset() != offset)
+	{
+		CBitSetLink *pbsl_new =
+			GPOS_NEW(m_mp) CBitSetLink(m_mp, offset, m_vector_size);
+		if (NULL == bsl)
+		{
+			m_bsllist.Prepend(pbsl_new);
+		}
+		else
+		{
+			// insert after found link
+			m_bsllist.Append(pbsl_new, bsl);
+		}
+
+		bsl = pbsl_new;
+	}
+
+	GPOS_ASSERT(bsl->GetOffset() == offset);
+
+	BOOL bit = bsl->GetVec()->ExchangeSet(pos - offset);
+	if (!bit)
+	{
+		m_size++;
+	}
+
+	return bit;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::RemoveEmptyLinks
+//
+//	@doc:
+//		Release links that have no bits set
+//
+//---------------------------------------------------------------------------
+void
+CBitSet::RemoveEmptyLinks()
+{
+	CBitSetLink *bsl = m_bsllist.First();
+
+	while (NULL != bsl)
+	{
+		CBitSetLink *bsl_to_remove = bsl;
+		bsl = m_bsllist.Next(bsl);
+
+		if (bsl_to_remove->GetVec()->IsEmpty())
+		{
+			m_bsllist.Remove(bsl_to_remove);
+			GPOS_DELETE(bsl_to_remove);
+		}
+	}
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CBitSet::RecomputeSize
 //
 //	@doc:
-//		Compute size of set by adding up sizes of links
+//		Compute size of set by counting the bits of all words, or by adding
+//		up sizes of links
 //
 //---------------------------------------------------------------------------
 void
 CBitSet::RecomputeSize()
 {
 	m_size = 0;
-	CBitSetLink *bsl = NULL;
 
-	for (bsl = m_bsllist.First(); bsl != NULL; bsl = m_bsllist.Next(bsl))
+	if (m_is_linked)
+	{
+		CBitSetLink *bsl = NULL;
+		for (bsl = m_bsllist.First(); bsl != NULL; bsl = m_bsllist.Next(bsl))
+		{
+			m_size += bsl->GetVec()->CountSetBits();
+		}
+
+		return;
+	}
+
+	for (ULONG i = 0; i < m_len; i++)
 	{
-		m_size += bsl->GetVec()->CountSetBits();
+		m_size += CountBits(m_words[i]);
 	}
 }
 
@@ -143,7 +460,7 @@ CBitSet::RecomputeSize()
 //		CBitSet::Clear
 //
 //	@doc:
-//		release all links
+//		release all links and empty the range; the words are kept for reuse
 //
 //---------------------------------------------------------------------------
 void
@@ -153,14 +470,13 @@ CBitSet::Clear()
 
 	while (NULL != (bsl = m_bsllist.First()))
 	{
-		CBitSetLink *bsl_to_remove = bsl;
-		bsl = m_bsllist.Next(bsl);
-
-		m_bsllist.Remove(bsl_to_remove);
-		GPOS_DELETE(bsl_to_remove);
+		m_bsllist.Remove(bsl);
+		GPOS_DELETE(bsl);
 	}
 
-	RecomputeSize();
+	m_is_linked = false;
+	m_len = 0;
+	m_size = 0;
 }
 
 
@@ -179,6 +495,49 @@ CBitSet::ComputeOffset(ULONG ul) const
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::GetNextSetBit
+//
+//	@doc:
+//		Find first set bit of the range at or after given position
+//
+//---------------------------------------------------------------------------
+BOOL
+CBitSet::GetNextSetBit(ULONG start_pos, ULONG &next_pos) const
+{
+	GPOS_ASSERT(!m_is_linked);
+
+	ULONG idx = start_pos / BITS_PER_WORD;
+	ULONG offset = start_pos % BITS_PER_WORD;
+
+	if (idx < m_base)
+	{
+		idx = m_base;
+		offset = 0;
+	}
+
+	for (; idx < m_base + m_len; idx++)
+	{
+		ULLONG word = m_words[idx - m_base];
+
+		// the initial offset applies only to the first word
+		if (0 < offset)
+		{
+			word &= ~(ULLONG) 0 << offset;
+			offset = 0;
+		}
+
+		if (0 != word)
+		{
+			next_pos = idx * BITS_PER_WORD + LowestBit(word);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -189,8 +548,17 @@ CBitSet::ComputeOffset(ULONG ul) const
 //
 //---------------------------------------------------------------------------
 CBitSet::CBitSet(CMemoryPool *mp, ULONG vector_size)
-	: m_mp(mp), m_vector_size(vector_size), m_size(0)
+	: m_words(m_inline_words),
+	  m_base(0),
+	  m_len(0),
+	  m_capacity(InlineWords),
+	  m_is_linked(false),
+	  m_mp(mp),
+	  m_vector_size(vector_size),
+	  m_size(0)
 {
+	GPOS_ASSERT(0 < vector_size);
+
 	m_bsllist.Init(GPOS_OFFSET(CBitSetLink, m_link));
 }
 
@@ -204,7 +572,14 @@ CBitSet::CBitSet(CMemoryPool *mp, ULONG vector_size)
 //
 //---------------------------------------------------------------------------
 CBitSet::CBitSet(CMemoryPool *mp, const CBitSet &bs)
-	: m_mp(mp), m_vector_size(bs.m_vector_size), m_size(0)
+	: m_words(m_inline_words),
+	  m_base(0),
+	  m_len(0),
+	  m_capacity(InlineWords),
+	  m_is_linked(false),
+	  m_mp(mp),
+	  m_vector_size(bs.m_vector_size),
+	  m_size(0)
 {
 	m_bsllist.Init(GPOS_OFFSET(CBitSetLink, m_link));
 	Union(&bs);
@@ -222,6 +597,11 @@ CBitSet::CBitSet(CMemoryPool *mp, const CBitSet &bs)
 CBitSet::~CBitSet()
 {
 	Clear();
+
+	if (m_words != m_inline_words)
+	{
+		GPOS_DELETE_ARRAY(m_words);
+	}
 }
 
 
@@ -236,15 +616,22 @@ CBitSet::~CBitSet()
 BOOL
 CBitSet::Get(ULONG pos) const
 {
-	ULONG offset = ComputeOffset(pos);
-
-	CBitSetLink *bsl = FindLinkByOffset(offset);
-	if (NULL != bsl && bsl->GetOffset() == offset)
+	if (m_is_linked)
 	{
-		return bsl->GetVec()->Get(pos - offset);
+		ULONG offset = ComputeOffset(pos);
+
+		CBitSetLink *bsl = FindLinkByOffset(offset);
+		if (NULL != bsl && bsl->GetOffset() == offset)
+		{
+			return bsl->GetVec()->Get(pos - offset);
+		}
+
+		return false;
 	}
 
-	return false;
+	ULLONG mask = ((ULLONG) 1) << (pos % BITS_PER_WORD);
+
+	return 0 != (GetWord(pos / BITS_PER_WORD) & mask);
 }
 
 
@@ -253,37 +640,48 @@ CBitSet::Get(ULONG pos) const
 //		CBitSet::ExchangeSet
 //
 //	@doc:
-//		Set given bit; return previous value; allocate new link if necessary
+//		Set given bit; return previous value; extend the range if that keeps
+//		it dense enough, otherwise switch to links
 //
 //---------------------------------------------------------------------------
 BOOL
 CBitSet::ExchangeSet(ULONG pos)
 {
-	ULONG offset = ComputeOffset(pos);
-
-	CBitSetLink *bsl = FindLinkByOffset(offset);
-	if (NULL == bsl || bsl->GetOffset() != offset)
+	if (!m_is_linked)
 	{
-		CBitSetLink *pbsl_new =
-			GPOS_NEW(m_mp) CBitSetLink(m_mp, offset, m_vector_size);
-		if (NULL == bsl)
-		{
-			m_bsllist.Prepend(pbsl_new);
-		}
-		else
+		ULONG idx = pos / BITS_PER_WORD;
+
+		if (0 == m_len || idx < m_base || idx >= m_base + m_len)
 		{
-			// insert after found link
-			m_bsllist.Append(pbsl_new, bsl);
+			ULONG new_len = 1;
+			if (0 < m_len)
+			{
+				new_len = std::max(m_base + m_len, idx + 1) -
+						  std::min(m_base, idx);
+			}
+
+			if (IsDenseRange(new_len, m_size + 1))
+			{
+				Extend(idx, idx);
+			}
+			else
+			{
+				ConvertToLinked();
+			}
 		}
-
-		bsl = pbsl_new;
 	}
 
-	GPOS_ASSERT(bsl->GetOffset() == offset);
+	if (m_is_linked)
+	{
+		return LinkedExchangeSet(pos);
+	}
 
-	BOOL bit = bsl->GetVec()->ExchangeSet(pos - offset);
+	ULLONG mask = ((ULLONG) 1) << (pos % BITS_PER_WORD);
+	ULLONG *word = &m_words[pos / BITS_PER_WORD - m_base];
+	BOOL bit = (0 != (*word & mask));
 	if (!bit)
 	{
+		*word |= mask;
 		m_size++;
 	}
 
@@ -302,29 +700,52 @@ CBitSet::ExchangeSet(ULONG pos)
 BOOL
 CBitSet::ExchangeClear(ULONG pos)
 {
-	ULONG offset = ComputeOffset(pos);
-
-	CBitSetLink *bsl = FindLinkByOffset(offset);
-	if (NULL != bsl && bsl->GetOffset() == offset)
+	if (m_is_linked)
 	{
-		BOOL bit = bsl->GetVec()->ExchangeClear(pos - offset);
+		ULONG offset = ComputeOffset(pos);
 
-		// remove empty link
-		if (bsl->GetVec()->IsEmpty())
+		CBitSetLink *bsl = FindLinkByOffset(offset);
+		if (NULL != bsl && bsl->GetOffset() == offset)
 		{
-			m_bsllist.Remove(bsl);
-			GPOS_DELETE(bsl);
-		}
+			BOOL bit = bsl->GetVec()->ExchangeClear(pos - offset);
 
-		if (bit)
-		{
-			m_size--;
+			// remove empty link
+			if (bsl->GetVec()->IsEmpty())
+			{
+				m_bsllist.Remove(bsl);
+				GPOS_DELETE(bsl);
+			}
+
+			if (bit)
+			{
+				m_size--;
+			}
+
+			return bit;
 		}
 
-		return bit;
+		return false;
 	}
 
-	return false;
+	ULONG idx = pos / BITS_PER_WORD;
+	ULLONG mask = ((ULLONG) 1) << (pos % BITS_PER_WORD);
+
+	if (0 == (GetWord(idx) & mask))
+	{
+		return false;
+	}
+
+	m_words[idx - m_base] &= ~mask;
+	m_size--;
+
+	// keep the range tight when clearing its first or last word
+	if (0 == m_words[idx - m_base] &&
+		(idx == m_base || idx == m_base + m_len - 1))
+	{
+		Trim();
+	}
+
+	return true;
 }
 
 
@@ -334,6 +755,9 @@ CBitSet::ExchangeClear(ULONG pos)
 //
 //	@doc:
 //		Union with given other set;
+//		if both sets are ranges and the union is dense enough, extend the
+//		range to cover the other set's range, then OR word by word;
+//		otherwise union the links:
 //		(1) determine which links need to be allocated before(!) modifying
 //			the set allocate and copy missing links aside
 //		(2) insert the new links into the list
@@ -345,6 +769,53 @@ CBitSet::ExchangeClear(ULONG pos)
 void
 CBitSet::Union(const CBitSet *pbsOther)
 {
+	if (0 == pbsOther->m_size)
+	{
+		return;
+	}
+
+	if (!m_is_linked && !pbsOther->m_is_linked)
+	{
+		ULONG first = pbsOther->m_base;
+		ULONG end = pbsOther->m_base + pbsOther->m_len;
+		if (0 < m_len)
+		{
+			first = std::min(first, m_base);
+			end = std::max(end, m_base + m_len);
+		}
+
+		if (IsDenseRange(end - first, m_size + pbsOther->m_size))
+		{
+			Extend(pbsOther->m_base, pbsOther->m_base + pbsOther->m_len - 1);
+
+			ULLONG *words = m_words + (pbsOther->m_base - m_base);
+			const ULLONG *other_words = pbsOther->m_words;
+			for (ULONG i = 0; i < pbsOther->m_len; i++)
+			{
+				words[i] |= other_words[i];
+			}
+
+			RecomputeSize();
+			return;
+		}
+	}
+
+	if (!m_is_linked)
+	{
+		ConvertToLinked();
+	}
+
+	if (!pbsOther->m_is_linked)
+	{
+		CBitSetIter bsiter(*pbsOther);
+		while (bsiter.Advance())
+		{
+			(void) LinkedExchangeSet(bsiter.Bit());
+		}
+
+		return;
+	}
+
 	CBitSetLink *bsl = NULL;
 	CBitSetLink *bsl_other = NULL;
 
@@ -412,7 +883,8 @@ CBitSet::Union(const CBitSet *pbsOther)
 //		CBitSet::Intersection
 //
 //	@doc:
-//		Iterate through all links and intersect them; release unused links
+//		AND word by word, or link by link; words outside the other set's
+//		range are cleared and unused links are released
 //
 //---------------------------------------------------------------------------
 void
@@ -423,6 +895,33 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 		return;
 	}
 
+	if (!m_is_linked)
+	{
+		for (ULONG i = 0; i < m_len; i++)
+		{
+			if (!pbsOther->m_is_linked)
+			{
+				m_words[i] &= pbsOther->GetWord(m_base + i);
+				continue;
+			}
+
+			ULLONG keep = 0;
+			for (ULLONG word = m_words[i]; 0 != word; word &= (word - 1))
+			{
+				ULONG bit = LowestBit(word);
+				if (pbsOther->Get((m_base + i) * BITS_PER_WORD + bit))
+				{
+					keep |= ((ULLONG) 1) << bit;
+				}
+			}
+			m_words[i] = keep;
+		}
+
+		Trim();
+		RecomputeSize();
+		return;
+	}
+
 	CBitSetLink *bsl_other = NULL;
 	CBitSetLink *bsl = m_bsllist.First();
 
@@ -430,6 +929,22 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 	{
 		CBitSetLink *bsl_to_remove = NULL;
 
+		if (!pbsOther->m_is_linked)
+		{
+			CBitVector *vec = bsl->GetVec();
+			ULONG bit = 0;
+			while (bit < m_vector_size && vec->GetNextSetBit(bit, bit))
+			{
+				if (!pbsOther->Get(bsl->GetOffset() + bit))
+				{
+					(void) vec->ExchangeClear(bit);
+				}
+				bit++;
+			}
+			bsl = m_bsllist.Next(bsl);
+			continue;
+		}
+
 		bsl_other = pbsOther->FindLinkByOffset(bsl->GetOffset(), bsl_other);
 		if (NULL != bsl_other && bsl_other->GetOffset() == bsl->GetOffset())
 		{
@@ -446,6 +961,7 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 		}
 	}
 
+	RemoveEmptyLinks();
 	RecomputeSize();
 }
 
@@ -455,13 +971,42 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 //		CBitSet::Difference
 //
 //	@doc:
-//		Substract other set from this by iterating through other set and
-//		explicit removal of elements;
+//		Substract other set from this word by word over the overlapping
+//		part of the ranges; for links, iterate through other set and
+//		explicitly remove its elements
 //
 //---------------------------------------------------------------------------
 void
 CBitSet::Difference(const CBitSet *pbs)
 {
+	if (this == pbs)
+	{
+		Clear();
+		return;
+	}
+
+	if (!m_is_linked && !pbs->m_is_linked)
+	{
+		ULONG first = std::max(m_base, pbs->m_base);
+		ULONG end = std::min(m_base + m_len, pbs->m_base + pbs->m_len);
+
+		if (first >= end)
+		{
+			return;
+		}
+
+		ULLONG *words = m_words + (first - m_base);
+		const ULLONG *other_words = pbs->m_words + (first - pbs->m_base);
+		for (ULONG i = 0; i < end - first; i++)
+		{
+			words[i] &= ~other_words[i];
+		}
+
+		Trim();
+		RecomputeSize();
+		return;
+	}
+
 	if (IsDisjoint(pbs))
 	{
 		return;
@@ -492,6 +1037,34 @@ CBitSet::ContainsAll(const CBitSet *bs) const
 		return false;
 	}
 
+	if (!m_is_linked && !bs->m_is_linked)
+	{
+		for (ULONG i = 0; i < bs->m_len; i++)
+		{
+			ULLONG other_word = bs->m_words[i];
+			if (0 != (other_word & ~GetWord(bs->m_base + i)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	if (!m_is_linked || !bs->m_is_linked)
+	{
+		CBitSetIter bsiter(*bs);
+		while (bsiter.Advance())
+		{
+			if (!Get(bsiter.Bit()))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	CBitSetLink *bsl = NULL;
 	CBitSetLink *bsl_other = NULL;
 
@@ -535,23 +1108,8 @@ CBitSet::Equals(const CBitSet *bs) const
 		return false;
 	}
 
-	CBitSetLink *bsl = m_bsllist.First();
-	CBitSetLink *bsl_other = bs->m_bsllist.First();
-
-	while (NULL != bsl)
-	{
-		if (NULL == bsl_other || bsl->GetOffset() != bsl_other->GetOffset() ||
-			!bsl->GetVec()->Equals(bsl_other->GetVec()))
-		{
-			return false;
-		}
-
-		bsl = m_bsllist.Next(bsl);
-		bsl_other = bs->m_bsllist.Next(bsl_other);
-	}
-
-	// same length implies bsl_other must have reached end as well
-	return bsl_other == NULL;
+	// with equal sizes, every bit of the other set being set here suffices
+	return ContainsAll(bs);
 }
 
 
@@ -567,6 +1125,36 @@ CBitSet::Equals(const CBitSet *bs) const
 BOOL
 CBitSet::IsDisjoint(const CBitSet *bs) const
 {
+	if (!m_is_linked && !bs->m_is_linked)
+	{
+		ULONG first = std::max(m_base, bs->m_base);
+		ULONG end = std::min(m_base + m_len, bs->m_base + bs->m_len);
+
+		for (ULONG idx = first; idx < end; idx++)
+		{
+			if (0 != (m_words[idx - m_base] & bs->m_words[idx - bs->m_base]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	if (!m_is_linked || !bs->m_is_linked)
+	{
+		CBitSetIter bsiter(*bs);
+		while (bsiter.Advance())
+		{
+			if (Get(bsiter.Bit()))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	CBitSetLink *bsl = NULL;
 	CBitSetLink *bsl_other = NULL;
 
@@ -592,7 +1180,9 @@ CBitSet::IsDisjoint(const CBitSet *bs) const
 //		CBitSet::HashValue
 //
 //	@doc:
-//		Compute hash value for set
+//		Compute hash value for set by combining the hash values of its
+//		bitvectors; for a range, the bitvectors the set would have as links
+//		are hashed, so that equal sets hash alike in either form
 //
 //---------------------------------------------------------------------------
 ULONG
@@ -600,11 +1190,55 @@ CBitSet::HashValue() const
 {
 	ULONG ulHash = 0;
 
-	CBitSetLink *bsl = m_bsllist.First();
-	while (NULL != bsl)
+	if (m_is_linked)
 	{
-		ulHash = gpos::CombineHashes(ulHash, bsl->GetVec()->HashValue());
-		bsl = m_bsllist.Next(bsl);
+		CBitSetLink *bsl = m_bsllist.First();
+		while (NULL != bsl)
+		{
+			ulHash = gpos::CombineHashes(ulHash, bsl->GetVec()->HashValue());
+			bsl = m_bsllist.Next(bsl);
+		}
+
+		return ulHash;
+	}
+
+	ULONG pos = 0;
+	if (!GetNextSetBit(0, pos))
+	{
+		return ulHash;
+	}
+
+	// words of a single bitvector, on the stack for the default size
+	const ULONG chunk_len = (m_vector_size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	ULLONG stack_words[4];
+	CAutoRg<ULLONG> a_rgull;
+	ULLONG *chunk = stack_words;
+	if (chunk_len > GPOS_ARRAY_SIZE(stack_words))
+	{
+		a_rgull = GPOS_NEW_ARRAY(m_mp, ULLONG, chunk_len);
+		chunk = a_rgull.Rgt();
+	}
+
+	BOOL found = true;
+	while (found)
+	{
+		ULONG offset = ComputeOffset(pos);
+		for (ULONG i = 0; i < chunk_len; i++)
+		{
+			chunk[i] = 0;
+		}
+
+		// collect the bits falling into this bitvector
+		do
+		{
+			ULONG bit = pos - offset;
+			chunk[bit / BITS_PER_WORD] |= ((ULLONG) 1) << (bit % BITS_PER_WORD);
+			found = GetNextSetBit(pos + 1, pos);
+		} while (found && pos - offset < m_vector_size);
+
+		ulHash = gpos::CombineHashes(
+			ulHash, gpos::HashByteArray((BYTE *) chunk,
+										GPOS_SIZEOF(ULLONG) * chunk_len));
 	}
 
 	return ulHash;
@@ -43,6 +43,14 @@ CBitSetIter::Advance()
 {
 	GPOS_ASSERT(m_active && "called advance on exhausted iterator");
 
+	if (!m_bs.m_is_linked)
+	{
+		// cursor starts at ULONG max so the first probe wraps around to bit 0
+		m_active = m_bs.GetNextSetBit(m_cursor + 1, m_cursor);
+
+		return m_active;
+	}
+
 	if (NULL == m_bsl)
 	{
 		m_bsl = m_bs.m_bsllist.First();
@@ -50,7 +58,7 @@ CBitSetIter::Advance()
 
 	while (NULL != m_bsl)
 	{
-		if (m_cursor + 1 <= m_bs.m_vector_size &&
+		if (m_cursor + 1 < m_bs.m_vector_size &&
 			m_bsl->GetVec()->GetNextSetBit(m_cursor + 1, m_cursor))
 		{
 			break;
@@ -76,10 +84,18 @@ CBitSetIter::Advance()
 ULONG
 CBitSetIter::Bit() const
 {
-	GPOS_ASSERT(m_active && NULL != m_bsl && "iterator uninitialized");
-	GPOS_ASSERT(m_bsl->GetVec()->Get(m_cursor));
+	GPOS_ASSERT(m_active && "iterator uninitialized");
+
+	if (NULL != m_bsl)
+	{
+		GPOS_ASSERT(m_bsl->GetVec()->Get(m_cursor));
+
+		return m_bsl->GetOffset() + m_cursor;
+	}
+
+	GPOS_ASSERT(m_bs.Get(m_cursor));
 
-	return m_bsl->GetOffset() + m_cursor;
+	return m_cursor;
 }
 
 // EOF
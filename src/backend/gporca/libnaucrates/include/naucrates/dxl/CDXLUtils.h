@@ -25,6 +25,8 @@
 
 #include "naucrates/statistics/CStatistics.h"
 
+#include <ostream>
+
 #include <xercesc/util/XMLString.hpp>
 
 namespace gpmd
@@ -83,10 +85,28 @@ public:
 	static CParseHandlerDXL *GetParseHandlerForDXLString(
 		CMemoryPool *, const CHAR *dxl_string, const CHAR *xsd_file_path);
 
-	// same as above but with DXL file name specified instead of the file contents
+	// same as above but with DXL file name specified instead of the file
+	// contents; the file may also be a binary DXL document, which is not
+	// validated
 	static CParseHandlerDXL *GetParseHandlerForDXLFile(
 		CMemoryPool *, const CHAR *dxl_filename, const CHAR *xsd_file_path);
 
+	// same as above but for a binary DXL document in memory
+	static CParseHandlerDXL *GetParseHandlerForBinaryDXL(CMemoryPool *,
+														 const BYTE *buffer,
+														 ULONG length);
+
+	// is the given file a binary DXL document
+	static BOOL IsBinaryDXLFile(const CHAR *filename);
+
+	// convert a DXL document to the binary DXL format
+	static void TranscodeXMLToBinary(CMemoryPool *, const CHAR *dxl_string,
+									 std::ostream &os);
+
+	// convert a binary DXL document to XML
+	static void TranscodeBinaryToXML(CMemoryPool *, const BYTE *buffer,
+									 ULONG length, IOstream &os);
+
 	// parse a DXL document containing a DXL plan
 	static CDXLNode *GetPlanDXLNode(CMemoryPool *, const CHAR *dxl_string,
 									const CHAR *xsd_file_path, ULLONG *plan_id,
@@ -266,7 +286,10 @@ public:
 										   const CWStringDynamic *dxl_string,
 										   ULONG *length);
 
-	static CHAR *Read(CMemoryPool *mp, const CHAR *filename);
+	// read a file into a null terminated buffer, optionally returning its
+	// length for binary files
+	static CHAR *Read(CMemoryPool *mp, const CHAR *filename,
+					  ULONG *length = NULL);
 
 	// create a multi-byte character string from a wide character string
 	static CHAR *CreateMultiByteCharStringFromWCString(CMemoryPool *mp,
@@ -0,0 +1,185 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CDXLBinaryReader.h
+//
+//	@doc:
+//		Reader of binary DXL documents
+//---------------------------------------------------------------------------
+#ifndef GPDXL_CDXLBinaryReader_H
+#define GPDXL_CDXLBinaryReader_H
+
+#include "gpos/base.h"
+#include "gpos/common/CDynamicPtrArray.h"
+
+#include <xercesc/sax2/Attributes.hpp>
+#include <xercesc/sax2/DefaultHandler.hpp>
+
+namespace gpdxl
+{
+using namespace gpos;
+
+XERCES_CPP_NAMESPACE_USE
+
+// fwd decl
+class CParseHandlerManager;
+
+// array of strings read from a binary DXL document
+typedef CDynamicPtrArray<XMLCh, CleanupDeleteArray> XMLChArray;
+
+// array of borrowed strings
+typedef CDynamicPtrArray<const XMLCh, CleanupNULL> ConstXMLChArray;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CDXLBinaryReader
+//
+//	@doc:
+//		Reads a document written by COstreamDXLBinary and replays its
+//		element, attribute and text events as SAX2 callbacks, either to the
+//		current parse handler of a parse handler manager or to a fixed
+//		handler. The parse handlers cannot tell a binary document from an
+//		XML one parsed by Xerces, except that no validation takes place.
+//
+//---------------------------------------------------------------------------
+class CDXLBinaryReader
+{
+private:
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CDXLBinaryReader::CAttributes
+	//
+	//	@doc:
+	//		Attributes of the element being started; namespace declarations
+	//		are dropped, as Xerces does
+	//
+	//---------------------------------------------------------------------------
+	class CAttributes : public Attributes
+	{
+	private:
+		// qualified names and values, the strings are not owned
+		ConstXMLChArray *m_names;
+
+		ConstXMLChArray *m_values;
+
+		// private copy ctor
+		CAttributes(const CAttributes &);
+
+	public:
+		// ctor
+		explicit CAttributes(CMemoryPool *mp);
+
+		// dtor
+		virtual ~CAttributes();
+
+		// remove all attributes
+		void Clear();
+
+		// add an attribute
+		void Add(const XMLCh *name, const XMLCh *value);
+
+		// Attributes interface
+		virtual XMLSize_t getLength() const;
+
+		virtual const XMLCh *getURI(const XMLSize_t index) const;
+
+		virtual const XMLCh *getLocalName(const XMLSize_t index) const;
+
+		virtual const XMLCh *getQName(const XMLSize_t index) const;
+
+		virtual const XMLCh *getType(const XMLSize_t index) const;
+
+		virtual const XMLCh *getValue(const XMLSize_t index) const;
+
+		virtual bool getIndex(const XMLCh *const uri,
+							  const XMLCh *const local_part,
+							  XMLSize_t &index) const;
+
+		virtual int getIndex(const XMLCh *const uri,
+							 const XMLCh *const local_part) const;
+
+		virtual bool getIndex(const XMLCh *const qname,
+							  XMLSize_t &index) const;
+
+		virtual int getIndex(const XMLCh *const qname) const;
+
+		virtual const XMLCh *getType(const XMLCh *const uri,
+									 const XMLCh *const local_part) const;
+
+		virtual const XMLCh *getType(const XMLCh *const qname) const;
+
+		virtual const XMLCh *getValue(const XMLCh *const uri,
+									  const XMLCh *const local_part) const;
+
+		virtual const XMLCh *getValue(const XMLCh *const qname) const;
+
+	};	// class CAttributes
+
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// document and its length
+	const BYTE *m_buffer;
+
+	ULONG m_length;
+
+	// offset of the next byte to read
+	ULONG m_offset;
+
+	// string table, indexed by string id minus EbdxlstrFirstId
+	XMLChArray *m_strings;
+
+	// literal strings of the record being replayed
+	XMLChArray *m_literals;
+
+	// qualified names of the open elements
+	ConstXMLChArray *m_open_elements;
+
+	// attributes of the element being started
+	CAttributes *m_attributes;
+
+	// private copy ctor
+	CDXLBinaryReader(const CDXLBinaryReader &);
+
+	// raise an error for a corrupt document
+	void RaiseCorrupt() const;
+
+	// read a byte or a varint
+	BYTE ReadByte();
+
+	ULONG ReadVarint();
+
+	// read a string; names must come from the string table
+	const XMLCh *ReadString(BOOL is_name);
+
+	// replay the document to the given manager or handler
+	void Replay(CParseHandlerManager *parse_handler_mgr,
+				DefaultHandler *handler);
+
+	// local name and namespace uri of a qualified name
+	static const XMLCh *LocalName(const XMLCh *qname);
+
+	static const XMLCh *Uri(const XMLCh *qname);
+
+public:
+	// ctor
+	CDXLBinaryReader(CMemoryPool *mp, const BYTE *buffer, ULONG length);
+
+	// dtor
+	~CDXLBinaryReader();
+
+	// replay the document to the current parse handler of the manager
+	void Parse(CParseHandlerManager *parse_handler_mgr);
+
+	// replay the document to the given handler
+	void Parse(DefaultHandler *handler);
+
+};	// class CDXLBinaryReader
+
+}  // namespace gpdxl
+
+#endif	// !GPDXL_CDXLBinaryReader_H
+
+// EOF
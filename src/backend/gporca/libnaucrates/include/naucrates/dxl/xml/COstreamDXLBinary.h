@@ -0,0 +1,257 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		COstreamDXLBinary.h
+//
+//	@doc:
+//		Output stream writing DXL documents in the binary DXL format
+//---------------------------------------------------------------------------
+#ifndef GPDXL_COstreamDXLBinary_H
+#define GPDXL_COstreamDXLBinary_H
+
+#include <ostream>
+
+#include "gpos/base.h"
+#include "gpos/common/CHashMap.h"
+#include "gpos/io/COstream.h"
+
+// magic bytes and version at the start of a binary DXL document
+#define GPDXL_BINARY_MAGIC "BDXL"
+#define GPDXL_BINARY_MAGIC_LENGTH 4
+#define GPDXL_BINARY_VERSION 1
+
+// longest attribute value or text that is added to the string table
+#define GPDXL_BINARY_MAX_INTERNED_LENGTH 64
+
+namespace gpdxl
+{
+using namespace gpos;
+
+// record types of the binary DXL format
+enum EBinaryDXLRecord
+{
+	EbdxlrecEnd = 0,		  // end of document
+	EbdxlrecStartElement,	  // element name
+	EbdxlrecAttribute,		  // attribute name and value
+	EbdxlrecEndElement,		  // closes the innermost open element
+	EbdxlrecCharacters,		  // text content
+
+	EbdxlrecSentinel
+};
+
+// string references of the binary DXL format
+enum EBinaryDXLString
+{
+	EbdxlstrNew = 0,  // a string to add to the string table follows
+	EbdxlstrLiteral,  // a string not added to the table follows
+
+	EbdxlstrFirstId	 // ids of strings in the table start here
+};
+
+//---------------------------------------------------------------------------
+//	@class:
+//		COstreamDXLBinary
+//
+//	@doc:
+//		The binary DXL format encodes the same element, attribute and text
+//		events as a DXL XML document, so any document can be converted in
+//		both directions and the same parse handlers read both formats.
+//
+//		A document is the magic bytes, a version byte and a sequence of
+//		records, each a record type byte followed by its strings. Element
+//		and attribute names, and short values, go to a string table on
+//		first use and are referenced by their id afterwards, which removes
+//		the repetition of names and metadata ids that makes up most of a
+//		DXL document. Strings are UTF-16 code units, the representation the
+//		parse handlers take. Lengths and ids are unsigned LEB128 varints.
+//
+//		DXL is written to this stream as XML text, the way it is written
+//		to any other stream, and tokenized on the fly, so the serializer and
+//		the pre-serialized metadata objects and section headers of a
+//		minidump need no changes. Documents parsed by other means can be
+//		written with the element and attribute calls below.
+//
+//---------------------------------------------------------------------------
+class COstreamDXLBinary : public COstream
+{
+private:
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		COstreamDXLBinary::CBuffer
+	//
+	//	@doc:
+	//		Null terminated character buffer that keeps its memory when it
+	//		is reset, so that tokenizing does not allocate per token
+	//
+	//---------------------------------------------------------------------------
+	class CBuffer
+	{
+	private:
+		// memory pool
+		CMemoryPool *m_mp;
+
+		// characters
+		WCHAR *m_buffer;
+
+		// number of characters, not counting the terminator
+		ULONG m_length;
+
+		// allocated size
+		ULONG m_capacity;
+
+		// private copy ctor
+		CBuffer(const CBuffer &);
+
+	public:
+		// ctor
+		explicit CBuffer(CMemoryPool *mp);
+
+		// dtor
+		~CBuffer();
+
+		// append a character
+		void Append(WCHAR wc);
+
+		// empty the buffer
+		void
+		Reset()
+		{
+			m_length = 0;
+			m_buffer[0] = WCHAR_EOS;
+		}
+
+		// null terminated content
+		const WCHAR *
+		GetBuffer() const
+		{
+			return m_buffer;
+		}
+
+		// number of characters
+		ULONG
+		Length() const
+		{
+			return m_length;
+		}
+
+	};	// class CBuffer
+
+	// states of the tokenizer for XML text written to the stream
+	enum ETokenizerState
+	{
+		EtsText,			   // between tags
+		EtsTagOpen,			   // after '<'
+		EtsStartTagName,	   // in the name of a start tag
+		EtsEndTagName,		   // in the name of an end tag
+		EtsInTag,			   // in a start tag, between attributes
+		EtsAttributeName,	   // in an attribute name
+		EtsAttributeValueStart,	 // after '=', before the quote
+		EtsAttributeValue,	   // in a quoted attribute value
+		EtsEmptyTagEnd,		   // after the '/' of an empty element tag
+		EtsSkip				   // in a declaration or comment
+	};
+
+	// hash and equality of interned strings
+	static ULONG HashString(const WCHAR *str);
+
+	static BOOL EqualStrings(const WCHAR *str, const WCHAR *other_str);
+
+	// map from interned strings to their ids
+	typedef CHashMap<WCHAR, ULONG, HashString, EqualStrings,
+					 CleanupDeleteArray<WCHAR>, CleanupDelete<ULONG> >
+		StringToIdMap;
+
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// underlying byte stream
+	std::ostream &m_os;
+
+	// string table
+	StringToIdMap *m_string_ids;
+
+	// id of the next interned string
+	ULONG m_next_string_id;
+
+	// has the end of the document been written
+	BOOL m_finished;
+
+	// tokenizer state
+	ETokenizerState m_state;
+
+	// quote character of the attribute value being read
+	WCHAR m_quote;
+
+	// element name or text being read by the tokenizer
+	CBuffer m_token;
+
+	// attribute name being read by the tokenizer
+	CBuffer m_attribute_name;
+
+	// attribute value being read by the tokenizer
+	CBuffer m_attribute_value;
+
+	// scratch buffer for decoding XML escapes
+	CBuffer m_decoded;
+
+	// private copy ctor
+	COstreamDXLBinary(const COstreamDXLBinary &);
+
+	// write an unsigned LEB128 varint
+	void WriteVarint(ULONG value);
+
+	// write a null terminated string, adding it to the string table if
+	// asked to or if it is short
+	void WriteString(const WCHAR *str, BOOL intern);
+
+	// decode the XML escapes in the given string into m_decoded
+	void Decode(const CBuffer &str);
+
+	// write the text read by the tokenizer unless it is all whitespace
+	void FlushText();
+
+	// feed one character of XML text to the tokenizer
+	void Tokenize(WCHAR wc);
+
+public:
+	// please see comments in COstream.h for an explanation
+	using COstream::operator<<;
+
+	// ctor, writes the magic bytes and the version
+	COstreamDXLBinary(CMemoryPool *mp, std::ostream &os);
+
+	// dtor, ends the document if that has not been done yet
+	virtual ~COstreamDXLBinary();
+
+	// write XML text
+	virtual IOstream &operator<<(const WCHAR *wsz);
+
+	virtual IOstream &operator<<(const WCHAR wc);
+
+	// start an element with the given qualified name
+	void StartElement(const WCHAR *name);
+
+	// add an attribute to the element just started
+	void AddAttribute(const WCHAR *name, const WCHAR *value);
+
+	// end the innermost open element
+	void EndElement();
+
+	// add text content
+	void AddCharacters(const WCHAR *text);
+
+	// end the document
+	void Finish();
+
+	// does the given buffer start with the magic bytes
+	static BOOL IsBinaryDXL(const BYTE *buffer, ULONG length);
+
+};	// class COstreamDXLBinary
+
+}  // namespace gpdxl
+
+#endif	// !GPDXL_COstreamDXLBinary_H
+
+// EOF
@@ -130,6 +130,9 @@ public:
 	// add a byte array attribute
 	void AddAttribute(const CWStringBase *pstrAttr, BOOL is_null,
 					  const BYTE *data, ULONG length);
+
+	// adds text content to the currently open element
+	void AddCharacters(const CWStringBase *str);
 };
 
 }  // namespace gpdxl
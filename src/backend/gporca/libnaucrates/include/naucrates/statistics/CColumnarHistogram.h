@@ -0,0 +1,161 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CColumnarHistogram.h
+//
+//	@doc:
+//		Compact columnar view of the buckets of a histogram whose bounds
+//		map to numbers
+//---------------------------------------------------------------------------
+#ifndef GPNAUCRATES_CColumnarHistogram_H
+#define GPNAUCRATES_CColumnarHistogram_H
+
+#include "gpos/base.h"
+#include "gpos/common/CDouble.h"
+
+#include "naucrates/statistics/CBucket.h"
+
+namespace gpnaucrates
+{
+using namespace gpos;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CColumnarHistogram
+//
+//	@doc:
+//		Parallel arrays of the mapped lower and upper bounds, frequencies and
+//		NDVs of a sorted bucket array. Searching these arrays answers "which
+//		buckets can possibly contain this point / overlap that bucket"
+//		without going through CPoint and IDatum for every bucket. Only the
+//		strict comparisons are answered here; callers fall back to the
+//		CBucket methods for anything that is close enough to be ambiguous,
+//		so results are identical to a plain scan of the buckets.
+//
+//---------------------------------------------------------------------------
+class CColumnarHistogram
+{
+private:
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// number of buckets
+	ULONG m_num_buckets;
+
+	// were the bounds mapped to LINT (exact comparison) or to double
+	BOOL m_is_lint;
+
+	// tolerance for equality of double mapped bounds
+	DOUBLE m_epsilon;
+
+	// mapped lower bounds
+	DOUBLE *m_lower;
+
+	// mapped upper bounds
+	DOUBLE *m_upper;
+
+	// bucket frequencies
+	DOUBLE *m_freq;
+
+	// bucket NDVs
+	DOUBLE *m_ndv;
+
+	// private ctor
+	CColumnarHistogram(CMemoryPool *mp, ULONG num_buckets, BOOL is_lint);
+
+	// private copy ctor
+	CColumnarHistogram(const CColumnarHistogram &);
+
+	// map a datum the same way IDatum's stats comparisons do
+	static BOOL MapDatum(const IDatum *datum, BOOL is_lint, DOUBLE *value);
+
+	// equality as done by IDatum::StatsAreEqual on mapped values
+	BOOL
+	AreEqual(DOUBLE value1, DOUBLE value2) const
+	{
+		if (m_is_lint)
+		{
+			return value1 == value2;
+		}
+
+		return fabs(value1 - value2) <= m_epsilon;
+	}
+
+	// is value1 below value2 and not equal to it
+	BOOL
+	IsStrictlyBelow(DOUBLE value1, DOUBLE value2) const
+	{
+		return value1 < value2 && !AreEqual(value1, value2);
+	}
+
+public:
+	// dtor
+	~CColumnarHistogram();
+
+	// build the columnar view; returns NULL if the buckets do not qualify
+	static CColumnarHistogram *Create(CMemoryPool *mp,
+									  const CBucketArray *buckets);
+
+	// number of buckets
+	ULONG
+	Size() const
+	{
+		return m_num_buckets;
+	}
+
+	// can the buckets of the two views be compared with each other
+	BOOL
+	IsComparable(const CColumnarHistogram *other) const
+	{
+		return m_is_lint == other->m_is_lint;
+	}
+
+	// map a point for searching; returns false if it cannot be compared
+	BOOL MapPoint(const CPoint *point, DOUBLE *value) const;
+
+	// first bucket at or after start whose upper bound is not strictly
+	// below value; buckets before it can neither contain nor follow value
+	ULONG FirstBucketNotBelow(DOUBLE value, ULONG start) const;
+
+	// first bucket at or after start whose lower bound is strictly above
+	// value; neither it nor any later bucket can contain value
+	ULONG FirstBucketAbove(DOUBLE value, ULONG start) const;
+
+	// first bucket at or after start that does not end strictly before
+	// the given bucket of another view begins
+	ULONG
+	FirstBucketNotBefore(const CColumnarHistogram *other, ULONG other_idx,
+						 ULONG start) const
+	{
+		GPOS_ASSERT(IsComparable(other));
+		GPOS_ASSERT(other_idx < other->m_num_buckets);
+
+		return FirstBucketNotBelow(other->m_lower[other_idx], start);
+	}
+
+	// does the given bucket end strictly before the other view's bucket
+	BOOL
+	IsBefore(ULONG idx, const CColumnarHistogram *other, ULONG other_idx) const
+	{
+		GPOS_ASSERT(IsComparable(other));
+		GPOS_ASSERT(idx < m_num_buckets);
+		GPOS_ASSERT(other_idx < other->m_num_buckets);
+
+		return IsStrictlyBelow(m_upper[idx], other->m_lower[other_idx]);
+	}
+
+	// sum of bucket frequencies
+	CDouble GetFrequency() const;
+
+	// sum of bucket NDVs
+	CDouble GetNumDistinct() const;
+
+};	// class CColumnarHistogram
+
+}  // namespace gpnaucrates
+
+#endif	// !GPNAUCRATES_CColumnarHistogram_H
+
+// EOF
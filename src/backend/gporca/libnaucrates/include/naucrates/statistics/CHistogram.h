@@ -14,6 +14,7 @@
 #include "gpos/base.h"
 #include "gpopt/base/CKHeap.h"
 #include "naucrates/statistics/CBucket.h"
+#include "naucrates/statistics/CColumnarHistogram.h"
 #include "naucrates/statistics/CStatsPred.h"
 
 namespace gpopt
@@ -95,6 +96,13 @@ private:
 	// is column statistics missing in the database
 	BOOL m_is_col_stats_missing;
 
+	// columnar view of the buckets, built on first use by the filter,
+	// join and union code paths
+	mutable CColumnarHistogram *m_columnar_histogram;
+
+	// was building the columnar view attempted
+	mutable BOOL m_columnar_histogram_built;
+
 	// private copy ctor
 	CHistogram(const CHistogram &);
 
@@ -141,6 +149,24 @@ private:
 	// accessor for n-th bucket
 	CBucket *operator[](ULONG) const;
 
+	// columnar view of the buckets; NULL if the buckets do not qualify
+	const CColumnarHistogram *GetColumnarHistogram() const;
+
+	// drop the columnar view after the buckets were replaced
+	void ResetColumnarHistogram();
+
+	// range of buckets that may contain the point; buckets before begin
+	// lie entirely below the point and buckets from end on entirely above
+	void GetCandidateBuckets(const CPoint *point, ULONG *begin,
+							 ULONG *end) const;
+
+	// is the current bucket of one union input clearly before the current
+	// bucket of the other input
+	static BOOL IsBucketBefore(const CColumnarHistogram *columnar1, ULONG idx1,
+							   BOOL bucket1_is_residual,
+							   const CColumnarHistogram *columnar2, ULONG idx2,
+							   BOOL bucket2_is_residual);
+
 	// compute skew estimate
 	void ComputeSkew();
 
@@ -365,6 +391,7 @@ public:
 	virtual ~CHistogram()
 	{
 		m_histogram_buckets->Release();
+		GPOS_DELETE(m_columnar_histogram);
 	}
 
 	// normalize histogram and return scaling factor
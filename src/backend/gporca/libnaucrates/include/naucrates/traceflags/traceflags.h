@@ -213,6 +213,18 @@ enum EOptTraceFlag
 	// Use legacy (cdbhash) opfamilies for compatibility
 	EopttraceUseLegacyOpfamilies = 103039,
 
+	// write minidumps in the binary DXL format
+	EopttraceBinaryMinidump = 103040,
+
+	// collect a profile of xforms, jobs and memo growth per search stage
+	EopttraceProfileOptimization = 103041,
+
+	// Propagate upper cost bounds to child optimization contexts
+	EopttraceEnableCostBoundPropagation = 103042,
+
+	// share identical subtrees of union inputs through CTEs
+	EopttraceEnableSubexpressionSharing = 103043,
+
 	///////////////////////////////////////////////////////
 	///////////////////// statistics flags ////////////////
 	//////////////////////////////////////////////////////
@@ -240,6 +252,10 @@ enum EOptTraceFlag
 
 	// Use calibrated bitmap index cost model
 	EopttraceCalibratedBitmapIndexCostModel = 104007,
+
+	// do not reuse join statistics derived for the same atoms and predicates
+	EopttraceDisableJoinStatsCache = 104008,
+
 	///////////////////////////////////////////////////////
 	/////////// constant expression evaluator flags ///////
 	///////////////////////////////////////////////////////
@@ -30,10 +30,12 @@
 #include "naucrates/dxl/parser/CParseHandlerDXL.h"
 #include "naucrates/dxl/parser/CParseHandlerPlan.h"
 
+#include "naucrates/dxl/parser/CDXLBinaryReader.h"
 #include "naucrates/dxl/parser/CParseHandlerFactory.h"
 #include "naucrates/dxl/parser/CParseHandlerManager.h"
 #include "naucrates/dxl/parser/CParseHandlerDummy.h"
 #include "naucrates/dxl/xml/CDXLMemoryManager.h"
+#include "naucrates/dxl/xml/COstreamDXLBinary.h"
 #include "naucrates/dxl/xml/CXMLSerializer.h"
 #include "gpopt/mdcache/CMDAccessor.h"
 #include "gpopt/base/COptCtxt.h"
@@ -56,6 +58,247 @@ using namespace gpopt;
 
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+// is the given attribute a namespace declaration
+BOOL
+IsNamespaceDeclaration(const XMLCh *name)
+{
+	const XMLCh *xmlns = CDXLTokens::XmlstrToken(EdxltokenNamespaceAttr);
+	const XMLSize_t xmlns_length = XMLString::stringLen(xmlns);
+
+	return 0 == XMLString::compareNString(name, xmlns, xmlns_length) &&
+		   (0 == name[xmlns_length] || ':' == name[xmlns_length]);
+}
+
+// name of the declaration of the DXL namespace
+CWStringDynamic *
+CreateNamespaceDeclarationName(CMemoryPool *mp)
+{
+	CWStringDynamic *name = GPOS_NEW(mp) CWStringDynamic(mp);
+	name->AppendFormat(
+		GPOS_WSZ_LIT("%ls:%ls"),
+		CDXLTokens::GetDXLTokenStr(EdxltokenNamespaceAttr)->GetBuffer(),
+		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix)->GetBuffer());
+
+	return name;
+}
+
+// copy of a character array that is not null terminated
+CWStringDynamic *
+CreateStringFromCharacters(CDXLMemoryManager *memory_manager,
+						   const XMLCh *const chars, const XMLSize_t length)
+{
+	CMemoryPool *mp = memory_manager->Pmp();
+	CAutoRg<XMLCh> text(GPOS_NEW_ARRAY(mp, XMLCh, length + 1));
+	for (XMLSize_t ul = 0; ul < length; ul++)
+	{
+		text[ul] = chars[ul];
+	}
+	text[length] = 0;
+
+	return CDXLUtils::CreateDynamicStringFromXMLChArray(memory_manager,
+														text.Rgt());
+}
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CXMLToBinaryHandler
+//
+//	@doc:
+//		SAX handler writing the events of a parsed DXL document to a
+//		binary DXL stream. Xerces does not report namespace declarations,
+//		so the DXL namespace is declared on the root element, as in the
+//		documents the optimizer writes
+//
+//---------------------------------------------------------------------------
+class CXMLToBinaryHandler : public DefaultHandler
+{
+private:
+	// memory manager
+	CDXLMemoryManager *m_memory_manager;
+
+	// output stream
+	COstreamDXLBinary *m_os;
+
+	// number of open elements
+	ULONG m_depth;
+
+public:
+	CXMLToBinaryHandler(CDXLMemoryManager *memory_manager,
+						COstreamDXLBinary *os)
+		: m_memory_manager(memory_manager), m_os(os), m_depth(0)
+	{
+	}
+
+	virtual void
+	startElement(const XMLCh *const,  // element_uri,
+				 const XMLCh *const,  // element_local_name,
+				 const XMLCh *const element_qname, const Attributes &attrs)
+	{
+		CMemoryPool *mp = m_memory_manager->Pmp();
+		CAutoP<CWStringDynamic> name(CDXLUtils::CreateDynamicStringFromXMLChArray(
+			m_memory_manager, element_qname));
+		m_os->StartElement(name->GetBuffer());
+
+		if (0 == m_depth)
+		{
+			CAutoP<CWStringDynamic> xmlns(CreateNamespaceDeclarationName(mp));
+			m_os->AddAttribute(
+				xmlns->GetBuffer(),
+				CDXLTokens::GetDXLTokenStr(EdxltokenNamespaceURI)->GetBuffer());
+		}
+
+		const XMLSize_t num_attrs = attrs.getLength();
+		for (XMLSize_t ul = 0; ul < num_attrs; ul++)
+		{
+			if (IsNamespaceDeclaration(attrs.getQName(ul)))
+			{
+				continue;
+			}
+
+			CAutoP<CWStringDynamic> attr_name(
+				CDXLUtils::CreateDynamicStringFromXMLChArray(
+					m_memory_manager, attrs.getQName(ul)));
+			CAutoP<CWStringDynamic> attr_value(
+				CDXLUtils::CreateDynamicStringFromXMLChArray(
+					m_memory_manager, attrs.getValue(ul)));
+			m_os->AddAttribute(attr_name->GetBuffer(),
+							   attr_value->GetBuffer());
+		}
+
+		m_depth++;
+	}
+
+	virtual void
+	endElement(const XMLCh *const,	// element_uri,
+			   const XMLCh *const,	// element_local_name,
+			   const XMLCh *const	// element_qname
+	)
+	{
+		GPOS_ASSERT(0 < m_depth);
+
+		m_os->EndElement();
+		m_depth--;
+	}
+
+	virtual void
+	characters(const XMLCh *const chars, const XMLSize_t length)
+	{
+		CAutoP<CWStringDynamic> text(
+			CreateStringFromCharacters(m_memory_manager, chars, length));
+
+		// whitespace between elements is indentation
+		const WCHAR *wsz = text->GetBuffer();
+		for (ULONG ul = 0; ul < text->Length(); ul++)
+		{
+			if (GPOS_WSZ_LIT(' ') != wsz[ul] && GPOS_WSZ_LIT('\t') != wsz[ul] &&
+				GPOS_WSZ_LIT('\n') != wsz[ul] && GPOS_WSZ_LIT('\r') != wsz[ul])
+			{
+				m_os->AddCharacters(wsz);
+				return;
+			}
+		}
+	}
+};
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CBinaryToXMLHandler
+//
+//	@doc:
+//		SAX handler writing the events replayed from a binary DXL document
+//		as XML. The binary reader drops the namespace declaration of the
+//		root element like Xerces does, so it is added back here
+//
+//---------------------------------------------------------------------------
+class CBinaryToXMLHandler : public DefaultHandler
+{
+private:
+	// memory manager
+	CDXLMemoryManager *m_memory_manager;
+
+	// serializer writing the XML document
+	CXMLSerializer *m_xml_serializer;
+
+	// names of the open elements, the serializer refers to them until
+	// they are closed
+	CDynamicPtrArray<CWStringDynamic, CleanupDelete> *m_open_elements;
+
+public:
+	CBinaryToXMLHandler(CDXLMemoryManager *memory_manager,
+						CXMLSerializer *xml_serializer)
+		: m_memory_manager(memory_manager),
+		  m_xml_serializer(xml_serializer),
+		  m_open_elements(NULL)
+	{
+		CMemoryPool *mp = m_memory_manager->Pmp();
+		m_open_elements =
+			GPOS_NEW(mp) CDynamicPtrArray<CWStringDynamic, CleanupDelete>(mp);
+	}
+
+	virtual ~CBinaryToXMLHandler()
+	{
+		m_open_elements->Release();
+	}
+
+	virtual void
+	startElement(const XMLCh *const,  // element_uri,
+				 const XMLCh *const,  // element_local_name,
+				 const XMLCh *const element_qname, const Attributes &attrs)
+	{
+		CMemoryPool *mp = m_memory_manager->Pmp();
+		CWStringDynamic *name = CDXLUtils::CreateDynamicStringFromXMLChArray(
+			m_memory_manager, element_qname);
+		m_open_elements->Append(name);
+		m_xml_serializer->OpenElement(NULL, name);
+
+		if (1 == m_open_elements->Size())
+		{
+			CAutoP<CWStringDynamic> xmlns(CreateNamespaceDeclarationName(mp));
+			m_xml_serializer->AddAttribute(
+				xmlns.Value(),
+				CDXLTokens::GetDXLTokenStr(EdxltokenNamespaceURI));
+		}
+
+		const XMLSize_t num_attrs = attrs.getLength();
+		for (XMLSize_t ul = 0; ul < num_attrs; ul++)
+		{
+			CAutoP<CWStringDynamic> attr_name(
+				CDXLUtils::CreateDynamicStringFromXMLChArray(
+					m_memory_manager, attrs.getQName(ul)));
+			CAutoP<CWStringDynamic> attr_value(
+				CDXLUtils::CreateDynamicStringFromXMLChArray(
+					m_memory_manager, attrs.getValue(ul)));
+			m_xml_serializer->AddAttribute(attr_name.Value(),
+										   attr_value.Value());
+		}
+	}
+
+	virtual void
+	endElement(const XMLCh *const,	// element_uri,
+			   const XMLCh *const,	// element_local_name,
+			   const XMLCh *const	// element_qname
+	)
+	{
+		const ULONG depth = m_open_elements->Size();
+		GPOS_ASSERT(0 < depth);
+
+		m_xml_serializer->CloseElement(NULL, (*m_open_elements)[depth - 1]);
+		GPOS_DELETE(m_open_elements->RemoveLast());
+	}
+
+	virtual void
+	characters(const XMLCh *const chars, const XMLSize_t length)
+	{
+		CAutoP<CWStringDynamic> text(
+			CreateStringFromCharacters(m_memory_manager, chars, length));
+		m_xml_serializer->AddCharacters(text.Value());
+	}
+};
+
+}  // namespace
+
 
 
 //---------------------------------------------------------------------------
@@ -160,6 +403,15 @@ CDXLUtils::GetParseHandlerForDXLFile(CMemoryPool *mp, const CHAR *dxl_filename,
 {
 	GPOS_ASSERT(NULL != mp);
 
+	if (IsBinaryDXLFile(dxl_filename))
+	{
+		ULONG length = 0;
+		CAutoRg<CHAR> buffer(Read(mp, dxl_filename, &length));
+
+		return GetParseHandlerForBinaryDXL(mp, (const BYTE *) buffer.Rgt(),
+										   length);
+	}
+
 	// setup own memory manager
 	CDXLMemoryManager mm(mp);
 	SAX2XMLReader *sax_2_xml_reader = NULL;
@@ -236,6 +488,143 @@ CDXLUtils::GetParseHandlerForDXLFile(CMemoryPool *mp, const CHAR *dxl_filename,
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::GetParseHandlerForBinaryDXL
+//
+//	@doc:
+//		Replay the given binary DXL document to the DXL parse handlers and
+//		return the top-level parser
+//
+//---------------------------------------------------------------------------
+CParseHandlerDXL *
+CDXLUtils::GetParseHandlerForBinaryDXL(CMemoryPool *mp, const BYTE *buffer,
+									   ULONG length)
+{
+	GPOS_ASSERT(NULL != mp);
+	GPOS_ASSERT(NULL != buffer);
+
+	CDXLMemoryManager mm(mp);
+	CParseHandlerManager parse_handler_mgr(&mm, NULL /*sax_2_xml_reader*/);
+	CAutoP<CParseHandlerDXL> parse_handler_dxl(
+		CParseHandlerFactory::GetParseHandlerDXL(mp, &parse_handler_mgr));
+	parse_handler_mgr.ActivateParseHandler(parse_handler_dxl.Value());
+
+	CDXLBinaryReader reader(mp, buffer, length);
+	reader.Parse(&parse_handler_mgr);
+
+	GPOS_CHECK_ABORT;
+
+	return parse_handler_dxl.Reset();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::IsBinaryDXLFile
+//
+//	@doc:
+//		Does the given file start with the magic bytes of the binary DXL
+//		format
+//
+//---------------------------------------------------------------------------
+BOOL
+CDXLUtils::IsBinaryDXLFile(const CHAR *filename)
+{
+	CFileReader fr;
+	fr.Open(filename);
+
+	BYTE magic[GPDXL_BINARY_MAGIC_LENGTH];
+	ULONG_PTR read_bytes = 0;
+	if (GPDXL_BINARY_MAGIC_LENGTH <= fr.FileSize())
+	{
+		read_bytes = fr.ReadBytesToBuffer(magic, GPDXL_BINARY_MAGIC_LENGTH);
+	}
+	fr.Close();
+
+	return COstreamDXLBinary::IsBinaryDXL(magic, (ULONG) read_bytes);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::TranscodeXMLToBinary
+//
+//	@doc:
+//		Convert a DXL document to the binary DXL format
+//
+//---------------------------------------------------------------------------
+void
+CDXLUtils::TranscodeXMLToBinary(CMemoryPool *mp, const CHAR *dxl_string,
+								std::ostream &os)
+{
+	GPOS_ASSERT(NULL != mp);
+	GPOS_ASSERT(NULL != dxl_string);
+
+	CDXLMemoryManager mm(mp);
+	COstreamDXLBinary binary_os(mp, os);
+	CXMLToBinaryHandler handler(&mm, &binary_os);
+
+	SAX2XMLReader *sax_2_xml_reader = XMLReaderFactory::createXMLReader(&mm);
+	sax_2_xml_reader->setContentHandler(&handler);
+	sax_2_xml_reader->setErrorHandler(&handler);
+
+	MemBufInputSource *input_src_memory_buffer = new (&mm)
+		MemBufInputSource((const XMLByte *) dxl_string, strlen(dxl_string),
+						  "dxl transcode", false, &mm);
+
+	try
+	{
+		sax_2_xml_reader->parse(*input_src_memory_buffer);
+	}
+	catch (const XMLException &)
+	{
+		delete sax_2_xml_reader;
+		delete input_src_memory_buffer;
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLXercesParseError);
+	}
+	catch (const SAXParseException &)
+	{
+		delete sax_2_xml_reader;
+		delete input_src_memory_buffer;
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLXercesParseError);
+	}
+	catch (const SAXException &)
+	{
+		delete sax_2_xml_reader;
+		delete input_src_memory_buffer;
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLXercesParseError);
+	}
+
+	delete sax_2_xml_reader;
+	delete input_src_memory_buffer;
+
+	binary_os.Finish();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::TranscodeBinaryToXML
+//
+//	@doc:
+//		Convert a binary DXL document to XML
+//
+//---------------------------------------------------------------------------
+void
+CDXLUtils::TranscodeBinaryToXML(CMemoryPool *mp, const BYTE *buffer,
+								ULONG length, IOstream &os)
+{
+	GPOS_ASSERT(NULL != mp);
+	GPOS_ASSERT(NULL != buffer);
+
+	CDXLMemoryManager mm(mp);
+	CXMLSerializer xml_serializer(mp, os, false /*indentation*/);
+	CBinaryToXMLHandler handler(&mm, &xml_serializer);
+
+	xml_serializer.StartDocument();
+
+	CDXLBinaryReader reader(mp, buffer, length);
+	reader.Parse(&handler);
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CDXLUtils::GetParseHandlerForDXLString
@@ -1749,7 +2138,7 @@ CDXLUtils::CreateMultiByteCharStringFromWCString(CMemoryPool *mp,
 //
 //---------------------------------------------------------------------------
 CHAR *
-CDXLUtils::Read(CMemoryPool *mp, const CHAR *filename)
+CDXLUtils::Read(CMemoryPool *mp, const CHAR *filename, ULONG *length)
 {
 	GPOS_TRACE_FORMAT("opening file %s", filename);
 
@@ -1767,6 +2156,11 @@ CDXLUtils::Read(CMemoryPool *mp, const CHAR *filename)
 
 	read_buffer[read_bytes] = '\0';
 
+	if (NULL != length)
+	{
+		*length = (ULONG) read_bytes;
+	}
+
 	return read_buffer.RgtReset();
 }
 
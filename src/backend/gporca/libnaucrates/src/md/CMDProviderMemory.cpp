@@ -24,6 +24,7 @@
 #include "naucrates/md/CDXLRelStats.h"
 #include "naucrates/md/CDXLColStats.h"
 #include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/dxl/parser/CParseHandlerDXL.h"
 #include "naucrates/exception.h"
 
 #include "gpopt/mdcache/CMDAccessor.h"
@@ -45,13 +46,14 @@ CMDProviderMemory::CMDProviderMemory(CMemoryPool *mp, const CHAR *file_name)
 {
 	GPOS_ASSERT(NULL != file_name);
 
-	// read DXL file
-	CAutoRg<CHAR> dxl_file;
-	dxl_file = CDXLUtils::Read(mp, file_name);
+	// parse DXL file, which may be in the XML or the binary format
+	CAutoP<CParseHandlerDXL> parse_handler_dxl(
+		CDXLUtils::GetParseHandlerForDXLFile(mp, file_name,
+											 NULL /*xsd_file_path*/));
 
 	CAutoRef<IMDCacheObjectArray> mdcache_obj_array;
-	mdcache_obj_array = CDXLUtils::ParseDXLToIMDObjectArray(
-		mp, dxl_file.Rgt(), NULL /*xsd_file_path*/);
+	mdcache_obj_array = parse_handler_dxl->GetMdIdCachedObjArray();
+	mdcache_obj_array->AddRef();
 
 	LoadMetadataObjectsFromArray(mp, mdcache_obj_array.Value());
 }
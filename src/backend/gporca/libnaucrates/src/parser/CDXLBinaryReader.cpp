@@ -0,0 +1,596 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CDXLBinaryReader.cpp
+//
+//	@doc:
+//		Implementation of the reader of binary DXL documents
+//---------------------------------------------------------------------------
+
+#include "naucrates/dxl/parser/CDXLBinaryReader.h"
+
+#include "naucrates/dxl/parser/CParseHandlerManager.h"
+#include "naucrates/dxl/xml/COstreamDXLBinary.h"
+#include "naucrates/dxl/xml/dxltokens.h"
+#include "naucrates/exception.h"
+
+#include <xercesc/util/XMLString.hpp>
+
+using namespace gpdxl;
+
+// number of records replayed between checks for aborts
+#define GPDXL_BINARY_CFA_FREQUENCY 1024
+
+// empty string returned for missing uris and types
+static const XMLCh empty_xmlstr[] = {0};
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CAttributes::CAttributes
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryReader::CAttributes::CAttributes(CMemoryPool *mp)
+	: m_names(NULL), m_values(NULL)
+{
+	m_names = GPOS_NEW(mp) ConstXMLChArray(mp);
+	m_values = GPOS_NEW(mp) ConstXMLChArray(mp);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CAttributes::~CAttributes
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryReader::CAttributes::~CAttributes()
+{
+	m_names->Release();
+	m_values->Release();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CAttributes::Clear
+//
+//	@doc:
+//		Remove all attributes
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::CAttributes::Clear()
+{
+	m_names->Clear();
+	m_values->Clear();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CAttributes::Add
+//
+//	@doc:
+//		Add an attribute unless it is a namespace declaration
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::CAttributes::Add(const XMLCh *name, const XMLCh *value)
+{
+	const XMLCh *xmlns = CDXLTokens::XmlstrToken(EdxltokenNamespaceAttr);
+	const XMLSize_t xmlns_length = XMLString::stringLen(xmlns);
+	if (0 == XMLString::compareNString(name, xmlns, xmlns_length) &&
+		(0 == name[xmlns_length] || ':' == name[xmlns_length]))
+	{
+		return;
+	}
+
+	m_names->Append(name);
+	m_values->Append(value);
+}
+
+XMLSize_t
+CDXLBinaryReader::CAttributes::getLength() const
+{
+	return m_names->Size();
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getURI(const XMLSize_t index) const
+{
+	if (index >= m_names->Size())
+	{
+		return NULL;
+	}
+
+	return Uri((*m_names)[index]);
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getLocalName(const XMLSize_t index) const
+{
+	if (index >= m_names->Size())
+	{
+		return NULL;
+	}
+
+	return LocalName((*m_names)[index]);
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getQName(const XMLSize_t index) const
+{
+	if (index >= m_names->Size())
+	{
+		return NULL;
+	}
+
+	return (*m_names)[index];
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getType(const XMLSize_t index) const
+{
+	if (index >= m_names->Size())
+	{
+		return NULL;
+	}
+
+	// attribute types are not recorded, all attributes read as CDATA
+	return XMLUni::fgCDATAString;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getValue(const XMLSize_t index) const
+{
+	if (index >= m_names->Size())
+	{
+		return NULL;
+	}
+
+	return (*m_values)[index];
+}
+
+bool
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const uri,
+										const XMLCh *const local_part,
+										XMLSize_t &index) const
+{
+	const ULONG size = m_names->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		const XMLCh *name = (*m_names)[ul];
+		if (XMLString::equals(LocalName(name), local_part) &&
+			XMLString::equals(Uri(name), uri))
+		{
+			index = ul;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const uri,
+										const XMLCh *const local_part) const
+{
+	XMLSize_t index = 0;
+	if (getIndex(uri, local_part, index))
+	{
+		return (int) index;
+	}
+
+	return -1;
+}
+
+bool
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const qname,
+										XMLSize_t &index) const
+{
+	const ULONG size = m_names->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		if (XMLString::equals((*m_names)[ul], qname))
+		{
+			index = ul;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const qname) const
+{
+	XMLSize_t index = 0;
+	if (getIndex(qname, index))
+	{
+		return (int) index;
+	}
+
+	return -1;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getType(const XMLCh *const uri,
+									   const XMLCh *const local_part) const
+{
+	return getType(getIndex(uri, local_part));
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getType(const XMLCh *const qname) const
+{
+	return getType(getIndex(qname));
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getValue(const XMLCh *const uri,
+										const XMLCh *const local_part) const
+{
+	return getValue(getIndex(uri, local_part));
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getValue(const XMLCh *const qname) const
+{
+	return getValue(getIndex(qname));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CDXLBinaryReader
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryReader::CDXLBinaryReader(CMemoryPool *mp, const BYTE *buffer,
+								   ULONG length)
+	: m_mp(mp),
+	  m_buffer(buffer),
+	  m_length(length),
+	  m_offset(0),
+	  m_strings(NULL),
+	  m_literals(NULL),
+	  m_open_elements(NULL),
+	  m_attributes(NULL)
+{
+	GPOS_ASSERT(NULL != mp);
+	GPOS_ASSERT(NULL != buffer);
+
+	m_strings = GPOS_NEW(m_mp) XMLChArray(m_mp);
+	m_literals = GPOS_NEW(m_mp) XMLChArray(m_mp);
+	m_open_elements = GPOS_NEW(m_mp) ConstXMLChArray(m_mp);
+	m_attributes = GPOS_NEW(m_mp) CAttributes(m_mp);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::~CDXLBinaryReader
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryReader::~CDXLBinaryReader()
+{
+	m_strings->Release();
+	m_literals->Release();
+	m_open_elements->Release();
+	GPOS_DELETE(m_attributes);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::RaiseCorrupt
+//
+//	@doc:
+//		Raise an error for a corrupt document
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::RaiseCorrupt() const
+{
+	GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLBinaryParseError, m_offset);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ReadByte
+//
+//	@doc:
+//		Read a byte
+//
+//---------------------------------------------------------------------------
+BYTE
+CDXLBinaryReader::ReadByte()
+{
+	if (m_offset >= m_length)
+	{
+		RaiseCorrupt();
+	}
+
+	return m_buffer[m_offset++];
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ReadVarint
+//
+//	@doc:
+//		Read an unsigned LEB128 varint
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryReader::ReadVarint()
+{
+	ULONG value = 0;
+	for (ULONG shift = 0; shift < 32; shift += 7)
+	{
+		BYTE byte = ReadByte();
+		value |= ((ULONG)(byte & 0x7f)) << shift;
+		if (0 == (byte & 0x80))
+		{
+			return value;
+		}
+	}
+
+	RaiseCorrupt();
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ReadString
+//
+//	@doc:
+//		Read a string reference. New strings are added to the string table,
+//		literals live until the next record is replayed. Names of elements
+//		and attributes must come from the string table, since the open
+//		elements refer to them
+//
+//---------------------------------------------------------------------------
+const XMLCh *
+CDXLBinaryReader::ReadString(BOOL is_name)
+{
+	const ULONG tag = ReadVarint();
+	if (EbdxlstrFirstId <= tag)
+	{
+		const ULONG index = tag - EbdxlstrFirstId;
+		if (index >= m_strings->Size())
+		{
+			RaiseCorrupt();
+		}
+
+		return (*m_strings)[index];
+	}
+
+	if (EbdxlstrLiteral == tag && is_name)
+	{
+		RaiseCorrupt();
+	}
+
+	const ULONG num_units = ReadVarint();
+	if (num_units > (m_length - m_offset) / 2)
+	{
+		RaiseCorrupt();
+	}
+
+	XMLCh *str = GPOS_NEW_ARRAY(m_mp, XMLCh, num_units + 1);
+	for (ULONG ul = 0; ul < num_units; ul++)
+	{
+		const BYTE *unit = m_buffer + m_offset + 2 * ul;
+		str[ul] = (XMLCh)(unit[0] | (unit[1] << 8));
+	}
+	str[num_units] = 0;
+	m_offset += 2 * num_units;
+
+	if (EbdxlstrNew == tag)
+	{
+		m_strings->Append(str);
+	}
+	else
+	{
+		m_literals->Append(str);
+	}
+
+	return str;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::LocalName
+//
+//	@doc:
+//		Local part of a qualified name
+//
+//---------------------------------------------------------------------------
+const XMLCh *
+CDXLBinaryReader::LocalName(const XMLCh *qname)
+{
+	const int colon = XMLString::indexOf(qname, ':');
+	if (0 > colon)
+	{
+		return qname;
+	}
+
+	return qname + colon + 1;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::Uri
+//
+//	@doc:
+//		Namespace uri of a qualified name; DXL declares a single namespace,
+//		so any prefixed name belongs to it
+//
+//---------------------------------------------------------------------------
+const XMLCh *
+CDXLBinaryReader::Uri(const XMLCh *qname)
+{
+	if (0 > XMLString::indexOf(qname, ':'))
+	{
+		return empty_xmlstr;
+	}
+
+	return CDXLTokens::XmlstrToken(EdxltokenNamespaceURI);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::Replay
+//
+//	@doc:
+//		Replay the records of the document as SAX2 callbacks. When a parse
+//		handler manager is given, every callback goes to the handler that
+//		is current at that point, just as Xerces switches content handlers
+//		when the manager activates a new handler
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::Replay(CParseHandlerManager *parse_handler_mgr,
+						 DefaultHandler *handler)
+{
+	GPOS_ASSERT((NULL == parse_handler_mgr) != (NULL == handler));
+
+	if (!COstreamDXLBinary::IsBinaryDXL(m_buffer, m_length) ||
+		GPDXL_BINARY_MAGIC_LENGTH + 1 > m_length)
+	{
+		RaiseCorrupt();
+	}
+	m_offset = GPDXL_BINARY_MAGIC_LENGTH;
+	if (GPDXL_BINARY_VERSION != ReadByte())
+	{
+		RaiseCorrupt();
+	}
+
+	ULONG iterations_since_last_abortcheck = 0;
+	BYTE record = ReadByte();
+	while (EbdxlrecEnd != record)
+	{
+		if (GPDXL_BINARY_CFA_FREQUENCY < ++iterations_since_last_abortcheck)
+		{
+			GPOS_CHECK_ABORT;
+			iterations_since_last_abortcheck = 0;
+		}
+
+		// events after the last handler is deactivated are dropped, the
+		// way Xerces drops them when it has no content handler
+		DefaultHandler *current_handler = handler;
+		if (NULL != parse_handler_mgr)
+		{
+			current_handler = parse_handler_mgr->GetCurrentParseHandler();
+		}
+
+		m_literals->Clear();
+		switch (record)
+		{
+			case EbdxlrecStartElement:
+			{
+				const XMLCh *qname = ReadString(true /*is_name*/);
+
+				// the attributes follow the element name
+				m_attributes->Clear();
+				record = ReadByte();
+				while (EbdxlrecAttribute == record)
+				{
+					const XMLCh *name = ReadString(true /*is_name*/);
+					const XMLCh *value = ReadString(false /*is_name*/);
+					m_attributes->Add(name, value);
+					record = ReadByte();
+				}
+
+				m_open_elements->Append(qname);
+				if (NULL != current_handler)
+				{
+					current_handler->startElement(Uri(qname), LocalName(qname),
+												  qname, *m_attributes);
+				}
+
+				// the record after the attributes is already read
+				continue;
+			}
+
+			case EbdxlrecEndElement:
+			{
+				const ULONG depth = m_open_elements->Size();
+				if (0 == depth)
+				{
+					RaiseCorrupt();
+				}
+
+				const XMLCh *qname = (*m_open_elements)[depth - 1];
+				m_open_elements->RemoveLast();
+				if (NULL != current_handler)
+				{
+					current_handler->endElement(Uri(qname), LocalName(qname),
+												qname);
+				}
+				break;
+			}
+
+			case EbdxlrecCharacters:
+			{
+				const XMLCh *text = ReadString(false /*is_name*/);
+				if (NULL != current_handler)
+				{
+					current_handler->characters(text,
+												XMLString::stringLen(text));
+				}
+				break;
+			}
+
+			default:
+				RaiseCorrupt();
+		}
+
+		record = ReadByte();
+	}
+
+	if (0 != m_open_elements->Size())
+	{
+		RaiseCorrupt();
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::Parse
+//
+//	@doc:
+//		Replay the document to the current parse handler of the manager
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::Parse(CParseHandlerManager *parse_handler_mgr)
+{
+	GPOS_ASSERT(NULL != parse_handler_mgr);
+
+	Replay(parse_handler_mgr, NULL);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::Parse
+//
+//	@doc:
+//		Replay the document to the given handler
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::Parse(DefaultHandler *handler)
+{
+	GPOS_ASSERT(NULL != handler);
+
+	Replay(NULL, handler);
+}
+
+// EOF
@@ -74,8 +74,11 @@ CParseHandlerManager::ActivateParseHandler(
 	GPOS_ASSERT(NULL != parse_handler_base);
 
 	m_curr_parse_handler = parse_handler_base;
-	m_xml_reader->setContentHandler(parse_handler_base);
-	m_xml_reader->setErrorHandler(parse_handler_base);
+	if (NULL != m_xml_reader)
+	{
+		m_xml_reader->setContentHandler(parse_handler_base);
+		m_xml_reader->setErrorHandler(parse_handler_base);
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -102,8 +105,11 @@ CParseHandlerManager::ReplaceHandler(CParseHandlerBase *parse_handler_base,
 	}
 
 	m_curr_parse_handler = parse_handler_base;
-	m_xml_reader->setContentHandler(parse_handler_base);
-	m_xml_reader->setErrorHandler(parse_handler_base);
+	if (NULL != m_xml_reader)
+	{
+		m_xml_reader->setContentHandler(parse_handler_base);
+		m_xml_reader->setErrorHandler(parse_handler_base);
+	}
 }
 
 
@@ -132,8 +138,11 @@ CParseHandlerManager::DeactivateHandler()
 		m_curr_parse_handler = NULL;
 	}
 
-	m_xml_reader->setContentHandler(m_curr_parse_handler);
-	m_xml_reader->setErrorHandler(m_curr_parse_handler);
+	if (NULL != m_xml_reader)
+	{
+		m_xml_reader->setContentHandler(m_curr_parse_handler);
+		m_xml_reader->setErrorHandler(m_curr_parse_handler);
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -144,7 +153,7 @@ CParseHandlerManager::DeactivateHandler()
 //		Returns the current handler
 //
 //---------------------------------------------------------------------------
-const CParseHandlerBase *
+CParseHandlerBase *
 CParseHandlerManager::GetCurrentParseHandler()
 {
 	return m_curr_parse_handler;
@@ -0,0 +1,218 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CColumnarHistogram.cpp
+//
+//	@doc:
+//		Implementation of the columnar view of histogram buckets
+//---------------------------------------------------------------------------
+
+#include "naucrates/statistics/CColumnarHistogram.h"
+#include "naucrates/statistics/CStatistics.h"
+
+using namespace gpnaucrates;
+
+// largest magnitude of a LINT that converts to a double without loss
+#define GPNAUCRATES_MAX_EXACT_LINT (((LINT) 1) << 53)
+
+// ctor
+CColumnarHistogram::CColumnarHistogram(CMemoryPool *mp, ULONG num_buckets,
+									   BOOL is_lint)
+	: m_mp(mp),
+	  m_num_buckets(num_buckets),
+	  m_is_lint(is_lint),
+	  m_epsilon(CStatistics::Epsilon.Get()),
+	  m_lower(NULL),
+	  m_upper(NULL),
+	  m_freq(NULL),
+	  m_ndv(NULL)
+{
+	GPOS_ASSERT(0 < num_buckets);
+
+	m_lower = GPOS_NEW_ARRAY(m_mp, DOUBLE, num_buckets);
+	m_upper = GPOS_NEW_ARRAY(m_mp, DOUBLE, num_buckets);
+	m_freq = GPOS_NEW_ARRAY(m_mp, DOUBLE, num_buckets);
+	m_ndv = GPOS_NEW_ARRAY(m_mp, DOUBLE, num_buckets);
+}
+
+// dtor
+CColumnarHistogram::~CColumnarHistogram()
+{
+	GPOS_DELETE_ARRAY(m_lower);
+	GPOS_DELETE_ARRAY(m_upper);
+	GPOS_DELETE_ARRAY(m_freq);
+	GPOS_DELETE_ARRAY(m_ndv);
+}
+
+// map a datum to a double using the same mapping (LINT before double) that
+// IDatum's stats comparisons use; fails for nulls, for datums mapped the
+// other way and for LINTs that a double cannot hold exactly
+BOOL
+CColumnarHistogram::MapDatum(const IDatum *datum, BOOL is_lint, DOUBLE *value)
+{
+	if (datum->IsNull())
+	{
+		return false;
+	}
+
+	if (datum->IsDatumMappableToLINT())
+	{
+		if (!is_lint)
+		{
+			return false;
+		}
+
+		LINT lint_value = datum->GetLINTMapping();
+		if (GPNAUCRATES_MAX_EXACT_LINT < lint_value ||
+			-GPNAUCRATES_MAX_EXACT_LINT > lint_value)
+		{
+			return false;
+		}
+
+		*value = (DOUBLE) lint_value;
+		return true;
+	}
+
+	if (is_lint || !datum->IsDatumMappableToDouble())
+	{
+		return false;
+	}
+
+	*value = datum->GetDoubleMapping().Get();
+	return true;
+}
+
+// build the columnar view of a bucket array. The buckets must all map the
+// same way and be sorted without overlap, which is what the searches below
+// rely on; otherwise NULL is returned and callers scan the buckets as usual
+CColumnarHistogram *
+CColumnarHistogram::Create(CMemoryPool *mp, const CBucketArray *buckets)
+{
+	GPOS_ASSERT(NULL != buckets);
+
+	const ULONG num_buckets = buckets->Size();
+	if (0 == num_buckets)
+	{
+		return NULL;
+	}
+
+	const IDatum *first_datum = (*buckets)[0]->GetLowerBound()->GetDatum();
+	if (first_datum->IsNull())
+	{
+		return NULL;
+	}
+
+	CColumnarHistogram *columnar_histogram = GPOS_NEW(mp) CColumnarHistogram(
+		mp, num_buckets, first_datum->IsDatumMappableToLINT());
+
+	for (ULONG ul = 0; ul < num_buckets; ul++)
+	{
+		CBucket *bucket = (*buckets)[ul];
+		DOUBLE *lower = &columnar_histogram->m_lower[ul];
+		DOUBLE *upper = &columnar_histogram->m_upper[ul];
+
+		if (!MapDatum(bucket->GetLowerBound()->GetDatum(),
+					  columnar_histogram->m_is_lint, lower) ||
+			!MapDatum(bucket->GetUpperBound()->GetDatum(),
+					  columnar_histogram->m_is_lint, upper) ||
+			*upper < *lower ||
+			(0 < ul && *lower < columnar_histogram->m_upper[ul - 1]))
+		{
+			GPOS_DELETE(columnar_histogram);
+			return NULL;
+		}
+
+		columnar_histogram->m_freq[ul] = bucket->GetFrequency().Get();
+		columnar_histogram->m_ndv[ul] = bucket->GetNumDistinct().Get();
+	}
+
+	return columnar_histogram;
+}
+
+// map a point for searching
+BOOL
+CColumnarHistogram::MapPoint(const CPoint *point, DOUBLE *value) const
+{
+	GPOS_ASSERT(NULL != point);
+
+	return MapDatum(point->GetDatum(), m_is_lint, value);
+}
+
+// binary search for the first bucket at or after start whose upper bound
+// is not strictly below value
+ULONG
+CColumnarHistogram::FirstBucketNotBelow(DOUBLE value, ULONG start) const
+{
+	ULONG low = start;
+	ULONG high = m_num_buckets;
+
+	while (low < high)
+	{
+		ULONG mid = low + (high - low) / 2;
+		if (IsStrictlyBelow(m_upper[mid], value))
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+// binary search for the first bucket at or after start whose lower bound
+// is strictly above value
+ULONG
+CColumnarHistogram::FirstBucketAbove(DOUBLE value, ULONG start) const
+{
+	ULONG low = start;
+	ULONG high = m_num_buckets;
+
+	while (low < high)
+	{
+		ULONG mid = low + (high - low) / 2;
+		if (IsStrictlyBelow(value, m_lower[mid]))
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+
+	return low;
+}
+
+// sum of bucket frequencies, accumulated in bucket order like
+// CHistogram::GetFrequency does
+CDouble
+CColumnarHistogram::GetFrequency() const
+{
+	CDouble frequency(0.0);
+	for (ULONG ul = 0; ul < m_num_buckets; ul++)
+	{
+		frequency = frequency + CDouble(m_freq[ul]);
+	}
+
+	return frequency;
+}
+
+// sum of bucket NDVs
+CDouble
+CColumnarHistogram::GetNumDistinct() const
+{
+	CDouble distinct(0.0);
+	for (ULONG ul = 0; ul < m_num_buckets; ul++)
+	{
+		distinct = distinct + CDouble(m_ndv[ul]);
+	}
+
+	return distinct;
+}
+
+// EOF
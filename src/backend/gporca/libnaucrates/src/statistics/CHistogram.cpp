@@ -62,7 +62,9 @@ CHistogram::CHistogram(CMemoryPool *mp, CBucketArray *histogram_buckets,
 	  m_skew_was_measured(false),
 	  m_skew(1.0),
 	  m_NDVs_were_scaled(false),
-	  m_is_col_stats_missing(false)
+	  m_is_col_stats_missing(false),
+	  m_columnar_histogram(NULL),
+	  m_columnar_histogram_built(false)
 {
 	GPOS_ASSERT(NULL != histogram_buckets);
 }
@@ -78,7 +80,9 @@ CHistogram::CHistogram(CMemoryPool *mp, BOOL is_well_defined)
 	  m_skew_was_measured(false),
 	  m_skew(1.0),
 	  m_NDVs_were_scaled(false),
-	  m_is_col_stats_missing(false)
+	  m_is_col_stats_missing(false),
+	  m_columnar_histogram(NULL),
+	  m_columnar_histogram_built(false)
 {
 	m_histogram_buckets = GPOS_NEW(m_mp) CBucketArray(m_mp);
 }
@@ -97,7 +101,9 @@ CHistogram::CHistogram(CMemoryPool *mp, CBucketArray *histogram_buckets,
 	  m_skew_was_measured(false),
 	  m_skew(1.0),
 	  m_NDVs_were_scaled(false),
-	  m_is_col_stats_missing(is_col_stats_missing)
+	  m_is_col_stats_missing(is_col_stats_missing),
+	  m_columnar_histogram(NULL),
+	  m_columnar_histogram_built(false)
 {
 	GPOS_ASSERT(m_histogram_buckets);
 	GPOS_ASSERT(CDouble(0.0) <= null_freq);
@@ -183,7 +189,18 @@ CHistogram::MakeHistogramLessThanOrLessThanEqualFilter(
 	CBucketArray *new_buckets = GPOS_NEW(m_mp) CBucketArray(m_mp);
 	const ULONG num_buckets = m_histogram_buckets->Size();
 
-	for (ULONG bucket_index = 0; bucket_index < num_buckets; bucket_index++)
+	// buckets entirely below the point are kept as they are
+	ULONG begin = 0;
+	ULONG end = num_buckets;
+	GetCandidateBuckets(point, &begin, &end);
+	for (ULONG bucket_index = 0; bucket_index < begin; bucket_index++)
+	{
+		CBucket *bucket = (*m_histogram_buckets)[bucket_index];
+		new_buckets->Append(bucket->MakeBucketCopy(m_mp));
+	}
+
+	for (ULONG bucket_index = begin; bucket_index < num_buckets;
+		 bucket_index++)
 	{
 		CBucket *bucket = (*m_histogram_buckets)[bucket_index];
 		if (bucket->IsBefore(point))
@@ -231,11 +248,17 @@ CHistogram::MakeBucketsWithInequalityFilter(CPoint *point) const
 	const ULONG num_buckets = m_histogram_buckets->Size();
 	bool point_is_null = point->GetDatum()->IsNull();
 
+	// only buckets in [begin, end) can contain the point
+	ULONG begin = 0;
+	ULONG end = num_buckets;
+	GetCandidateBuckets(point, &begin, &end);
+
 	for (ULONG bucket_index = 0; bucket_index < num_buckets; bucket_index++)
 	{
 		CBucket *bucket = (*m_histogram_buckets)[bucket_index];
 
-		if (bucket->Contains(point) && !point_is_null)
+		if (begin <= bucket_index && bucket_index < end &&
+			bucket->Contains(point) && !point_is_null)
 		{
 			CBucket *less_than_bucket = bucket->MakeBucketScaleUpper(
 				m_mp, point, false /*include_upper */);
@@ -306,9 +329,11 @@ CHistogram::MakeBucketsWithEqualityFilter(CPoint *point) const
 	}
 
 	const ULONG num_buckets = m_histogram_buckets->Size();
-	ULONG bucket_index = 0;
+	ULONG begin = 0;
+	ULONG end = num_buckets;
+	GetCandidateBuckets(point, &begin, &end);
 
-	for (bucket_index = 0; bucket_index < num_buckets; bucket_index++)
+	for (ULONG bucket_index = begin; bucket_index < end; bucket_index++)
 	{
 		CBucket *bucket = (*m_histogram_buckets)[bucket_index];
 
@@ -408,9 +433,12 @@ CHistogram::MakeHistogramGreaterThanOrGreaterThanEqualFilter(
 	CBucketArray *new_buckets = GPOS_NEW(m_mp) CBucketArray(m_mp);
 	const ULONG num_buckets = m_histogram_buckets->Size();
 
-	// find first bucket that contains point
+	// find first bucket that contains point; buckets entirely below the
+	// point are skipped
 	ULONG bucket_index = 0;
-	for (bucket_index = 0; bucket_index < num_buckets; bucket_index++)
+	ULONG end = num_buckets;
+	GetCandidateBuckets(point, &bucket_index, &end);
+	for (; bucket_index < num_buckets; bucket_index++)
 	{
 		CBucket *bucket = (*m_histogram_buckets)[bucket_index];
 		if (bucket->IsBefore(point))
@@ -466,11 +494,19 @@ CDouble
 CHistogram::GetFrequency() const
 {
 	CDouble frequency(0.0);
-	const ULONG num_of_buckets = m_histogram_buckets->Size();
-	for (ULONG bucket_index = 0; bucket_index < num_of_buckets; bucket_index++)
+	if (NULL != m_columnar_histogram)
 	{
-		CBucket *bucket = (*m_histogram_buckets)[bucket_index];
-		frequency = frequency + bucket->GetFrequency();
+		frequency = m_columnar_histogram->GetFrequency();
+	}
+	else
+	{
+		const ULONG num_of_buckets = m_histogram_buckets->Size();
+		for (ULONG bucket_index = 0; bucket_index < num_of_buckets;
+			 bucket_index++)
+		{
+			CBucket *bucket = (*m_histogram_buckets)[bucket_index];
+			frequency = frequency + bucket->GetFrequency();
+		}
 	}
 
 	if (CStatistics::Epsilon < m_null_freq)
@@ -486,11 +522,19 @@ CDouble
 CHistogram::GetNumDistinct() const
 {
 	CDouble distinct(0.0);
-	const ULONG num_of_buckets = m_histogram_buckets->Size();
-	for (ULONG bucket_index = 0; bucket_index < num_of_buckets; bucket_index++)
+	if (NULL != m_columnar_histogram)
 	{
-		CBucket *bucket = (*m_histogram_buckets)[bucket_index];
-		distinct = distinct + bucket->GetNumDistinct();
+		distinct = m_columnar_histogram->GetNumDistinct();
+	}
+	else
+	{
+		const ULONG num_of_buckets = m_histogram_buckets->Size();
+		for (ULONG bucket_index = 0; bucket_index < num_of_buckets;
+			 bucket_index++)
+		{
+			CBucket *bucket = (*m_histogram_buckets)[bucket_index];
+			distinct = distinct + bucket->GetNumDistinct();
+		}
 	}
 	CDouble distinct_null(0.0);
 	if (CStatistics::Epsilon < m_null_freq)
@@ -531,6 +575,7 @@ CHistogram::CapNDVs(CDouble rows)
 	}
 	m_histogram_buckets->Release();
 	m_histogram_buckets = histogram_buckets;
+	ResetColumnarHistogram();
 	m_distinct_remaining = m_distinct_remaining * scale_ratio;
 }
 
@@ -1000,6 +1045,7 @@ CHistogram::NormalizeHistogram()
 		}
 		m_histogram_buckets->Release();
 		m_histogram_buckets = histogram_buckets;
+		ResetColumnarHistogram();
 	}
 
 	m_null_freq = m_null_freq * scale_factor;
@@ -1112,9 +1158,31 @@ CHistogram::MakeJoinHistogramEqualityFilter(const CHistogram *histogram) const
 		return MakeNDVBasedJoinHistogramEqualityFilter(histogram);
 	}
 
+	// with columnar views of both inputs, runs of buckets that end before
+	// the other side's current bucket begins are skipped by binary search
+	const CColumnarHistogram *columnar1 = GetColumnarHistogram();
+	const CColumnarHistogram *columnar2 = histogram->GetColumnarHistogram();
+	BOOL skip_disjoint_buckets = NULL != columnar1 && NULL != columnar2 &&
+								 columnar1->IsComparable(columnar2);
+
 	CBucketArray *join_buckets = GPOS_NEW(m_mp) CBucketArray(m_mp);
 	while (idx1 < buckets1 && idx2 < buckets2)
 	{
+		if (skip_disjoint_buckets)
+		{
+			idx1 = columnar1->FirstBucketNotBefore(columnar2, idx2, idx1);
+			if (idx1 == buckets1)
+			{
+				break;
+			}
+
+			idx2 = columnar2->FirstBucketNotBefore(columnar1, idx1, idx2);
+			if (idx2 == buckets2)
+			{
+				break;
+			}
+		}
+
 		CBucket *bucket1 = (*m_histogram_buckets)[idx1];
 		CBucket *bucket2 = (*histogram->m_histogram_buckets)[idx2];
 
@@ -1448,9 +1516,14 @@ CHistogram::MakeUnionAllHistogramNormalize(CDouble rows,
 	BOOL bucket1_is_residual = false;
 	BOOL bucket2_is_residual = false;
 
+	const CColumnarHistogram *columnar1 = GetColumnarHistogram();
+	const CColumnarHistogram *columnar2 = histogram->GetColumnarHistogram();
+
 	while (NULL != bucket1 && NULL != bucket2)
 	{
-		if (bucket1->IsBefore(bucket2))
+		if (IsBucketBefore(columnar1, idx1, bucket1_is_residual, columnar2,
+						   idx2, bucket2_is_residual) ||
+			bucket1->IsBefore(bucket2))
 		{
 			new_buckets->Append(
 				bucket1->MakeBucketUpdateFrequency(m_mp, rows, rows_new));
@@ -1459,7 +1532,9 @@ CHistogram::MakeUnionAllHistogramNormalize(CDouble rows,
 			bucket1 = (*this)[idx1];
 			bucket1_is_residual = false;
 		}
-		else if (bucket2->IsBefore(bucket1))
+		else if (IsBucketBefore(columnar2, idx2, bucket2_is_residual,
+								columnar1, idx1, bucket1_is_residual) ||
+				 bucket2->IsBefore(bucket1))
 		{
 			new_buckets->Append(
 				bucket2->MakeBucketUpdateFrequency(m_mp, rows_other, rows_new));
@@ -1819,10 +1894,16 @@ CHistogram::MakeUnionHistogramNormalize(CDouble rows,
 	// number of tuples in each bucket of the resulting histogram
 	CDoubleArray *num_tuples_per_bucket = GPOS_NEW(m_mp) CDoubleArray(m_mp);
 
+	const CColumnarHistogram *columnar1 = GetColumnarHistogram();
+	const CColumnarHistogram *columnar2 =
+		other_histogram->GetColumnarHistogram();
+
 	CDouble cumulative_num_rows(0.0);
 	while (NULL != bucket1 && NULL != bucket2)
 	{
-		if (bucket1->IsBefore(bucket2))
+		if (IsBucketBefore(columnar1, idx1, bucket1_is_residual, columnar2,
+						   idx2, bucket2_is_residual) ||
+			bucket1->IsBefore(bucket2))
 		{
 			histogram_buckets->Append(bucket1->MakeBucketCopy(m_mp));
 			num_tuples_per_bucket->Append(
@@ -1832,7 +1913,9 @@ CHistogram::MakeUnionHistogramNormalize(CDouble rows,
 			bucket1 = (*this)[idx1];
 			bucket1_is_residual = false;
 		}
-		else if (bucket2->IsBefore(bucket1))
+		else if (IsBucketBefore(columnar2, idx2, bucket2_is_residual,
+								columnar1, idx1, bucket1_is_residual) ||
+				 bucket2->IsBefore(bucket1))
 		{
 			histogram_buckets->Append(bucket2->MakeBucketCopy(m_mp));
 			num_tuples_per_bucket->Append(
@@ -2005,6 +2088,69 @@ CHistogram::operator[](ULONG pos) const
 	return NULL;
 }
 
+// columnar view of the buckets, built on first use. The buckets are never
+// modified in place once they belong to a histogram, so the view stays
+// valid until m_histogram_buckets is replaced
+const CColumnarHistogram *
+CHistogram::GetColumnarHistogram() const
+{
+	if (!m_columnar_histogram_built)
+	{
+		m_columnar_histogram_built = true;
+		if (!IsHistogramForTextRelatedTypes())
+		{
+			m_columnar_histogram =
+				CColumnarHistogram::Create(m_mp, m_histogram_buckets);
+		}
+	}
+
+	return m_columnar_histogram;
+}
+
+// drop the columnar view after the buckets were replaced
+void
+CHistogram::ResetColumnarHistogram()
+{
+	GPOS_DELETE(m_columnar_histogram);
+	m_columnar_histogram = NULL;
+	m_columnar_histogram_built = false;
+}
+
+// range of buckets that may contain the point. Without a columnar view,
+// or for a point that does not map like the buckets, that is all buckets
+void
+CHistogram::GetCandidateBuckets(const CPoint *point, ULONG *begin,
+								ULONG *end) const
+{
+	GPOS_ASSERT(NULL != point);
+
+	*begin = 0;
+	*end = GetNumBuckets();
+
+	const CColumnarHistogram *columnar_histogram = GetColumnarHistogram();
+	DOUBLE value = 0.0;
+	if (NULL != columnar_histogram &&
+		columnar_histogram->MapPoint(point, &value))
+	{
+		*begin = columnar_histogram->FirstBucketNotBelow(value, 0);
+		*end = columnar_histogram->FirstBucketAbove(value, *begin);
+	}
+}
+
+// is the current bucket of one union input clearly before the current bucket
+// of the other input; residual buckets left over from a merge are not part
+// of the columnar views and are always compared with CBucket::IsBefore
+BOOL
+CHistogram::IsBucketBefore(const CColumnarHistogram *columnar1, ULONG idx1,
+						   BOOL bucket1_is_residual,
+						   const CColumnarHistogram *columnar2, ULONG idx2,
+						   BOOL bucket2_is_residual)
+{
+	return NULL != columnar1 && NULL != columnar2 && !bucket1_is_residual &&
+		   !bucket2_is_residual && columnar1->IsComparable(columnar2) &&
+		   columnar1->IsBefore(idx1, columnar2, idx2);
+}
+
 // translate the histogram into a the dxl derived column statistics
 CDXLStatsDerivedColumn *
 CHistogram::TranslateToDXLDerivedColumnStats(CMDAccessor *md_accessor,
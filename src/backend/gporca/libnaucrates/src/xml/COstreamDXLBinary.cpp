@@ -0,0 +1,662 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		COstreamDXLBinary.cpp
+//
+//	@doc:
+//		Implementation of the output stream for binary DXL documents
+//---------------------------------------------------------------------------
+
+#include "naucrates/dxl/xml/COstreamDXLBinary.h"
+
+#include "gpos/common/clibwrapper.h"
+
+using namespace gpdxl;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::CBuffer::CBuffer
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+COstreamDXLBinary::CBuffer::CBuffer(CMemoryPool *mp)
+	: m_mp(mp), m_buffer(NULL), m_length(0), m_capacity(64)
+{
+	m_buffer = GPOS_NEW_ARRAY(m_mp, WCHAR, m_capacity);
+	m_buffer[0] = WCHAR_EOS;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::CBuffer::~CBuffer
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+COstreamDXLBinary::CBuffer::~CBuffer()
+{
+	GPOS_DELETE_ARRAY(m_buffer);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::CBuffer::Append
+//
+//	@doc:
+//		Append a character, doubling the buffer when it is full
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::CBuffer::Append(WCHAR wc)
+{
+	if (m_length + 1 == m_capacity)
+	{
+		WCHAR *buffer = GPOS_NEW_ARRAY(m_mp, WCHAR, m_capacity * 2);
+		clib::Wmemcpy(buffer, m_buffer, m_length);
+		GPOS_DELETE_ARRAY(m_buffer);
+		m_buffer = buffer;
+		m_capacity *= 2;
+	}
+
+	m_buffer[m_length++] = wc;
+	m_buffer[m_length] = WCHAR_EOS;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::HashString
+//
+//	@doc:
+//		Hash function of interned strings
+//
+//---------------------------------------------------------------------------
+ULONG
+COstreamDXLBinary::HashString(const WCHAR *str)
+{
+	return gpos::HashByteArray((const BYTE *) str,
+							   clib::Wcslen(str) * GPOS_SIZEOF(WCHAR));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::EqualStrings
+//
+//	@doc:
+//		Equality function of interned strings
+//
+//---------------------------------------------------------------------------
+BOOL
+COstreamDXLBinary::EqualStrings(const WCHAR *str, const WCHAR *other_str)
+{
+	const ULONG length = clib::Wcslen(str);
+
+	return length == clib::Wcslen(other_str) &&
+		   0 == clib::Wcsncmp(str, other_str, length);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::COstreamDXLBinary
+//
+//	@doc:
+//		Ctor, writes the magic bytes and the version
+//
+//---------------------------------------------------------------------------
+COstreamDXLBinary::COstreamDXLBinary(CMemoryPool *mp, std::ostream &os)
+	: COstream(),
+	  m_mp(mp),
+	  m_os(os),
+	  m_string_ids(NULL),
+	  m_next_string_id(EbdxlstrFirstId),
+	  m_finished(false),
+	  m_state(EtsText),
+	  m_quote(GPOS_WSZ_LIT('"')),
+	  m_token(mp),
+	  m_attribute_name(mp),
+	  m_attribute_value(mp),
+	  m_decoded(mp)
+{
+	GPOS_ASSERT(NULL != mp);
+
+	m_string_ids = GPOS_NEW(m_mp) StringToIdMap(m_mp);
+
+	m_os.write(GPDXL_BINARY_MAGIC, GPDXL_BINARY_MAGIC_LENGTH);
+	m_os.put((CHAR) GPDXL_BINARY_VERSION);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::~COstreamDXLBinary
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+COstreamDXLBinary::~COstreamDXLBinary()
+{
+	Finish();
+
+	m_string_ids->Release();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::IsBinaryDXL
+//
+//	@doc:
+//		Does the given buffer start with the magic bytes of a binary DXL
+//		document
+//
+//---------------------------------------------------------------------------
+BOOL
+COstreamDXLBinary::IsBinaryDXL(const BYTE *buffer, ULONG length)
+{
+	return GPDXL_BINARY_MAGIC_LENGTH <= length &&
+		   0 == clib::Memcmp(buffer, GPDXL_BINARY_MAGIC,
+							 GPDXL_BINARY_MAGIC_LENGTH);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::WriteVarint
+//
+//	@doc:
+//		Write an unsigned LEB128 varint
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::WriteVarint(ULONG value)
+{
+	while (0x80 <= value)
+	{
+		m_os.put((CHAR)((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	m_os.put((CHAR) value);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::WriteString
+//
+//	@doc:
+//		Write a null terminated string as a reference to the string table,
+//		as a new table entry or as a literal
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::WriteString(const WCHAR *str, BOOL intern)
+{
+	const ULONG length = clib::Wcslen(str);
+	intern = intern || GPDXL_BINARY_MAX_INTERNED_LENGTH >= length;
+
+	if (intern)
+	{
+		const ULONG *id = m_string_ids->Find(str);
+		if (NULL != id)
+		{
+			WriteVarint(*id);
+			return;
+		}
+
+		WCHAR *key = GPOS_NEW_ARRAY(m_mp, WCHAR, length + 1);
+		clib::WcStrNCpy(key, str, length + 1);
+		BOOL inserted GPOS_ASSERTS_ONLY = m_string_ids->Insert(
+			key, GPOS_NEW(m_mp) ULONG(m_next_string_id++));
+		GPOS_ASSERT(inserted);
+
+		WriteVarint(EbdxlstrNew);
+	}
+	else
+	{
+		WriteVarint(EbdxlstrLiteral);
+	}
+
+	// count the UTF-16 code units first, characters outside the basic
+	// plane take a surrogate pair
+	ULONG num_units = length;
+	for (ULONG ul = 0; ul < length; ul++)
+	{
+		if (0xffff < (ULONG) str[ul])
+		{
+			num_units++;
+		}
+	}
+	WriteVarint(num_units);
+
+	for (ULONG ul = 0; ul < length; ul++)
+	{
+		ULONG code_point = (ULONG) str[ul];
+		if (0xffff < code_point)
+		{
+			code_point -= 0x10000;
+			ULONG high = 0xd800 + (code_point >> 10);
+			ULONG low = 0xdc00 + (code_point & 0x3ff);
+			m_os.put((CHAR)(high & 0xff));
+			m_os.put((CHAR)(high >> 8));
+			m_os.put((CHAR)(low & 0xff));
+			m_os.put((CHAR)(low >> 8));
+		}
+		else
+		{
+			m_os.put((CHAR)(code_point & 0xff));
+			m_os.put((CHAR)(code_point >> 8));
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::StartElement
+//
+//	@doc:
+//		Start an element; names are always interned
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::StartElement(const WCHAR *name)
+{
+	GPOS_ASSERT(NULL != name);
+	GPOS_ASSERT(!m_finished);
+
+	m_os.put((CHAR) EbdxlrecStartElement);
+	WriteString(name, true /*intern*/);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::AddAttribute
+//
+//	@doc:
+//		Add an attribute to the element just started
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::AddAttribute(const WCHAR *name, const WCHAR *value)
+{
+	GPOS_ASSERT(NULL != name);
+	GPOS_ASSERT(NULL != value);
+	GPOS_ASSERT(!m_finished);
+
+	m_os.put((CHAR) EbdxlrecAttribute);
+	WriteString(name, true /*intern*/);
+	WriteString(value, false /*intern*/);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::EndElement
+//
+//	@doc:
+//		End the innermost open element
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::EndElement()
+{
+	GPOS_ASSERT(!m_finished);
+
+	m_os.put((CHAR) EbdxlrecEndElement);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::AddCharacters
+//
+//	@doc:
+//		Add text content
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::AddCharacters(const WCHAR *text)
+{
+	GPOS_ASSERT(NULL != text);
+	GPOS_ASSERT(!m_finished);
+
+	m_os.put((CHAR) EbdxlrecCharacters);
+	WriteString(text, false /*intern*/);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::Finish
+//
+//	@doc:
+//		End the document
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::Finish()
+{
+	if (m_finished)
+	{
+		return;
+	}
+
+	FlushText();
+	m_os.put((CHAR) EbdxlrecEnd);
+	m_os.flush();
+	m_finished = true;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::Decode
+//
+//	@doc:
+//		Decode the predefined entities and character references that
+//		CXMLSerializer escapes into m_decoded
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::Decode(const CBuffer &str)
+{
+	m_decoded.Reset();
+
+	const WCHAR *wsz = str.GetBuffer();
+	const ULONG length = str.Length();
+	ULONG ul = 0;
+	while (ul < length)
+	{
+		if (GPOS_WSZ_LIT('&') != wsz[ul])
+		{
+			m_decoded.Append(wsz[ul]);
+			ul++;
+			continue;
+		}
+
+		ULONG end = ul + 1;
+		while (end < length && GPOS_WSZ_LIT(';') != wsz[end])
+		{
+			end++;
+		}
+
+		const WCHAR *entity = wsz + ul + 1;
+		const ULONG entity_length = end - ul - 1;
+		WCHAR wc = 0;
+		if (end == length)
+		{
+			// no terminating semicolon, this is not an entity
+		}
+		else if (2 == entity_length &&
+				 0 == clib::Wcsncmp(entity, GPOS_WSZ_LIT("lt"), 2))
+		{
+			wc = GPOS_WSZ_LIT('<');
+		}
+		else if (2 == entity_length &&
+				 0 == clib::Wcsncmp(entity, GPOS_WSZ_LIT("gt"), 2))
+		{
+			wc = GPOS_WSZ_LIT('>');
+		}
+		else if (3 == entity_length &&
+				 0 == clib::Wcsncmp(entity, GPOS_WSZ_LIT("amp"), 3))
+		{
+			wc = GPOS_WSZ_LIT('&');
+		}
+		else if (4 == entity_length &&
+				 0 == clib::Wcsncmp(entity, GPOS_WSZ_LIT("quot"), 4))
+		{
+			wc = GPOS_WSZ_LIT('"');
+		}
+		else if (4 == entity_length &&
+				 0 == clib::Wcsncmp(entity, GPOS_WSZ_LIT("apos"), 4))
+		{
+			wc = GPOS_WSZ_LIT('\'');
+		}
+		else if (1 < entity_length && GPOS_WSZ_LIT('#') == entity[0])
+		{
+			// character reference, decimal or hexadecimal
+			BOOL hex = (GPOS_WSZ_LIT('x') == entity[1]);
+			ULONG code_point = 0;
+			for (ULONG ulDigit = hex ? 2 : 1; ulDigit < entity_length;
+				 ulDigit++)
+			{
+				WCHAR digit = entity[ulDigit];
+				code_point *= hex ? 16 : 10;
+				if (GPOS_WSZ_LIT('0') <= digit && GPOS_WSZ_LIT('9') >= digit)
+				{
+					code_point += digit - GPOS_WSZ_LIT('0');
+				}
+				else if (hex && GPOS_WSZ_LIT('a') <= digit &&
+						 GPOS_WSZ_LIT('f') >= digit)
+				{
+					code_point += digit - GPOS_WSZ_LIT('a') + 10;
+				}
+				else if (hex && GPOS_WSZ_LIT('A') <= digit &&
+						 GPOS_WSZ_LIT('F') >= digit)
+				{
+					code_point += digit - GPOS_WSZ_LIT('A') + 10;
+				}
+			}
+			wc = (WCHAR) code_point;
+		}
+
+		if (0 == wc)
+		{
+			// not an entity we know, keep the ampersand and go on after it
+			m_decoded.Append(wsz[ul]);
+			ul++;
+			continue;
+		}
+
+		m_decoded.Append(wc);
+		ul = end + 1;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::FlushText
+//
+//	@doc:
+//		Write the text read by the tokenizer unless it is all whitespace,
+//		which is what indentation produces
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::FlushText()
+{
+	const WCHAR *wsz = m_token.GetBuffer();
+	const ULONG length = m_token.Length();
+
+	BOOL whitespace = true;
+	for (ULONG ul = 0; ul < length && whitespace; ul++)
+	{
+		whitespace = (GPOS_WSZ_LIT(' ') == wsz[ul] ||
+					  GPOS_WSZ_LIT('\t') == wsz[ul] ||
+					  GPOS_WSZ_LIT('\n') == wsz[ul] ||
+					  GPOS_WSZ_LIT('\r') == wsz[ul]);
+	}
+
+	if (!whitespace)
+	{
+		Decode(m_token);
+		AddCharacters(m_decoded.GetBuffer());
+	}
+	m_token.Reset();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::Tokenize
+//
+//	@doc:
+//		Feed one character of XML text to the tokenizer, writing a record
+//		whenever an element start, an attribute or an element end is
+//		complete
+//
+//---------------------------------------------------------------------------
+void
+COstreamDXLBinary::Tokenize(WCHAR wc)
+{
+	const BOOL space = (GPOS_WSZ_LIT(' ') == wc || GPOS_WSZ_LIT('\t') == wc ||
+						GPOS_WSZ_LIT('\n') == wc || GPOS_WSZ_LIT('\r') == wc);
+
+	switch (m_state)
+	{
+		case EtsText:
+			if (GPOS_WSZ_LIT('<') == wc)
+			{
+				FlushText();
+				m_state = EtsTagOpen;
+			}
+			else
+			{
+				m_token.Append(wc);
+			}
+			break;
+
+		case EtsTagOpen:
+			if (GPOS_WSZ_LIT('/') == wc)
+			{
+				m_state = EtsEndTagName;
+			}
+			else if (GPOS_WSZ_LIT('?') == wc || GPOS_WSZ_LIT('!') == wc)
+			{
+				m_state = EtsSkip;
+			}
+			else
+			{
+				m_token.Append(wc);
+				m_state = EtsStartTagName;
+			}
+			break;
+
+		case EtsStartTagName:
+			if (space || GPOS_WSZ_LIT('/') == wc || GPOS_WSZ_LIT('>') == wc)
+			{
+				StartElement(m_token.GetBuffer());
+				m_token.Reset();
+				m_state = EtsInTag;
+				Tokenize(wc);
+			}
+			else
+			{
+				m_token.Append(wc);
+			}
+			break;
+
+		case EtsEndTagName:
+			// the name was checked by the serializer, only the end of the
+			// tag matters
+			if (GPOS_WSZ_LIT('>') == wc)
+			{
+				EndElement();
+				m_state = EtsText;
+			}
+			break;
+
+		case EtsInTag:
+			if (GPOS_WSZ_LIT('>') == wc)
+			{
+				m_state = EtsText;
+			}
+			else if (GPOS_WSZ_LIT('/') == wc)
+			{
+				m_state = EtsEmptyTagEnd;
+			}
+			else if (!space)
+			{
+				m_attribute_name.Append(wc);
+				m_state = EtsAttributeName;
+			}
+			break;
+
+		case EtsAttributeName:
+			if (GPOS_WSZ_LIT('=') == wc)
+			{
+				m_state = EtsAttributeValueStart;
+			}
+			else if (!space)
+			{
+				m_attribute_name.Append(wc);
+			}
+			break;
+
+		case EtsAttributeValueStart:
+			if (GPOS_WSZ_LIT('"') == wc || GPOS_WSZ_LIT('\'') == wc)
+			{
+				m_quote = wc;
+				m_state = EtsAttributeValue;
+			}
+			break;
+
+		case EtsAttributeValue:
+			if (m_quote == wc)
+			{
+				Decode(m_attribute_value);
+				AddAttribute(m_attribute_name.GetBuffer(),
+							 m_decoded.GetBuffer());
+				m_attribute_name.Reset();
+				m_attribute_value.Reset();
+				m_state = EtsInTag;
+			}
+			else
+			{
+				m_attribute_value.Append(wc);
+			}
+			break;
+
+		case EtsEmptyTagEnd:
+			if (GPOS_WSZ_LIT('>') == wc)
+			{
+				EndElement();
+				m_state = EtsText;
+			}
+			break;
+
+		case EtsSkip:
+			if (GPOS_WSZ_LIT('>') == wc)
+			{
+				m_state = EtsText;
+			}
+			break;
+
+		default:
+			GPOS_ASSERT(!"Unexpected tokenizer state");
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::operator<<
+//
+//	@doc:
+//		Write XML text
+//
+//---------------------------------------------------------------------------
+IOstream &
+COstreamDXLBinary::operator<<(const WCHAR *wsz)
+{
+	GPOS_ASSERT(NULL != wsz);
+
+	for (const WCHAR *wc = wsz; WCHAR_EOS != *wc; wc++)
+	{
+		Tokenize(*wc);
+	}
+
+	return *this;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COstreamDXLBinary::operator<<
+//
+//	@doc:
+//		Write an XML character
+//
+//---------------------------------------------------------------------------
+IOstream &
+COstreamDXLBinary::operator<<(const WCHAR wc)
+{
+	Tokenize(wc);
+
+	return *this;
+}
+
+// EOF
@@ -355,6 +355,31 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, BOOL fValue)
 	AddAttribute(pstrAttr, str_value);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CXMLSerializer::AddCharacters
+//
+//	@doc:
+//		Adds text content to the currently open element; the element is
+//		closed with an end tag afterwards
+//
+//---------------------------------------------------------------------------
+void
+CXMLSerializer::AddCharacters(const CWStringBase *str)
+{
+	GPOS_ASSERT(NULL != str);
+	GPOS_ASSERT(0 < m_ulLevel);
+
+	if (m_fOpenTag)
+	{
+		m_os << CDXLTokens::GetDXLTokenStr(EdxltokenBracketCloseTag)
+					->GetBuffer();	// >
+		m_fOpenTag = false;
+	}
+
+	WriteEscaped(m_os, str);
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CXMLSerializer::Indent
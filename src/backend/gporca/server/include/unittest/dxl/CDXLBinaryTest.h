@@ -0,0 +1,42 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CDXLBinaryTest.h
+//
+//	@doc:
+//		Tests the binary DXL format
+//---------------------------------------------------------------------------
+#ifndef GPOPT_CDXLBinaryTest_H
+#define GPOPT_CDXLBinaryTest_H
+
+#include "gpos/base.h"
+
+namespace gpdxl
+{
+using namespace gpos;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CDXLBinaryTest
+//
+//	@doc:
+//		Static unit tests
+//
+//---------------------------------------------------------------------------
+class CDXLBinaryTest
+{
+public:
+	// unittests
+	static GPOS_RESULT EresUnittest();
+	static GPOS_RESULT EresUnittest_RoundTrip();
+	static GPOS_RESULT EresUnittest_Parse();
+	static GPOS_RESULT EresUnittest_Stream();
+
+};	// class CDXLBinaryTest
+}  // namespace gpdxl
+
+#endif	// !GPOPT_CDXLBinaryTest_H
+
+// EOF
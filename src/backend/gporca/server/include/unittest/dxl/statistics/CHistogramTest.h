@@ -48,6 +48,9 @@ public:
 	// merge basic tests
 	static GPOS_RESULT EresUnittest_MergeUnion();
 
+	// columnar bucket search tests
+	static GPOS_RESULT EresUnittest_ColumnarHistogram();
+
 };	// class CHistogramTest
 }  // namespace gpnaucrates
 
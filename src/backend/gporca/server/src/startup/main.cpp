@@ -35,6 +35,7 @@
 #include "unittest/gpopt/search/CTreeMapTest.h"
 
 #include "unittest/dxl/CDXLMemoryManagerTest.h"
+#include "unittest/dxl/CDXLBinaryTest.h"
 #include "unittest/dxl/CDXLUtilsTest.h"
 #include "unittest/dxl/CParseHandlerManagerTest.h"
 #include "unittest/dxl/CParseHandlerTest.h"
@@ -166,6 +167,7 @@ static gpos::CUnittest rgut[] = {
 	GPOS_UNITTEST_STD(CTranslatorDXLToExprTest),
 	GPOS_UNITTEST_STD(CTranslatorExprToDXLTest),
 	GPOS_UNITTEST_STD(CXMLSerializerTest),
+	GPOS_UNITTEST_STD(CDXLBinaryTest),
 
 	// opt
 	GPOS_UNITTEST_STD(CArrayExpansionTest), GPOS_UNITTEST_STD(CJoinOrderDPTest),
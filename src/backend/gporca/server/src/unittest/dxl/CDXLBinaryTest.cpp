@@ -0,0 +1,196 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2020 VMware, Inc.
+//
+//	@filename:
+//		CDXLBinaryTest.cpp
+//
+//	@doc:
+//		Tests the binary DXL format
+//---------------------------------------------------------------------------
+
+#include <sstream>
+
+#include "gpos/base.h"
+#include "gpos/common/CAutoP.h"
+#include "gpos/common/CAutoRg.h"
+#include "gpos/io/COstreamString.h"
+#include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/test/CUnittest.h"
+
+#include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/dxl/parser/CParseHandlerDXL.h"
+#include "naucrates/dxl/xml/COstreamDXLBinary.h"
+
+#include "unittest/dxl/CDXLBinaryTest.h"
+
+using namespace gpos;
+using namespace gpdxl;
+
+static const CHAR *szMinidumpFile =
+	"../data/dxl/minidump/AddEqualityPredicates.mdp";
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryTest::EresUnittest
+//
+//	@doc:
+//		Unittest for the binary DXL format
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLBinaryTest::EresUnittest()
+{
+	CUnittest rgut[] = {
+		GPOS_UNITTEST_FUNC(CDXLBinaryTest::EresUnittest_RoundTrip),
+		GPOS_UNITTEST_FUNC(CDXLBinaryTest::EresUnittest_Parse),
+		GPOS_UNITTEST_FUNC(CDXLBinaryTest::EresUnittest_Stream),
+	};
+
+	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryTest::EresUnittest_RoundTrip
+//
+//	@doc:
+//		Converting a document to binary, back to XML and to binary again
+//		gives the same binary document, which is smaller than the XML one
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLBinaryTest::EresUnittest_RoundTrip()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CAutoRg<CHAR> dxl_string(CDXLUtils::Read(mp, szMinidumpFile));
+
+	std::ostringstream binary;
+	CDXLUtils::TranscodeXMLToBinary(mp, dxl_string.Rgt(), binary);
+	const std::string binary_dxl = binary.str();
+
+	CWStringDynamic xml(mp);
+	COstreamString oss(&xml);
+	CDXLUtils::TranscodeBinaryToXML(mp, (const BYTE *) binary_dxl.data(),
+									(ULONG) binary_dxl.size(), oss);
+
+	CAutoRg<CHAR> xml_string(
+		CDXLUtils::CreateMultiByteCharStringFromWCString(mp, xml.GetBuffer()));
+	std::ostringstream binary_again;
+	CDXLUtils::TranscodeXMLToBinary(mp, xml_string.Rgt(), binary_again);
+
+	GPOS_RTL_ASSERT(binary_dxl == binary_again.str());
+	GPOS_RTL_ASSERT(binary_dxl.size() < clib::Strlen(dxl_string.Rgt()));
+
+	return GPOS_OK;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryTest::EresUnittest_Parse
+//
+//	@doc:
+//		The parse handlers build the same query and metadata from the
+//		binary document as from the XML one
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLBinaryTest::EresUnittest_Parse()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CAutoRg<CHAR> dxl_string(CDXLUtils::Read(mp, szMinidumpFile));
+
+	std::ostringstream binary;
+	CDXLUtils::TranscodeXMLToBinary(mp, dxl_string.Rgt(), binary);
+	const std::string binary_dxl = binary.str();
+
+	CAutoP<CParseHandlerDXL> xml_parse_handler(
+		CDXLUtils::GetParseHandlerForDXLString(mp, dxl_string.Rgt(),
+											   NULL /*xsd_file_path*/));
+	CAutoP<CParseHandlerDXL> binary_parse_handler(
+		CDXLUtils::GetParseHandlerForBinaryDXL(
+			mp, (const BYTE *) binary_dxl.data(), (ULONG) binary_dxl.size()));
+
+	GPOS_RTL_ASSERT(
+		xml_parse_handler->GetMdIdCachedObjArray()->Size() ==
+		binary_parse_handler->GetMdIdCachedObjArray()->Size());
+
+	CWStringDynamic xml_query(mp);
+	COstreamString xml_oss(&xml_query);
+	CDXLUtils::SerializeQuery(
+		mp, xml_oss, xml_parse_handler->GetQueryDXLRoot(),
+		xml_parse_handler->GetOutputColumnsDXLArray(),
+		xml_parse_handler->GetCTEProducerDXLArray(),
+		false /*serialize_document_header_footer*/, false /*indentation*/);
+
+	CWStringDynamic binary_query(mp);
+	COstreamString binary_oss(&binary_query);
+	CDXLUtils::SerializeQuery(
+		mp, binary_oss, binary_parse_handler->GetQueryDXLRoot(),
+		binary_parse_handler->GetOutputColumnsDXLArray(),
+		binary_parse_handler->GetCTEProducerDXLArray(),
+		false /*serialize_document_header_footer*/, false /*indentation*/);
+
+	GPOS_RTL_ASSERT(xml_query.Equals(&binary_query));
+
+	return GPOS_OK;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryTest::EresUnittest_Stream
+//
+//	@doc:
+//		Writing XML text to the binary stream, the way minidumps are
+//		captured, gives the same document as converting the parsed XML
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLBinaryTest::EresUnittest_Stream()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CAutoRg<CHAR> dxl_string(CDXLUtils::Read(mp, szMinidumpFile));
+
+	std::ostringstream binary;
+	CDXLUtils::TranscodeXMLToBinary(mp, dxl_string.Rgt(), binary);
+
+	CAutoP<CWStringDynamic> xml(
+		CDXLUtils::CreateDynamicStringFromCharArray(mp, dxl_string.Rgt()));
+	std::ostringstream streamed;
+	{
+		COstreamDXLBinary os(mp, streamed);
+		os << xml->GetBuffer();
+	}
+
+	GPOS_RTL_ASSERT(binary.str() == streamed.str());
+
+	// truncated documents are rejected; the objects parsed so far live in
+	// their own pool, which is not checked for leaks when the error unwinds
+	const std::string binary_dxl = binary.str();
+	GPOS_TRY
+	{
+		CAutoMemoryPool ampTruncated;
+		CAutoP<CParseHandlerDXL> parse_handler(
+			CDXLUtils::GetParseHandlerForBinaryDXL(
+				ampTruncated.Pmp(), (const BYTE *) binary_dxl.data(),
+				(ULONG) binary_dxl.size() / 2));
+		GPOS_RTL_ASSERT(!"Truncated binary DXL was parsed");
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		GPOS_RTL_ASSERT(
+			GPOS_MATCH_EX(ex, gpdxl::ExmaDXL, gpdxl::ExmiDXLBinaryParseError));
+		GPOS_RESET_EX;
+	}
+	GPOS_CATCH_END;
+
+	return GPOS_OK;
+}
+
+// EOF
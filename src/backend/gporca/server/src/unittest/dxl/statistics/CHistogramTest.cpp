@@ -21,6 +21,7 @@
 
 #include "naucrates/statistics/CPoint.h"
 #include "naucrates/statistics/CHistogram.h"
+#include "naucrates/statistics/CColumnarHistogram.h"
 
 #include "unittest/base.h"
 #include "unittest/dxl/statistics/CCardinalityTestUtils.h"
@@ -39,7 +40,8 @@ CHistogramTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CHistogramTest::EresUnittest_CHistogramBool),
 		GPOS_UNITTEST_FUNC(CHistogramTest::EresUnittest_Skew),
 		GPOS_UNITTEST_FUNC(CHistogramTest::EresUnittest_CHistogramValid),
-		GPOS_UNITTEST_FUNC(CHistogramTest::EresUnittest_MergeUnion)};
+		GPOS_UNITTEST_FUNC(CHistogramTest::EresUnittest_MergeUnion),
+		GPOS_UNITTEST_FUNC(CHistogramTest::EresUnittest_ColumnarHistogram)};
 
 	CAutoMemoryPool amp;
 	CMemoryPool *mp = amp.Pmp();
@@ -375,4 +377,69 @@ CHistogramTest::EresUnittest_MergeUnion()
 	return GPOS_OK;
 }
 
+// the columnar search range must cover every bucket that contains a point
+GPOS_RESULT
+CHistogramTest::EresUnittest_ColumnarHistogram()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CHistogram *histogram = CCardinalityTestUtils::PhistExampleInt4(mp);
+	const CBucketArray *buckets = histogram->GetBuckets();
+	CColumnarHistogram *columnar_histogram =
+		CColumnarHistogram::Create(mp, buckets);
+	GPOS_RTL_ASSERT(NULL != columnar_histogram);
+	GPOS_RTL_ASSERT(buckets->Size() == columnar_histogram->Size());
+	GPOS_RTL_ASSERT(columnar_histogram->GetFrequency() ==
+					histogram->GetFrequency());
+
+	for (INT value = -5; value <= 110; value++)
+	{
+		CPoint *point = CTestUtils::PpointInt4(mp, value);
+		DOUBLE mapped_value = 0.0;
+		GPOS_RTL_ASSERT(columnar_histogram->MapPoint(point, &mapped_value));
+
+		ULONG begin = columnar_histogram->FirstBucketNotBelow(mapped_value, 0);
+		ULONG end = columnar_histogram->FirstBucketAbove(mapped_value, begin);
+		ULONG num_containing = 0;
+		for (ULONG ul = 0; ul < buckets->Size(); ul++)
+		{
+			if ((*buckets)[ul]->Contains(point))
+			{
+				GPOS_RTL_ASSERT(begin <= ul && ul < end);
+				num_containing++;
+			}
+		}
+
+		// equality filter finds the containing bucket, if any
+		CHistogram *eq_histogram =
+			histogram->MakeHistogramFilter(CStatsPred::EstatscmptEq, point);
+		GPOS_RTL_ASSERT(eq_histogram->GetNumBuckets() == num_containing);
+		GPOS_DELETE(eq_histogram);
+		point->Release();
+	}
+
+	// joining with a histogram whose buckets all lie above this one's skips
+	// straight to the overlapping buckets
+	CBucketArray *upper_buckets = GPOS_NEW(mp) CBucketArray(mp);
+	upper_buckets->Append(CCardinalityTestUtils::PbucketInteger(
+		mp, 85, 95, true /* is_lower_closed */, false /* is_upper_closed */,
+		CDouble(0.5), CDouble(10.0)));
+	upper_buckets->Append(CCardinalityTestUtils::PbucketInteger(
+		mp, 200, 300, true /* is_lower_closed */, false /* is_upper_closed */,
+		CDouble(0.5), CDouble(100.0)));
+	CHistogram *upper_histogram = GPOS_NEW(mp) CHistogram(mp, upper_buckets);
+	CHistogram *join_histogram =
+		histogram->MakeJoinHistogram(CStatsPred::EstatscmptEq, upper_histogram);
+	GPOS_RTL_ASSERT(join_histogram->GetNumBuckets() == 1);
+
+	GPOS_DELETE(columnar_histogram);
+	GPOS_DELETE(join_histogram);
+	GPOS_DELETE(upper_histogram);
+	GPOS_DELETE(histogram);
+
+	return GPOS_OK;
+}
+
 // EOF
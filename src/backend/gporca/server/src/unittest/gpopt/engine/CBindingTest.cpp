@@ -9,6 +9,7 @@
 //		Test for checking bindings extracted for an expression
 //---------------------------------------------------------------------------
 #include "gpopt/engine/CEngine.h"
+#include "gpopt/engine/COptimizationProfile.h"
 #include "gpopt/minidump/CMinidumperUtils.h"
 #include "gpopt/translate/CTranslatorDXLToExpr.h"
 
@@ -131,10 +132,13 @@ CBindingTest::EresUnittest_Basic()
 	CExpression *pexprPlan = eng.PexprExtractPlan();
 	GPOS_ASSERT(NULL != pexprPlan);
 
-	UlongPtrArray *number_of_bindings = eng.GetNumberOfBindings();
+	COptimizationProfile *profile = eng.Profile();
+	GPOS_ASSERT(NULL != profile);
 	ULONG search_stage = 0;
-	ULONG bindings_for_xform = (ULONG)(
-		*number_of_bindings)[search_stage][CXform::ExfJoin2IndexGetApply];
+	ULONG bindings_for_xform =
+		(ULONG) profile->PstageStats(search_stage)
+			->m_rgxform[CXform::ExfJoin2IndexGetApply]
+			.m_ullBindings;
 
 	GPOS_RESULT eres = GPOS_FAILED;
 
@@ -101,6 +101,9 @@ _copyPlannedStmt(const PlannedStmt *from)
 
 	COPY_SCALAR_FIELD(commandType);
 	COPY_SCALAR_FIELD(planGen);
+	COPY_SCALAR_FIELD(planBudgetExhausted);
+	COPY_SCALAR_FIELD(planSearchStagesCompleted);
+	COPY_SCALAR_FIELD(planSearchStages);
 	COPY_SCALAR_FIELD(queryId);
 	COPY_SCALAR_FIELD(hasReturning);
 	COPY_SCALAR_FIELD(hasModifyingCTE);
@@ -340,6 +340,9 @@ _outPlannedStmt(StringInfo str, const PlannedStmt *node)
 
 	WRITE_ENUM_FIELD(commandType, CmdType);
 	WRITE_ENUM_FIELD(planGen, PlanGenerator);
+	WRITE_BOOL_FIELD(planBudgetExhausted);
+	WRITE_INT_FIELD(planSearchStagesCompleted);
+	WRITE_INT_FIELD(planSearchStages);
 	WRITE_UINT64_FIELD(queryId);
 	WRITE_BOOL_FIELD(hasReturning);
 	WRITE_BOOL_FIELD(hasModifyingCTE);
@@ -2401,6 +2401,9 @@ _readPlannedStmt(void)
 
 	READ_ENUM_FIELD(commandType, CmdType);
 	READ_ENUM_FIELD(planGen, PlanGenerator);
+	READ_BOOL_FIELD(planBudgetExhausted);
+	READ_INT_FIELD(planSearchStagesCompleted);
+	READ_INT_FIELD(planSearchStages);
 	READ_UINT64_FIELD(queryId);
 	READ_BOOL_FIELD(hasReturning);
 	READ_BOOL_FIELD(hasModifyingCTE);
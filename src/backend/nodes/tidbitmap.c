@@ -2034,6 +2034,9 @@ opstream_begin_iterate(StreamNode *self, StreamBMIterator *iterator)
 
 		iterator->input.stream = lappend(iterator->input.stream, inIter);
 	}
+
+	/* One page entry per input, reused for every block pulled */
+	iterator->opaque = palloc(list_length(input) * sizeof(PagetableEntry));
 }
 
 static void
@@ -2048,6 +2051,9 @@ opstream_end_iterate(StreamBMIterator *self)
 		tbm_stream_end_iterate(inIter);
 	}
 	list_free(self->input.stream);
+
+	if (self->opaque)
+		pfree(self->opaque);
 }
 
 /*
@@ -2062,6 +2068,7 @@ static bool
 opstream_iterate(StreamBMIterator *iterator, PagetableEntry *e)
 {
 	const StreamNode   *n = iterator->node;
+	PagetableEntry	   *inputs = (PagetableEntry *) iterator->opaque;
 	bool				res = false;
 
 	/*
@@ -2077,10 +2084,9 @@ opstream_iterate(StreamBMIterator *iterator, PagetableEntry *e)
 	 */
 	ListCell   *map;
 	BlockNumber minblockno;
-	ListCell   *cell;
+	int			inputno;
+	int			ninputs;
 	int			wordnum;
-	List	   *matches;
-	bool		empty;
 
 	Assert(n->type == BMS_OR || n->type == BMS_AND);
 
@@ -2101,20 +2107,22 @@ opstream_iterate(StreamBMIterator *iterator, PagetableEntry *e)
 	 * for block 10 for one of the streams: the intersection with fail.
 	 * So, we set the desired block (op->nextblock) to block 15 and loop
 	 * around to the `restart' label.
+	 *
+	 * Each input is pulled into its own slot of the iterator's array of
+	 * page entries, so that nothing is allocated per block.
 	 */
 restart:
 	e->blockno = InvalidBlockNumber;
-	empty = false;
-	matches = NIL;
 	minblockno = InvalidBlockNumber;
+	inputno = 0;
 	Assert(PointerIsValid(iterator->input.stream));
 	foreach(map, iterator->input.stream)
 	{
 		StreamBMIterator *inIter = lfirst(map);
-		PagetableEntry *new;
+		PagetableEntry *new = &inputs[inputno++];
 		bool		r;
 
-		new = (PagetableEntry *) palloc0(sizeof(PagetableEntry));
+		MemSet(new, 0, sizeof(PagetableEntry));
 
 		/* set the desired block */
 		inIter->nextblock = iterator->nextblock;
@@ -2136,11 +2144,10 @@ restart:
 				minblockno = Min(minblockno, new->blockno);
 			else
 				minblockno = Max(minblockno, new->blockno);
-			matches = lappend(matches, (void *) new);
 		}
 		else
 		{
-			pfree(new);
+			new->blockno = InvalidBlockNumber;
 
 			if (n->type == BMS_AND)
 			{
@@ -2152,18 +2159,20 @@ restart:
 				iterator->nextblock = minblockno + 1;	/* seems safe */
 				return false;
 			}
-			else if (n->type == BMS_OR)
-				continue;
 		}
 	}
+	ninputs = inputno;
 
 	/*
 	 * Now we iterate through the actual matches and perform the desired
 	 * operation on those from the same minimum block
 	 */
-	foreach(cell, matches)
+	for (inputno = 0; inputno < ninputs; inputno++)
 	{
-		PagetableEntry *tmp = (PagetableEntry *) lfirst(cell);
+		PagetableEntry *tmp = &inputs[inputno];
+
+		if (tmp->blockno == InvalidBlockNumber)
+			continue;
 
 		if (tmp->blockno == minblockno)
 		{
@@ -2182,16 +2191,21 @@ restart:
 				e->ischunk = true;
 				/* XXX: we can just return now... I think :) */
 				iterator->nextblock = minblockno + 1;
-				list_free_deep(matches);
 				return res;
 			}
 
-			/* union/intersect existing output and new matches */
-			for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
+			/*
+			 * union/intersect existing output and new matches. Keep the
+			 * operator test out of the loops so that they vectorize.
+			 */
+			if (n->type == BMS_OR)
 			{
-				if (n->type == BMS_OR)
+				for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
 					e->words[wordnum] |= tmp->words[wordnum];
-				else
+			}
+			else
+			{
+				for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
 					e->words[wordnum] &= tmp->words[wordnum];
 			}
 			e->recheck |= tmp->recheck;
@@ -2208,20 +2222,12 @@ restart:
 			 */
 
 			iterator->nextblock = minblockno;
-			empty = true;
-			break;
+
+			/* start again */
+			MemSet(e->words, 0, sizeof(tbm_bitmapword) * WORDS_PER_PAGE);
+			goto restart;
 		}
 	}
-	if (empty)
-	{
-		/* start again */
-		empty = false;
-		MemSet(e->words, 0, sizeof(tbm_bitmapword) * WORDS_PER_PAGE);
-		list_free_deep(matches);
-		goto restart;
-	}
-	else
-		list_free_deep(matches);
 	if (res)
 		iterator->nextblock = minblockno + 1;
 
@@ -99,6 +99,7 @@ optimize_query(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	PlannerGlobal  *glob;
 	Query		   *pqueryCopy;
 	PlannedStmt    *result;
+	OrcaPlanCacheKey *cacheKey = NULL;
 	List		   *relationOids;
 	List		   *invalItems;
 	ListCell	   *lc;
@@ -156,6 +157,24 @@ optimize_query(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	 */
 	pqueryCopy = (Query *) transformGroupedWindows((Node *) pqueryCopy, NULL);
 
+	/*
+	 * Reuse the plan of an earlier query that differs only in constants that
+	 * ORCA estimates the same way. A query that folded stable functions must
+	 * be planned anew, though.
+	 */
+	if (!glob->oneoffPlan)
+	{
+		result = orca_plan_cache_lookup(pqueryCopy, cursorOptions, &cacheKey);
+		if (result)
+		{
+			if (optimizer_print_plan_cache)
+				elog(INFO, "GPORCA reused a cached plan");
+			else if (optimizer_log)
+				elog(DEBUG1, "GPORCA reused a cached plan");
+			return result;
+		}
+	}
+
 	/* Ok, invoke ORCA. */
 	result = GPOPTOptimizedPlan(pqueryCopy, &fUnexpectedFailure);
 
@@ -282,6 +301,9 @@ optimize_query(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	result->oneoffPlan = glob->oneoffPlan;
 	result->transientPlan = glob->transientPlan;
 
+	if (cacheKey)
+		orca_plan_cache_insert(cacheKey, result);
+
 	return result;
 }
 
@@ -0,0 +1,912 @@
+/*-------------------------------------------------------------------------
+ *
+ * orcaplancache.c
+ *	  session-local cache of GPORCA plans, keyed on the query shape
+ *
+ * Reporting and dashboard tools send the same statements over and over,
+ * with only the constants in their WHERE clauses changing. Unless they are
+ * prepared, each of them goes through a full GPORCA optimization. This
+ * cache lets such a query reuse the plan produced for an earlier query of
+ * the same shape:
+ *
+ * - Constants compared with a column of a table ("col op const") are the
+ *	 parameters of the shape. The key of a query is its Query tree with those
+ *	 constants replaced by Params, plus the settings that influence GPORCA.
+ *	 All other constants, such as LIMIT counts, stay in the key.
+ *
+ * - A cached plan is reused only if each parameter falls into the same
+ *	 part of its column's statistics as the constant the plan was built
+ *	 with: the same most common value, or the same tenth of the histogram.
+ *	 Parameters of columns without statistics match any value. This keeps a
+ *	 plan built for a rare value from being used for a common one.
+ *
+ * - The constants of the cached plan are then replaced with the new ones.
+ *	 Only constants that the plan compares with a column are replaced, so
+ *	 constants ORCA adds of its own are left alone. To do that
+ *	 unambiguously, a plan is only cached if the parameters of its query were
+ *	 all distinct, none of them equals a constant left in the key, and all of
+ *	 them can be found in the plan.
+ *
+ * Plans are dropped when a relation they depend on changes, including when
+ * it is analyzed, or when the functions, types or operators they use
+ * change, like in plancache.c. Plans that depend on the value of their
+ * constants in other ways (direct dispatch, partitioned tables, one-off
+ * plans) are not cached.
+ *
+ * Portions Copyright (c) 2020-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/optimizer/plan/orcaplancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_statistic.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbplan.h"
+#include "cdb/cdbutil.h"
+#include "lib/ilist.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/orca.h"
+#include "optimizer/walkers.h"
+#include "parser/parsetree.h"
+#include "utils/datum.h"
+#include "utils/guc.h"
+#include "utils/guc_tables.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/syscache.h"
+#include "utils/typcache.h"
+
+/*
+ * Selectivity classes of a parameter. A most common value gets its own
+ * class; other values are classified by the tenth of the histogram they
+ * fall into, counting values below and above the histogram separately.
+ */
+#define PLANCACHE_CLASS_NO_STATS	0
+#define PLANCACHE_CLASS_EXACT		(-1)
+#define PLANCACHE_CLASS_HISTOGRAM	100000
+#define PLANCACHE_HISTOGRAM_PARTS	10
+
+/* Parameters of a query, in the order they appear in its Query tree */
+struct OrcaPlanCacheKey
+{
+	char	   *key;			/* normalized query and settings */
+	bool		ambiguous;		/* a constant in the key equals a parameter */
+	int			nparams;
+	Const	  **params;			/* the constants replaced by Params */
+	int		   *classes;		/* selectivity class of each parameter */
+};
+
+typedef struct OrcaPlanCacheEntry
+{
+	char	   *key;			/* hash table key, must be first */
+	MemoryContext context;		/* holds the entry's key, plan and params */
+	PlannedStmt *plan;
+	int			nparams;
+	Const	  **params;			/* constants the plan was built with */
+	int		   *classes;
+	dlist_node	lru_node;		/* most recently used entries first */
+} OrcaPlanCacheEntry;
+
+typedef struct normalize_context
+{
+	List	   *rtables;		/* range tables of enclosing Queries */
+	List	   *params;			/* constants replaced so far */
+	List	   *columns;		/* (relid, attno) the params are compared to */
+	List	   *literals;		/* constants left in the query */
+	bool		cacheable;
+} normalize_context;
+
+typedef struct rebind_context
+{
+	plan_tree_base_prefix base;
+	int			nparams;
+	Const	  **oldparams;
+	Const	  **newparams;
+	int		   *matches;		/* number of plan constants bound to each */
+} rebind_context;
+
+static MemoryContext OrcaPlanCacheContext = NULL;
+static HTAB *OrcaPlanCacheHash = NULL;
+static dlist_head OrcaPlanCacheLRU = DLIST_STATIC_INIT(OrcaPlanCacheLRU);
+
+/* settings that are part of the key */
+static List *OrcaPlanCacheGucs = NIL;
+
+static void orca_plan_cache_init(void);
+static uint32 orca_plan_cache_hash(const void *key, Size keysize);
+static int	orca_plan_cache_match(const void *key1, const void *key2,
+								  Size keysize);
+static void orca_plan_cache_remove(OrcaPlanCacheEntry *entry);
+static void orca_plan_cache_trim(int size);
+static Node *normalize_query_mutator(Node *node, normalize_context *context);
+static bool is_column_constant(Node *arg, Node *other, normalize_context *context,
+							   Oid *relid, AttrNumber *attno);
+static int	param_selectivity_class(Oid relid, AttrNumber attno, Const *param);
+static bool const_equal(Const *con1, Const *con2);
+static void append_without_locations(StringInfo buf, const char *str);
+static PlannedStmt *rebind_plan(PlannedStmt *stmt, int nparams,
+								Const **oldparams, Const **newparams,
+								int *matches);
+static Node *rebind_plan_mutator(Node *node, rebind_context *context);
+static Node *rebind_const(Const *con, rebind_context *context);
+static void OrcaPlanCacheRelCallback(Datum arg, Oid relid);
+static void OrcaPlanCacheObjectCallback(Datum arg, int cacheid, uint32 hashvalue);
+static void OrcaPlanCacheSysCallback(Datum arg, int cacheid, uint32 hashvalue);
+
+/*
+ * orca_plan_cache_lookup
+ *		Find a cached plan for a query that has been pre-processed for ORCA
+ *
+ * Returns a copy of the cached plan, bound to the constants of the query, or
+ * NULL. If the query can be cached, *key_p is set to its key, to be passed to
+ * orca_plan_cache_insert() once the query has been planned.
+ */
+PlannedStmt *
+orca_plan_cache_lookup(Query *query, int cursorOptions, OrcaPlanCacheKey **key_p)
+{
+	normalize_context context;
+	OrcaPlanCacheKey *key;
+	OrcaPlanCacheEntry *entry;
+	StringInfoData buf;
+	Query	   *normalized;
+	char	   *str;
+	List	   *settings;
+	ListCell   *lc;
+	ListCell   *lcc;
+	ListCell   *lit;
+	PlannedStmt *result;
+	int			i;
+
+	*key_p = NULL;
+
+	if (optimizer_plan_cache_size <= 0)
+	{
+		/* drop anything cached before the cache was disabled */
+		if (OrcaPlanCacheHash)
+			orca_plan_cache_trim(0);
+		return NULL;
+	}
+
+	if (query->commandType != CMD_SELECT || query->utilityStmt != NULL ||
+		query->parentStmtType != PARENTSTMTTYPE_NONE)
+		return NULL;
+
+	orca_plan_cache_init();
+
+	context.rtables = NIL;
+	context.params = NIL;
+	context.columns = NIL;
+	context.literals = NIL;
+	context.cacheable = true;
+	normalized = (Query *) normalize_query_mutator((Node *) query, &context);
+	if (!context.cacheable)
+		return NULL;
+
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "segments=%d cursor=%d", getgpsegmentCount(),
+					 cursorOptions);
+	settings = gp_guc_list_show(PGC_S_DEFAULT, OrcaPlanCacheGucs);
+	foreach(lc, settings)
+		appendStringInfo(&buf, " %s", (char *) lfirst(lc));
+	appendStringInfoChar(&buf, ' ');
+	str = nodeToString(normalized);
+	append_without_locations(&buf, str);
+	pfree(str);
+
+	key = palloc(sizeof(OrcaPlanCacheKey));
+	key->key = buf.data;
+	key->ambiguous = false;
+	key->nparams = list_length(context.params);
+	key->params = palloc(Max(key->nparams, 1) * sizeof(Const *));
+	key->classes = palloc(Max(key->nparams, 1) * sizeof(int));
+	i = 0;
+	forboth(lc, context.params, lcc, context.columns)
+	{
+		List	   *column = (List *) lfirst(lcc);
+
+		key->params[i] = (Const *) lfirst(lc);
+		key->classes[i] = param_selectivity_class(linitial_oid(column),
+												  (AttrNumber) lsecond_oid(column),
+												  key->params[i]);
+
+		/*
+		 * A constant of the plan that equals a parameter is taken for it
+		 * when rebinding, so it must not be a literal of the query too.
+		 */
+		foreach(lit, context.literals)
+		{
+			if (const_equal(key->params[i], (Const *) lfirst(lit)))
+				key->ambiguous = true;
+		}
+		i++;
+	}
+	*key_p = key;
+
+	entry = (OrcaPlanCacheEntry *) hash_search(OrcaPlanCacheHash,
+											   &key->key, HASH_FIND, NULL);
+	if (!entry)
+		return NULL;
+
+	Assert(entry->nparams == key->nparams);
+	for (i = 0; i < key->nparams; i++)
+	{
+		Const	   *oldparam = entry->params[i];
+		Const	   *newparam = key->params[i];
+
+		if (entry->classes[i] != key->classes[i])
+			return NULL;
+
+		if (entry->classes[i] == PLANCACHE_CLASS_EXACT &&
+			!datumIsEqual(oldparam->constvalue, newparam->constvalue,
+						  oldparam->constbyval, oldparam->constlen))
+			return NULL;
+	}
+
+	result = rebind_plan(entry->plan, entry->nparams, entry->params,
+						 key->params, NULL);
+
+	/* the plan was built for another statement text */
+	result->queryId = query->queryId;
+	result->stmt_location = query->stmt_location;
+	result->stmt_len = query->stmt_len;
+
+	dlist_move_head(&OrcaPlanCacheLRU, &entry->lru_node);
+	*key_p = NULL;
+
+	return result;
+}
+
+/*
+ * orca_plan_cache_insert
+ *		Cache the plan ORCA produced for a query with the given key
+ */
+void
+orca_plan_cache_insert(OrcaPlanCacheKey *key, PlannedStmt *plan)
+{
+	OrcaPlanCacheEntry *entry;
+	MemoryContext entrycxt;
+	MemoryContext oldcxt;
+	ListCell   *lc;
+	int		   *matches;
+	bool		found;
+	int			i;
+	int			j;
+
+	Assert(key != NULL);
+
+	if (plan->commandType != CMD_SELECT || plan->oneoffPlan ||
+		plan->transientPlan)
+		return;
+
+	/* a directly dispatched plan is only valid for its constants */
+	for (i = 0; i < plan->numSlices; i++)
+	{
+		if (plan->slices[i].directDispatch.isDirectDispatch)
+			return;
+	}
+
+	foreach(lc, plan->rtable)
+	{
+		RangeTblEntry *rte = (RangeTblEntry *) lfirst(lc);
+
+		if (rte->rtekind == RTE_RELATION &&
+			rte->relkind == RELKIND_PARTITIONED_TABLE)
+			return;
+	}
+
+	/* the constants must identify the plan constants to replace */
+	if (key->ambiguous)
+		return;
+	for (i = 0; i < key->nparams; i++)
+	{
+		for (j = 0; j < i; j++)
+		{
+			if (const_equal(key->params[i], key->params[j]))
+				return;
+		}
+	}
+
+	matches = palloc0(Max(key->nparams, 1) * sizeof(int));
+	(void) rebind_plan(plan, key->nparams, key->params, key->params, matches);
+	for (i = 0; i < key->nparams; i++)
+	{
+		/* the constant was folded away, the plan depends on its value */
+		if (matches[i] == 0)
+			return;
+	}
+	pfree(matches);
+
+	entry = (OrcaPlanCacheEntry *) hash_search(OrcaPlanCacheHash,
+											   &key->key, HASH_FIND, NULL);
+	if (entry)
+		orca_plan_cache_remove(entry);
+	orca_plan_cache_trim(optimizer_plan_cache_size - 1);
+
+	entrycxt = AllocSetContextCreate(OrcaPlanCacheContext,
+									 "ORCA cached plan",
+									 ALLOCSET_START_SMALL_SIZES);
+	oldcxt = MemoryContextSwitchTo(entrycxt);
+
+	entry = (OrcaPlanCacheEntry *) hash_search(OrcaPlanCacheHash,
+											   &key->key, HASH_ENTER, &found);
+	Assert(!found);
+	/* the entry points to the caller's key string until we copy it */
+	entry->key = pstrdup(key->key);
+	entry->context = entrycxt;
+	entry->plan = copyObject(plan);
+	entry->nparams = key->nparams;
+	entry->params = palloc(Max(key->nparams, 1) * sizeof(Const *));
+	entry->classes = palloc(Max(key->nparams, 1) * sizeof(int));
+	for (i = 0; i < key->nparams; i++)
+	{
+		entry->params[i] = copyObject(key->params[i]);
+		entry->classes[i] = key->classes[i];
+	}
+	dlist_push_head(&OrcaPlanCacheLRU, &entry->lru_node);
+
+	MemoryContextSwitchTo(oldcxt);
+
+	if (optimizer_print_plan_cache)
+		elog(INFO, "GPORCA cached the plan");
+}
+
+/*
+ * Set up the cache on first use
+ */
+static void
+orca_plan_cache_init(void)
+{
+	struct config_generic **gucs;
+	HASHCTL		ctl;
+	int			nguc;
+	int			i;
+
+	if (OrcaPlanCacheHash)
+		return;
+
+	OrcaPlanCacheContext = AllocSetContextCreate(CacheMemoryContext,
+												 "ORCA plan cache",
+												 ALLOCSET_DEFAULT_SIZES);
+
+	/* keyed on the whole key string, queries with equal hashes may differ */
+	MemSet(&ctl, 0, sizeof(ctl));
+	ctl.keysize = sizeof(char *);
+	ctl.entrysize = sizeof(OrcaPlanCacheEntry);
+	ctl.hash = orca_plan_cache_hash;
+	ctl.match = orca_plan_cache_match;
+	ctl.hcxt = OrcaPlanCacheContext;
+	OrcaPlanCacheHash = hash_create("ORCA plan cache", 64, &ctl,
+									HASH_ELEM | HASH_FUNCTION | HASH_COMPARE |
+									HASH_CONTEXT);
+
+	/*
+	 * Planner settings, plus the optimizer settings that are developer
+	 * options and hence not in gp_guc_list_for_explain. The setting that
+	 * reports on the cache itself does not change plans.
+	 */
+	gucs = get_guc_variables();
+	nguc = GetNumConfigOptions();
+	for (i = 0; i < nguc; i++)
+	{
+		if (strcmp(gucs[i]->name, "optimizer_print_plan_cache") == 0)
+			continue;
+		if (list_member_ptr(gp_guc_list_for_explain, gucs[i]) ||
+			strncmp(gucs[i]->name, "optimizer", strlen("optimizer")) == 0)
+			OrcaPlanCacheGucs = lappend(OrcaPlanCacheGucs, gucs[i]);
+	}
+
+	CacheRegisterRelcacheCallback(OrcaPlanCacheRelCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(PROCOID, OrcaPlanCacheObjectCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(TYPEOID, OrcaPlanCacheObjectCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(NAMESPACEOID, OrcaPlanCacheSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(OPEROID, OrcaPlanCacheSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(AMOPOPID, OrcaPlanCacheSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(FOREIGNSERVEROID, OrcaPlanCacheSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(FOREIGNDATAWRAPPEROID, OrcaPlanCacheSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(STATRELATTINH, OrcaPlanCacheSysCallback, (Datum) 0);
+}
+
+/*
+ * Hash and match functions of the hash table, whose keys are pointers to key
+ * strings
+ */
+static uint32
+orca_plan_cache_hash(const void *key, Size keysize)
+{
+	const char *str = *(char *const *) key;
+
+	return DatumGetUInt32(hash_any((const unsigned char *) str, strlen(str)));
+}
+
+static int
+orca_plan_cache_match(const void *key1, const void *key2, Size keysize)
+{
+	return strcmp(*(char *const *) key1, *(char *const *) key2);
+}
+
+static void
+orca_plan_cache_remove(OrcaPlanCacheEntry *entry)
+{
+	MemoryContext entrycxt = entry->context;
+
+	dlist_delete(&entry->lru_node);
+	hash_search(OrcaPlanCacheHash, &entry->key, HASH_REMOVE, NULL);
+	MemoryContextDelete(entrycxt);
+}
+
+/*
+ * Evict the least recently used entries until at most 'size' are left
+ */
+static void
+orca_plan_cache_trim(int size)
+{
+	while (hash_get_num_entries(OrcaPlanCacheHash) > Max(size, 0))
+	{
+		OrcaPlanCacheEntry *entry;
+
+		entry = dlist_tail_element(OrcaPlanCacheEntry, lru_node,
+								   &OrcaPlanCacheLRU);
+		orca_plan_cache_remove(entry);
+	}
+}
+
+/*
+ * Copy a Query tree, replacing the constants compared with table columns by
+ * Params, and collect the replaced constants
+ */
+static Node *
+normalize_query_mutator(Node *node, normalize_context *context)
+{
+	if (node == NULL)
+		return NULL;
+
+	if (IsA(node, Query))
+	{
+		Query	   *query = (Query *) node;
+		ListCell   *lc;
+
+		foreach(lc, query->rtable)
+		{
+			RangeTblEntry *rte = (RangeTblEntry *) lfirst(lc);
+
+			/* partition elimination depends on the constants */
+			if (rte->rtekind == RTE_RELATION &&
+				rte->relkind == RELKIND_PARTITIONED_TABLE)
+				context->cacheable = false;
+		}
+
+		context->rtables = lcons(query->rtable, context->rtables);
+		query = query_tree_mutator(query, normalize_query_mutator, context, 0);
+		context->rtables = list_delete_first(context->rtables);
+
+		return (Node *) query;
+	}
+
+	if (IsA(node, Param))
+	{
+		/* the Params we add must be the only ones */
+		context->cacheable = false;
+		return copyObject(node);
+	}
+
+	if (IsA(node, Const))
+	{
+		/* a constant that is not a parameter, it stays in the key */
+		if (!((Const *) node)->constisnull)
+			context->literals = lappend(context->literals, node);
+		return copyObject(node);
+	}
+
+	if (IsA(node, OpExpr) && list_length(((OpExpr *) node)->args) == 2)
+	{
+		OpExpr	   *opexpr = (OpExpr *) node;
+		Node	   *left = linitial(opexpr->args);
+		Node	   *right = lsecond(opexpr->args);
+		Oid			relid;
+		AttrNumber	attno;
+		int			i;
+
+		for (i = 0; i < 2; i++)
+		{
+			Node	   *arg = (i == 0) ? left : right;
+			Node	   *other = (i == 0) ? right : left;
+			OpExpr	   *newexpr;
+			Const	   *con;
+			Param	   *param;
+
+			if (!is_column_constant(arg, other, context, &relid, &attno))
+				continue;
+
+			con = (Const *) arg;
+			context->params = lappend(context->params, con);
+			context->columns = lappend(context->columns,
+									   list_make2_oid(relid, (Oid) attno));
+
+			param = makeNode(Param);
+			param->paramkind = PARAM_EXTERN;
+			param->paramid = list_length(context->params);
+			param->paramtype = con->consttype;
+			param->paramtypmod = con->consttypmod;
+			param->paramcollid = con->constcollid;
+			param->location = -1;
+
+			newexpr = (OpExpr *) palloc(sizeof(OpExpr));
+			memcpy(newexpr, opexpr, sizeof(OpExpr));
+			if (i == 0)
+				newexpr->args = list_make2(param, copyObject(other));
+			else
+				newexpr->args = list_make2(copyObject(other), param);
+
+			return (Node *) newexpr;
+		}
+	}
+
+	return expression_tree_mutator(node, normalize_query_mutator, context);
+}
+
+/*
+ * Is 'arg' a constant that can be a parameter, compared with 'other', a
+ * column of a table? If so, return the table and column.
+ */
+static bool
+is_column_constant(Node *arg, Node *other, normalize_context *context,
+				   Oid *relid, AttrNumber *attno)
+{
+	Const	   *con;
+	Var		   *var;
+	RangeTblEntry *rte;
+
+	if (!IsA(arg, Const) || !IsA(other, Var))
+		return false;
+
+	con = (Const *) arg;
+	var = (Var *) other;
+
+	/*
+	 * Booleans are left in the key, ORCA adds boolean constants of its own
+	 * that we must not mistake for ours. Arrays are left too, their elements
+	 * are what matter to ORCA.
+	 */
+	if (con->constisnull || con->consttype == BOOLOID ||
+		type_is_array(con->consttype))
+		return false;
+
+	if (var->varattno <= 0 ||
+		var->varlevelsup >= list_length(context->rtables))
+		return false;
+
+	rte = rt_fetch(var->varno,
+				   (List *) list_nth(context->rtables, var->varlevelsup));
+	if (rte->rtekind != RTE_RELATION)
+		return false;
+
+	*relid = rte->relid;
+	*attno = var->varattno;
+
+	return true;
+}
+
+/*
+ * Classify a parameter by its position in the statistics of its column,
+ * see the comments at the top of the file
+ */
+static int
+param_selectivity_class(Oid relid, AttrNumber attno, Const *param)
+{
+	HeapTuple	statstuple;
+	AttStatsSlot sslot;
+	TypeCacheEntry *typentry;
+	FmgrInfo   *cmpfunc = NULL;
+	int			result = PLANCACHE_CLASS_EXACT;
+	int			i;
+
+	statstuple = SearchSysCache3(STATRELATTINH,
+								 ObjectIdGetDatum(relid),
+								 Int16GetDatum(attno),
+								 BoolGetDatum(false));
+	if (!HeapTupleIsValid(statstuple))
+		return PLANCACHE_CLASS_NO_STATS;
+
+	typentry = lookup_type_cache(param->consttype, TYPECACHE_CMP_PROC_FINFO);
+	if (OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+		cmpfunc = &typentry->cmp_proc_finfo;
+
+	if (get_attstatsslot(&sslot, statstuple, STATISTIC_KIND_MCV,
+						 InvalidOid, ATTSTATSSLOT_VALUES))
+	{
+		if (sslot.valuetype != param->consttype)
+		{
+			free_attstatsslot(&sslot);
+			ReleaseSysCache(statstuple);
+			return PLANCACHE_CLASS_EXACT;
+		}
+
+		for (i = 0; i < sslot.nvalues; i++)
+		{
+			bool		equal;
+
+			if (cmpfunc)
+				equal = DatumGetInt32(FunctionCall2Coll(cmpfunc, sslot.stacoll,
+														param->constvalue,
+														sslot.values[i])) == 0;
+			else
+				equal = datumIsEqual(param->constvalue, sslot.values[i],
+									 param->constbyval, param->constlen);
+			if (equal)
+			{
+				result = i + 1;
+				break;
+			}
+		}
+		free_attstatsslot(&sslot);
+
+		if (result != PLANCACHE_CLASS_EXACT)
+		{
+			ReleaseSysCache(statstuple);
+			return result;
+		}
+	}
+
+	if (cmpfunc &&
+		get_attstatsslot(&sslot, statstuple, STATISTIC_KIND_HISTOGRAM,
+						 InvalidOid, ATTSTATSSLOT_VALUES))
+	{
+		if (sslot.valuetype == param->consttype && sslot.nvalues >= 2)
+		{
+			int			low = 0;
+			int			high = sslot.nvalues;
+
+			/* find the number of histogram bounds <= the parameter */
+			while (low < high)
+			{
+				int			mid = low + (high - low) / 2;
+
+				if (DatumGetInt32(FunctionCall2Coll(cmpfunc, sslot.stacoll,
+													sslot.values[mid],
+													param->constvalue)) <= 0)
+					low = mid + 1;
+				else
+					high = mid;
+			}
+
+			if (low == 0)
+				result = PLANCACHE_CLASS_HISTOGRAM;
+			else if (low == sslot.nvalues &&
+					 DatumGetInt32(FunctionCall2Coll(cmpfunc, sslot.stacoll,
+													 sslot.values[low - 1],
+													 param->constvalue)) < 0)
+				result = PLANCACHE_CLASS_HISTOGRAM + PLANCACHE_HISTOGRAM_PARTS + 1;
+			else
+			{
+				int			bucket = Min(low - 1, sslot.nvalues - 2);
+
+				result = PLANCACHE_CLASS_HISTOGRAM + 1 +
+					bucket * PLANCACHE_HISTOGRAM_PARTS / (sslot.nvalues - 1);
+			}
+		}
+		free_attstatsslot(&sslot);
+	}
+	else if (cmpfunc)
+	{
+		/* only most common values, and this is not one of them */
+		result = PLANCACHE_CLASS_HISTOGRAM;
+	}
+
+	ReleaseSysCache(statstuple);
+
+	return result;
+}
+
+/*
+ * Are two non-null constants of the same type and value? This is how
+ * rebind_plan_mutator() identifies the plan constants to replace.
+ */
+static bool
+const_equal(Const *con1, Const *con2)
+{
+	return con1->consttype == con2->consttype &&
+		datumIsEqual(con1->constvalue, con2->constvalue,
+					 con1->constbyval, con1->constlen);
+}
+
+/*
+ * Append a node string, leaving out the values of location fields, which
+ * change with the length of the constants in the query text
+ */
+static void
+append_without_locations(StringInfo buf, const char *str)
+{
+	static const char *const fields[] = {
+		":location ", ":stmt_location ", ":stmt_len "
+	};
+
+	while (*str)
+	{
+		bool		skipped = false;
+		int			i;
+
+		if (*str == ':')
+		{
+			for (i = 0; i < lengthof(fields); i++)
+			{
+				size_t		len = strlen(fields[i]);
+
+				if (strncmp(str, fields[i], len) == 0)
+				{
+					appendBinaryStringInfo(buf, str, len);
+					str += len;
+					if (*str == '-')
+						str++;
+					while (isdigit((unsigned char) *str))
+						str++;
+					skipped = true;
+					break;
+				}
+			}
+		}
+
+		if (!skipped)
+			appendStringInfoChar(buf, *str++);
+	}
+}
+
+/*
+ * Copy a plan, replacing the constants equal to one of 'oldparams' with the
+ * corresponding 'newparams'. Like the parameters of the query, only the
+ * constants compared with a column are candidates. If 'matches' is not NULL,
+ * count the replaced constants of each parameter in it.
+ */
+static PlannedStmt *
+rebind_plan(PlannedStmt *stmt, int nparams, Const **oldparams,
+			Const **newparams, int *matches)
+{
+	rebind_context context;
+	PlannedStmt *result;
+	ListCell   *lc;
+
+	exec_init_plan_tree_base(&context.base, stmt);
+	context.nparams = nparams;
+	context.oldparams = oldparams;
+	context.newparams = newparams;
+	context.matches = matches;
+
+	result = copyObject(stmt);
+	result->planTree = (Plan *) rebind_plan_mutator((Node *) result->planTree,
+													&context);
+	foreach(lc, result->subplans)
+		lfirst(lc) = rebind_plan_mutator((Node *) lfirst(lc), &context);
+
+	return result;
+}
+
+static Node *
+rebind_plan_mutator(Node *node, rebind_context *context)
+{
+	if (node == NULL)
+		return NULL;
+
+	if (IsA(node, OpExpr) && list_length(((OpExpr *) node)->args) == 2)
+	{
+		OpExpr	   *opexpr = (OpExpr *) node;
+		Node	   *left = linitial(opexpr->args);
+		Node	   *right = lsecond(opexpr->args);
+		OpExpr	   *newexpr;
+
+		newexpr = (OpExpr *) palloc(sizeof(OpExpr));
+		memcpy(newexpr, opexpr, sizeof(OpExpr));
+		if (IsA(left, Const) && IsA(strip_implicit_coercions(right), Var))
+			newexpr->args = list_make2(rebind_const((Const *) left, context),
+									   copyObject(right));
+		else if (IsA(right, Const) && IsA(strip_implicit_coercions(left), Var))
+			newexpr->args = list_make2(copyObject(left),
+									   rebind_const((Const *) right, context));
+		else
+		{
+			pfree(newexpr);
+			return plan_tree_mutator(node, rebind_plan_mutator, context, false);
+		}
+		return (Node *) newexpr;
+	}
+
+	return plan_tree_mutator(node, rebind_plan_mutator, context, false);
+}
+
+/*
+ * Return a copy of a plan constant compared with a column, with the value of
+ * the new parameter if it is equal to one of the old ones
+ */
+static Node *
+rebind_const(Const *con, rebind_context *context)
+{
+	int			i;
+
+	for (i = 0; i < context->nparams && !con->constisnull; i++)
+	{
+		Const	   *oldparam = context->oldparams[i];
+		Const	   *newparam = context->newparams[i];
+		Const	   *newcon;
+
+		if (!const_equal(con, oldparam))
+			continue;
+
+		if (context->matches)
+			context->matches[i]++;
+
+		newcon = (Const *) copyObject(con);
+		newcon->constvalue = datumCopy(newparam->constvalue,
+									   newparam->constbyval,
+									   newparam->constlen);
+		return (Node *) newcon;
+	}
+
+	return (Node *) copyObject(con);
+}
+
+/*
+ * Relcache invalidation callback: drop the plans that depend on the relation,
+ * or all plans for InvalidOid
+ */
+static void
+OrcaPlanCacheRelCallback(Datum arg, Oid relid)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &OrcaPlanCacheLRU)
+	{
+		OrcaPlanCacheEntry *entry = dlist_container(OrcaPlanCacheEntry,
+													lru_node, iter.cur);
+
+		if (relid == InvalidOid ||
+			list_member_oid(entry->plan->relationOids, relid))
+			orca_plan_cache_remove(entry);
+	}
+}
+
+/*
+ * Syscache invalidation callback for the objects listed in the invalItems of
+ * the plans, see PlanCacheObjectCallback
+ */
+static void
+OrcaPlanCacheObjectCallback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &OrcaPlanCacheLRU)
+	{
+		OrcaPlanCacheEntry *entry = dlist_container(OrcaPlanCacheEntry,
+													lru_node, iter.cur);
+		ListCell   *lc;
+
+		foreach(lc, entry->plan->invalItems)
+		{
+			PlanInvalItem *item = (PlanInvalItem *) lfirst(lc);
+
+			if (item->cacheId != cacheid)
+				continue;
+			if (hashvalue == 0 || item->hashValue == hashvalue)
+			{
+				orca_plan_cache_remove(entry);
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * Syscache invalidation callback for catalogs that plans depend on in ways we
+ * do not track, including the statistics: drop all plans
+ */
+static void
+OrcaPlanCacheSysCallback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	OrcaPlanCacheRelCallback(arg, InvalidOid);
+}
@@ -631,18 +631,28 @@ cdb_estimate_rel_size(RelOptInfo   *relOptInfo,
  * inheritance), this sums up the estimates from the child tables. Also, if
  * gp_enable_relsize_collection is off, and none of the partitions have been
  * analyzed, this returns 0 rather than the default constant estimate.
+ *
+ * A table can have tens of thousands of partitions, so the per-partition
+ * work is kept small: the tuple counts are read from the pg_class entries
+ * without opening the partitions, and the sizes of the unanalyzed
+ * partitions are collected from the segments in batches. A partition is
+ * only opened if it turns out to be non-empty, to estimate its tuple width.
  */
 double
 cdb_estimate_partitioned_numtuples(Relation rel)
 {
 	List	   *inheritors;
+	List	   *unsized = NIL;
 	ListCell   *lc;
 	double		totaltuples;
-
+	bool		local;
 
 	if (rel->rd_rel->reltuples > 0)
 		return rel->rd_rel->reltuples;
 
+	/* as in cdb_estimate_rel_size(), sizes of local tables are not dispatched */
+	local = (!rel->rd_cdbpolicy || GpPolicyIsEntry(rel->rd_cdbpolicy));
+
 	inheritors = find_all_inheritors(RelationGetRelid(rel),
 									 AccessShareLock,
 									 NULL);
@@ -650,42 +660,98 @@ cdb_estimate_partitioned_numtuples(Relation rel)
 	foreach(lc, inheritors)
 	{
 		Oid			childid = lfirst_oid(lc);
-		Relation	childrel;
+		HeapTuple	tuple;
+		Form_pg_class classForm;
 		double		childtuples;
 
-		if (childid != RelationGetRelid(rel))
-			childrel = try_table_open(childid, NoLock, false);
-		else
-			childrel = rel;
+		tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(childid));
+		if (!HeapTupleIsValid(tuple))
+			continue;			/* dropped concurrently */
+		classForm = (Form_pg_class) GETSTRUCT(tuple);
 
-		childtuples = childrel->rd_rel->reltuples;
+		childtuples = classForm->reltuples;
 
-		if (gp_enable_relsize_collection && childtuples == 0)
+		if (childtuples == 0 && rel_is_external_table(childid))
 		{
-			RelOptInfo *dummy_reloptinfo;
-			BlockNumber	numpages;
-			double		allvisfrac;
-
-			dummy_reloptinfo = makeNode(RelOptInfo);
-			dummy_reloptinfo->cdbpolicy = rel->rd_cdbpolicy;
-
-			cdb_estimate_rel_size(dummy_reloptinfo,
-								  childrel,
-								  NULL,
-								  &numpages,
-								  &childtuples,
-								  &allvisfrac);
-			pfree(dummy_reloptinfo);
+			childtuples = DEFAULT_EXTERNAL_TABLE_TUPLES;
 		}
-		if (childtuples == 0 && rel_is_external_table(RelationGetRelid(childrel)))
+		else if (gp_enable_relsize_collection && childtuples == 0 &&
+				 classForm->relpages == 0 &&
+				 RELKIND_HAS_STORAGE(classForm->relkind))
 		{
-			childtuples = DEFAULT_EXTERNAL_TABLE_TUPLES;
+			/*
+			 * Never analyzed. A partition that was analyzed has no tuples
+			 * if it has no tuples per page, and a partitioned table has no
+			 * storage of its own.
+			 */
+			if (local)
+			{
+				Relation	childrel;
+				RelOptInfo *dummy_reloptinfo;
+				BlockNumber	numpages;
+				double		allvisfrac;
+
+				childrel = try_table_open(childid, NoLock, false);
+				if (childrel)
+				{
+					dummy_reloptinfo = makeNode(RelOptInfo);
+					dummy_reloptinfo->cdbpolicy = rel->rd_cdbpolicy;
+
+					cdb_estimate_rel_size(dummy_reloptinfo,
+										  childrel,
+										  NULL,
+										  &numpages,
+										  &childtuples,
+										  &allvisfrac);
+					pfree(dummy_reloptinfo);
+					heap_close(childrel, NoLock);
+				}
+			}
+			else
+				unsized = lappend_oid(unsized, childid);
 		}
 		totaltuples += childtuples;
 
-		if (childrel != rel)
+		ReleaseSysCache(tuple);
+	}
+
+	if (unsized != NIL)
+	{
+		int64	   *sizes;
+		int			i = 0;
+
+		sizes = (int64 *) palloc(sizeof(int64) * list_length(unsized));
+		cdbRelMaxSegSizes(unsized, sizes);
+
+		foreach(lc, unsized)
+		{
+			BlockNumber curpages = sizes[i++] / BLCKSZ;
+			Relation	childrel;
+			int32		tuple_width;
+			double		density;
+
+			if (curpages == 0)
+				continue;
+
+			childrel = try_table_open(lfirst_oid(lc), NoLock, false);
+			if (!childrel)
+				continue;
+
+			/* estimate tuples per page as cdb_estimate_rel_size() does */
+			tuple_width = get_rel_data_width(childrel, NULL);
+			tuple_width += sizeof(HeapTupleHeaderData);
+			tuple_width += sizeof(ItemPointerData);
+			/* note: integer division is intentional here */
+			density = (BLCKSZ - SizeOfPageHeaderData) / tuple_width;
+			totaltuples += rint(density * (double) curpages);
+
 			heap_close(childrel, NoLock);
+		}
+
+		pfree(sizes);
+		list_free(unsized);
 	}
+
 	return totaltuples;
 }
 
@@ -26,6 +26,7 @@
 #include "access/distributedlog.h"
 #include "cdb/cdblocaldistribxact.h"
 #include "cdb/cdbvars.h"
+#include "cdb/ml_ipc.h"
 #include "commands/async.h"
 #include "executor/nodeShareInputScan.h"
 #include "miscadmin.h"
@@ -195,6 +196,7 @@ CreateSharedMemoryAndSemaphores(int port)
 		size = add_size(size, CancelBackendMsgShmemSize());
 		size = add_size(size, WorkFileShmemSize());
 		size = add_size(size, ShareInputShmemSize());
+		size = add_size(size, ICPeerStatsShmemSize());
 
 #ifdef FAULT_INJECTOR
 		size = add_size(size, FaultInjector_ShmemSize());
@@ -358,6 +360,7 @@ CreateSharedMemoryAndSemaphores(int port)
 	BackendCancelShmemInit();
 	WorkFileShmemInit();
 	ShareInputShmemInit();
+	ICPeerStatsShmemInit();
 
 	/*
 	 * Set up Instrumentation free list
@@ -1643,9 +1643,7 @@ SnapshotResetDslm(Snapshot snapshot)
 	snapshot->haveDistribSnapshot = false;
 
 	dslm = &snapshot->distribSnapshotWithLocalMapping;
-	dslm->currentLocalXidsCount = 0;
-	dslm->minCachedLocalXid = InvalidTransactionId;
-	dslm->maxCachedLocalXid = InvalidTransactionId;
+	DistributedSnapshotWithLocalMapping_ResetCache(dslm);
 	if (dslm->inProgressMappedLocalXids == NULL)
 	{
 		dslm->inProgressMappedLocalXids =
@@ -266,8 +266,13 @@ ReadyForQuery(CommandDest dest)
 					pq_sendint64(&buf, VmemTracker_GetMaxReservedVmemBytes());
 					pq_endmessage(&buf);
 
+					/*
+					 * Report whether the transaction has assigned an xid, and
+					 * so will write a commit record. Only those QEs need to
+					 * take part in a two phase commit.
+					 */
 					pq_beginmessage(&buf, 'x');
-					pq_sendbyte(&buf, TransactionDidWriteXLog());
+					pq_sendbyte(&buf, TransactionIdIsValid(GetTopTransactionIdIfAny()));
 					pq_endmessage(&buf);
 				}
 
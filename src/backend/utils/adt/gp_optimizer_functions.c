@@ -8,6 +8,10 @@
  *
  * gp_opt_version: This function wraps LibraryVersion. 
  *
+ * gp_optimizer_profile: This function wraps OptimizerProfile.
+ *
+ * gp_optimizer_profile_reset: This function wraps ResetOptimizerProfile.
+ *
  * Copyright(c) 2012 - present, EMC/Greenplum
  */
 
@@ -46,6 +50,39 @@ disable_xform(PG_FUNCTION_ARGS)
 #endif
 }
 
+extern Datum OptimizerProfile(PG_FUNCTION_ARGS);
+
+/*
+* Returns the optimizer profile of the session.
+*/
+Datum
+gp_optimizer_profile(PG_FUNCTION_ARGS)
+{
+#ifdef USE_ORCA
+	return OptimizerProfile(fcinfo);
+#else
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("server has been compiled without ORCA")));
+	PG_RETURN_VOID();
+#endif
+}
+
+extern Datum ResetOptimizerProfile(PG_FUNCTION_ARGS);
+
+/*
+* Discards the optimizer profile of the session.
+*/
+Datum
+gp_optimizer_profile_reset(PG_FUNCTION_ARGS)
+{
+#ifdef USE_ORCA
+	return ResetOptimizerProfile(fcinfo);
+#else
+	PG_RETURN_VOID();
+#endif
+}
+
 extern Datum LibraryVersion();
 	
 /*
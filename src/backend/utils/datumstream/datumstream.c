@@ -522,6 +522,36 @@ create_datumstreamwrite(
 						  maxsz,
 						  attr);
 
+	/*
+	 * With adaptive encoding, columns that are not RLE_TYPE compressed are
+	 * written in the Dense format too, so that each block can use RLE_TYPE
+	 * and Delta Range encoding when sampling shows they pay off.  Any bulk
+	 * compression is still applied on top of the block.  Readers follow the
+	 * version recorded in each block header.
+	 */
+	if (gp_aocs_adaptive_encoding &&
+		acc->datumStreamVersion == DatumStreamVersion_Original)
+	{
+		acc->datumStreamVersion = DatumStreamVersion_Dense_Enhanced;
+		acc->rle_want_compression = true;
+		acc->delta_want_compression = is_deltarange_compression_supported(attr);
+		acc->ao_attr.safeFSWriteSize = safeFSWriteSize;
+	}
+
+	/*
+	 * Dictionary encoding of variable-length columns also needs the Dense
+	 * format, where blocks with few distinct values store each value once.
+	 */
+	if (gp_aocs_dictionary_encoding &&
+		acc->typeInfo.datumlen == -1 &&
+		acc->datumStreamVersion == DatumStreamVersion_Original)
+	{
+		acc->datumStreamVersion = DatumStreamVersion_Dense_Enhanced;
+		acc->rle_want_compression = false;
+		acc->delta_want_compression = false;
+		acc->ao_attr.safeFSWriteSize = safeFSWriteSize;
+	}
+
 	compressionFunctions = NULL;
 	compressionState = NULL;
 	verifyBlockCompressionState = NULL;
@@ -618,6 +648,9 @@ create_datumstreamwrite(
 							   acc->datumStreamVersion,
 							   acc->rle_want_compression,
 							   acc->delta_want_compression,
+							   /* adaptive */ gp_aocs_adaptive_encoding,
+							   /* dictionary */ (gp_aocs_dictionary_encoding &&
+												 acc->typeInfo.datumlen == -1),
 							   initialMaxDatumPerBlock,
 							   maxDatumPerBlock,
 							   acc->maxAoBlockSize - acc->maxAoHeaderSize,
@@ -837,6 +870,7 @@ datumstreamread_open_file(DatumStreamRead * ds, char *fn, int64 eof, int64 eofUn
 	AppendOnlyStorageRead_OpenFile(&ds->ao_read, fn, version, ds->eof);
 
 	ds->need_close_file = true;
+	ds->blockContentRead = false;
 }
 
 void
@@ -863,6 +897,7 @@ datumstreamread_close_file(DatumStreamRead * ds)
 	AppendOnlyStorageRead_CloseFile(&ds->ao_read);
 
 	ds->need_close_file = false;
+	ds->blockContentRead = false;
 }
 
 static int64
@@ -1137,6 +1172,10 @@ datumstreamread_block_get_ready(DatumStreamRead * acc)
 		bool		hadToAdjustRowCount;
 		int32		adjustedRowCount;
 
+		if (acc->datumStreamVersion == DatumStreamVersion_Original)
+			DatumStreamBlockRead_AdoptBlockVersion(&acc->blockRead,
+												   acc->buffer_beginp);
+
 		DatumStreamBlockRead_GetReady(
 									  &acc->blockRead,
 									  acc->buffer_beginp,
@@ -1283,6 +1322,8 @@ datumstreamread_block_content(DatumStreamRead * acc)
 	 * Unpack the information from the block headers and get ready to read the first datum.
 	 */
 	datumstreamread_block_get_ready(acc);
+
+	acc->blockContentRead = true;
 }
 
 
@@ -1416,6 +1457,54 @@ datumstreamread_find(DatumStreamRead * datumStream,
 	Assert(rowNumInBlock == DatumStreamBlockRead_Nth(&datumStream->blockRead));
 }
 
+/*
+ * Position the datum stream on the given row of the currently open segment
+ * file.  Used by late materialization, where a column is only read for rows
+ * that passed the scan qual.  Rows must be requested in ascending order.
+ *
+ * Blocks that end before the requested row are stepped over using their
+ * headers alone, so their content is never read into the datum stream
+ * buffer nor decompressed.
+ *
+ * Returns false if the segment file ends before the row is reached.
+ */
+bool
+datumstreamread_seek_row(DatumStreamRead * datumStream,
+						 int64 rowNum)
+{
+	while (!datumStream->blockContentRead ||
+		   rowNum >= datumStream->blockFirstRowNum + datumStream->blockRowCount)
+	{
+		datumStream->blockContentRead = false;
+
+		if (!datumstreamread_block_info(datumStream))
+			return false;
+
+		if (rowNum >= datumStream->blockFirstRowNum + datumStream->blockRowCount)
+		{
+			AppendOnlyStorageRead_SkipCurrentBlock(&datumStream->ao_read);
+			continue;
+		}
+
+		datumstreamread_block_content(datumStream);
+	}
+
+	if (rowNum < datumStream->blockFirstRowNum)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("row " INT64_FORMAT " is before the current block of datum stream '%s' "
+						"(firstRowNum " INT64_FORMAT ", rowCount %d)",
+						rowNum,
+						datumStream->title,
+						datumStream->blockFirstRowNum,
+						datumStream->blockRowCount)));
+
+	datumstreamread_find(datumStream,
+						 (int32) (rowNum - datumStream->blockFirstRowNum));
+
+	return true;
+}
+
 /*
  * Find the block that contains the given row.
  */
@@ -43,6 +43,17 @@ static void DatumStreamBlock_IntegrityCheckDense(
 							 int (*errcontextCallback) (void *errcontextArg),
 									 void *errcontextArg);
 
+static void DatumStreamBlock_IntegrityCheckDictionary(
+									 uint8 * physicalData,
+									 int32 physicalDataSize,
+									 int32 physicalDatumCount,
+									 DatumStreamVersion datumStreamVersion,
+									 DatumStreamTypeInfo * typeInfo,
+							   int (*errdetailCallback) (void *errdetailArg),
+									 void *errdetailArg,
+							 int (*errcontextCallback) (void *errcontextArg),
+									 void *errcontextArg);
+
 /* Proper align with zero padding */
 static inline char *
 att_align_zero(char *data, char alignchar)
@@ -403,7 +414,12 @@ void
 DatumStreamBlockRead_Finish(
 							DatumStreamBlockRead * dsr)
 {
-	/* Place holder. */
+	if (dsr->dictionary_entries != NULL)
+	{
+		pfree(dsr->dictionary_entries);
+		dsr->dictionary_entries = NULL;
+		dsr->dictionary_entries_maxcount = 0;
+	}
 }
 
 /*
@@ -609,6 +625,122 @@ DatumStreamBlockRead_ResetDense(DatumStreamBlockRead * dsr)
 
 	dsr->delta_block_was_compressed = false;
 	dsr->delta_item = false;
+
+	dsr->dictionary_block_was_compressed = false;
+	dsr->dictionary_count = 0;
+	dsr->dictionary_code_size = 0;
+	dsr->dictionary_codesp = NULL;
+}
+
+/*
+ * Unpack the dictionary of a dictionary encoded Dense block, which sits at
+ * the beginning of the physical data area, and position on the item of the
+ * first physical datum.
+ */
+static void
+DatumStreamBlockRead_GetReadyDictionary(
+										DatumStreamBlockRead * dsr)
+{
+	DatumStreamBlock_Dictionary_Extension *dictionaryExtension;
+	int64		codesAlignedSize;
+	uint8	   *p;
+	int32		i;
+
+	if (dsr->typeInfo.datumlen != -1 ||
+		dsr->physical_data_size < (int32) sizeof(DatumStreamBlock_Dictionary_Extension))
+	{
+		ereport(ERROR,
+				(errmsg("Bad datum stream dictionary encoded block (datum length %d, physical data size %d)",
+						dsr->typeInfo.datumlen,
+						dsr->physical_data_size),
+				 errdetail_datumstreamblockread(dsr),
+				 errcontext_datumstreamblockread(dsr)));
+	}
+
+	dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) dsr->datum_beginp;
+	dsr->dictionary_count = dictionaryExtension->dictionary_count;
+	dsr->dictionary_code_size = dictionaryExtension->code_size;
+
+	codesAlignedSize = MAXALIGN(sizeof(DatumStreamBlock_Dictionary_Extension) +
+								(int64) dsr->physical_datum_count * dsr->dictionary_code_size);
+
+	if (dsr->dictionary_count <= 0 ||
+		dsr->dictionary_count > DATUMSTREAM_DICTIONARY_MAX_COUNT ||
+		(dsr->dictionary_code_size != 1 && dsr->dictionary_code_size != 2) ||
+		dictionaryExtension->dictionary_size <= 0 ||
+		codesAlignedSize + dictionaryExtension->dictionary_size != dsr->physical_data_size)
+	{
+		ereport(ERROR,
+				(errmsg("Bad datum stream dictionary header (dictionary count %d, dictionary size %d, code size %d, "
+						"physical datum count %d, physical data size %d)",
+						dsr->dictionary_count,
+						dictionaryExtension->dictionary_size,
+						dsr->dictionary_code_size,
+						dsr->physical_datum_count,
+						dsr->physical_data_size),
+				 errdetail_datumstreamblockread(dsr),
+				 errcontext_datumstreamblockread(dsr)));
+	}
+
+	dsr->dictionary_codesp = dsr->datum_beginp + sizeof(DatumStreamBlock_Dictionary_Extension);
+	dsr->dictionary_block_was_compressed = true;
+
+	/*
+	 * Codes index the entries array directly, so verify them even when the
+	 * full integrity checks are off.
+	 */
+	for (i = 0; i < dsr->physical_datum_count; i++)
+	{
+		if (DatumStreamBlockRead_DictionaryCode(dsr, i) >= dsr->dictionary_count)
+			ereport(ERROR,
+					(errmsg("Bad datum stream dictionary code %d for physical datum %d (dictionary count %d)",
+							DatumStreamBlockRead_DictionaryCode(dsr, i),
+							i,
+							dsr->dictionary_count),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+	}
+
+	if (dsr->dictionary_entries_maxcount < dsr->dictionary_count)
+	{
+		MemoryContext oldCtxt;
+
+		oldCtxt = MemoryContextSwitchTo(dsr->memctxt);
+		if (dsr->dictionary_entries != NULL)
+			pfree(dsr->dictionary_entries);
+		dsr->dictionary_entries = palloc(dsr->dictionary_count * sizeof(uint8 *));
+		dsr->dictionary_entries_maxcount = dsr->dictionary_count;
+		MemoryContextSwitchTo(oldCtxt);
+	}
+
+	/*
+	 * Locate the items, skipping zero padding just like when reading a plain
+	 * block.
+	 */
+	p = dsr->datum_beginp + codesAlignedSize;
+	for (i = 0; i < dsr->dictionary_count; i++)
+	{
+		if (i > 0 && p < dsr->datum_afterp && *p == 0)
+			p = (uint8 *) att_align_nominal(p, dsr->typeInfo.align);
+
+		if (p >= dsr->datum_afterp ||
+			p + VARSIZE_ANY(p) > dsr->datum_afterp)
+			ereport(ERROR,
+					(errmsg("Bad datum stream dictionary item %d out of bounds (dictionary count %d, dictionary size %d)",
+							i,
+							dsr->dictionary_count,
+							dictionaryExtension->dictionary_size),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+
+		dsr->dictionary_entries[i] = p;
+		p += VARSIZE_ANY(p);
+	}
+
+	dsr->dictionary_generation++;
+
+	if (dsr->physical_datum_count > 0)
+		dsr->datump = dsr->dictionary_entries[DatumStreamBlockRead_DictionaryCode(dsr, 0)];
 }
 
 void
@@ -943,6 +1075,9 @@ DatumStreamBlockRead_GetReadyDense(
 		}
 	}
 	dsr->datump = dsr->datum_beginp;
+
+	if ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0)
+		DatumStreamBlockRead_GetReadyDictionary(dsr);
 }
 
 static int
@@ -3559,6 +3694,82 @@ DatumStreamBlockWrite_Nth(DatumStreamBlockWrite * dsw)
 	return dsw->nth;
 }
 
+/*
+ * Decide which encodings to attempt for the next block, based on what the
+ * block that was just written achieved.
+ *
+ * Attempting RLE_TYPE costs a comparison with the previous item for every
+ * datum, and Delta Range a subtraction and range check.  When a sampled block
+ * shows that an encoding does not pay off for this column, stop attempting it
+ * for a while and sample again later, since the data distribution can change
+ * along the column.
+ */
+static void
+DatumStreamBlockWrite_AdaptiveChoose(
+									 DatumStreamBlockWrite * dsw)
+{
+	if (dsw->rle_can_compression)
+	{
+		if (dsw->rle_want_compression)
+		{
+			int32		elidedRows;
+
+			/*
+			 * Rows represented by a repeat count rather than a physical datum
+			 * or a NULL bit.
+			 */
+			elidedRows = dsw->nth - dsw->always_null_bitmap_count;
+
+			if (elidedRows * DATUMSTREAM_ADAPTIVE_RLE_MIN_FRACTION < dsw->nth)
+			{
+				dsw->rle_want_compression = false;
+				dsw->rle_skip_blocks = DATUMSTREAM_ADAPTIVE_RESAMPLE_BLOCKS;
+			}
+		}
+		else if (--dsw->rle_skip_blocks <= 0)
+			dsw->rle_want_compression = true;
+	}
+
+	if (dsw->delta_can_compression)
+	{
+		if (dsw->delta_want_compression)
+		{
+			if (dsw->deltas_count * DATUMSTREAM_ADAPTIVE_DELTA_MIN_FRACTION <
+				dsw->physical_datum_count + dsw->deltas_count)
+			{
+				dsw->delta_want_compression = false;
+				dsw->delta_skip_blocks = DATUMSTREAM_ADAPTIVE_RESAMPLE_BLOCKS;
+			}
+		}
+		else if (--dsw->delta_skip_blocks <= 0)
+			dsw->delta_want_compression = true;
+	}
+
+	/*
+	 * Delta Range is built on the RLE_TYPE data structures, so RLE_TYPE stays
+	 * on as long as Delta Range does, even when repeats alone do not pay off.
+	 */
+	if (dsw->delta_want_compression)
+	{
+		Assert(dsw->rle_can_compression);
+		dsw->rle_want_compression = true;
+	}
+
+	if (Debug_appendonly_print_insert)
+	{
+		ereport(LOG,
+				(errmsg("Datum stream block write adaptive encoding for next block "
+						"(RLE_TYPE %s, Delta Range %s, previous block rows %d, physical datums %d, deltas %d)",
+						(dsw->rle_want_compression ? "on" : "off"),
+						(dsw->delta_want_compression ? "on" : "off"),
+						dsw->nth,
+						dsw->physical_datum_count,
+						dsw->deltas_count),
+				 errdetail_datumstreamblockwrite(dsw),
+				 errcontext_datumstreamblockwrite(dsw)));
+	}
+}
+
 void
 DatumStreamBlockWrite_GetReady(
 							   DatumStreamBlockWrite * dsw)
@@ -3566,6 +3777,9 @@ DatumStreamBlockWrite_GetReady(
 	if (strncmp(dsw->eyecatcher, DatumStreamBlockWrite_Eyecatcher, DatumStreamBlockWrite_EyecatcherLen) != 0)
 		elog(FATAL, "DatumStreamBlockWrite data structure not valid (eyecatcher)");
 
+	if (dsw->adaptive && dsw->nth > 0)
+		DatumStreamBlockWrite_AdaptiveChoose(dsw);
+
 	dsw->nth = 0;
 	dsw->physical_datum_count = 0;
 
@@ -3590,7 +3804,12 @@ DatumStreamBlockWrite_GetReady(
 		case DatumStreamVersion_Dense_Enhanced:
 			dsw->datump = dsw->datum_buffer;
 
-			if (dsw->rle_want_compression)
+			/*
+			 * Reset the encoding state whenever the stream was set up for it,
+			 * even if adaptive encoding turned it off for this block, so no
+			 * stale state from an earlier block is looked at.
+			 */
+			if (dsw->rle_want_compression || dsw->rle_can_compression)
 			{
 				/* Set up for RLETYPE compression */
 				dsw->rle_has_compression = false;
@@ -3610,7 +3829,7 @@ DatumStreamBlockWrite_GetReady(
 				dsw->rle_repeatcounts_current_size = 0;
 			}
 
-			if (dsw->delta_want_compression)
+			if (dsw->delta_want_compression || dsw->delta_can_compression)
 			{
 				/* Set up for RLETYPE with delta compression */
 				dsw->delta_has_compression = false;
@@ -3763,6 +3982,195 @@ DatumStreamBlockWrite_BlockOrig(
 	return writesz;
 }
 
+/* FNV-1a, for the dictionary hash table */
+static inline uint32
+DatumStreamBlock_HashBytes(uint8 * p, int32 len)
+{
+	uint32		hash = 2166136261U;
+	int32		i;
+
+	for (i = 0; i < len; i++)
+	{
+		hash ^= p[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/*
+ * Dictionary encode the variable-length physical datums of the block into
+ * dsw->dictionary_buffer, in the layout described with
+ * DatumStreamBlock_Dictionary_Extension.
+ *
+ * Returns the size of the encoded physical data, or -1 when the block has
+ * too many distinct items or the encoding would not save enough space; the
+ * block is then written as usual.
+ */
+static int32
+DatumStreamBlockWrite_DictionaryEncode(
+									   DatumStreamBlockWrite * dsw)
+{
+	int32		physicalDataSize = dsw->datump - dsw->datum_buffer;
+	int32		count = dsw->physical_datum_count;
+	int32		maxEntries;
+	int32		tableSize;
+	int32	   *table;
+	uint8	  **entries;
+	int32	   *entryLens;
+	uint16	   *codes;
+	int32		entryCount;
+	int32		codeSize;
+	int32		codesAlignedSize;
+	int32		dictionarySize;
+	int32		encodedSize;
+	DatumStreamBlock_Dictionary_Extension dictionaryExtension;
+	MemoryContext oldCtxt;
+	uint8	   *p;
+	int32		i;
+
+	Assert(dsw->typeInfo->datumlen == -1);
+
+	if (count < 2)
+		return -1;
+
+	maxEntries = Min(count, DATUMSTREAM_DICTIONARY_MAX_COUNT);
+	tableSize = 1;
+	while (tableSize < 2 * maxEntries)
+		tableSize <<= 1;
+
+	oldCtxt = MemoryContextSwitchTo(dsw->memctxt);
+	table = palloc(tableSize * sizeof(int32));
+	entries = palloc(maxEntries * sizeof(uint8 *));
+	entryLens = palloc(maxEntries * sizeof(int32));
+	codes = palloc(count * sizeof(uint16));
+	MemoryContextSwitchTo(oldCtxt);
+
+	memset(table, -1, tableSize * sizeof(int32));
+
+	/*
+	 * Walk the physical datums the same way the reader does, and give each
+	 * distinct item a code in order of first appearance.
+	 */
+	entryCount = 0;
+	p = dsw->datum_buffer;
+	for (i = 0; i < count; i++)
+	{
+		int32		len;
+		int32		slot;
+
+		if (i > 0 && *p == 0)
+			p = (uint8 *) att_align_nominal(p, dsw->typeInfo->align);
+
+		len = VARSIZE_ANY(p);
+		slot = DatumStreamBlock_HashBytes(p, len) & (tableSize - 1);
+		while (table[slot] != -1 &&
+			   (entryLens[table[slot]] != len ||
+				memcmp(entries[table[slot]], p, len) != 0))
+			slot = (slot + 1) & (tableSize - 1);
+
+		if (table[slot] == -1)
+		{
+			/*
+			 * More distinct items than codes can address: give up on the
+			 * dictionary and write the block as usual.
+			 */
+			if (entryCount >= maxEntries)
+			{
+				pfree(table);
+				pfree(entries);
+				pfree(entryLens);
+				pfree(codes);
+				return -1;
+			}
+
+			entries[entryCount] = p;
+			entryLens[entryCount] = len;
+			table[slot] = entryCount++;
+		}
+		codes[i] = (uint16) table[slot];
+
+		p += len;
+	}
+	Assert(p == dsw->datump);
+
+	codeSize = (entryCount <= PG_UINT8_MAX + 1) ? 1 : 2;
+	codesAlignedSize = MAXALIGN(sizeof(DatumStreamBlock_Dictionary_Extension) +
+								count * codeSize);
+
+	dictionarySize = 0;
+	for (i = 0; i < entryCount; i++)
+	{
+		if (!VARATT_IS_SHORT(entries[i]))
+			dictionarySize = (int32) att_align_nominal(dictionarySize, dsw->typeInfo->align);
+		dictionarySize += entryLens[i];
+	}
+
+	encodedSize = codesAlignedSize + dictionarySize;
+	if (encodedSize > physicalDataSize -
+		physicalDataSize / DATUMSTREAM_DICTIONARY_MIN_SAVINGS_FRACTION)
+	{
+		encodedSize = -1;
+	}
+	else
+	{
+		if (dsw->dictionary_buffer == NULL)
+			dsw->dictionary_buffer = MemoryContextAlloc(dsw->memctxt,
+														dsw->maxDataBlockSize);
+
+		dictionaryExtension.dictionary_count = entryCount;
+		dictionaryExtension.dictionary_size = dictionarySize;
+		dictionaryExtension.code_size = codeSize;
+
+		p = dsw->dictionary_buffer;
+		memcpy(p, &dictionaryExtension, sizeof(DatumStreamBlock_Dictionary_Extension));
+		p += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+		for (i = 0; i < count; i++)
+		{
+			if (codeSize == 1)
+				*(p++) = (uint8) codes[i];
+			else
+			{
+				*(uint16 *) p = codes[i];
+				p += sizeof(uint16);
+			}
+		}
+
+		while (p < dsw->dictionary_buffer + codesAlignedSize)
+			*(p++) = 0;
+
+		for (i = 0; i < entryCount; i++)
+		{
+			if (!VARATT_IS_SHORT(entries[i]))
+				p = (uint8 *) att_align_zero((char *) p, dsw->typeInfo->align);
+			memcpy(p, entries[i], entryLens[i]);
+			p += entryLens[i];
+		}
+		Assert(p - dsw->dictionary_buffer == encodedSize);
+
+		if (Debug_appendonly_print_insert)
+			ereport(LOG,
+					(errmsg("Datum stream write Dense block dictionary encoded "
+							"(physical datum count %d, dictionary count %d, code size %d, "
+							"physical data size %d, encoded size %d)",
+							count,
+							entryCount,
+							codeSize,
+							physicalDataSize,
+							encodedSize),
+					 errdetail_datumstreamblockwrite(dsw),
+					 errcontext_datumstreamblockwrite(dsw)));
+	}
+
+	pfree(table);
+	pfree(entries);
+	pfree(entryLens);
+	pfree(codes);
+
+	return encodedSize;
+}
+
 static int64
 DatumStreamBlockWrite_BlockDense(
 								 DatumStreamBlockWrite * dsw,
@@ -3786,6 +4194,7 @@ DatumStreamBlockWrite_BlockDense(
 	int32		totalDeltasSize;
 	int64		formattedMetadataSize;
 	bool		minimalIntegrityChecks;
+	uint8	   *physicalData;
 
 	totalRepeatCountsSize = 0;
 	totalDeltasSize = 0;
@@ -3818,6 +4227,21 @@ DatumStreamBlockWrite_BlockDense(
 	dense.physical_datum_count = dsw->physical_datum_count;
 	dense.physical_data_size = dsw->datump - dsw->datum_buffer;
 
+	physicalData = dsw->datum_buffer;
+	if (dsw->dictionary_want_compression)
+	{
+		int32		encodedSize;
+
+		encodedSize = DatumStreamBlockWrite_DictionaryEncode(dsw);
+		if (encodedSize >= 0)
+		{
+			dense.orig_4_bytes.flags |= DSB_HAS_DICTIONARY_COMPRESSION;
+			dsw->savings += dense.physical_data_size - encodedSize;
+			dense.physical_data_size = encodedSize;
+			physicalData = dsw->dictionary_buffer;
+		}
+	}
+
 	headerSize = sizeof(DatumStreamBlock_Dense);
 
 	/*
@@ -4040,7 +4464,7 @@ DatumStreamBlockWrite_BlockDense(
 				 errcontext_datumstreamblockwrite(dsw)));
 	}
 
-	memcpy(p, dsw->datum_buffer, dense.physical_data_size);
+	memcpy(p, physicalData, dense.physical_data_size);
 	p += dense.physical_data_size;
 
 	/* Calculate write size. */
@@ -4234,6 +4658,8 @@ DatumStreamBlockWrite_Init(
 						   DatumStreamVersion datumStreamVersion,
 						   bool rle_want_compression,
 						   bool delta_want_compression,
+						   bool adaptive,
+						   bool dictionary_want_compression,
 						   int32 initialMaxDatumPerBlock,
 						   int32 maxDatumPerBlock,
 						   int32 maxDataBlockSize,
@@ -4251,6 +4677,16 @@ DatumStreamBlockWrite_Init(
 	dsw->rle_want_compression = rle_want_compression;
 	dsw->delta_want_compression = delta_want_compression;
 
+	dsw->adaptive = adaptive;
+	dsw->rle_can_compression = rle_want_compression;
+	dsw->delta_can_compression = delta_want_compression;
+	dsw->rle_skip_blocks = 0;
+	dsw->delta_skip_blocks = 0;
+
+	dsw->dictionary_want_compression = dictionary_want_compression;
+	Assert(!dictionary_want_compression ||
+		   (typeInfo->datumlen == -1 && datumStreamVersion != DatumStreamVersion_Original));
+
 	dsw->initialMaxDatumPerBlock = initialMaxDatumPerBlock;
 	dsw->maxDatumPerBlock = maxDatumPerBlock;
 
@@ -4460,6 +4896,9 @@ DatumStreamBlockWrite_Finish(
 	if (dsw->delta_sign != NULL)
 		pfree(dsw->delta_sign);
 
+	if (dsw->dictionary_buffer != NULL)
+		pfree(dsw->dictionary_buffer);
+
 	MemoryContextSwitchTo(oldCtxt);
 }
 
@@ -4898,6 +5337,7 @@ DatumStreamBlock_IntegrityCheckDense(
 	bool		hasNull;
 	bool		hasRleCompression;
 	bool		hasDeltaCompression;
+	bool		hasDictionaryCompression;
 
 	int32		alignedHeaderSize;
 	int32		deltaOnCount;
@@ -4944,6 +5384,16 @@ DatumStreamBlock_IntegrityCheckDense(
 	hasNull = ((blockDense->orig_4_bytes.flags & DSB_HAS_NULLBITMAP) != 0);
 	hasRleCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_RLE_COMPRESSION) != 0);
 	hasDeltaCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DELTA_COMPRESSION) != 0);
+	hasDictionaryCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0);
+
+	if (hasDictionaryCompression && typeInfo->datumlen != -1)
+	{
+		ereport(ERROR,
+				(errmsg("Dictionary encoding is only expected for variable-length items (datum length %d)",
+						typeInfo->datumlen),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
 
 	/*
 	 * Verify logical row count.
@@ -5432,7 +5882,20 @@ DatumStreamBlock_IntegrityCheckDense(
 												  errcontextArg);
 	}
 
-	if (typeInfo->datumlen == -1)
+	if (hasDictionaryCompression)
+	{
+		DatumStreamBlock_IntegrityCheckDictionary(
+												  buffer + alignedHeaderSize,
+												  blockDense->physical_data_size,
+											 blockDense->physical_datum_count,
+											blockDense->orig_4_bytes.version,
+												  typeInfo,
+												  errdetailCallback,
+												  errdetailArg,
+												  errcontextCallback,
+												  errcontextArg);
+	}
+	else if (typeInfo->datumlen == -1)
 	{
 		/*
 		 * Variable-length items.
@@ -5450,6 +5913,102 @@ DatumStreamBlock_IntegrityCheckDense(
 	}
 }
 
+static void
+DatumStreamBlock_IntegrityCheckDictionary(
+										  uint8 * physicalData,
+										  int32 physicalDataSize,
+										  int32 physicalDatumCount,
+									   DatumStreamVersion datumStreamVersion,
+										  DatumStreamTypeInfo * typeInfo,
+							   int (*errdetailCallback) (void *errdetailArg),
+										  void *errdetailArg,
+							 int (*errcontextCallback) (void *errcontextArg),
+										  void *errcontextArg)
+{
+	DatumStreamBlock_Dictionary_Extension *dictionaryExtension;
+	int64		codesAlignedSize;
+	int32		i;
+
+	if (physicalDataSize < (int32) sizeof(DatumStreamBlock_Dictionary_Extension))
+	{
+		ereport(ERROR,
+				(errmsg("Physical data size %d too small for the dictionary header",
+						physicalDataSize),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
+	dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) physicalData;
+
+	if (dictionaryExtension->code_size != 1 && dictionaryExtension->code_size != 2)
+	{
+		ereport(ERROR,
+				(errmsg("Bad dictionary code size %d",
+						dictionaryExtension->code_size),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
+	if (dictionaryExtension->dictionary_count <= 0 ||
+		dictionaryExtension->dictionary_count > DATUMSTREAM_DICTIONARY_MAX_COUNT ||
+		(dictionaryExtension->code_size == 1 &&
+		 dictionaryExtension->dictionary_count > PG_UINT8_MAX + 1))
+	{
+		ereport(ERROR,
+				(errmsg("Bad dictionary count %d for code size %d",
+						dictionaryExtension->dictionary_count,
+						dictionaryExtension->code_size),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
+	codesAlignedSize = MAXALIGN(sizeof(DatumStreamBlock_Dictionary_Extension) +
+								(int64) physicalDatumCount * dictionaryExtension->code_size);
+	if (codesAlignedSize + dictionaryExtension->dictionary_size != physicalDataSize)
+	{
+		ereport(ERROR,
+				(errmsg("Dictionary sizes do not add up to the physical data size "
+						"(codes size " INT64_FORMAT ", dictionary size %d, physical data size %d)",
+						codesAlignedSize,
+						dictionaryExtension->dictionary_size,
+						physicalDataSize),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
+	for (i = 0; i < physicalDatumCount; i++)
+	{
+		uint8	   *codesp = physicalData + sizeof(DatumStreamBlock_Dictionary_Extension);
+		int32		code;
+
+		if (dictionaryExtension->code_size == 1)
+			code = codesp[i];
+		else
+			code = ((uint16 *) codesp)[i];
+
+		if (code >= dictionaryExtension->dictionary_count)
+		{
+			ereport(ERROR,
+					(errmsg("Dictionary code %d of physical datum %d out of range (dictionary count %d)",
+							code,
+							i,
+							dictionaryExtension->dictionary_count),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+	}
+
+	DatumStreamBlock_IntegrityCheckVarlena(
+										   physicalData + codesAlignedSize,
+										   dictionaryExtension->dictionary_size,
+										   datumStreamVersion,
+										   typeInfo,
+										   errdetailCallback,
+										   errdetailArg,
+										   errcontextCallback,
+										   errcontextArg);
+}
+
 char *
 DatumStreamVersion_String(DatumStreamVersion datumStreamVersion)
 {
@@ -5,6 +5,8 @@
 
 #include "../datumstreamblock.c"
 
+#include "utils/memutils.h"
+
 /* 
  * Unit test function to test the routines added for
  * Delta Compression
@@ -166,13 +168,224 @@ test__DeltaCompression__Core(void **state)
 	free(dsw);
 }
 
+/*
+ * Unit test for the per-block choice of encodings done by adaptive encoding
+ */
+static void
+test__AdaptiveChoose(void **state)
+{
+	DatumStreamTypeInfo typeInfo;
+	int			i;
+
+	DatumStreamBlockWrite* dsw = malloc(sizeof(DatumStreamBlockWrite));
+	memset(dsw, 0, sizeof(DatumStreamBlockWrite));
+
+	strncpy(dsw->eyecatcher, DatumStreamBlockWrite_Eyecatcher, DatumStreamBlockWrite_EyecatcherLen);
+	dsw->datumStreamVersion = DatumStreamVersion_Dense_Enhanced;
+	dsw->typeInfo = &typeInfo;
+	dsw->adaptive = true;
+	dsw->rle_want_compression = dsw->rle_can_compression = true;
+	dsw->delta_want_compression = dsw->delta_can_compression = true;
+
+	/* A block of 1000 distinct values far apart: neither encoding helped */
+	dsw->nth = 1000;
+	dsw->always_null_bitmap_count = 1000;
+	dsw->physical_datum_count = 1000;
+	dsw->deltas_count = 0;
+	DatumStreamBlockWrite_AdaptiveChoose(dsw);
+	assert_false(dsw->rle_want_compression);
+	assert_false(dsw->delta_want_compression);
+
+	/* Both stay off until it is time to sample again */
+	for (i = 1; i < DATUMSTREAM_ADAPTIVE_RESAMPLE_BLOCKS; i++)
+	{
+		DatumStreamBlockWrite_AdaptiveChoose(dsw);
+		assert_false(dsw->rle_want_compression);
+		assert_false(dsw->delta_want_compression);
+	}
+	DatumStreamBlockWrite_AdaptiveChoose(dsw);
+	assert_true(dsw->rle_want_compression);
+	assert_true(dsw->delta_want_compression);
+
+	/* Long runs and small deltas: both encodings are kept */
+	dsw->nth = 1000;
+	dsw->always_null_bitmap_count = 100;
+	dsw->physical_datum_count = 20;
+	dsw->deltas_count = 80;
+	DatumStreamBlockWrite_AdaptiveChoose(dsw);
+	assert_true(dsw->rle_want_compression);
+	assert_true(dsw->delta_want_compression);
+
+	/*
+	 * An ascending sequence has no repeats but small deltas: Delta Range is
+	 * kept, and with it RLE_TYPE, which Delta Range is built on.
+	 */
+	dsw->nth = 1000;
+	dsw->always_null_bitmap_count = 1000;
+	dsw->physical_datum_count = 10;
+	dsw->deltas_count = 990;
+	DatumStreamBlockWrite_AdaptiveChoose(dsw);
+	assert_true(dsw->rle_want_compression);
+	assert_true(dsw->delta_want_compression);
+
+	/* Once Delta Range stops paying off too, RLE_TYPE is switched off */
+	dsw->physical_datum_count = 1000;
+	dsw->deltas_count = 0;
+	DatumStreamBlockWrite_AdaptiveChoose(dsw);
+	assert_false(dsw->rle_want_compression);
+	assert_false(dsw->delta_want_compression);
+	for (i = 0; i < DATUMSTREAM_ADAPTIVE_RESAMPLE_BLOCKS; i++)
+		DatumStreamBlockWrite_AdaptiveChoose(dsw);
+	assert_true(dsw->rle_want_compression);
+	assert_true(dsw->delta_want_compression);
+
+	/* A stream that was never set up for an encoding never turns it on */
+	dsw->rle_want_compression = dsw->rle_can_compression = false;
+	dsw->rle_skip_blocks = 0;
+	DatumStreamBlockWrite_AdaptiveChoose(dsw);
+	assert_false(dsw->rle_want_compression);
+
+	free(dsw);
+}
+
+/*
+ * Append a short varlena holding str to the block being written.
+ */
+static void
+put_short_varlena(DatumStreamBlockWrite *dsw, const char *str)
+{
+	int			len = strlen(str);
+
+	SET_VARSIZE_SHORT(dsw->datump, len + VARHDRSZ_SHORT);
+	memcpy(dsw->datump + VARHDRSZ_SHORT, str, len);
+	dsw->datump += len + VARHDRSZ_SHORT;
+	dsw->physical_datum_count++;
+	dsw->nth++;
+}
+
+/*
+ * Unit test for dictionary encoding of the variable-length items of a block
+ */
+static void
+test__DictionaryEncode(void **state)
+{
+	static const char *const values[] = {"alpha", "beta", "gamma"};
+	DatumStreamTypeInfo typeInfo;
+	DatumStreamBlock_Dictionary_Extension *dictionaryExtension;
+	int32		dataSize;
+	int32		encodedSize;
+	uint8	   *p;
+	char		buf[16];
+	int			i;
+
+	DatumStreamBlockWrite* dsw = malloc(sizeof(DatumStreamBlockWrite));
+	memset(dsw, 0, sizeof(DatumStreamBlockWrite));
+
+	typeInfo.datumlen = -1;
+	typeInfo.typid = TEXTOID;
+	typeInfo.align = 'i';
+	typeInfo.byval = false;
+
+	strncpy(dsw->eyecatcher, DatumStreamBlockWrite_Eyecatcher, DatumStreamBlockWrite_EyecatcherLen);
+	dsw->datumStreamVersion = DatumStreamVersion_Dense_Enhanced;
+	dsw->typeInfo = &typeInfo;
+	dsw->memctxt = CurrentMemoryContext;
+	dsw->dictionary_want_compression = true;
+	dsw->maxDataBlockSize = 32768;
+	dsw->datum_buffer_size = dsw->maxDataBlockSize;
+	dsw->datum_buffer = malloc(dsw->datum_buffer_size);
+	dsw->datump = dsw->datum_buffer;
+
+	/* 300 rows drawn from 3 distinct values encode with 1 byte codes */
+	for (i = 0; i < 300; i++)
+		put_short_varlena(dsw, values[i % 3]);
+	dataSize = dsw->datump - dsw->datum_buffer;
+
+	encodedSize = DatumStreamBlockWrite_DictionaryEncode(dsw);
+	assert_true(encodedSize > 0);
+	assert_true(encodedSize < dataSize);
+
+	dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) dsw->dictionary_buffer;
+	assert_int_equal(dictionaryExtension->dictionary_count, 3);
+	assert_int_equal(dictionaryExtension->code_size, 1);
+	assert_int_equal(encodedSize,
+					 MAXALIGN(sizeof(DatumStreamBlock_Dictionary_Extension) + 300) +
+					 dictionaryExtension->dictionary_size);
+
+	/* Codes are given in order of first appearance */
+	p = dsw->dictionary_buffer + sizeof(DatumStreamBlock_Dictionary_Extension);
+	for (i = 0; i < 300; i++)
+		assert_int_equal(p[i], i % 3);
+
+	/* Values that are all distinct are left alone */
+	dsw->datump = dsw->datum_buffer;
+	dsw->physical_datum_count = 0;
+	dsw->nth = 0;
+	for (i = 0; i < 300; i++)
+	{
+		snprintf(buf, sizeof(buf), "value%d", i);
+		put_short_varlena(dsw, buf);
+	}
+	assert_int_equal(DatumStreamBlockWrite_DictionaryEncode(dsw), -1);
+
+	free(dsw->datum_buffer);
+	free(dsw);
+}
+
+/*
+ * Unit test for a block with more distinct items than dictionary codes. Each
+ * item repeats, so that the dictionary would otherwise pay off.
+ */
+static void
+test__DictionaryEncodeTooManyDistinct(void **state)
+{
+	DatumStreamTypeInfo typeInfo;
+	char		buf[16];
+	int			distinct = DATUMSTREAM_DICTIONARY_MAX_COUNT + 1;
+	int			i;
+
+	DatumStreamBlockWrite* dsw = malloc(sizeof(DatumStreamBlockWrite));
+	memset(dsw, 0, sizeof(DatumStreamBlockWrite));
+
+	typeInfo.datumlen = -1;
+	typeInfo.typid = TEXTOID;
+	typeInfo.align = 'i';
+	typeInfo.byval = false;
+
+	strncpy(dsw->eyecatcher, DatumStreamBlockWrite_Eyecatcher, DatumStreamBlockWrite_EyecatcherLen);
+	dsw->datumStreamVersion = DatumStreamVersion_Dense_Enhanced;
+	dsw->typeInfo = &typeInfo;
+	dsw->memctxt = CurrentMemoryContext;
+	dsw->dictionary_want_compression = true;
+	dsw->maxDataBlockSize = 32768;
+	dsw->datum_buffer_size = 4 * distinct * 16;
+	dsw->datum_buffer = malloc(dsw->datum_buffer_size);
+	dsw->datump = dsw->datum_buffer;
+
+	for (i = 0; i < 4 * distinct; i++)
+	{
+		snprintf(buf, sizeof(buf), "value%d", i % distinct);
+		put_short_varlena(dsw, buf);
+	}
+	assert_int_equal(DatumStreamBlockWrite_DictionaryEncode(dsw), -1);
+	assert_true(dsw->dictionary_buffer == NULL);
+
+	free(dsw->datum_buffer);
+	free(dsw);
+}
+
 int 
 main(int argc, char* argv[]) 
 {
 	cmockery_parse_arguments(argc, argv);
 
+	MemoryContextInit();
+
 	const UnitTest tests[] = {
-			unit_test(test__DeltaCompression__Core)
+			unit_test(test__DeltaCompression__Core),
+			unit_test(test__AdaptiveChoose),
+			unit_test(test__DictionaryEncode),
+			unit_test(test__DictionaryEncodeTooManyDistinct)
 	};
 	return run_tests(tests);
 }
@@ -25,7 +25,6 @@
 #endif
 
 #define FILE_ERROR_SZ 200
-char* format_error(char* c1, char* c2);
 
 typedef struct
 {
@@ -46,9 +45,12 @@ struct fstream_t
 	char* 			buffer;			 /* buffer to store data read from file */
 	int 			buffer_cur_size; /* number of bytes in buffer currently */
 	const char*		ferror; 		 /* error string */
+	char			err_buf[FILE_ERROR_SZ]; /* room for a formatted ferror */
 	struct fstream_options options;
 };
 
+static const char* format_error(fstream_t* fs, const char* c1, const char* c2);
+
 /*
  * Returns a pointer to the end of the last delimiter occurrence,
  * or the start pointer if delimiter doesn't appear.
@@ -672,31 +674,31 @@ static int nextFile(fstream_t*fs)
  * format_error
  * enables addition of string parameters to the const char* error message in fstream_t
  * while enabling the calling functions not to worry about freeing memory - which is 
- * the present behaviour
+ * the present behaviour. The message is kept in the fstream, as streams may be read
+ * by different threads.
  */
-char* format_error(char* c1, char* c2)
+static const char* format_error(fstream_t* fs, const char* c1, const char* c2)
 {
 	int len1, len2;
 	
-	static char err_msg[FILE_ERROR_SZ];
-	memset(err_msg, 0, FILE_ERROR_SZ);
+	memset(fs->err_buf, 0, FILE_ERROR_SZ);
 	
 	len1 = strlen(c1);
 	len2 = strlen(c2);
-	if ( (len1 + len2) > FILE_ERROR_SZ )
+	if ( (len1 + len2) >= FILE_ERROR_SZ )
 	{
 		gfile_printf_then_putc_newline("cannot read file");
 		return "cannot read file";
 	}
 	
-	char* targ = err_msg;
+	char* targ = fs->err_buf;
 	memcpy(targ, c1, len1);
 	targ += len1;
 	memcpy(targ, c2, len2);
 	
-	gfile_printf_then_putc_newline("%s", err_msg);
+	gfile_printf_then_putc_newline("%s", fs->err_buf);
 	
-	return err_msg;
+	return fs->err_buf;
 }
 
 /*
@@ -716,7 +718,6 @@ int fstream_read(fstream_t *fs,
 				 const int line_delim_length)
 {
 	int buffer_capacity = fs->options.bufsize;
-	static char err_buf[FILE_ERROR_SZ] = {0};
 	
 	if (fs->ferror)
 		return -1;
@@ -749,7 +750,7 @@ int fstream_read(fstream_t *fs,
 
 			if (bytesread < 0)
 			{
-				fs->ferror = format_error("cannot read file - ", fs->glob.gl_pathv[fs->fidx]);
+				fs->ferror = format_error(fs, "cannot read file - ", fs->glob.gl_pathv[fs->fidx]);
 				return -1;
 			}
 
@@ -835,7 +836,7 @@ int fstream_read(fstream_t *fs,
 
 			if (bytesread2 < 0)
 			{
-				fs->ferror = format_error("cannot read file - ", fs->glob.gl_pathv[fs->fidx]);
+				fs->ferror = format_error(fs, "cannot read file - ", fs->glob.gl_pathv[fs->fidx]);
 				return -1;
 			}
 
@@ -904,14 +905,14 @@ int fstream_read(fstream_t *fs,
 			if (!p || (char*)dest + size >= p + buffer_capacity)
 			{
 #ifdef WIN32
-				snprintf(err_buf, sizeof(err_buf)-1, "line too long in file %s near (%ld bytes)",
+				snprintf(fs->err_buf, sizeof(fs->err_buf)-1, "line too long in file %s near (%ld bytes)",
 						 fs->glob.gl_pathv[fs->fidx], (long) fs->foff);
 #else
-				snprintf(err_buf, sizeof(err_buf)-1, "line too long in file %s near (%lld bytes)",
+				snprintf(fs->err_buf, sizeof(fs->err_buf)-1, "line too long in file %s near (%lld bytes)",
 						 fs->glob.gl_pathv[fs->fidx], (long long) fs->foff);
 #endif
-				fs->ferror = err_buf;
-				gfile_printf_then_putc_newline("%s", err_buf);
+				fs->ferror = fs->err_buf;
+				gfile_printf_then_putc_newline("%s", fs->err_buf);
 				return -1;
 			}
 
@@ -953,7 +954,7 @@ int fstream_read(fstream_t *fs,
 
 		if (bytesread < 0)
 		{
-			fs->ferror = format_error("cannot read file - ", fs->glob.gl_pathv[fs->fidx]);
+			fs->ferror = format_error(fs, "cannot read file - ", fs->glob.gl_pathv[fs->fidx]);
 			
 			return -1;
 		}
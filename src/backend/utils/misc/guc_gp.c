@@ -140,6 +140,9 @@ bool		gp_permit_relation_node_change = false;
 int			gp_max_local_distributed_cache = 1024;
 bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
+bool		gp_aocs_adaptive_encoding = false;
+bool		gp_aocs_late_materialization = false;
+bool		gp_aocs_dictionary_encoding = false;
 bool		gp_appendonly_compaction = true;
 int			gp_appendonly_compaction_threshold = 0;
 bool		gp_heap_require_relhasoids_match = true;
@@ -273,6 +276,7 @@ bool		optimizer_control = true;
 bool		optimizer_trace_fallback;
 bool		optimizer_partition_selection_log;
 int			optimizer_minidump;
+bool		optimizer_minidump_binary;
 int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
@@ -290,7 +294,9 @@ bool		optimizer_print_expression_properties;
 bool		optimizer_print_group_properties;
 bool		optimizer_print_optimization_context;
 bool		optimizer_print_optimization_stats;
+bool		optimizer_print_plan_cache;
 bool		optimizer_print_xform_results;
+bool		optimizer_profile;
 
 /* array of xforms disable flags */
 bool		optimizer_xforms[OPTIMIZER_XFORMS_COUNT] = {[0 ... OPTIMIZER_XFORMS_COUNT - 1] = false};
@@ -349,6 +355,7 @@ double		optimizer_damping_factor_join;
 double		optimizer_damping_factor_groupby;
 bool		optimizer_dpe_stats;
 bool		optimizer_enable_derive_stats_all_groups;
+bool		optimizer_enable_join_stats_cache;
 
 /* Costing related GUCs used by the Optimizer */
 int			optimizer_segments;
@@ -364,6 +371,8 @@ int         optimizer_join_order_threshold;
 int			optimizer_join_order;
 int			optimizer_cte_inlining_bound;
 int			optimizer_push_group_by_below_setop_threshold;
+int			optimizer_planning_time_budget;
+int			optimizer_plan_cache_size;
 bool		optimizer_force_multistage_agg;
 bool		optimizer_force_three_stage_scalar_dqa;
 bool		optimizer_force_expanded_distinct_aggs;
@@ -379,13 +388,16 @@ bool		optimizer_multilevel_partitioning;
 bool 		optimizer_parallel_union;
 bool		optimizer_array_constraints;
 bool		optimizer_cte_inlining;
+bool		optimizer_enable_subexpression_sharing;
 bool		optimizer_enable_space_pruning;
+bool		optimizer_enable_cost_bound_propagation;
 bool		optimizer_enable_associativity;
 bool		optimizer_enable_eageragg;
 bool		optimizer_enable_range_predicate_dpe;
 
 /* Analyze related GUCs for Optimizer */
 bool		optimizer_analyze_root_partition;
+bool		gp_analyze_changed_partitions_only = false;
 bool		optimizer_analyze_midlevel_partition;
 bool		optimizer_analyze_enable_merge_of_leaf_stats;
 
@@ -408,6 +420,7 @@ bool		gp_reject_internal_tcp_conn = true;
 
 /* copy */
 bool		gp_enable_segment_copy_checking = true;
+bool		gp_copy_from_passthrough = false;
 /*
  * Default storage options GUC.  Value is comma-separated name=value
  * pairs.  E.g. "appendonly=true,orientation=column"
@@ -499,6 +512,7 @@ static const struct config_enum_entry gp_autostats_modes[] = {
 static const struct config_enum_entry gp_interconnect_fc_methods[] = {
 	{"loss", INTERCONNECT_FC_METHOD_LOSS},
 	{"capacity", INTERCONNECT_FC_METHOD_CAPACITY},
+	{"delay", INTERCONNECT_FC_METHOD_DELAY},
 	{NULL, 0}
 };
 
@@ -866,6 +880,43 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_aocs_adaptive_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Let append-only column store writers choose RLE and delta encoding per block."),
+			gettext_noop("Columns without RLE_TYPE compression are written in the dense block "
+						 "format, and each block is sampled to decide whether run-length and "
+						 "delta encoding pay off for the following blocks."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_aocs_adaptive_encoding,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_aocs_late_materialization", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Let append-only column store scans read the filter columns first."),
+			gettext_noop("The remaining columns are only read for rows that pass the scan's "
+						 "filter, skipping blocks that hold no such rows."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_aocs_late_materialization,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_aocs_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Let append-only column store writers dictionary encode variable-length columns."),
+			gettext_noop("Blocks with few distinct values store each value once plus a small "
+						 "code per row, and scans evaluate filters once per distinct value."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_aocs_dictionary_encoding,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_appendonly_compaction", PGC_SUSET, APPENDONLY_TABLES,
 			gettext_noop("Perform append-only compaction instead of eof truncation on vacuum."),
@@ -1015,6 +1066,16 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_local_socket", PGC_SIGHUP, GP_ARRAY_TUNING,
+			gettext_noop("Use Unix-domain sockets for TCP interconnect connections within a host."),
+			gettext_noop("Motions between processes on the same host bypass the TCP/IP stack.")
+		},
+		&gp_interconnect_local_socket,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"resource_scheduler", PGC_POSTMASTER, RESOURCES_MGM,
 			gettext_noop("Enable resource scheduling."),
@@ -1987,6 +2048,40 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_print_plan_cache", PGC_USERSET, LOGGING_WHAT,
+			gettext_noop("Print when a query uses or fills the GPORCA plan cache."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_print_plan_cache,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_profile", PGC_USERSET, LOGGING_WHAT,
+			gettext_noop("Collect a profile of the xforms, jobs and memo growth of each GPORCA search stage."),
+			gettext_noop("The profile accumulates over the queries of the session and "
+						 "is returned by gp_optimizer_profile()."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_profile,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_minidump_binary", PGC_USERSET, LOGGING_WHEN,
+			gettext_noop("Write optimizer minidumps in the compact binary DXL format."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_minidump_binary,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_extract_dxl_stats", PGC_USERSET, LOGGING_WHAT,
 			gettext_noop("Extract plan stats in dxl."),
@@ -2157,6 +2252,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_enable_cost_bound_propagation", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Propagate upper cost bounds to child optimization contexts in the optimizer."),
+			gettext_noop("Requires optimizer_enable_space_pruning."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_enable_cost_bound_propagation,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_enable_master_only_queries", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Process master only queries via the optimizer."),
@@ -2289,6 +2395,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_enable_join_stats_cache", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Reuse join statistics derived for the same relations and predicates during join ordering."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_enable_join_stats_cache,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_force_multistage_agg", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Force optimizer to always pick multistage aggregates when such a plan alternative is generated."),
@@ -2457,6 +2574,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_enable_subexpression_sharing", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Share identical subtrees of UNION inputs through CTEs in the optimizer."),
+			gettext_noop("Requires optimizer_cte_inlining."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_enable_subexpression_sharing,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_analyze_root_partition", PGC_USERSET, STATS_ANALYZE,
 			gettext_noop("Enable statistics collection on root partitions during ANALYZE"),
@@ -2467,6 +2595,18 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_analyze_changed_partitions_only", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("ANALYZE of a partitioned table skips leaf partitions that have not changed since they were last analyzed."),
+			gettext_noop("The root partition statistics are merged from the existing statistics "
+						 "of the skipped leaf partitions."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_analyze_changed_partitions_only,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_analyze_midlevel_partition", PGC_USERSET, STATS_ANALYZE,
 			gettext_noop("Enable statistics collection on intermediate partitions during ANALYZE"),
@@ -2710,6 +2850,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_copy_from_passthrough", PGC_USERSET, CUSTOM_OPTIONS,
+			gettext_noop("Pass input lines of COPY FROM through the coordinator to the segments unparsed, when possible."),
+			gettext_noop("Applies to text and CSV input into randomly distributed tables. "
+						 "Lines are sent to the segments in round-robin batches, and parsed there.")
+		},
+		&gp_copy_from_passthrough,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_ignore_error_table", PGC_USERSET, COMPAT_OPTIONS_PREVIOUS,
 			gettext_noop("Ignore INTO error-table in external table and COPY (Deprecated)."),
@@ -3870,6 +4021,27 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_planning_time_budget", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Stop exploring alternative join orders once the optimizer search has taken this much time."),
+			gettext_noop("0 means no budget."),
+			GUC_UNIT_MS
+		},
+		&optimizer_planning_time_budget,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_plan_cache_size", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the number of GPORCA plans a session keeps for reuse by queries that differ only in their constants."),
+			gettext_noop("0 disables the cache.")
+		},
+		&optimizer_plan_cache_size,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_join_arity_for_associativity_commutativity", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Maximum number of children n-ary-join have without disabling commutativity and associativity transform"),
@@ -3995,6 +4167,30 @@ struct config_int ConfigureNamesInt_gp[] =
 		0, 0, INT_MAX, NULL, NULL
 	},
 
+#ifdef ENABLE_IC_PROXY
+	{
+		{"gp_interconnect_proxy_batch_size", PGC_SIGHUP, GP_ARRAY_TUNING,
+			gettext_noop("Sets the size at which the ic-proxy writes the packets coalesced for a peer."),
+			gettext_noop("Packets to the same peer are written together with one system call. 0 writes every packet separately."),
+			GUC_UNIT_BYTE
+		},
+		&gp_interconnect_proxy_batch_size,
+		65536, 0, 16 * 1024 * 1024,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_proxy_flush_interval", PGC_SIGHUP, GP_ARRAY_TUNING,
+			gettext_noop("Sets the maximum time the ic-proxy holds the packets coalesced for a peer."),
+			gettext_noop("0 writes them once the pending network events are handled."),
+			GUC_UNIT_MS
+		},
+		&gp_interconnect_proxy_flush_interval,
+		0, 0, 1000,
+		NULL, NULL, NULL
+	},
+#endif  /* ENABLE_IC_PROXY */
+
 	/* End-of-list marker */
 	{
 		{NULL, 0, 0, NULL, NULL}, NULL, 0, 0, 0, NULL, NULL
@@ -4452,7 +4648,7 @@ struct config_enum ConfigureNamesEnum_gp[] =
 	{
 		{"gp_interconnect_fc_method", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Sets the flow control method used for UDP interconnect."),
-			gettext_noop("Valid values are \"capacity\" and \"loss\".")
+			gettext_noop("Valid values are \"capacity\", \"loss\" and \"delay\".")
 		},
 		&Gp_interconnect_fc_method,
 		INTERCONNECT_FC_METHOD_LOSS, gp_interconnect_fc_methods,
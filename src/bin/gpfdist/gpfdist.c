@@ -11,6 +11,7 @@
 #include <apr_file_info.h>
 #include <apr_hash.h>
 #include <apr_pools.h>
+#include <apr_allocator.h>
 #include <apr_strings.h>
 #include <apr_time.h>
 #include <apr_general.h>
@@ -173,7 +174,8 @@ static struct
 	struct transform* trlist; /* transforms from config file */
 	const char* ssl; /* path to certificates in case we use gpfdist with ssl */
 	int			w; /* The time used for session timeout in seconds */
-} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0 };
+	int			ra; /* # of blocks read ahead by a thread per session, 0 to read inline */
+} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0, 0 };
 
 
 typedef union address
@@ -209,6 +211,42 @@ static struct
 	int 			wdtimer; /* Kill gpfdist after k seconds of inactivity. 0 to disable. */
 } gcb;
 
+#ifndef WIN32
+/*  A block of whole rows read ahead for a session */
+typedef struct prefetch_t prefetch_t;
+struct prefetch_t
+{
+	char*			data;		/* opt.m bytes */
+	int				size;		/* as returned by fstream_read() */
+	struct fstream_filename_and_offset fos;
+	apr_int64_t		read_bytes;	/* compressed bytes consumed by this block */
+};
+
+/*
+ * Read-ahead of a GET session. A thread reads, decompresses (or runs the
+ * transformation) and splits the data into blocks of whole rows, while the
+ * main thread sends out the blocks that are ready. Only the thread touches
+ * the fstream while it runs. The main thread never waits for the thread:
+ * requests that find no block ready wait for an event on a pipe, which the
+ * thread writes to whenever it has read a block.
+ */
+typedef struct readahead_t readahead_t;
+struct readahead_t
+{
+	pthread_t		thread;
+	pthread_mutex_t	mutex;
+	pthread_cond_t	cond;		/* signalled when a block is taken, and on stop */
+	int				wakefd[2];	/* the thread writes a byte to [1] when a block is read */
+	struct event	ev;			/* EV_READ on wakefd[0], in the main thread */
+	prefetch_t*		blocks;		/* ring of opt.ra blocks */
+	int				head;		/* next block to take */
+	int				count;		/* # of blocks read and not taken yet */
+	int				stop;		/* the thread should exit */
+	const char*		line_delim_str;
+	int				line_delim_length;
+};
+#endif
+
 /*  A session */
 typedef struct session_t session_t;
 struct session_t
@@ -232,6 +270,9 @@ struct session_t
 	struct timeval 	tm;             /* timeout for struct event */
 	struct event   	ev;             /* event we are watching for this session*/
 	apr_hash_t		*requests;
+#ifndef WIN32
+	readahead_t*	ra;				/* read-ahead of a GET session, if any */
+#endif
 };
 
 /*  An http request */
@@ -287,6 +328,9 @@ struct request_t
 	block_t	outblock;	/* next block to send out */
 	char*           line_delim_str;
 	int             line_delim_length;
+#ifndef WIN32
+	int				ra_waiting;	/* waits for a block to be read ahead */
+#endif
 
 #ifdef USE_SSL
 	/* SSL related */
@@ -344,6 +388,16 @@ static void session_detach(request_t* r);
 static void session_end(session_t* s, int error);
 static void session_free(session_t* s);
 static void session_active_segs_dump(session_t* session);
+#ifndef WIN32
+static void readahead_start(session_t* session, const char* line_delim_str, int line_delim_length);
+static void readahead_stop(session_t* session);
+static void* readahead_thread(void* arg);
+static void readahead_wakeup(int fd, short event, void* arg);
+static void readahead_wake_requests(session_t* session);
+static int readahead_wait(request_t* r);
+static int readahead_take(const request_t* r, char* data, struct fstream_filename_and_offset* fos,
+						  const char** ferror, const char* line_delim_str, int line_delim_length);
+#endif
 static int session_active_segs_isempty(session_t* session);
 static int request_validate(request_t *r);
 static int request_set_path(request_t *r, const char* d, char* p, char* pp, char* path);
@@ -501,7 +555,7 @@ static void usage_error(const char* msg, int print_usage)
 		{
 			fprintf(stderr,
 					"gpfdist -- file distribution web server\n\n"
-						"usage: gpfdist [--ssl <certificates_directory>] [-d <directory>] [-p <http(s)_port>] [-l <log_file>] [-t <timeout>] [-v | -V | -s] [-m <maxlen>] [-w <timeout>]"
+						"usage: gpfdist [--ssl <certificates_directory>] [-d <directory>] [-p <http(s)_port>] [-l <log_file>] [-t <timeout>] [-v | -V | -s] [-m <maxlen>] [-w <timeout>] [--read-ahead <n>]"
 #ifdef GPFXDIST
 					    "[-c file]"
 #endif
@@ -527,7 +581,11 @@ static void usage_error(const char* msg, int print_usage)
 					    "        -c file    : configuration file for transformations\n"
 #endif
 						"        --version  : print version information\n"
-						"        -w timeout : timeout in seconds before close target file\n\n");
+						"        -w timeout : timeout in seconds before close target file\n"
+#ifndef WIN32
+						"        --read-ahead n : read, decompress and split up to n blocks per session ahead in a thread\n"
+#endif
+						"\n");
 		}
 	}
 
@@ -590,6 +648,7 @@ static void parse_command_line(int argc, const char* const argv[],
 #endif
 	{ "version", 256, 0, "print version number" },
 	{ NULL, 'w', 1, "wait for session timeout in seconds" },
+	{ "read-ahead", 258, 1, "blocks to read ahead per session in a thread" },
 	{ 0 } };
 
 	status = apr_getopt_init(&os, pool, argc, argv);
@@ -674,6 +733,9 @@ static void parse_command_line(int argc, const char* const argv[],
 		case 'w':
 			opt.w = atoi(arg);
 			break;
+		case 258:
+			opt.ra = atoi(arg);
+			break;
 		}
 	}
 
@@ -699,6 +761,14 @@ static void parse_command_line(int argc, const char* const argv[],
     if (! ((GPFDIST_MAX_LINE_LOWER_LIMIT <= opt.m) && (opt.m <= GPFDIST_MAX_LINE_UPPER_LIMIT)))
     	usage_error(GPFDIST_MAX_LINE_MESSAGE, 0);
 
+#ifdef WIN32
+	if (opt.ra != 0)
+		usage_error("Error: --read-ahead is not supported on this platform", 0);
+#else
+	if (opt.ra < 0 || opt.ra > 64)
+		usage_error("Error: --read-ahead must be between 0 and 64 blocks", 0);
+#endif
+
     if (!is_valid_listen_queue_size(opt.z))
 		usage_error("Error: -z listen queue size must be between 16 and 512 (default is 256)", 0);
 
@@ -1301,6 +1371,7 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 	int 		size;
 	const int 	whole_rows = 1; /* gpfdist must not read data with partial rows */
 	struct fstream_filename_and_offset fos;
+	const char*	ferror = 0;
 
 	session_t *session = r->session;
 
@@ -1313,26 +1384,36 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 		return 0;
 	}
 
-	gcb.read_bytes -= fstream_get_compressed_position(session->fstream);
-
 	/* read data from our filestream as a chunk with whole data rows */
+#ifndef WIN32
+	if (opt.ra > 0)
+		size = readahead_take(r, retblock->data, &fos, &ferror, line_delim_str, line_delim_length);
+	else
+#endif
+	{
+		gcb.read_bytes -= fstream_get_compressed_position(session->fstream);
+
+		size = fstream_read(session->fstream, retblock->data, opt.m, &fos, whole_rows, line_delim_str, line_delim_length);
 
-	size = fstream_read(session->fstream, retblock->data, opt.m, &fos, whole_rows, line_delim_str, line_delim_length);
+		if (size == 0)
+			gcb.read_bytes += fstream_get_compressed_size(session->fstream);
+		else
+			gcb.read_bytes += fstream_get_compressed_position(session->fstream);
+
+		if (size < 0)
+			ferror = fstream_get_error(session->fstream);
+	}
 	delay_watchdog_timer();
 
 	if (size == 0)
 	{
 		gprintln(NULL, "session_get_block: end session due to EOF");
-		gcb.read_bytes += fstream_get_compressed_size(session->fstream);
 		session_end(session, 0);
 		return 0;
 	}
 
-	gcb.read_bytes += fstream_get_compressed_position(session->fstream);
-
 	if (size < 0)
 	{
-		const char* ferror = fstream_get_error(session->fstream);
 		gwarning(NULL, "session_get_block end session due to %s", ferror);
 		session_end(session, 1);
 		return ferror;
@@ -1346,6 +1427,274 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 	return 0;
 }
 
+#ifndef WIN32
+/*
+ * readahead_start
+ *
+ * Start the read-ahead thread of a GET session, on its first block.
+ */
+static void readahead_start(session_t* session, const char* line_delim_str, int line_delim_length)
+{
+	readahead_t*	ra;
+	int				i;
+	int				rc;
+
+	ra = apr_pcalloc(session->pool, sizeof(readahead_t));
+	ra->blocks = apr_pcalloc(session->pool, sizeof(prefetch_t) * opt.ra);
+	if (!ra || !ra->blocks)
+		gfatal(NULL, "out of memory in readahead_start");
+	for (i = 0; i < opt.ra; i++)
+	{
+		ra->blocks[i].data = apr_palloc(session->pool, opt.m);
+		if (!ra->blocks[i].data)
+			gfatal(NULL, "out of memory in readahead_start");
+	}
+
+	/* the delimiter belongs to the request, which may go away first */
+	ra->line_delim_str = apr_pstrmemdup(session->pool, line_delim_str, line_delim_length);
+	ra->line_delim_length = line_delim_length;
+
+	if (pipe(ra->wakefd) ||
+		fcntl(ra->wakefd[0], F_SETFL, O_NONBLOCK) ||
+		fcntl(ra->wakefd[1], F_SETFL, O_NONBLOCK))
+		gfatal(NULL, "cannot create read-ahead pipe: %s", strerror(errno));
+	event_set(&ra->ev, ra->wakefd[0], EV_READ | EV_PERSIST, readahead_wakeup, session);
+	if (event_add(&ra->ev, 0))
+		gfatal(NULL, "failed to event_add!");
+
+	pthread_mutex_init(&ra->mutex, NULL);
+	pthread_cond_init(&ra->cond, NULL);
+
+	session->ra = ra;
+	rc = pthread_create(&ra->thread, NULL, readahead_thread, session);
+	if (rc)
+		gfatal(NULL, "cannot create read-ahead thread: %s", strerror(rc));
+
+	gprintln(NULL, "session %ld reads ahead %d blocks", session->id, opt.ra);
+}
+
+/*
+ * readahead_stop
+ *
+ * Stop the read-ahead thread of a session, if any, so that the fstream can
+ * be closed. Blocks read ahead and not sent yet are dropped.
+ */
+static void readahead_stop(session_t* session)
+{
+	readahead_t* ra = session->ra;
+
+	if (!ra)
+		return;
+
+	pthread_mutex_lock(&ra->mutex);
+	ra->stop = 1;
+	pthread_cond_broadcast(&ra->cond);
+	pthread_mutex_unlock(&ra->mutex);
+
+	pthread_join(ra->thread, NULL);
+	pthread_cond_destroy(&ra->cond);
+	pthread_mutex_destroy(&ra->mutex);
+
+	event_del(&ra->ev);
+	close(ra->wakefd[0]);
+	close(ra->wakefd[1]);
+
+	session->ra = 0;
+
+	/* let the waiting requests find out that the session has ended */
+	readahead_wake_requests(session);
+}
+
+/*
+ * readahead_thread
+ *
+ * Fill the ring of blocks of a session until EOF, an error, or stop. The
+ * final block has the size 0 (EOF) or -1 (error) that fstream_read returned.
+ */
+static void* readahead_thread(void* arg)
+{
+	session_t*		session = (session_t*) arg;
+	readahead_t*	ra = session->ra;
+	const int 		whole_rows = 1; /* gpfdist must not read data with partial rows */
+
+	for (;;)
+	{
+		prefetch_t*	pb;
+		apr_int64_t	pos;
+
+		pthread_mutex_lock(&ra->mutex);
+		while (ra->count == opt.ra && !ra->stop)
+			pthread_cond_wait(&ra->cond, &ra->mutex);
+		if (ra->stop)
+		{
+			pthread_mutex_unlock(&ra->mutex);
+			break;
+		}
+		pb = &ra->blocks[(ra->head + ra->count) % opt.ra];
+		pthread_mutex_unlock(&ra->mutex);
+
+		/* the slot is ours until we count it as read */
+		pos = fstream_get_compressed_position(session->fstream);
+		pb->size = fstream_read(session->fstream, pb->data, opt.m, &pb->fos, whole_rows,
+								ra->line_delim_str, ra->line_delim_length);
+		if (pb->size == 0)
+			pb->read_bytes = fstream_get_compressed_size(session->fstream) - pos;
+		else
+			pb->read_bytes = fstream_get_compressed_position(session->fstream) - pos;
+
+		pthread_mutex_lock(&ra->mutex);
+		ra->count++;
+		pthread_mutex_unlock(&ra->mutex);
+
+		/* if the pipe is full, a wakeup is pending anyway */
+		if (write(ra->wakefd[1], "", 1) < 0 && errno != EAGAIN && errno != EINTR)
+			gfatal(NULL, "cannot write to read-ahead pipe: %s", strerror(errno));
+
+		if (pb->size <= 0)
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+ * readahead_take
+ *
+ * Take the next block read ahead for the session of a request. The caller
+ * must have seen with readahead_wait that it is ready. Returns like
+ * fstream_read.
+ */
+static int readahead_take(const request_t* r, char* data, struct fstream_filename_and_offset* fos,
+						  const char** ferror, const char* line_delim_str, int line_delim_length)
+{
+	session_t*		session = r->session;
+	readahead_t*	ra;
+	prefetch_t*		pb;
+	int				size;
+
+	if (!session->ra)
+		readahead_start(session, line_delim_str, line_delim_length);
+	ra = session->ra;
+
+	pthread_mutex_lock(&ra->mutex);
+	if (ra->count == 0)
+		gfatal(r, "internal error - no block read ahead");
+	pb = &ra->blocks[ra->head];
+
+	size = pb->size;
+	if (size > 0)
+	{
+		memcpy(data, pb->data, size);
+		*fos = pb->fos;
+	}
+	else if (size < 0)
+	{
+		/* the thread is done with the fstream after an error */
+		*ferror = apr_pstrdup(session->pool, fstream_get_error(session->fstream));
+	}
+	gcb.read_bytes += pb->read_bytes;
+
+	ra->head = (ra->head + 1) % opt.ra;
+	ra->count--;
+	pthread_cond_broadcast(&ra->cond);
+	pthread_mutex_unlock(&ra->mutex);
+
+	return size;
+}
+
+/*
+ * readahead_wait
+ *
+ * Check whether the next block of the session of a request has been read
+ * ahead. If not, mark the request as waiting and return 1. do_write is then
+ * set up again by readahead_wakeup once the block is there. Returns 0 if the
+ * block can be taken, or if the request should go on with session_get_block
+ * for another reason.
+ */
+static int readahead_wait(request_t* r)
+{
+	session_t*		session = r->session;
+	readahead_t*	ra;
+	int				ready;
+
+	if (opt.ra <= 0 || session->is_error || 0 == session->fstream)
+		return 0;
+
+	if (!session->ra)
+		readahead_start(session, r->line_delim_str, r->line_delim_length);
+	ra = session->ra;
+
+	pthread_mutex_lock(&ra->mutex);
+	ready = (ra->count > 0);
+	pthread_mutex_unlock(&ra->mutex);
+
+	if (ready)
+		return 0;
+
+	gdebug(r, "wait for a block to be read ahead");
+	r->ra_waiting = 1;
+	return 1;
+}
+
+/*
+ * readahead_wakeup
+ *
+ * Callback when the read-ahead thread of a session has read a block.
+ */
+static void readahead_wakeup(int fd, short event, void* arg)
+{
+	session_t*	session = (session_t*) arg;
+	char		buf[64];
+
+	while (read(fd, buf, sizeof(buf)) > 0)
+		;
+
+	readahead_wake_requests(session);
+}
+
+/*
+ * readahead_wake_requests
+ *
+ * Set up do_write again for the requests of a session that wait for a block.
+ */
+static void readahead_wake_requests(session_t* session)
+{
+	apr_hash_index_t*	hi;
+	request_t**			waiting;
+	int					nwaiting = 0;
+	int					i;
+
+	if (session->nrequest <= 0)
+		return;
+
+	/* request_end may free the session, so don't walk its hash meanwhile */
+	if (!(waiting = malloc(sizeof(request_t*) * session->nrequest)))
+		gfatal(NULL, "out of memory in readahead_wake_requests");
+
+	for (hi = apr_hash_first(session->pool, session->requests); hi; hi = apr_hash_next(hi))
+	{
+		void*		entry;
+		request_t*	r;
+
+		apr_hash_this(hi, 0, 0, &entry);
+		r = (request_t*) entry;
+		if (r->ra_waiting && nwaiting < session->nrequest)
+		{
+			r->ra_waiting = 0;
+			waiting[nwaiting++] = r;
+		}
+	}
+
+	for (i = 0; i < nwaiting; i++)
+	{
+		if (setup_write(waiting[i]))
+			request_end(waiting[i], 1, 0);
+	}
+
+	free(waiting);
+}
+#endif
+
 /* finish the session - close the file */
 static void session_end(session_t* session, int error)
 {
@@ -1354,6 +1703,10 @@ static void session_end(session_t* session, int error)
 	if (error)
 		session->is_error = error;
 
+#ifndef WIN32
+	readahead_stop(session);
+#endif
+
 	if (session->fstream)
 	{
 		gprintln(NULL, "close fstream");
@@ -1367,6 +1720,10 @@ static void session_free(session_t* session)
 {
 	gprintln(NULL, "free session %s", session->key);
 
+#ifndef WIN32
+	readahead_stop(session);
+#endif
+
 	if (session->fstream)
 	{
 		fstream_close(session->fstream);
@@ -1583,6 +1940,40 @@ static int session_attach(request_t* r)
             fstream_options.transform->for_write  = fstream_options.forwrite;
             fstream_options.transform->mp         = pool;
 			fstream_options.transform->errfile    = r->trans.errfile;
+
+			/*
+			 * With read-ahead, the transformation of the next file is started
+			 * by the read-ahead thread. Give it a pool with an allocator of
+			 * its own, which the main thread does not allocate from, and its
+			 * own handle of the stderr file, which outlives this request.
+			 */
+			if (opt.ra > 0 && r->is_get)
+			{
+				apr_allocator_t*	allocator;
+				apr_pool_t*			tpool;
+
+				if (apr_allocator_create(&allocator) ||
+					apr_pool_create_ex(&tpool, pool, NULL, allocator))
+				{
+					gwarning(r, "out of memory");
+					http_error(r, FDIST_INTERNAL_ERROR, "internal error - out of memory");
+					request_end(r, 1, 0);
+					apr_pool_destroy(pool);
+					return -1;
+				}
+				apr_allocator_owner_set(allocator, tpool);
+				fstream_options.transform->mp = tpool;
+
+				if (r->trans.errfile &&
+					apr_file_dup(&fstream_options.transform->errfile, r->trans.errfile, tpool))
+				{
+					gwarning(r, "cannot duplicate stderr file %s", r->trans.errfilename);
+					http_error(r, FDIST_INTERNAL_ERROR, "internal error - cannot duplicate stderr file");
+					request_end(r, 1, 0);
+					apr_pool_destroy(pool);
+					return -1;
+				}
+			}
         }
 		gprintlnif(r, "r->path %s", r->path);
 #endif
@@ -1749,7 +2140,15 @@ static void do_write(int fd, short event, void* arg)
 		/* get a block (or find a remaining block) */
 		if (r->outblock.top == r->outblock.bot)
 		{
-			const char* ferror = session_get_block(r, &r->outblock, r->line_delim_str, r->line_delim_length);
+			const char* ferror;
+
+#ifndef WIN32
+			/* do_write is called again once the block is read ahead */
+			if (readahead_wait(r))
+				return;
+#endif
+
+			ferror = session_get_block(r, &r->outblock, r->line_delim_str, r->line_delim_length);
 
 			if (ferror)
 			{
@@ -33,6 +33,7 @@ extern bool synchronize_seqscans;
 
 struct BulkInsertStateData;
 struct IndexInfo;
+struct PlanState;
 struct SampleScanState;
 struct TBMIterateResult;
 struct VacuumParams;
@@ -58,7 +59,13 @@ typedef enum ScanOptions
 	SO_ALLOW_PAGEMODE = 1 << 6,
 
 	/* unregister snapshot at scan end? */
-	SO_TEMP_SNAPSHOT = 1 << 7
+	SO_TEMP_SNAPSHOT = 1 << 7,
+
+	/*
+	 * GPDB: set by scan_begin_extractcolumns if the AM evaluates the qual
+	 * itself, and only returns tuples that satisfy it
+	 */
+	SO_QUAL_APPLIED = 1 << 8
 } ScanOptions;
 
 /*
@@ -206,11 +213,17 @@ typedef struct TableAmRoutine
 
 	/*
 	 * GPDB_12_MERGE_FIXME: Extract columns for scan from targetlist and quals.
+	 *
+	 * ps is the scan node evaluating the quals, if any. An AM may use it to
+	 * evaluate the quals itself before materializing the rest of the tuple,
+	 * and then sets SO_QUAL_APPLIED in the scan's rs_flags so that the
+	 * caller doesn't evaluate them again.
 	 */
 	TableScanDesc	(*scan_begin_extractcolumns) (Relation rel,
 												  Snapshot snapshot,
 												  List *targetlist,
 												  List *qual,
+												  struct PlanState *ps,
 												  uint32 flags);
 
 	/*
@@ -769,7 +782,8 @@ table_beginscan(Relation rel, Snapshot snapshot,
  */
 static inline TableScanDesc
 table_beginscan_es(Relation rel, Snapshot snapshot,
-				   List *targetList, List *qual)
+				   List *targetList, List *qual,
+				   struct PlanState *ps)
 {
 	uint32		flags = SO_TYPE_SEQSCAN |
 	SO_ALLOW_STRAT | SO_ALLOW_SYNC | SO_ALLOW_PAGEMODE;
@@ -777,7 +791,7 @@ table_beginscan_es(Relation rel, Snapshot snapshot,
 	if (rel->rd_tableam->scan_begin_extractcolumns)
 		return rel->rd_tableam->scan_begin_extractcolumns(rel, snapshot,
 														  targetList, qual,
-														  flags);
+														  ps, flags);
 
 	return rel->rd_tableam->scan_begin(rel, snapshot,
 									   0, NULL,
@@ -157,6 +157,30 @@ typedef struct AOCSScanDescData
 		AttrNumber		   *proj_atts;
 		AttrNumber			num_proj_atts;
 
+		/*
+		 * Late materialization, see aocs_enable_late_materialization(). If
+		 * qual is set, proj_atts is split into the columns the qual refers
+		 * to, read for every row, and the late columns, only read for rows
+		 * that satisfy the qual.
+		 */
+		AttrNumber		   *qual_atts;
+		AttrNumber			num_qual_atts;
+		AttrNumber		   *late_atts;
+		AttrNumber			num_late_atts;
+		ExprState		   *qual;
+		PlanState		   *ps;
+
+		/*
+		 * With a single qual column, the qual result for each dictionary
+		 * code of the current dictionary encoded block: -1 unknown, 0 false,
+		 * 1 true.  Only valid while the block's dictionary generation
+		 * matches qual_code_cache_generation.
+		 */
+		int8			   *qual_code_cache;
+		int32				qual_code_cache_size;
+		uint32				qual_code_cache_generation;
+		bool				qual_code_cache_valid;
+
 		struct DatumStreamRead **ds;
 	} columnScanInfo;
 
@@ -295,6 +319,9 @@ extern AOCSScanDesc aocs_beginrangescan(Relation relation, Snapshot snapshot,
 										Snapshot appendOnlyMetaDataSnapshot,
 										int *segfile_no_arr, int segfile_count);
 
+extern void aocs_enable_late_materialization(AOCSScanDesc scan,
+											 bool *qualcols,
+											 PlanState *ps);
 extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
@@ -45,6 +45,12 @@ typedef struct DistributedSnapshot
 	DistributedTransactionId        *inProgressXidArray;
 } DistributedSnapshot;
 
+/*
+ * Number of entries in the cache of recent visibility results of a
+ * DistributedSnapshotWithLocalMapping, must be a power of 2.
+ */
+#define DSLM_RESULT_CACHE_SIZE 8
+
 /*
  * GPDB: Snapshot stores this information to check tuple visibility against
  * distributed transactions.
@@ -55,12 +61,21 @@ typedef struct DistributedSnapshotWithLocalMapping
 
 	/*
 	 * Cache to perform quick check for localXid, populated after reverse
-	 * mapping distributed xid to local xid.
+	 * mapping distributed xid to local xid. The local xids are kept sorted.
 	 */
 	TransactionId minCachedLocalXid;
 	TransactionId maxCachedLocalXid;
 	int32 currentLocalXidsCount;
 	TransactionId *inProgressMappedLocalXids;
+
+	/*
+	 * Direct-mapped cache of the results of recent checks, indexed by the
+	 * low bits of the local xid. Tuples written by the same transaction tend
+	 * to be checked one after another, so this saves the lookups in the
+	 * local-distributed cache and the distributed log for most of them.
+	 */
+	TransactionId cachedResultXids[DSLM_RESULT_CACHE_SIZE];
+	uint8 cachedResults[DSLM_RESULT_CACHE_SIZE];
 } DistributedSnapshotWithLocalMapping;
 
 typedef enum
@@ -77,6 +92,9 @@ extern DistributedSnapshotCommitted DistributedSnapshotWithLocalMapping_Committe
 	TransactionId 							localXid,
 	bool isVacuumCheck);
 
+extern void DistributedSnapshotWithLocalMapping_ResetCache(
+	DistributedSnapshotWithLocalMapping *dslm);
+
 extern void DistributedSnapshot_Reset(
 	DistributedSnapshot *distributedSnapshot);
 
@@ -216,6 +216,21 @@ struct MotionConn
 	uint64 dev;
 	uint64 deadlockCheckBeginTime;
 
+	/*
+	 * Congestion control state of the delay based flow control, which keeps
+	 * a window per connection.
+	 *
+	 * cwnd         - congestion window, in packets
+	 * ssthresh     - slow start threshold
+	 * baseRtt      - the smallest rtt seen, taken as the rtt of the path
+	 *                without queueing
+	 * nextSendTime - the time the next packet may be sent, for pacing
+	 */
+	float cwnd;
+	float ssthresh;
+	uint64 baseRtt;
+	uint64 nextSendTime;
+
 
 	ICBuffer *curBuff;
 
@@ -287,6 +302,7 @@ struct MotionConn
 	uint64 stat_count_acks;
 	uint64 stat_max_ack_time;
 	uint64 stat_min_ack_time;
+	uint64 stat_count_sent;
 	uint64 stat_count_resent;
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
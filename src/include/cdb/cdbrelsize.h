@@ -15,8 +15,10 @@
 #ifndef CDBRELSIZE_H_
 #define CDBRELSIZE_H_
 
+#include "nodes/pg_list.h"
 #include "utils/relcache.h"
 
 extern int64 cdbRelMaxSegSize(Relation rel);
+extern void cdbRelMaxSegSizes(List *relids, int64 *sizes);
 
 #endif /* CDBRELSIZE_H_ */
@@ -233,6 +233,12 @@ typedef struct TMGXACTLOCAL
 
 	Bitmapset					*dtxSegmentsMap;
 	List						*dtxSegments;
+
+	/* Used on QD, segments whose QEs have assigned an xid in the transaction */
+	Bitmapset					*xlogSegmentsMap;
+	/* Used on QD, the split of dtxSegments made before PREPARE */
+	List						*prepareSegments;
+	List						*readOnlySegments;
 	List						*waitGxids;
 }	TMGXACTLOCAL;
 
@@ -341,6 +347,7 @@ extern void markCurrentGxactWriterGangLost(void);
 extern bool currentGxactWriterGangLost(void);
 
 extern void addToGxactDtxSegments(struct Gang* gp);
+extern void addToGxactXLogSegments(int segindex);
 extern bool CurrentDtxIsRollingback(void);
 
 extern pid_t DtxRecoveryPID(void);
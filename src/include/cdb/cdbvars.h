@@ -288,11 +288,14 @@ typedef enum GpVars_Interconnect_Type
 extern int Gp_interconnect_type;
 
 extern char *gp_interconnect_proxy_addresses;
+extern int	gp_interconnect_proxy_batch_size;
+extern int	gp_interconnect_proxy_flush_interval;
 
 typedef enum GpVars_Interconnect_Method
 {
 	INTERCONNECT_FC_METHOD_CAPACITY = 0,
 	INTERCONNECT_FC_METHOD_LOSS = 2,
+	INTERCONNECT_FC_METHOD_DELAY = 3,
 } GpVars_Interconnect_Method;
 
 extern int Gp_interconnect_fc_method;
@@ -355,6 +358,14 @@ extern bool gp_interconnect_log_stats;
 
 extern bool gp_interconnect_cache_future_packets;
 
+/*
+ * Parameter gp_interconnect_local_socket
+ *
+ * The TCP interconnect connects to receivers on the same host through a
+ * Unix-domain socket instead of TCP. Off by default.
+ */
+extern bool gp_interconnect_local_socket;
+
 #define UNDEF_SEGMENT -2
 
 /*
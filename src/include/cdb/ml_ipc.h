@@ -321,6 +321,9 @@ extern void TeardownUDPIFCInterconnect(ChunkTransportState *transportStates,
 
 extern uint32 getActiveMotionConns(void);
 
+extern Size ICPeerStatsShmemSize(void);
+extern void ICPeerStatsShmemInit(void);
+
 extern char *format_sockaddr(struct sockaddr_storage *sa, char *buf, size_t len);
 
 #endif   /* ML_IPC_H */
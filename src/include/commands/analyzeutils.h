@@ -59,5 +59,7 @@ extern bool needs_sample(VacAttrStats **vacattrstats, int attr_cnt);
 extern AttrNumber fetch_leaf_attnum(Oid leafRelid, const char* attname);
 extern HeapTuple fetch_leaf_att_stats(Oid leafRelid, AttrNumber leafAttNum);
 extern bool leaf_parts_analyzed(Oid attrelid, Oid relid_exclude, List *va_cols, int elevel);
+extern List *leaf_parts_unchanged_since_analyze(Oid attrelid, List *part_oids,
+												List *va_cols, int elevel);
 
 #endif  /* ANALYZEUTILS_H */
@@ -193,6 +193,20 @@ typedef struct CopyStateData
 
 	StringInfo	dispatch_msgbuf; /* used in COPY_DISPATCH mode, to construct message
 								  * to send to QE. */
+
+	/*
+	 * In COPY_DISPATCH mode, when the QD needs nothing from the rows to
+	 * route them, the input lines are passed through to the QEs as is, in
+	 * batches of lines sent round-robin. In COPY_EXECUTOR mode, the batch
+	 * received from the QD that lines are being taken from.
+	 */
+	bool		dispatch_passthrough;
+	StringInfo	dispatch_batchbuf;
+	int			dispatch_batch_nlines;	/* # of lines in (QD) or left in (QE)
+										 * the batch */
+	int64		dispatch_batch_lineno;	/* line number of the first (QD) or
+										 * next (QE) line */
+	int			dispatch_batch_seg;		/* QD: random start + # of batches sent */
 	
 	/* Error handling options */
 	CopyErrMode	errMode;
@@ -42,6 +42,7 @@ class CExpression;
 class CMDAccessor;
 class CQueryContext;
 class COptimizerConfig;
+class COptimizationProfile;
 class ICostModel;
 }  // namespace gpopt
 
@@ -155,6 +156,9 @@ private:
 										 IMdIdArray *col_stats,
 										 MdidHashSet *phsmdidRel);
 
+	// add the profile of an optimization to the profile of the session
+	static void AddToSessionProfile(const COptimizationProfile *profile);
+
 public:
 	// convert Query->DXL->LExpr->Optimize->PExpr->DXL
 	static char *Optimize(Query *query);
@@ -165,6 +169,12 @@ public:
 
 	// enable/disable a given xforms
 	static bool SetXform(char *xform_str, bool should_disable);
+
+	// profile of the queries optimized in this session, or NULL
+	static const COptimizationProfile *GetSessionProfile();
+
+	// discard the profile of the session
+	static void ResetSessionProfile();
 };
 
 #endif	// COptTasks_H
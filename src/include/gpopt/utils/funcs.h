@@ -19,6 +19,8 @@ extern "C" {
 
 extern Datum DisableXform(PG_FUNCTION_ARGS);
 extern Datum EnableXform(PG_FUNCTION_ARGS);
+extern Datum OptimizerProfile(PG_FUNCTION_ARGS);
+extern Datum ResetOptimizerProfile(PG_FUNCTION_ARGS);
 extern Datum LibraryVersion();
 }
 
@@ -78,6 +78,15 @@ typedef struct PlannedStmt
 
 	PlanGenerator	planGen;		/* optimizer generation */
 
+	/*
+	 * GPDB: for GPORCA plans, whether the search was cut short by
+	 * optimizer_planning_time_budget, and how many of its search stages
+	 * ran to completion.
+	 */
+	bool		planBudgetExhausted;
+	int			planSearchStagesCompleted;
+	int			planSearchStages;
+
 	uint64		queryId;		/* query identifier (copied from Query) */
 
 	bool		hasReturning;	/* is it insert|update|delete RETURNING? */
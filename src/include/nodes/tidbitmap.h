@@ -181,7 +181,9 @@ struct StreamBMIterator
 		TBMIterator	   *hash;		/* for IndexStream */
 		List		   *stream;		/* for OpStream */
 	} input;						/* input iterator(s) */
-	void			   *opaque;		/* for the implementation in bitmap.c */
+	void			   *opaque;		/* for the implementation in bitmap.c, or
+									 * for OpStream, one PagetableEntry per
+									 * input, reused for every block */
 
 	PagetableEntry	   *nextentry;	/* for IndexStream, a pointer to the next cached entry */
 	BlockNumber			nextblock;	/* block number we're up to */
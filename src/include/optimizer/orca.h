@@ -23,6 +23,13 @@
 
 extern PlannedStmt * optimize_query(Query *parse, int cursorOptions, ParamListInfo boundParams);
 
+/* in orcaplancache.c */
+typedef struct OrcaPlanCacheKey OrcaPlanCacheKey;
+
+extern PlannedStmt *orca_plan_cache_lookup(Query *query, int cursorOptions,
+										   OrcaPlanCacheKey **key_p);
+extern void orca_plan_cache_insert(OrcaPlanCacheKey *key, PlannedStmt *plan);
+
 #else
 
 /* Keep compilers quiet in case the build used --disable-orca */
@@ -166,6 +166,14 @@ typedef struct DatumStreamRead
 	/* AO Storage */
 	bool		need_close_file;
 
+	/*
+	 * True once the content of the block described by blockFirstRowNum and
+	 * blockRowCount has been read from the currently open file.  Used by
+	 * datumstreamread_seek_row() to tell a current block apart from a stale
+	 * one left over from a previous segment file.
+	 */
+	bool		blockContentRead;
+
 }	DatumStreamRead;
 
 /*
@@ -242,6 +250,24 @@ datumstreamread_nth(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Dictionary code of the current, non-NULL item, or -1 when the current
+ * block is not dictionary encoded.  Codes are only comparable while
+ * *generation stays the same.
+ */
+inline static int32
+datumstreamread_dictionary_code(DatumStreamRead * acc, uint32 *generation)
+{
+	DatumStreamBlockRead *dsr = &acc->blockRead;
+
+	if (acc->largeObjectState != DatumStreamLargeObjectState_None ||
+		!dsr->dictionary_block_was_compressed)
+		return -1;
+
+	*generation = dsr->dictionary_generation;
+	return DatumStreamBlockRead_DictionaryCode(dsr, dsr->physical_datum_index);
+}
+
 /* ------------------------------------------------------------------------------ */
 
 extern int datumstreamwrite_put(
@@ -312,6 +338,8 @@ extern int	datumstreamread_block(DatumStreamRead * ds,
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
+extern bool datumstreamread_seek_row(DatumStreamRead * datumStream,
+						 int64 rowNum);
 extern bool datumstreamread_find_block(DatumStreamRead * datumStream,
 						   DatumStreamFetchDesc datumStreamFetchDesc,
 						   int64 rowNum);
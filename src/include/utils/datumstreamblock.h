@@ -196,6 +196,45 @@ typedef struct DatumStreamBlock_Delta_Extension
 	 */
 }	DatumStreamBlock_Delta_Extension;
 
+/*
+ * Datum Stream Block dictionary encoding of variable-length items.
+ *
+ * When DSB_HAS_DICTIONARY_COMPRESSION is set, the physical data area of a
+ * Dense block does not hold one varlena per physical datum. Instead it holds
+ * this header, one code per physical datum (1 byte each when there are at
+ * most 256 dictionary entries, 2 bytes otherwise), zero padding to a MAXALIGN
+ * boundary, and then each distinct varlena once, laid out and padded just
+ * like the items of a plain block.  physical_data_size covers all of it.
+ *
+ * Only the physical data area changes, so NULL bit-maps and RLE_TYPE
+ * metadata are unaffected.  12 bytes.
+ */
+typedef struct DatumStreamBlock_Dictionary_Extension
+{
+	int32		dictionary_count;
+	/*
+	 * Number of distinct items in the dictionary.
+	 */
+
+	int32		dictionary_size;
+	/*
+	 * Size of the dictionary items, including alignment padding.
+	 */
+
+	int32		code_size;
+	/*
+	 * Byte size of each code, 1 or 2.
+	 */
+}	DatumStreamBlock_Dictionary_Extension;
+
+#define DATUMSTREAM_DICTIONARY_MAX_COUNT (PG_UINT16_MAX + 1)
+
+/*
+ * A block is only dictionary encoded when that shrinks its physical data
+ * area by at least 1/DATUMSTREAM_DICTIONARY_MIN_SAVINGS_FRACTION.
+ */
+#define DATUMSTREAM_DICTIONARY_MIN_SAVINGS_FRACTION 8
+
 
 /* Flags */
 enum
@@ -203,6 +242,7 @@ enum
 	DSB_HAS_NULLBITMAP = 0x1,
 	DSB_HAS_RLE_COMPRESSION = 0x2,
 	DSB_HAS_DELTA_COMPRESSION = 0x4,
+	DSB_HAS_DICTIONARY_COMPRESSION = 0x8,
 };
 
 typedef struct DatumStreamBitMapWrite
@@ -988,6 +1028,20 @@ typedef struct DatumStreamTypeInfo
 
 #define MAXREPEAT_COUNT 0x3FFFFFFF
 
+/*
+ * Adaptive encoding (gp_aocs_adaptive_encoding) thresholds.
+ *
+ * A sampled block keeps RLE_TYPE when repeats elided at least
+ * 1/DATUMSTREAM_ADAPTIVE_RLE_MIN_FRACTION of its rows, and keeps Delta Range
+ * when at least 1/DATUMSTREAM_ADAPTIVE_DELTA_MIN_FRACTION of its physical
+ * datums were stored as deltas.  An encoding that did not pay off is switched
+ * off for DATUMSTREAM_ADAPTIVE_RESAMPLE_BLOCKS blocks and then sampled again.
+ * RLE_TYPE is never switched off while Delta Range is on, which depends on it.
+ */
+#define DATUMSTREAM_ADAPTIVE_RLE_MIN_FRACTION 16
+#define DATUMSTREAM_ADAPTIVE_DELTA_MIN_FRACTION 4
+#define DATUMSTREAM_ADAPTIVE_RESAMPLE_BLOCKS 8
+
 #define DatumStreamBlockWrite_Eyecatcher "DBW"
 #define DatumStreamBlockWrite_EyecatcherLen 4
 
@@ -1009,6 +1063,17 @@ typedef struct DatumStreamBlockWrite
 	bool		rle_want_compression;
 	bool		delta_want_compression;
 
+	/*
+	 * Adaptive encoding.  rle_can_compression and delta_can_compression are
+	 * what the stream was set up for; the want flags above are re-decided at
+	 * each block boundary from the statistics of the block just written.
+	 */
+	bool		adaptive;
+	bool		rle_can_compression;
+	bool		delta_can_compression;
+	int32		rle_skip_blocks;
+	int32		delta_skip_blocks;
+
 	int32		initialMaxDatumPerBlock;
 	int32		maxDatumPerBlock;
 
@@ -1057,6 +1122,9 @@ typedef struct DatumStreamBlockWrite
 	int32		deltas_count;
 	int32		deltas_current_size;
 
+	/* Dictionary variables, see DatumStreamBlock_Dictionary_Extension */
+	bool		dictionary_want_compression;
+
 	/* Common buffers */
 	MemoryContext memctxt;
 
@@ -1082,6 +1150,9 @@ typedef struct DatumStreamBlockWrite
 	bool	   *delta_sign;
 	int32		deltas_maxcount;
 
+	/* Dictionary buffer, allocated on first use */
+	uint8	   *dictionary_buffer;
+
 	/* EOF of current file */
 	int64		savings;
 	int64		remember_savings;
@@ -1164,6 +1235,20 @@ typedef struct DatumStreamBlockRead
 	bool		delta_block_was_compressed;
 	DatumStreamBitMapRead delta_bitmap;
 
+	/* Dictionary variables */
+	bool		dictionary_block_was_compressed;
+	int32		dictionary_count;
+	int32		dictionary_code_size;
+	uint8	   *dictionary_codesp;
+	uint8	  **dictionary_entries;
+	int32		dictionary_entries_maxcount;
+
+	/*
+	 * Bumped for each dictionary encoded block made ready, so callers can
+	 * tell when dictionary codes change meaning.
+	 */
+	uint32		dictionary_generation;
+
 	/*
 	 * Keep less frequently accessed fields down here for possible better CPU data cache
 	 * performance.
@@ -1718,6 +1803,21 @@ DatumStreamBlockRead_AdvanceDenseDelta(DatumStreamBlockRead * dsr)
 	return DELTA_COMPRESSION_OK;
 }
 
+/*
+ * Dictionary code of the given physical datum of a dictionary encoded block.
+ */
+inline static int32
+DatumStreamBlockRead_DictionaryCode(DatumStreamBlockRead * dsr, int32 physicalIndex)
+{
+	Assert(dsr->dictionary_block_was_compressed);
+	Assert(physicalIndex >= 0 && physicalIndex < dsr->physical_datum_count);
+
+	if (dsr->dictionary_code_size == 1)
+		return dsr->dictionary_codesp[physicalIndex];
+	else
+		return ((uint16 *) dsr->dictionary_codesp)[physicalIndex];
+}
+
 inline static int
 DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 {
@@ -1962,7 +2062,16 @@ DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 		/*
 		 * Advance the item pointer.
 		 */
-		if (dsr->typeInfo.datumlen == -1)
+		if (dsr->dictionary_block_was_compressed)
+		{
+			int32		code;
+
+			code = DatumStreamBlockRead_DictionaryCode(dsr, dsr->physical_datum_index);
+			Assert(code < dsr->dictionary_count);
+
+			dsr->datump = dsr->dictionary_entries[code];
+		}
+		else if (dsr->typeInfo.datumlen == -1)
 		{
 			struct varlena *s;
 
@@ -2133,6 +2242,34 @@ DatumStreamBlockRead_Reset(DatumStreamBlockRead * dsr)
 	}
 }
 
+/*
+ * Blocks are self-describing: both the Original and the Dense headers start
+ * with the datum stream version the block was written with.  A column that
+ * is not RLE_TYPE compressed is read as Original, but may contain Dense
+ * blocks written with gp_aocs_adaptive_encoding, so switch to the block's
+ * own format before unpacking it.
+ */
+inline static void
+DatumStreamBlockRead_AdoptBlockVersion(
+									   DatumStreamBlockRead * dsr,
+									   uint8 * buffer)
+{
+	DatumStreamVersion blockVersion;
+
+	blockVersion = (DatumStreamVersion) ((DatumStreamBlock_Orig *) buffer)->version;
+	if (blockVersion == dsr->datumStreamVersion)
+		return;
+
+	if (blockVersion != DatumStreamVersion_Original &&
+		blockVersion != DatumStreamVersion_Dense &&
+		blockVersion != DatumStreamVersion_Dense_Enhanced)
+		elog(ERROR, "Unexpected datum stream block version %d",
+			 (int) blockVersion);
+
+	dsr->datumStreamVersion = blockVersion;
+	DatumStreamBlockRead_Reset(dsr);
+}
+
 
 extern void DatumStreamBlockRead_Init(
 						  DatumStreamBlockRead * dsr,
@@ -2152,6 +2289,8 @@ extern void DatumStreamBlockWrite_Init(
 						   DatumStreamVersion datumStreamVersion,
 						   bool rle_want_compression,
 						   bool delta_want_compression,
+						   bool adaptive,
+						   bool dictionary_want_compression,
 						   int32 initialMaxDatumPerBlock,
 						   int32 maxDatumPerBlock,
 						   int32 maxDataBlockSize,
@@ -296,6 +296,9 @@ extern int  gp_max_local_distributed_cache;
 extern bool gp_local_distributed_cache_stats;
 extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
+extern bool gp_aocs_adaptive_encoding;
+extern bool gp_aocs_late_materialization;
+extern bool gp_aocs_dictionary_encoding;
 extern bool gp_appendonly_compaction;
 
 /*
@@ -457,6 +460,7 @@ extern bool	optimizer_log;
 extern int  optimizer_log_failure;
 extern bool	optimizer_trace_fallback;
 extern int optimizer_minidump;
+extern bool optimizer_minidump_binary;
 extern int  optimizer_cost_model;
 extern bool optimizer_metadata_caching;
 extern int	optimizer_mdcache_size;
@@ -473,7 +477,9 @@ extern bool	optimizer_print_expression_properties;
 extern bool	optimizer_print_group_properties;
 extern bool	optimizer_print_optimization_context;
 extern bool optimizer_print_optimization_stats;
+extern bool optimizer_print_plan_cache;
 extern bool optimizer_print_xform_results;
+extern bool optimizer_profile;
 
 /* array of xforms disable flags */
 extern bool optimizer_xforms[OPTIMIZER_XFORMS_COUNT];
@@ -533,6 +539,7 @@ extern double optimizer_damping_factor_join;
 extern double optimizer_damping_factor_groupby;
 extern bool optimizer_dpe_stats;
 extern bool optimizer_enable_derive_stats_all_groups;
+extern bool optimizer_enable_join_stats_cache;
 
 /* Costing or tuning related GUCs used by the Optimizer */
 extern int optimizer_segments;
@@ -548,6 +555,8 @@ extern int optimizer_join_order;
 extern int optimizer_join_arity_for_associativity_commutativity;
 extern int optimizer_cte_inlining_bound;
 extern int optimizer_push_group_by_below_setop_threshold;
+extern int optimizer_planning_time_budget;
+extern int optimizer_plan_cache_size;
 extern bool optimizer_force_multistage_agg;
 extern bool optimizer_force_three_stage_scalar_dqa;
 extern bool optimizer_force_expanded_distinct_aggs;
@@ -563,12 +572,15 @@ extern bool optimizer_multilevel_partitioning;
 extern bool optimizer_parallel_union;
 extern bool optimizer_array_constraints;
 extern bool optimizer_cte_inlining;
+extern bool optimizer_enable_subexpression_sharing;
 extern bool optimizer_enable_space_pruning;
+extern bool optimizer_enable_cost_bound_propagation;
 extern bool optimizer_enable_associativity;
 extern bool optimizer_enable_range_predicate_dpe;
 
 /* Analyze related GUCs for Optimizer */
 extern bool optimizer_analyze_root_partition;
+extern bool gp_analyze_changed_partitions_only;
 extern bool optimizer_analyze_midlevel_partition;
 extern bool optimizer_analyze_enable_merge_of_leaf_stats;
 
@@ -598,6 +610,7 @@ extern char  *gp_default_storage_options;
 
 /* copy GUC */
 extern bool gp_enable_segment_copy_checking;
+extern bool gp_copy_from_passthrough;
 
 extern int writable_external_table_bufsize;
 
@@ -12,6 +12,9 @@
 		"force_parallel_mode",
 		"gin_fuzzy_search_limit",
 		"gin_pending_list_limit",
+		"gp_aocs_adaptive_encoding",
+		"gp_aocs_late_materialization",
+		"gp_aocs_dictionary_encoding",
 		"gp_blockdirectory_entry_min_range",
 		"gp_blockdirectory_minipage_size",
 		"gp_debug_linger",
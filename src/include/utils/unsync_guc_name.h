@@ -150,6 +150,7 @@
 		"gp_adjust_selectivity_for_outerjoins",
 		"gp_allow_non_uniform_partitioning_ddl",
 		"gp_allow_rename_relation_without_lock",
+		"gp_analyze_changed_partitions_only",
 		"gp_appendonly_compaction",
 		"gp_appendonly_compaction_threshold",
 		"gp_appendonly_verify_block_checksums",
@@ -162,6 +163,7 @@
 		"gp_command_count",
 		"gp_connection_send_timeout",
 		"gp_contentid",
+		"gp_copy_from_passthrough",
 		"gp_cost_hashjoin_chainwalk",
 		"gp_create_table_random_default_distribution",
 		"gp_cte_sharing",
@@ -207,6 +209,9 @@
 		"gp_ignore_window_exclude",
 		"gp_instrument_shmem_size",
 		"gp_interconnect_cache_future_packets",
+		"gp_interconnect_local_socket",
+		"gp_interconnect_proxy_batch_size",
+		"gp_interconnect_proxy_flush_interval",
 		"gp_is_writer",
 		"gp_keep_all_xlog",
 		"gp_local_distributed_cache_stats",
@@ -361,6 +366,7 @@
 		"optimizer_enable_bitmapscan",
 		"optimizer_enable_broadcast_nestloop_outer_child",
 		"optimizer_enable_constant_expression_evaluation",
+		"optimizer_enable_cost_bound_propagation",
 		"optimizer_enable_ctas",
 		"optimizer_enable_derive_stats_all_groups",
 		"optimizer_enable_direct_dispatch",
@@ -376,6 +382,7 @@
 		"optimizer_enable_indexjoin",
 		"optimizer_enable_indexscan",
 		"optimizer_enable_indexonlyscan",
+		"optimizer_enable_join_stats_cache",
 		"optimizer_enable_master_only_queries",
 		"optimizer_enable_materialize",
 		"optimizer_enable_mergejoin",
@@ -394,6 +401,7 @@
 		"optimizer_enable_sort",
 		"optimizer_enable_space_pruning",
 		"optimizer_enable_streaming_material",
+		"optimizer_enable_subexpression_sharing",
 		"optimizer_enable_tablescan",
 		"optimizer_enforce_subplans",
 		"optimizer_enumerate_plans",
@@ -411,11 +419,14 @@
 		"optimizer_log_failure",
 		"optimizer_metadata_caching",
 		"optimizer_minidump",
+		"optimizer_minidump_binary",
 		"optimizer_multilevel_partitioning",
 		"optimizer_nestloop_factor",
 		"optimizer_parallel_union",
 		"optimizer_penalize_broadcast_threshold",
 		"optimizer_penalize_skew",
+		"optimizer_plan_cache_size",
+		"optimizer_planning_time_budget",
 		"optimizer_print_expression_properties",
 		"optimizer_print_group_properties",
 		"optimizer_print_job_scheduler",
@@ -426,9 +437,11 @@
 		"optimizer_print_optimization_context",
 		"optimizer_print_optimization_stats",
 		"optimizer_print_plan",
+		"optimizer_print_plan_cache",
 		"optimizer_print_query",
 		"optimizer_print_xform",
 		"optimizer_print_xform_results",
+		"optimizer_profile",
 		"optimizer_prune_computed_columns",
 		"optimizer_prune_unused_columns",
 		"optimizer_push_requirements_from_consumer_to_producer",
@@ -0,0 +1,56 @@
+-- Segments that have not assigned an xid in a distributed transaction are
+-- not prepared, but they must stay in the transaction, holding their locks,
+-- until the commit has been decided.
+CREATE TABLE readonly_segments_commit_t (a int, b int) DISTRIBUTED BY (a);
+CREATE TABLE readonly_segments_commit_lock (a int) DISTRIBUTED BY (a);
+INSERT INTO readonly_segments_commit_t SELECT i, 0 FROM generate_series(1, 100) i;
+-- keep one row on each segment
+DELETE FROM readonly_segments_commit_t WHERE a NOT IN (SELECT min(a) FROM readonly_segments_commit_t GROUP BY gp_segment_id);
+
+-- Only content 0 and 1 write, content 2 is read-only. The lock is taken in a
+-- mode that does not assign an xid, as ACCESS EXCLUSIVE would with wal_level
+-- replica.
+1: BEGIN;
+1: LOCK TABLE readonly_segments_commit_lock IN ROW SHARE MODE;
+1: UPDATE readonly_segments_commit_t SET b = b + 1 WHERE gp_segment_id <> 2;
+SELECT gp_inject_fault('dtm_broadcast_prepare', 'suspend', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+1&: COMMIT;
+SELECT gp_wait_until_triggered_fault('dtm_broadcast_prepare', 1, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+
+-- The writers are prepared, the read-only segment is not, but it still
+-- holds its lock.
+0U: SELECT count(*) FROM pg_prepared_xacts;
+2U: SELECT count(*) FROM pg_prepared_xacts;
+2U: SELECT count(*) FROM pg_locks WHERE relation = 'readonly_segments_commit_lock'::regclass AND mode = 'RowShareLock' AND granted;
+
+SELECT gp_inject_fault('dtm_broadcast_prepare', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+1<:
+
+2U: SELECT count(*) FROM pg_locks WHERE relation = 'readonly_segments_commit_lock'::regclass;
+SELECT gp_segment_id, min(b), max(b) FROM readonly_segments_commit_t GROUP BY 1 ORDER BY 1;
+SELECT count(*) FROM gp_dist_random('pg_prepared_xacts');
+
+-- A failed PREPARE on a writer aborts the read-only segment as well.
+SELECT gp_inject_fault('start_prepare', 'error', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+1: BEGIN;
+1: LOCK TABLE readonly_segments_commit_lock IN ROW SHARE MODE;
+1: UPDATE readonly_segments_commit_t SET b = b + 1 WHERE gp_segment_id <> 2;
+1: COMMIT;
+SELECT gp_inject_fault('start_prepare', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+
+2U: SELECT count(*) FROM pg_locks WHERE relation = 'readonly_segments_commit_lock'::regclass;
+SELECT gp_segment_id, min(b), max(b) FROM readonly_segments_commit_t GROUP BY 1 ORDER BY 1;
+SELECT count(*) FROM gp_dist_random('pg_prepared_xacts');
+
+-- The next transaction commits normally.
+1: BEGIN;
+1: LOCK TABLE readonly_segments_commit_lock IN ROW SHARE MODE;
+1: UPDATE readonly_segments_commit_t SET b = b + 1 WHERE gp_segment_id <> 2;
+1: COMMIT;
+SELECT gp_segment_id, min(b), max(b) FROM readonly_segments_commit_t GROUP BY 1 ORDER BY 1;
+
+1q:
+0Uq:
+2Uq:
+DROP TABLE readonly_segments_commit_t;
+DROP TABLE readonly_segments_commit_lock;
@@ -0,0 +1,95 @@
+--
+-- Test gp_analyze_changed_partitions_only: ANALYZE of a partitioned table
+-- skips the leaf partitions that have not changed since their last ANALYZE.
+--
+create table acp (a int, b int) distributed by (a)
+partition by range (b) (start (0) end (3) every (1));
+
+-- The segments report the modification counts of a leaf to their stats
+-- collector asynchronously. Wait until they add up to what is expected, so
+-- that the ANALYZE that follows sees them.
+create function acp_mod_since_analyze(rel regclass) returns setof bigint as $$
+begin
+	perform pg_stat_clear_snapshot();
+	return next pg_stat_get_mod_since_analyze(rel);
+end;
+$$ language plpgsql execute on all segments;
+create function acp_wait_for_mods(rel regclass, expected bigint) returns bool as $$
+begin
+	for i in 1 .. 300 loop
+		if (select sum(m) from acp_mod_since_analyze(rel) m) = expected then
+			return true;
+		end if;
+		perform pg_sleep(0.1);
+	end loop;
+	return false;
+end;
+$$ language plpgsql;
+
+-- A leaf was analyzed again if any of its statistics rows was rewritten or
+-- added since they were saved in acp_last_analyze.
+create temp table acp_last_analyze (relid oid, staattnum int2, staxmin text)
+distributed randomly;
+create temp view acp_reanalyzed as
+select c.relname, bool_or(a.staxmin is distinct from s.xmin::text) as reanalyzed,
+       c.reltuples
+from pg_class c
+  join pg_statistic s on s.starelid = c.oid
+  left join acp_last_analyze a on a.relid = s.starelid and a.staattnum = s.staattnum
+where c.relname like 'acp_1_prt_%'
+group by c.relname, c.reltuples;
+
+insert into acp select i, i % 3 from generate_series(1, 300) i;
+select acp_wait_for_mods('acp_1_prt_1', 100) and
+       acp_wait_for_mods('acp_1_prt_2', 100) and
+       acp_wait_for_mods('acp_1_prt_3', 100) as reported;
+
+analyze acp;
+select acp_wait_for_mods('acp_1_prt_1', 0) and
+       acp_wait_for_mods('acp_1_prt_2', 0) and
+       acp_wait_for_mods('acp_1_prt_3', 0) as reported;
+
+insert into acp_last_analyze
+select starelid, staattnum, xmin::text from pg_statistic
+where starelid::regclass::text like 'acp_1_prt_%';
+
+-- Modify only the second leaf.
+insert into acp select i, 1 from generate_series(301, 400) i;
+select acp_wait_for_mods('acp_1_prt_2', 100) as reported;
+
+set gp_analyze_changed_partitions_only to on;
+analyze acp;
+
+-- Only acp_1_prt_2 was analyzed again.
+select relname, reanalyzed, reltuples from acp_reanalyzed order by relname;
+
+-- The root statistics are still merged from all leaves.
+select attname, null_frac from pg_stats where tablename = 'acp' order by attname;
+
+-- Nothing changed since, so no leaf is analyzed again.
+select acp_wait_for_mods('acp_1_prt_2', 0) as reported;
+truncate acp_last_analyze;
+insert into acp_last_analyze
+select starelid, staattnum, xmin::text from pg_statistic
+where starelid::regclass::text like 'acp_1_prt_%';
+analyze acp;
+select relname, reanalyzed from acp_reanalyzed order by relname;
+
+-- A leaf without statistics for a requested column is always analyzed.
+alter table acp add column c int;
+analyze acp(c);
+select relname, reanalyzed from acp_reanalyzed order by relname;
+
+-- With the GUC off, every leaf is analyzed.
+reset gp_analyze_changed_partitions_only;
+truncate acp_last_analyze;
+insert into acp_last_analyze
+select starelid, staattnum, xmin::text from pg_statistic
+where starelid::regclass::text like 'acp_1_prt_%';
+analyze acp;
+select relname, reanalyzed from acp_reanalyzed order by relname;
+
+drop view acp_reanalyzed;
+drop table acp;
+drop function acp_wait_for_mods(regclass, bigint);
+drop function acp_mod_since_analyze(regclass);
@@ -0,0 +1,56 @@
+--
+-- Late materialization of sequential scans on AO column tables
+--
+create schema aocs_late_materialization;
+set search_path to aocs_late_materialization;
+set gp_aocs_late_materialization to on;
+
+create table lm (a int, b int, c text, d int)
+  with (appendonly=true, orientation=column) distributed by (a);
+insert into lm select i, i % 100, repeat('x', 100) || i, i * 2
+  from generate_series(1, 20000) i;
+-- rows deleted through the visibility map are not returned
+delete from lm where b = 7 and a > 10000;
+
+select count(*), sum(d) from lm where b = 7;
+select a, length(c), d from lm where b = 7 and a < 300 order by a;
+select count(*), min(d) from lm where b = 7 and c like '%07';
+
+-- same results without late materialization
+set gp_aocs_late_materialization to off;
+select count(*), sum(d) from lm where b = 7;
+select a, length(c), d from lm where b = 7 and a < 300 order by a;
+set gp_aocs_late_materialization to on;
+
+-- The qual is evaluated exactly once per row, by the scan when late
+-- materialization applies, else by the executor. The functions count their
+-- calls in the transaction, so that a row checked twice would show up.
+create table lm_one (k int, b int, c text)
+  with (appendonly=true, orientation=column) distributed by (k);
+insert into lm_one select 1, i, 'row' || i from generate_series(1, 5) i;
+
+create function lm_check_stable(i int) returns bool as $$
+declare
+  n int := coalesce(nullif(current_setting('lm.calls', true), ''), '0')::int + 1;
+begin
+  perform set_config('lm.calls', n::text, true);
+  raise notice 'lm_check_stable(%), call %', i, n;
+  return i % 2 = 1;
+end;
+$$ language plpgsql stable;
+
+create function lm_check_volatile(i int) returns bool as $$
+declare
+  n int := coalesce(nullif(current_setting('lm.calls', true), ''), '0')::int + 1;
+begin
+  perform set_config('lm.calls', n::text, true);
+  raise notice 'lm_check_volatile(%), call %', i, n;
+  return i % 2 = 1;
+end;
+$$ language plpgsql volatile;
+
+select b, c from lm_one where lm_check_stable(b) order by b;
+select b, c from lm_one where lm_check_volatile(b) order by b;
+
+reset gp_aocs_late_materialization;
+drop schema aocs_late_materialization cascade;
@@ -341,3 +341,22 @@ SELECT * from bm_test_reindex where c2 = 32767;
 SELECT * from bm_test_reindex where c2 = 32768;
 SELECT * from bm_test_reindex where c2 = 32769;
 SELECT * from bm_test_reindex where c2 = 65536;
+
+-- The bitmap words of these indexes are mostly literal words with bits set
+-- all over them, including the last bit of a word, and span several
+-- blocks of AO tids. ANDing and ORing them pulls the inputs of a block, and
+-- an input with nothing in a block makes the AND skip ahead to the next.
+CREATE TABLE bm_test_words(i int, a int, b int, d int, c int)
+  WITH (appendonly=true) DISTRIBUTED BY (c);
+INSERT INTO bm_test_words SELECT i, i % 5, i % 3, i / 30000, 0
+  FROM generate_series(1, 70000) i;
+CREATE INDEX bm_test_words_a_idx ON bm_test_words USING bitmap(a);
+CREATE INDEX bm_test_words_b_idx ON bm_test_words USING bitmap(b);
+CREATE INDEX bm_test_words_d_idx ON bm_test_words USING bitmap(d);
+SELECT count(*), sum(i) FROM bm_test_words WHERE a = 1;
+SELECT count(*), sum(i) FROM bm_test_words WHERE a = 1 AND b = 2;
+SELECT count(*), sum(i) FROM bm_test_words WHERE a = 1 OR b = 2;
+SELECT count(*), sum(i) FROM bm_test_words WHERE a = 1 AND d = 1;
+SELECT count(*), sum(i) FROM bm_test_words WHERE a = 1 OR d = 2;
+SELECT count(*), sum(i) FROM bm_test_words WHERE (a = 1 OR a = 4) AND b = 0 AND d = 2;
+DROP TABLE bm_test_words;
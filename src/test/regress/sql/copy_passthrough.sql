@@ -0,0 +1,55 @@
+--
+-- COPY FROM with gp_copy_from_passthrough, where the QD sends the input lines
+-- of a randomly distributed table to the QEs in batches, without parsing them.
+--
+set gp_copy_from_passthrough = on;
+create table copy_passthrough (a int, b text, c int default 42) distributed randomly;
+-- text
+copy copy_passthrough from stdin;
+1	one	10
+2	two	20
+3	\N	30
+4	four	40
+\.
+select * from copy_passthrough order by a;
+truncate copy_passthrough;
+-- csv, with quoted delimiters and newlines
+copy copy_passthrough from stdin csv;
+1,"one, two",10
+2,"multi
+line",20
+3,,30
+4,"",40
+\.
+select a, replace(b, E'\n', '/') as b, b is null as b_null, c from copy_passthrough order by a;
+truncate copy_passthrough;
+-- defaults are evaluated in the QEs
+copy copy_passthrough (a, b) from stdin;
+1	one
+2	two
+\.
+select * from copy_passthrough order by a;
+truncate copy_passthrough;
+-- errors are logged with the line numbers of the input
+copy copy_passthrough from stdin log errors segment reject limit 10;
+1	one	10
+bad	two	20
+3	three	30
+4	four
+5	five	50
+\.
+select * from copy_passthrough order by a;
+select linenum, replace(rawdata, E'\t', '|') as rawdata from gp_read_error_log('copy_passthrough') order by linenum;
+select gp_truncate_error_log('copy_passthrough');
+truncate copy_passthrough;
+-- empty input
+copy copy_passthrough from stdin;
+\.
+select count(*) from copy_passthrough;
+-- a single line
+copy copy_passthrough from stdin;
+1	one	10
+\.
+select * from copy_passthrough;
+drop table copy_passthrough;
+reset gp_copy_from_passthrough;
@@ -0,0 +1,49 @@
+--
+-- Test that propagating upper cost bounds to child optimization contexts
+-- (optimizer_enable_cost_bound_propagation) prunes alternatives, as counted
+-- in the optimizer profile, and that results do not change.
+--
+create table cbp1 (a int, b int) distributed by (a);
+create table cbp2 (a int, b int) distributed by (a);
+create table cbp3 (a int, b int) distributed by (b);
+create table cbp4 (a int, b int) distributed randomly;
+insert into cbp1 select i, i % 10 from generate_series(1, 1000) i;
+insert into cbp2 select i, i % 50 from generate_series(1, 500) i;
+insert into cbp3 select i, i from generate_series(1, 100) i;
+insert into cbp4 select i, i % 100 from generate_series(1, 2000) i;
+create index cbp2_b on cbp2 (b);
+analyze cbp1;
+analyze cbp2;
+analyze cbp3;
+analyze cbp4;
+
+set optimizer_profile = on;
+select gp_optimizer_profile_reset();
+
+set optimizer_enable_cost_bound_propagation = on;
+select count(*) from cbp1, cbp2, cbp3, cbp4
+where cbp1.a = cbp2.a and cbp2.b = cbp3.a and cbp3.a = cbp4.b;
+select cbp1.b, sum(cbp2.a) from cbp1 join cbp2 on cbp1.a = cbp2.b
+group by cbp1.b order by cbp1.b;
+select count(*) from cbp1 left join cbp3 on cbp1.b = cbp3.b
+where cbp1.a in (select a from cbp4 where b < 10);
+-- the same context requested with different bounds
+select count(*) from cbp2 x join cbp2 y on x.b = y.b
+  join cbp1 on cbp1.a = x.a join cbp4 on cbp4.a = y.a;
+select coalesce(sum(calls), 0) > 0 as pruned
+from gp_optimizer_profile() where kind = 'counter' and name = 'CostBoundPrunes';
+
+-- without the bounds, nothing is pruned against them
+select gp_optimizer_profile_reset();
+reset optimizer_enable_cost_bound_propagation;
+select count(*) from cbp1, cbp2, cbp3, cbp4
+where cbp1.a = cbp2.a and cbp2.b = cbp3.a and cbp3.a = cbp4.b;
+select count(*) from cbp2 x join cbp2 y on x.b = y.b
+  join cbp1 on cbp1.a = x.a join cbp4 on cbp4.a = y.a;
+select coalesce(sum(calls), 0) > 0 as pruned
+from gp_optimizer_profile() where kind = 'counter' and name = 'CostBoundPrunes';
+
+reset optimizer_profile;
+select gp_optimizer_profile_reset();
+
+drop table cbp1, cbp2, cbp3, cbp4;
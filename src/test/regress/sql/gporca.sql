@@ -2815,6 +2815,17 @@ reset optimizer_enable_groupagg;
 reset optimizer_trace_fallback;
 reset enable_sort;
 
+-- the optimizer profile of the session only covers queries optimized by
+-- GPORCA while optimizer_profile is on
+select gp_optimizer_profile_reset();
+set optimizer_profile = on;
+select count(*) >= 0 as ok from foo join tbitmap using (a);
+reset optimizer_profile;
+select count(*) > 0 as has_xforms from gp_optimizer_profile() where kind = 'xform';
+select count(*) > 0 as has_stages from gp_optimizer_profile() where kind = 'stage' and calls = 1;
+select gp_optimizer_profile_reset();
+select count(*) from gp_optimizer_profile();
+
 -- start_ignore
 DROP SCHEMA orca CASCADE;
 -- end_ignore
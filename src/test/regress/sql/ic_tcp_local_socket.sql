@@ -0,0 +1,34 @@
+--
+-- Test the TCP interconnect with gp_interconnect_local_socket, where senders
+-- connect to receivers on the same host through Unix-domain sockets.
+--
+-- start_ignore
+\! gpconfig -c gp_interconnect_local_socket -v on
+\! gpstop -u
+-- end_ignore
+-- Wait a few seconds, to ensure the config changes take effect.
+select pg_sleep(2);
+
+create table ic_local_socket (a int, b int) distributed by (a);
+insert into ic_local_socket select i, i % 10 from generate_series(1, 1000) i;
+
+select gp_inject_fault_infinite('interconnect_local_socket_connect', 'skip', dbid)
+from gp_segment_configuration where role = 'p' and content >= 0;
+
+-- gp_interconnect_type can only be set when the session starts. The join
+-- moves rows between the segments, and the results to the coordinator.
+\! PGOPTIONS='-c gp_interconnect_type=tcp' psql -X -d regression -c "select count(*), sum(t1.a) from ic_local_socket t1 join ic_local_socket t2 on t1.a = t2.b"
+\! PGOPTIONS='-c gp_interconnect_type=tcp' psql -X -d regression -c "select b, count(*) from ic_local_socket group by b order by b"
+
+-- every segment sent through a local socket
+select gp_wait_until_triggered_fault('interconnect_local_socket_connect', 1, dbid)
+from gp_segment_configuration where role = 'p' and content >= 0;
+select gp_inject_fault('interconnect_local_socket_connect', 'reset', dbid)
+from gp_segment_configuration where role = 'p' and content >= 0;
+
+-- start_ignore
+\! gpconfig -r gp_interconnect_local_socket
+\! gpstop -u
+-- end_ignore
+
+drop table ic_local_socket;
@@ -0,0 +1,74 @@
+-- 
+-- @description Interconncet delay based flow control test case: combination guc value
+-- @created 2026-10-18
+-- @modified 2026-10-18
+-- @tags executor
+-- @gpdb_version [4.2.3.0,main]
+
+-- Create a table
+CREATE TEMP TABLE small_table(dkey INT, jkey INT, rval REAL, tval TEXT default 'abcdefghijklmnopqrstuvwxyz') DISTRIBUTED BY (dkey);
+
+-- Generate some data
+INSERT INTO small_table VALUES(generate_series(1, 5000), generate_series(5001, 10000), sqrt(generate_series(5001, 10000)));
+
+-- Functional tests
+-- Skew with gather+redistribute
+SET gp_interconnect_fc_method = "delay";
+SHOW gp_interconnect_fc_method;
+
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+
+-- Set GUC values
+SET gp_interconnect_snd_queue_depth = 1;
+SET gp_interconnect_queue_depth = 1;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+
+-- Set GUC values
+SET gp_interconnect_snd_queue_depth = 4096;
+SET gp_interconnect_queue_depth = 4096;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+
+-- Set GUC values
+SET gp_interconnect_snd_queue_depth = 1;
+SET gp_interconnect_queue_depth = 4096;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+
+-- Set GUC values
+SET gp_interconnect_snd_queue_depth = 4096;
+SET gp_interconnect_queue_depth = 1;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+
+-- Set GUC values
+SET gp_interconnect_snd_queue_depth = 1024;
+SET gp_interconnect_queue_depth = 1024;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+
+-- Every segment sent its rows to the coordinator, and the senders kept the
+-- statistics of those connections
+SELECT count(DISTINCT gp_segment_id) = (SELECT count(*) FROM gp_segment_configuration WHERE role = 'p' AND content >= 0) AS all_segments
+  FROM gp_interconnect_peer_stats
+  WHERE gp_segment_id >= 0 AND peer_segment_id = -1 AND connections > 0 AND packets > 0;
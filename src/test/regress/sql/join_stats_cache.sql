@@ -0,0 +1,61 @@
+--
+-- Test that join order xforms reuse join statistics through the join stats
+-- cache (optimizer_enable_join_stats_cache), as counted in the optimizer
+-- profile, and that results do not change.
+--
+create table jsc1 (a int, b int) distributed by (a);
+create table jsc2 (a int, b int) distributed by (a);
+create table jsc3 (a int, b int) distributed by (a);
+create table jsc4 (a int, b int) distributed by (a);
+create table jsc5 (a int, b int) distributed by (a);
+insert into jsc1 select i, i % 10 from generate_series(1, 1000) i;
+insert into jsc2 select i, i % 50 from generate_series(1, 500) i;
+insert into jsc3 select i, i from generate_series(1, 100) i;
+insert into jsc4 select i, i % 100 from generate_series(1, 2000) i;
+insert into jsc5 select i, i from generate_series(1, 50) i;
+analyze jsc1;
+analyze jsc2;
+analyze jsc3;
+analyze jsc4;
+analyze jsc5;
+
+set optimizer_profile = on;
+
+-- the join order xforms derive the stats of the same inner joins
+select gp_optimizer_profile_reset();
+select count(*) from jsc1, jsc2, jsc3, jsc4, jsc5
+where jsc1.a = jsc2.a and jsc2.b = jsc3.a and jsc3.a = jsc4.b and jsc4.a = jsc5.a;
+select coalesce(sum(calls), 0) > 0 as cache_hits
+from gp_optimizer_profile() where kind = 'counter' and name = 'JoinStatsCacheHits';
+
+-- and derive them anew without the cache
+select gp_optimizer_profile_reset();
+set optimizer_enable_join_stats_cache = off;
+select count(*) from jsc1, jsc2, jsc3, jsc4, jsc5
+where jsc1.a = jsc2.a and jsc2.b = jsc3.a and jsc3.a = jsc4.b and jsc4.a = jsc5.a;
+select coalesce(sum(calls), 0) > 0 as cache_hits
+from gp_optimizer_profile() where kind = 'counter' and name = 'JoinStatsCacheHits';
+reset optimizer_enable_join_stats_cache;
+
+reset optimizer_profile;
+select gp_optimizer_profile_reset();
+
+-- every join order algorithm; the join order xforms reset the stats of the
+-- groups they add alternatives to
+set optimizer_join_order = exhaustive2;
+select count(*) from jsc1, jsc2, jsc3, jsc4, jsc5
+where jsc1.a = jsc2.a and jsc2.b = jsc3.a and jsc3.a = jsc4.b and jsc4.a = jsc5.a;
+set optimizer_join_order = greedy;
+select count(*) from jsc1, jsc2, jsc3, jsc4, jsc5
+where jsc1.a = jsc2.a and jsc2.b = jsc3.a and jsc3.a = jsc4.b and jsc4.a = jsc5.a;
+reset optimizer_join_order;
+
+-- with an outer join, only the inner joins are cached
+select count(*) from jsc1 join jsc2 on jsc1.a = jsc2.a
+  left join jsc3 on jsc2.b = jsc3.a
+  join jsc4 on jsc4.a = jsc1.a;
+-- the same atoms joined by different predicates
+select count(*) from jsc1, jsc3, jsc4, jsc5
+where jsc1.b = jsc3.b and jsc3.a = jsc5.a and jsc1.a = jsc4.a;
+
+drop table jsc1, jsc2, jsc3, jsc4, jsc5;
@@ -0,0 +1,53 @@
+--
+-- Test that plans reused from the GPORCA plan cache (optimizer_plan_cache_size)
+-- return the same rows as freshly planned queries.
+--
+create table opc1 (a int, b int) distributed by (a);
+create table opc2 (a int, b int) distributed by (a);
+insert into opc1 select i, i % 10 from generate_series(1, 100) i;
+insert into opc2 select i, i % 20 from generate_series(1, 200) i;
+analyze opc1;
+analyze opc2;
+
+set optimizer_plan_cache_size = 16;
+
+-- only the constants compared with columns change
+select count(*) from opc1 where b = 3;
+select count(*) from opc1 where b = 4;
+select count(*) from opc1 where b = 3;
+select sum(opc1.a) from opc1 join opc2 on opc1.a = opc2.a where opc2.b < 5;
+select sum(opc1.a) from opc1 join opc2 on opc1.a = opc2.a where opc2.b < 15;
+
+-- a literal of the query equal to a parameter must not be rebound
+select sum(a + 5) from opc1 where b = 5;
+select sum(a + 5) from opc1 where b = 7;
+select sum(a + 5) from opc1 where b = 5;
+select sum(a + 7) from opc1 where b = 7;
+select sum(a + 7) from opc1 where b = 5;
+select a + 5 from opc1 where b = 5 order by a limit 3;
+select a + 5 from opc1 where b = 7 order by a limit 3;
+
+-- parameters equal to each other
+select count(*) from opc1 where a > 5 and b = 5;
+select count(*) from opc1 where a > 6 and b = 5;
+select count(*) from opc1 where a > 5 and b = 6;
+
+-- the same constant with another type is not a parameter of this one
+select sum(a + 5::bigint) from opc1 where b = 5;
+select sum(a + 5::bigint) from opc1 where b = 7;
+
+-- a column without statistics matches any value, so the plan built for the
+-- first query is reused, with its constant replaced, for the second one
+set gp_autostats_mode = none;
+create table opc3 (a int, b int) distributed by (a);
+insert into opc3 select i, i % 10 from generate_series(1, 100) i;
+set optimizer_print_plan_cache = on;
+select count(*) from opc3 where b < 3;
+select count(*) from opc3 where b < 7;
+select count(*) from opc3 where b > 3;
+reset optimizer_print_plan_cache;
+reset gp_autostats_mode;
+
+reset optimizer_plan_cache_size;
+
+drop table opc1, opc2, opc3;
@@ -0,0 +1,72 @@
+--
+-- Test that a spent planning time budget (optimizer_planning_time_budget)
+-- cuts the search short, as counted in the optimizer profile, and only stops
+-- the exploration of join orders: GPORCA still produces a plan, and the plan
+-- returns the right rows.
+--
+create table ptb1 (a int, b int) distributed by (a);
+create table ptb2 (a int, b int) distributed by (a);
+create table ptb3 (a int, b int) distributed by (a);
+create table ptb4 (a int, b int) distributed by (a);
+create table ptb5 (a int, b int) distributed by (a);
+create table ptb6 (a int, b int) distributed by (a);
+insert into ptb1 select i, i % 10 from generate_series(1, 1000) i;
+insert into ptb2 select i, i % 50 from generate_series(1, 500) i;
+insert into ptb3 select i, i from generate_series(1, 100) i;
+insert into ptb4 select i, i % 100 from generate_series(1, 2000) i;
+insert into ptb5 select i, i from generate_series(1, 50) i;
+insert into ptb6 select i, i % 5 from generate_series(1, 200) i;
+analyze ptb1;
+analyze ptb2;
+analyze ptb3;
+analyze ptb4;
+analyze ptb5;
+analyze ptb6;
+
+set optimizer_profile = on;
+
+-- exploring the join orders of six tables takes longer than a millisecond
+select gp_optimizer_profile_reset();
+set optimizer_planning_time_budget = 1;
+set optimizer_join_order = exhaustive;
+select count(*) from ptb1, ptb2, ptb3, ptb4, ptb5, ptb6
+where ptb1.a = ptb2.a and ptb2.b = ptb3.a and ptb3.a = ptb4.b
+  and ptb4.a = ptb5.a and ptb5.b = ptb6.a;
+select coalesce(sum(calls), 0) > 0 as budget_exhausted
+from gp_optimizer_profile() where kind = 'counter' and name = 'TimeBudgetExhausted';
+
+-- without a budget, the search runs to completion
+select gp_optimizer_profile_reset();
+reset optimizer_planning_time_budget;
+select count(*) from ptb1, ptb2, ptb3, ptb4, ptb5, ptb6
+where ptb1.a = ptb2.a and ptb2.b = ptb3.a and ptb3.a = ptb4.b
+  and ptb4.a = ptb5.a and ptb5.b = ptb6.a;
+select coalesce(sum(calls), 0) > 0 as budget_exhausted
+from gp_optimizer_profile() where kind = 'counter' and name = 'TimeBudgetExhausted';
+
+reset optimizer_profile;
+select gp_optimizer_profile_reset();
+
+set optimizer_planning_time_budget = 1;
+
+-- exhaustive2 does not expand n-ary joins in query order by itself
+set optimizer_join_order = exhaustive2;
+select count(*) from ptb1, ptb2, ptb3, ptb4, ptb5, ptb6
+where ptb1.a = ptb2.a and ptb2.b = ptb3.a and ptb3.a = ptb4.b
+  and ptb4.a = ptb5.a and ptb5.b = ptb6.a;
+
+set optimizer_join_order = greedy;
+select count(*) from ptb1, ptb2, ptb3, ptb4, ptb5, ptb6
+where ptb1.a = ptb2.a and ptb2.b = ptb3.a and ptb3.a = ptb4.b
+  and ptb4.a = ptb5.a and ptb5.b = ptb6.a;
+reset optimizer_join_order;
+
+-- outer joins and subqueries still need exploration to be implemented
+select count(*) from ptb1 join ptb2 on ptb1.a = ptb2.a
+  left join ptb3 on ptb2.b = ptb3.a
+  join ptb4 on ptb4.a = ptb1.a
+where ptb1.b in (select b from ptb6);
+
+reset optimizer_planning_time_budget;
+
+drop table ptb1, ptb2, ptb3, ptb4, ptb5, ptb6;
@@ -0,0 +1,96 @@
+--
+-- Test sharing identical subtrees of UNION inputs through CTEs
+-- (optimizer_enable_subexpression_sharing). The shared subtrees define
+-- different columns in each input, so the results show whether they are
+-- mapped back correctly.
+--
+create table ses_fact (id int, dim_id int, amount int) distributed by (id);
+create table ses_dim (id int, region text, kind int) distributed by (id);
+insert into ses_fact select i, i % 20, i from generate_series(1, 1000) i;
+insert into ses_dim select i, 'r' || (i % 3), i % 4 from generate_series(0, 19) i;
+analyze ses_fact;
+analyze ses_dim;
+
+-- Count the Shared Scan nodes in the plan of a query.
+create function ses_count_shared_scans(query text) returns int as $$
+declare
+	ln text;
+	result int := 0;
+begin
+	for ln in execute 'explain (costs off) ' || query loop
+		if ln like '%Shared Scan%' then
+			result := result + 1;
+		end if;
+	end loop;
+	return result;
+end;
+$$ language plpgsql;
+
+set optimizer_cte_inlining = on;
+
+-- Whether to inline the consumers of the CTE is left to costing; keep them
+-- so that the plan shows the sharing.
+-- start_ignore
+select disable_xform('CXformInlineCTEConsumer');
+-- end_ignore
+-- without sharing, each branch computes the join
+select ses_count_shared_scans($$
+select 'sum' as agg, d.region, sum(f.amount)
+from ses_fact f join ses_dim d on f.dim_id = d.id group by d.region
+union all
+select 'max', d.region, max(f.amount)
+from ses_fact f join ses_dim d on f.dim_id = d.id group by d.region
+$$) > 0 as shared;
+-- with sharing, a CTE producer computes the join once for both branches
+set optimizer_enable_subexpression_sharing = on;
+select ses_count_shared_scans($$
+select 'sum' as agg, d.region, sum(f.amount)
+from ses_fact f join ses_dim d on f.dim_id = d.id group by d.region
+union all
+select 'max', d.region, max(f.amount)
+from ses_fact f join ses_dim d on f.dim_id = d.id group by d.region
+$$) > 0 as shared;
+-- start_ignore
+select enable_xform('CXformInlineCTEConsumer');
+-- end_ignore
+
+-- the same join in every branch, aggregated differently
+select 'sum' as agg, d.region, sum(f.amount)
+from ses_fact f join ses_dim d on f.dim_id = d.id group by d.region
+union all
+select 'max', d.region, max(f.amount)
+from ses_fact f join ses_dim d on f.dim_id = d.id group by d.region
+union all
+select 'min', d.region, min(f.amount)
+from ses_fact f join ses_dim d on f.dim_id = d.id group by d.region
+order by 1, 2;
+
+-- the shared join under different filters, with union removing duplicates
+select d.kind from ses_fact f join ses_dim d on f.dim_id = d.id
+where f.amount < 100
+union
+select d.kind from ses_fact f join ses_dim d on f.dim_id = d.id
+where f.amount > 990
+order by 1;
+
+-- the join appears with its inputs swapped; the columns of each branch
+-- must come from its own copy
+select f.id, d.region from ses_fact f join ses_dim d on f.dim_id = d.id
+where f.id <= 3
+union all
+select f.id + 1000, d.region from ses_dim d join ses_fact f on f.dim_id = d.id
+where f.id <= 3
+order by 1;
+
+-- only one branch has the join, nothing is shared
+select count(*) from (
+select f.id from ses_fact f join ses_dim d on f.dim_id = d.id
+union all
+select id from ses_fact
+) s;
+
+reset optimizer_enable_subexpression_sharing;
+reset optimizer_cte_inlining;
+
+drop function ses_count_shared_scans(text);
+drop table ses_fact, ses_dim;